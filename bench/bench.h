@@ -0,0 +1,33 @@
+#ifndef MCL_0C5D8E2B7A4F4E19B3D6F1A8E27C9B40
+#define MCL_0C5D8E2B7A4F4E19B3D6F1A8E27C9B40
+
+#include "mcl/typedef.h"
+#include "mcl/keyword.h"
+#include <stdio.h>
+#include <time.h>
+
+MCL_STDC_BEGIN
+
+MCL_INLINE uint64_t MclBench_GetNowNs() {
+	struct timespec ts;
+	(void)clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+MCL_INLINE void MclBench_Report(const char *name, uint64_t startNs, MclSize ops) {
+	uint64_t ns = MclBench_GetNowNs() - startNs;
+	printf("%-40s %10.2f ms %8.2f ns/op\n", name, ns / 1e6, ops ? (double)ns / ops : 0.0);
+}
+
+/* Keeps the result alive so the measured loop is not optimized away */
+MCL_INLINE void MclBench_Consume(uintptr_t value) {
+	__asm__ __volatile__("" : : "r"(value) : "memory");
+}
+
+void MclBench_RunMap(MclSize count);
+void MclBench_RunConcurrentMap(MclSize count);
+void MclBench_RunRingBuff(MclSize count);
+
+MCL_STDC_END
+
+#endif
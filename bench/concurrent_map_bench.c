@@ -0,0 +1,134 @@
+#include "bench.h"
+#include "mcl/map/concurrent_hash_map.h"
+#include "mcl/map/hash_map.h"
+#include "mcl/lock/rwlock.h"
+#include "mcl/thread/thread.h"
+#include "mcl/array/array_size.h"
+#include "mcl/mem/memory.h"
+#include "mcl/assert.h"
+
+/* Keys in map, small enough to stay in cache, so it measures reader contention rather than misses */
+#define MCL_CONCURRENT_BENCH_KEY_COUNT (64 * 1024)
+
+typedef struct {
+	const char *name;
+	void* (*create)(MclSize count);
+	void (*destroy)(void *map);
+	void (*set)(void *map, MclHashKey, MclHashValue);
+	MclHashValue (*get)(void *map, MclHashKey);
+} MclConcurrentMapBench;
+
+typedef struct {
+	MclHashMap *map;
+	MclRwLock rwlock;
+} MclRwLockHashMap;
+
+MCL_PRIVATE void* MclConcurrentMapBench_CreateRwLock(MclSize count) {
+	MclRwLockHashMap *self = MCL_MALLOC(sizeof(MclRwLockHashMap));
+	MCL_ASSERT_VALID_PTR_NIL(self);
+
+	self->map = MclHashMap_CreateDefault();
+	(void)MclHashMap_Reserve(self->map, count);
+	(void)MclRwLock_Init(&self->rwlock, NULL);
+	return self;
+}
+
+MCL_PRIVATE void MclConcurrentMapBench_DeleteRwLock(void *map) {
+	MclRwLockHashMap *self = map;
+	MclHashMap_Delete(self->map, NULL);
+	(void)MclRwLock_Destroy(&self->rwlock);
+	MCL_FREE(self);
+}
+
+MCL_PRIVATE void MclConcurrentMapBench_SetRwLock(void *map, MclHashKey key, MclHashValue value) {
+	MclRwLockHashMap *self = map;
+	MCL_LOCK_WRITE_AUTO(self->rwlock);
+	(void)MclHashMap_Set(self->map, key, value);
+}
+
+MCL_PRIVATE MclHashValue MclConcurrentMapBench_GetRwLock(void *map, MclHashKey key) {
+	MclRwLockHashMap *self = map;
+	MCL_LOCK_READ_AUTO(self->rwlock);
+	return MclHashMap_Get(self->map, key);
+}
+
+MCL_PRIVATE void* MclConcurrentMapBench_CreateConcurrent(MclSize count) {
+	return MclConcurrentHashMap_Create(count);
+}
+
+MCL_PRIVATE void MclConcurrentMapBench_DeleteConcurrent(void *map) {
+	MclConcurrentHashMap_Delete(map, NULL);
+}
+
+MCL_PRIVATE void MclConcurrentMapBench_SetConcurrent(void *map, MclHashKey key, MclHashValue value) {
+	(void)MclConcurrentHashMap_Set(map, key, value);
+}
+
+MCL_PRIVATE MclHashValue MclConcurrentMapBench_GetConcurrent(void *map, MclHashKey key) {
+	return MclConcurrentHashMap_Get(map, key);
+}
+
+MCL_PRIVATE const MclConcurrentMapBench benches[] = {
+	{"RwLockHashMap", MclConcurrentMapBench_CreateRwLock, MclConcurrentMapBench_DeleteRwLock,
+			MclConcurrentMapBench_SetRwLock, MclConcurrentMapBench_GetRwLock},
+	{"ConcurrentHashMap", MclConcurrentMapBench_CreateConcurrent, MclConcurrentMapBench_DeleteConcurrent,
+			MclConcurrentMapBench_SetConcurrent, MclConcurrentMapBench_GetConcurrent},
+};
+
+MCL_PRIVATE const MclSize threadCounts[] = {1, 2, 4, 8, 16, 32};
+
+///////////////////////////////////////////////////////////
+typedef struct {
+	const MclConcurrentMapBench *bench;
+	void *map;
+	MclSize count;
+	uint64_t seed;
+} MclConcurrentMapReader;
+
+MCL_PRIVATE void* MclConcurrentMapReader_Run(void *arg) {
+	MclConcurrentMapReader *self = arg;
+	uintptr_t sum = 0;
+	uint64_t state = self->seed;
+
+	for (MclSize i = 0; i < self->count; i++) {
+		state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+		sum += (uintptr_t)self->bench->get(self->map, (state >> 33) % MCL_CONCURRENT_BENCH_KEY_COUNT);
+	}
+	MclBench_Consume(sum);
+	return NULL;
+}
+
+/* Each reader does count gets, ns/op is wall time over all gets, so it falls when readers scale */
+MCL_PRIVATE void MclConcurrentMapBench_Run(const MclConcurrentMapBench *bench, MclSize threadCount, MclSize count) {
+	char name[64];
+	MclThread threads[threadCount];
+	MclConcurrentMapReader readers[threadCount];
+
+	void *map = bench->create(MCL_CONCURRENT_BENCH_KEY_COUNT);
+	MCL_ASSERT_VALID_PTR_VOID(map);
+
+	for (MclHashKey key = 0; key < MCL_CONCURRENT_BENCH_KEY_COUNT; key++) {
+		bench->set(map, key, (MclHashValue)(uintptr_t)(key + 1));
+	}
+
+	uint64_t start = MclBench_GetNowNs();
+	for (MclSize i = 0; i < threadCount; i++) {
+		readers[i] = (MclConcurrentMapReader){.bench = bench, .map = map, .count = count, .seed = i + 1};
+		(void)MclThread_Create(&threads[i], NULL, MclConcurrentMapReader_Run, &readers[i]);
+	}
+	for (MclSize i = 0; i < threadCount; i++) {
+		(void)MclThread_Join(threads[i], NULL);
+	}
+	(void)snprintf(name, sizeof(name), "%s get %u readers", bench->name, threadCount);
+	MclBench_Report(name, start, count * threadCount);
+
+	bench->destroy(map);
+}
+
+void MclBench_RunConcurrentMap(MclSize count) {
+	for (MclSize i = 0; i < MCL_ARRAY_SIZE(benches); i++) {
+		for (MclSize j = 0; j < MCL_ARRAY_SIZE(threadCounts); j++) {
+			MclConcurrentMapBench_Run(&benches[i], threadCounts[j], count);
+		}
+	}
+}
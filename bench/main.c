@@ -0,0 +1,14 @@
+#include "bench.h"
+#include <stdlib.h>
+
+#define MCL_BENCH_COUNT_DEFAULT (1024 * 1024)
+
+int main(int argc, char **argv) {
+	MclSize count = (argc > 1) ? (MclSize)strtoul(argv[1], NULL, 10) : MCL_BENCH_COUNT_DEFAULT;
+
+	printf("mcl bench with %u entries\n", count);
+	MclBench_RunMap(count);
+	MclBench_RunConcurrentMap(count);
+	MclBench_RunRingBuff(count);
+	return 0;
+}
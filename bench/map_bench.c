@@ -0,0 +1,216 @@
+#include "bench.h"
+#include "mcl/map/hash_map.h"
+#include "mcl/map/flat_hash_map.h"
+#include "mcl/array/array_size.h"
+#include "mcl/algo/loop.h"
+#include "mcl/mem/memory.h"
+#include "mcl/assert.h"
+
+typedef struct {
+	const char *name;
+	void* (*create)(MclSize count);
+	void (*destroy)(void *map);
+	void (*set)(void *map, MclHashKey, MclHashValue);
+	MclHashValue (*get)(const void *map, MclHashKey);
+	MclHashValue (*remove)(void *map, MclHashKey);
+} MclMapBench;
+
+/* Maps start small to take the cost of growing into account */
+MCL_PRIVATE void* MclMapBench_CreateChained(MclSize count) {
+	return MclHashMap_CreateDefault();
+}
+
+MCL_PRIVATE void* MclMapBench_CreateReserved(MclSize count) {
+	MclHashMap *map = MclHashMap_CreateDefault();
+	MCL_ASSERT_VALID_PTR_NIL(map);
+
+	(void)MclHashMap_Reserve(map, count);
+	return map;
+}
+
+MCL_PRIVATE void* MclMapBench_CreateSlab(MclSize count) {
+	return MclHashMap_Create(MCL_HASHMAP_BUCKET_COUNT_DEFAULT, &MclHashNodeAllocator_Slab);
+}
+
+MCL_PRIVATE void MclMapBench_DeleteChained(void *map) {
+	MclHashMap_Delete(map, NULL);
+}
+
+MCL_PRIVATE void MclMapBench_SetChained(void *map, MclHashKey key, MclHashValue value) {
+	(void)MclHashMap_Set(map, key, value);
+}
+
+MCL_PRIVATE MclHashValue MclMapBench_GetChained(const void *map, MclHashKey key) {
+	return MclHashMap_Get(map, key);
+}
+
+MCL_PRIVATE MclHashValue MclMapBench_RemoveChained(void *map, MclHashKey key) {
+	return MclHashMap_Remove(map, key);
+}
+
+MCL_PRIVATE void* MclMapBench_CreateFlat(MclSize count) {
+	return MclFlatHashMap_CreateDefault();
+}
+
+MCL_PRIVATE void MclMapBench_DeleteFlat(void *map) {
+	MclFlatHashMap_Delete(map, NULL);
+}
+
+MCL_PRIVATE void MclMapBench_SetFlat(void *map, MclHashKey key, MclHashValue value) {
+	(void)MclFlatHashMap_Set(map, key, value);
+}
+
+MCL_PRIVATE MclHashValue MclMapBench_GetFlat(const void *map, MclHashKey key) {
+	return MclFlatHashMap_Get(map, key);
+}
+
+MCL_PRIVATE MclHashValue MclMapBench_RemoveFlat(void *map, MclHashKey key) {
+	return MclFlatHashMap_Remove(map, key);
+}
+
+MCL_PRIVATE const MclMapBench benches[] = {
+	{"HashMap", MclMapBench_CreateChained, MclMapBench_DeleteChained,
+			MclMapBench_SetChained, MclMapBench_GetChained, MclMapBench_RemoveChained},
+	{"HashMapReserved", MclMapBench_CreateReserved, MclMapBench_DeleteChained,
+			MclMapBench_SetChained, MclMapBench_GetChained, MclMapBench_RemoveChained},
+	{"HashMapSlab", MclMapBench_CreateSlab, MclMapBench_DeleteChained,
+			MclMapBench_SetChained, MclMapBench_GetChained, MclMapBench_RemoveChained},
+	{"FlatHashMap", MclMapBench_CreateFlat, MclMapBench_DeleteFlat,
+			MclMapBench_SetFlat, MclMapBench_GetFlat, MclMapBench_RemoveFlat},
+};
+
+///////////////////////////////////////////////////////////
+MCL_PRIVATE uint64_t MclMapBench_Random(uint64_t *state) {
+	*state ^= *state << 13;
+	*state ^= *state >> 7;
+	*state ^= *state << 17;
+	return *state;
+}
+
+/* Keys in random order, dense ones are ids in 0..count-1, sparse ones spread over 63 bits,
+ * the top bit is kept clear for keys never set. */
+MCL_PRIVATE void MclMapBench_InitKeys(MclHashKey *keys, MclSize count, bool isSparse) {
+	uint64_t state = 0x2545f4914f6cdd1dULL;
+	for (MclSize i = 0; i < count; i++) {
+		keys[i] = isSparse ? (MclHashKey_Hash(i) & ~(1ULL << 63)) : i;
+	}
+	for (MclSize i = count; i > 1; i--) {
+		MclSize j = (MclSize)(MclMapBench_Random(&state) % i);
+		MclHashKey key = keys[i - 1];
+		keys[i - 1] = keys[j];
+		keys[j] = key;
+	}
+}
+
+MCL_PRIVATE void MclMapBench_Run(const MclMapBench *bench, const char *mode, const MclHashKey *keys, MclSize count) {
+	char name[64];
+	uintptr_t sum = 0;
+
+	void *map = bench->create(count);
+	MCL_ASSERT_VALID_PTR_VOID(map);
+
+	uint64_t start = MclBench_GetNowNs();
+	for (MclSize i = 0; i < count; i++) {
+		bench->set(map, keys[i], (MclHashValue)(uintptr_t)(keys[i] + 1));
+	}
+	(void)snprintf(name, sizeof(name), "%s set %s", bench->name, mode);
+	MclBench_Report(name, start, count);
+
+	start = MclBench_GetNowNs();
+	for (MclSize i = 0; i < count; i++) {
+		sum += (uintptr_t)bench->get(map, keys[count - 1 - i]);
+	}
+	(void)snprintf(name, sizeof(name), "%s get hit %s", bench->name, mode);
+	MclBench_Report(name, start, count);
+
+	start = MclBench_GetNowNs();
+	for (MclSize i = 0; i < count; i++) {
+		sum += (uintptr_t)bench->get(map, keys[i] | (1ULL << 63));
+	}
+	(void)snprintf(name, sizeof(name), "%s get miss %s", bench->name, mode);
+	MclBench_Report(name, start, count);
+
+	start = MclBench_GetNowNs();
+	for (MclSize i = 0; i < count; i++) {
+		sum += (uintptr_t)bench->remove(map, keys[i]);
+	}
+	(void)snprintf(name, sizeof(name), "%s remove %s", bench->name, mode);
+	MclBench_Report(name, start, count);
+
+	MclBench_Consume(sum);
+	bench->destroy(map);
+}
+
+/* Keys resolved per request by a query, looked up one by one or as one batch */
+#define MCL_MAP_BENCH_BATCH 256
+
+MCL_PRIVATE void MclMapBench_RunBatch(const char *mode, const MclHashKey *keys, MclSize count) {
+	char name[64];
+	uintptr_t sum = 0;
+	MclHashValue values[MCL_MAP_BENCH_BATCH];
+
+	MclHashMap *map = MclHashMap_CreateDefault();
+	MCL_ASSERT_VALID_PTR_VOID(map);
+
+	uint64_t start = MclBench_GetNowNs();
+	for (MclSize base = 0; base < count; base += MCL_MAP_BENCH_BATCH) {
+		MclSize batch = ((count - base) < MCL_MAP_BENCH_BATCH) ? (count - base) : MCL_MAP_BENCH_BATCH;
+		for (MclSize i = 0; i < batch; i++) {
+			values[i] = (MclHashValue)(uintptr_t)(keys[base + i] + 1);
+		}
+		(void)MclHashMap_SetBatch(map, keys + base, values, batch, NULL);
+	}
+	(void)snprintf(name, sizeof(name), "HashMap set batch %s", mode);
+	MclBench_Report(name, start, count);
+
+	start = MclBench_GetNowNs();
+	for (MclSize base = 0; base + MCL_MAP_BENCH_BATCH <= count; base += MCL_MAP_BENCH_BATCH) {
+		for (MclSize i = 0; i < MCL_MAP_BENCH_BATCH; i++) {
+			sum += (uintptr_t)MclHashMap_Get(map, keys[count - 1 - base - i]);
+		}
+	}
+	(void)snprintf(name, sizeof(name), "HashMap get loop %s", mode);
+	MclBench_Report(name, start, count);
+
+	MclHashKey *reversed = MCL_MALLOC(sizeof(MclHashKey) * count);
+	MCL_ASSERT_VALID_PTR_VOID(reversed);
+	for (MclSize i = 0; i < count; i++) {
+		reversed[i] = keys[count - 1 - i];
+	}
+
+	start = MclBench_GetNowNs();
+	for (MclSize base = 0; base + MCL_MAP_BENCH_BATCH <= count; base += MCL_MAP_BENCH_BATCH) {
+		MclHashMap_GetBatch(map, reversed + base, MCL_MAP_BENCH_BATCH, values);
+		for (MclSize i = 0; i < MCL_MAP_BENCH_BATCH; i++) {
+			sum += (uintptr_t)values[i];
+		}
+	}
+	(void)snprintf(name, sizeof(name), "HashMap get batch %s", mode);
+	MclBench_Report(name, start, count);
+
+	start = MclBench_GetNowNs();
+	for (MclSize base = 0; base < count; base += MCL_MAP_BENCH_BATCH) {
+		MclSize batch = ((count - base) < MCL_MAP_BENCH_BATCH) ? (count - base) : MCL_MAP_BENCH_BATCH;
+		sum += MclHashMap_RemoveBatch(map, keys + base, batch, values);
+	}
+	(void)snprintf(name, sizeof(name), "HashMap remove batch %s", mode);
+	MclBench_Report(name, start, count);
+
+	MclBench_Consume(sum);
+	MCL_FREE(reversed);
+	MclHashMap_Delete(map, NULL);
+}
+
+void MclBench_RunMap(MclSize count) {
+	MclHashKey *keys = MCL_MALLOC(sizeof(MclHashKey) * count);
+	MCL_ASSERT_VALID_PTR_VOID(keys);
+
+	MCL_LOOP_FOREACH_INDEX(sparse, 2) {
+		MclMapBench_InitKeys(keys, count, sparse);
+		for (MclSize i = 0; i < MCL_ARRAY_SIZE(benches); i++) {
+			MclMapBench_Run(&benches[i], sparse ? "sparse" : "dense", keys, count);
+		}
+		MclMapBench_RunBatch(sparse ? "sparse" : "dense", keys, count);
+	}
+	MCL_FREE(keys);
+}
@@ -0,0 +1,61 @@
+#include "bench.h"
+#include "mcl/ringbuff/ringbuff.h"
+#include "mcl/thread/thread.h"
+#include "mcl/assert.h"
+
+#define MCL_RINGBUFF_BENCH_CAPACITY 1024
+
+typedef struct {
+	MclRingBuff *ringbuff;
+	MclSize count;
+	uintptr_t sum;
+} MclRingBuffStream;
+
+MCL_PRIVATE void* MclRingBuffStream_Send(void *arg) {
+	MclRingBuffStream *self = arg;
+	for (MclSize i = 0; i < self->count;) {
+		if (MCL_FAILED(MclRingBuff_Put(self->ringbuff, &i))) {
+			MclThread_Yield();
+			continue;
+		}
+		i++;
+	}
+	return NULL;
+}
+
+MCL_PRIVATE void* MclRingBuffStream_Recv(void *arg) {
+	MclRingBuffStream *self = arg;
+	for (MclSize received = 0; received < self->count;) {
+		MclSize value = 0;
+		if (MCL_FAILED(MclRingBuff_Pop(self->ringbuff, &value))) {
+			MclThread_Yield();
+			continue;
+		}
+		self->sum += value;
+		received++;
+	}
+	return NULL;
+}
+
+/* One producer and one consumer thread, ns/op is wall time over all msgs */
+MCL_PRIVATE void MclRingBuffBench_Run(const char *name, MclRingBuff *ringbuff, MclSize count) {
+	MCL_ASSERT_VALID_PTR_VOID(ringbuff);
+
+	MclRingBuffStream stream = {.ringbuff = ringbuff, .count = count, .sum = 0};
+	MclThread producer, consumer;
+
+	uint64_t start = MclBench_GetNowNs();
+	(void)MclThread_Create(&producer, NULL, MclRingBuffStream_Send, &stream);
+	(void)MclThread_Create(&consumer, NULL, MclRingBuffStream_Recv, &stream);
+	(void)MclThread_Join(producer, NULL);
+	(void)MclThread_Join(consumer, NULL);
+	MclBench_Report(name, start, count);
+
+	MclBench_Consume(stream.sum);
+	MclRingBuff_Delete(ringbuff);
+}
+
+void MclBench_RunRingBuff(MclSize count) {
+	MclRingBuffBench_Run("RingBuff put/pop", MclRingBuff_Create(MCL_RINGBUFF_BENCH_CAPACITY, sizeof(MclSize)), count);
+	MclRingBuffBench_Run("RingBuffSpsc put/pop", MclRingBuff_CreateSpsc(MCL_RINGBUFF_BENCH_CAPACITY, sizeof(MclSize)), count);
+}
@@ -4,13 +4,13 @@
 
 void MclAggregatorMap_Init(MclAggregatorMap *self, MclHashBucket *bucket, MclSize bucketCount) {
 	MCL_ASSERT_VALID_PTR_VOID(self);
-	MclHashMap_Init(self, bucket, bucketCount, &MclHashNodeAllocator_Default);
+	MclHashMap_InitGrowable(self, bucket, bucketCount, &MclHashNodeAllocator_Default);
 }
 
 void MclAggregatorMap_Destroy(MclAggregatorMap *self, MclAggregatorMapElemDestroy destroy) {
 	MCL_ASSERT_VALID_PTR_VOID(self);
 
-	MclHashMap_Clear(self, (MclHashValueDestroy)destroy);
+	MclHashMap_Destroy(self, (MclHashValueDestroy)destroy);
 }
 
 MclAggregator* MclAggregatorMap_Insert(MclAggregatorMap *self, MclAggregator *aggregator) {
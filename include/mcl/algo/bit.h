@@ -27,4 +27,6 @@
 #define MCL_BITS_IS_ON(DATA, MASK)          (MCL_BITS_TEST(DATA, MASK) == (MASK))
 #define MCL_BITS_IS_OFF(DATA, MASK)         (MCL_BITS_TEST(DATA, MASK) == 0)
 
+#define MCL_BIT_IS_POWER_OF_2(DATA)         (((DATA) != 0) && (((DATA) & ((DATA) - 1)) == 0))
+
 #endif
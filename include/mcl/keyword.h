@@ -14,6 +14,7 @@
 	#define MCL_PLACEHOLDER     __attribute__ ((weak))
     #define MCL_MALLOC_API      __attribute__ ((malloc))
     #define MCL_PURE            __attribute__ ((pure))
+    #define MCL_NOINLINE        __attribute__ ((noinline))
     #define MCL_UNUSED          __attribute__ ((unused))
     #define MCL_PUBLIC          __attribute__ ((visibility ("default")))
     #define MCL_LOCAL           __attribute__ ((visibility ("hidden")))
@@ -25,6 +26,7 @@
     #define MCL_RAII(function)
     #define MCL_MALLOC_API
     #define MCL_PURE
+    #define MCL_NOINLINE
     #define MCL_UNUSED
     #define MCL_PUBLIC
     #define MCL_LOCAL
@@ -6,6 +6,7 @@
 MCL_STDC_BEGIN
 
 MCL_TYPE_DECL(MclListNode);
+MCL_TYPE_DECL(MclSlabCache);
 
 MCL_INTERFACE(MclListNodeAllocator) {
     MclListNode* (*alloc)(MclListNodeAllocator*);
@@ -22,6 +23,11 @@ MCL_INLINE void MclListNodeAllocator_Free(MclListNodeAllocator *self, MclListNod
 
 extern MclListNodeAllocator MclListNodeAllocator_Default;
 
+/* Nodes from a slab cache shared by all users, see mcl/mem/slab.h */
+extern MclListNodeAllocator MclListNodeAllocator_Slab;
+
+MclSlabCache* MclListNodeAllocator_GetSlabCache();
+
 /////////////////////////////////////////////////////////
 #define MCL_LIST_NODE_ALLOCATOR(ALLOC, FREE) {.alloc = ALLOC, .free = FREE}
 
@@ -0,0 +1,34 @@
+#ifndef H5B0F7E2A_3C41_4D8E_9A6B_2F1C8D7E4A90
+#define H5B0F7E2A_3C41_4D8E_9A6B_2F1C8D7E4A90
+
+#include "mcl/list/list_node_allocator.h"
+#include "mcl/status.h"
+
+MCL_STDC_BEGIN
+
+/* List node allocator recycles freed nodes in a free list, nodes come from heap
+ * only when the free list is empty and go back to heap at destroy.
+ * NOT thread safe, the owner of lists should protect it.
+ * allocator must be the first member, callbacks cast it back to the pool. */
+MCL_TYPE(MclListNodePool) {
+    MclListNodeAllocator allocator;
+    MclListNode *freeNodes;
+    MclSize freeCount;
+};
+
+MclStatus MclListNodePool_Init(MclListNodePool*, MclSize preallocCount);
+
+/* IMPORTANT: SHOULD INVOKE AFTER ALL NODES FREED TO THE POOL!!! */
+void MclListNodePool_Destroy(MclListNodePool*);
+
+MCL_INLINE MclListNodeAllocator* MclListNodePool_GetAllocator(MclListNodePool *self) {
+    return self ? &self->allocator : NULL;
+}
+
+MCL_INLINE MclSize MclListNodePool_GetFreeCount(const MclListNodePool *self) {
+    return self ? self->freeCount : 0;
+}
+
+MCL_STDC_END
+
+#endif
@@ -76,6 +76,30 @@ MCL_INLINE MclAtomic MclAtomic_CompareSwapVal(MclAtomic *self, MclSize oldValue,
     return __sync_val_compare_and_swap(self, oldValue, newValue);
 }
 
+MCL_INLINE MclAtomic MclAtomic_LoadRelaxed(const MclAtomic *self) {
+    return __atomic_load_n(self, __ATOMIC_RELAXED);
+}
+
+MCL_INLINE MclAtomic MclAtomic_LoadAcquire(const MclAtomic *self) {
+    return __atomic_load_n(self, __ATOMIC_ACQUIRE);
+}
+
+MCL_INLINE void MclAtomic_StoreRelease(MclAtomic *self, MclSize value) {
+    __atomic_store_n(self, value, __ATOMIC_RELEASE);
+}
+
+MCL_INLINE void MclAtomic_StoreRelaxed(MclAtomic *self, MclSize value) {
+    __atomic_store_n(self, value, __ATOMIC_RELAXED);
+}
+
+MCL_INLINE bool MclAtomic_CompareExchange(MclAtomic *self, MclSize *expected, MclSize desired) {
+    return __atomic_compare_exchange_n(self, expected, desired, false, __ATOMIC_SEQ_CST, __ATOMIC_RELAXED);
+}
+
+MCL_INLINE bool MclAtomic_CompareExchangeRelaxed(MclAtomic *self, MclSize *expected, MclSize desired) {
+    return __atomic_compare_exchange_n(self, expected, desired, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED);
+}
+
 #define MCL_ATOMIC_SYNC(...)  __sync_synchronize(__VA_ARGS__)
 
 MCL_STDC_END
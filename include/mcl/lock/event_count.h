@@ -0,0 +1,58 @@
+#ifndef MCL_7E21C0D94B3A4F58A6D2E85B19F3C640
+#define MCL_7E21C0D94B3A4F58A6D2E85B19F3C640
+
+#include "mcl/lock/atomic.h"
+#include "mcl/lock/mutex.h"
+#include "mcl/lock/cond.h"
+#include "mcl/time/time_type.h"
+
+MCL_STDC_BEGIN
+
+#if defined(MCL_OS_LINUX) && defined(__linux__)
+#define MCL_EVENT_COUNT_FUTEX
+#endif
+
+/*
+ * Event count for blocking on a lock free condition:
+ *   key = PrepareWait(); if (condition) CancelWait(); else WaitUntil(key, deadline);
+ * Notifier changes the condition first then calls Notify, which only
+ * pays the wake syscall when some waiter exists.
+ * Parks on futex in linux, else falls back to mutex and cond.
+ */
+MCL_TYPE(MclEventCount) {
+    MclAtomic epoch;
+    MclAtomic waiters;
+#ifndef MCL_EVENT_COUNT_FUTEX
+    MclMutex mutex;
+    MclCond cond;
+#endif
+};
+
+MclStatus MclEventCount_Init(MclEventCount*);
+void MclEventCount_Destroy(MclEventCount*);
+
+MclSize MclEventCount_PrepareWait(MclEventCount*);
+void MclEventCount_CancelWait(MclEventCount*);
+
+/* Returns MCL_TIMEDOUT when deadline passed, else caller should check condition again */
+MclStatus MclEventCount_WaitUntil(MclEventCount*, MclSize key, MclTimeUs deadline);
+
+void MclEventCount_Notify(MclEventCount*);
+void MclEventCount_NotifyAll(MclEventCount*);
+
+/* Wakes at most count waiters by one syscall, e.g. one per batch of new items */
+void MclEventCount_NotifyN(MclEventCount*, MclSize count);
+
+/* Deadline is in monotonic us, MCL_TIME_US_INVALID means wait forever */
+MclTimeUs MclEventCount_GetDeadline(MclTimeUs timeoutUs);
+
+///////////////////////////////////////////////////////////
+#ifdef MCL_EVENT_COUNT_FUTEX
+#define MCL_EVENT_COUNT() {.epoch = 0, .waiters = 0}
+#else
+#define MCL_EVENT_COUNT() {.epoch = 0, .waiters = 0, .mutex = MCL_MUTEX(), .cond = MCL_COND()}
+#endif
+
+MCL_STDC_END
+
+#endif
@@ -8,15 +8,31 @@ MCL_STDC_BEGIN
 
 MCL_TYPE_DECL(MclFuture);
 
+/* Callback gets the result instead of the future, which may be deleted by its getter then */
+typedef void (*MclFutureCallback)(MclStatus, void *value, void *ctxt);
+
 MclFuture* MclFuture_Create();
 void MclFuture_Delete(MclFuture*);
 
 void MclFuture_Stop(MclFuture*);
 bool MclFuture_IsReady(const MclFuture*);
 
-void MclFuture_Set(MclFuture*, MclStatus, void*);
+/* Fails if the future is already set or stopped */
+MclStatus MclFuture_Set(MclFuture*, MclStatus, void*);
 void MclFuture_Get(MclFuture*, MclStatus*, void**);
 
+/* Callback runs once in the thread setting or stopping the future, or right now if it is ready */
+MclStatus MclFuture_OnReady(MclFuture*, MclFutureCallback, void *ctxt);
+
+/* Unregisters the callback of ctxt, fails if it is not registered or already taken to run */
+MclStatus MclFuture_CancelOnReady(MclFuture*, MclFutureCallback, void *ctxt);
+
+/* Input futures should live until they are ready.
+ * WhenAll is ready after all ready, with MCL_SUCCESS or the first failed status.
+ * WhenAny is ready with the status and value of the first ready one. */
+MclFuture* MclFuture_WhenAll(MclFuture **futures, MclSize count);
+MclFuture* MclFuture_WhenAny(MclFuture **futures, MclSize count);
+
 MCL_STDC_END
 
 #endif
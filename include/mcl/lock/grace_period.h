@@ -0,0 +1,63 @@
+#ifndef MCL_A4C27E9B51D84F6E9D03B7F2C8E61A5D
+#define MCL_A4C27E9B51D84F6E9D03B7F2C8E61A5D
+
+#include "mcl/typedef.h"
+#include "mcl/keyword.h"
+#include "mcl/macro/symbol.h"
+
+MCL_STDC_BEGIN
+
+/*
+ * Grace period defers freeing shared nodes until no reader can still see them.
+ * Readers wrap lookups in ReadLock and ReadUnlock, which write only a record of
+ * the calling thread and never a line shared with other readers. Writers
+ * unlink a node under their own lock, then Retire it to be freed later, or
+ * Synchronize to wait until all read sections entered before are left.
+ * Read sections may nest, and should never wait for a writer in Synchronize.
+ */
+typedef struct MclGraceNode {
+	struct MclGraceNode *next;
+	void (*free)(struct MclGraceNode*);
+	uint64_t epoch;
+} MclGraceNode;
+
+typedef void (*MclGraceNodeFree)(MclGraceNode*);
+
+void MclGracePeriod_ReadLock();
+void MclGracePeriod_ReadUnlock();
+
+bool MclGracePeriod_IsReading();
+
+/* Blocks until all read sections entered before it are left, then reclaims */
+void MclGracePeriod_Synchronize();
+
+/* Never blocks, node is freed by a later Retire, Reclaim or Synchronize after its grace period */
+void MclGracePeriod_Retire(MclGraceNode*, MclGraceNodeFree);
+
+/* Frees the retired nodes whose grace period passed, returns the count freed */
+MclSize MclGracePeriod_Reclaim();
+
+///////////////////////////////////////////////////////////
+/* Retired nodes pending before Retire tries to reclaim */
+#ifndef MCL_GRACE_PERIOD_RECLAIM_BATCH
+#define MCL_GRACE_PERIOD_RECLAIM_BATCH 64
+#endif
+
+MCL_INLINE bool MclGracePeriod_AutoReadLock() {
+	MclGracePeriod_ReadLock();
+	return true;
+}
+
+MCL_INLINE void MclGracePeriod_AutoReadUnlock(bool *isLocked) {
+	if (isLocked && *isLocked) {
+		MclGracePeriod_ReadUnlock();
+		*isLocked = false;
+	}
+}
+
+#define MCL_GRACE_READ_AUTO											\
+MCL_RAII(MclGracePeriod_AutoReadUnlock) bool MCL_SYMBOL_UNIQUE(MCL_GRACE_READ) = MclGracePeriod_AutoReadLock()
+
+MCL_STDC_END
+
+#endif
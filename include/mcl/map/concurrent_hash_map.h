@@ -0,0 +1,61 @@
+#ifndef MCL_3E8F1C6A07B94D2B95E4A1D6C72F0B38
+#define MCL_3E8F1C6A07B94D2B95E4A1D6C72F0B38
+
+#include "mcl/typedef.h"
+#include "mcl/map/hash_key.h"
+#include "mcl/map/hash_value.h"
+#include "mcl/status.h"
+
+MCL_STDC_BEGIN
+
+/*
+ * Hash map for many readers and few writers. Get and Accept take no lock and
+ * write no shared memory, they only enter a grace period read section (see
+ * mcl/lock/grace_period.h), so readers scale with threads. Writers lock one of
+ * the striped mutexes by key hash, so writers of different stripes go in
+ * parallel. Nodes removed and tables replaced by growing are retired to the
+ * grace period, and freed after all readers which could see them left.
+ * Values are owned by caller: a value removed may still be returned by a Get
+ * started before, so free it only after MclGracePeriod_Synchronize, or keep
+ * values alive by other means (e.g. reference counting).
+ */
+MCL_TYPE_DECL(MclConcurrentHashMap);
+
+typedef MclStatus (*MclConcurrentHashVisit)(MclHashKey, MclHashValue, void*);
+
+MclConcurrentHashMap* MclConcurrentHashMap_CreateDefault();
+
+/* Buckets are rounded up to power of two, and never less than the stripes */
+MclConcurrentHashMap* MclConcurrentHashMap_Create(MclSize bucketCount);
+
+/* No thread should use the map any more when deleting */
+void MclConcurrentHashMap_Delete(MclConcurrentHashMap*, MclHashValueDestroy);
+
+MclHashValue MclConcurrentHashMap_Get(const MclConcurrentHashMap*, MclHashKey);
+
+/* Returns the replaced value if key exists, otherwise the new value, NULL on failure */
+MclHashValue MclConcurrentHashMap_Set(MclConcurrentHashMap*, MclHashKey, MclHashValue);
+
+MclHashValue MclConcurrentHashMap_Remove(MclConcurrentHashMap*, MclHashKey);
+
+/* Visits a weakly consistent view, stops visiting when visit returns MCL_STATUS_DONE */
+MclStatus MclConcurrentHashMap_Accept(const MclConcurrentHashMap*, MclConcurrentHashVisit, void*);
+
+MclSize MclConcurrentHashMap_GetSize(const MclConcurrentHashMap*);
+
+MclSize MclConcurrentHashMap_GetBucketCount(const MclConcurrentHashMap*);
+
+MCL_INLINE bool MclConcurrentHashMap_IsEmpty(const MclConcurrentHashMap *self) {
+	return MclConcurrentHashMap_GetSize(self) == 0;
+}
+
+///////////////////////////////////////////////////////////
+#ifndef MCL_CONCURRENT_HASHMAP_STRIPE_COUNT
+#define MCL_CONCURRENT_HASHMAP_STRIPE_COUNT 64
+#endif
+
+#define MCL_CONCURRENT_HASHMAP_BUCKET_COUNT_DEFAULT 128
+
+MCL_STDC_END
+
+#endif
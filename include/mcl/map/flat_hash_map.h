@@ -0,0 +1,72 @@
+#ifndef MCL_6B1E0F4A93D24C7F8A52E7D1C08B3F65
+#define MCL_6B1E0F4A93D24C7F8A52E7D1C08B3F65
+
+#include "mcl/typedef.h"
+#include "mcl/map/hash_key.h"
+#include "mcl/map/hash_value.h"
+#include "mcl/status.h"
+
+MCL_STDC_BEGIN
+
+typedef struct {
+	MclHashKey key;
+	MclHashValue value;
+} MclFlatHashSlot;
+
+/*
+ * Open addressing map with keys and values inline in one slot array. Each slot
+ * has a control byte, empty or 7 bits of the key hash, and lookup matches a
+ * group of control bytes at once by SIMD (SSE2, or AVX2 if built with it), so
+ * only slots whose hash bits matched are touched. Probing is linear, which lets
+ * Remove shift the following slots back instead of leaving tombstones, so
+ * lookups never slow down by removes. Table grows by doubling at 7/8 load.
+ * Accept visits in slot order, the map should not be changed while visiting.
+ */
+MCL_TYPE(MclFlatHashMap) {
+	uint8_t *ctrls;
+	MclFlatHashSlot *slots;
+	MclSize capacity;
+	MclSize size;
+};
+
+typedef MclStatus (*MclFlatHashVisit)(MclHashKey, MclHashValue, void*);
+
+MclFlatHashMap* MclFlatHashMap_CreateDefault();
+
+/* Reserves for count entries, which are added without growing */
+MclFlatHashMap* MclFlatHashMap_Create(MclSize count);
+
+void MclFlatHashMap_Delete(MclFlatHashMap*, MclHashValueDestroy);
+
+/* Keeps capacity of the table */
+void MclFlatHashMap_Clear(MclFlatHashMap*, MclHashValueDestroy);
+
+MclHashValue MclFlatHashMap_Get(const MclFlatHashMap*, MclHashKey);
+
+/* Returns the replaced value if key exists, otherwise the new value, NULL on failure */
+MclHashValue MclFlatHashMap_Set(MclFlatHashMap*, MclHashKey, MclHashValue);
+
+MclHashValue MclFlatHashMap_Remove(MclFlatHashMap*, MclHashKey);
+
+/* Stops visiting when visit returns MCL_STATUS_DONE */
+MclStatus MclFlatHashMap_Accept(const MclFlatHashMap*, MclFlatHashVisit, void*);
+
+///////////////////////////////////////////////////////////
+MCL_INLINE MclSize MclFlatHashMap_GetSize(const MclFlatHashMap *self) {
+	return self ? self->size : 0;
+}
+
+MCL_INLINE bool MclFlatHashMap_IsEmpty(const MclFlatHashMap *self) {
+	return MclFlatHashMap_GetSize(self) == 0;
+}
+
+MCL_INLINE MclSize MclFlatHashMap_GetCapacity(const MclFlatHashMap *self) {
+	return self ? self->capacity : 0;
+}
+
+///////////////////////////////////////////////////////////
+#define MCL_FLAT_HASHMAP_COUNT_DEFAULT 64
+
+MCL_STDC_END
+
+#endif
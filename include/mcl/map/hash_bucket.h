@@ -23,6 +23,7 @@ MclHashValue MclHashBucket_RemoveByPred(MclHashBucket*, MclHashNodePred, void*,
 
 MclSize MclHashBucket_RemoveAllByPred(MclHashBucket*, MclHashNodePred, void*, MclHashNodeAllocator*, MclHashValueDestroy);
 
+/* Returns MCL_STATUS_DONE if visit stopped it, so the map stops visiting other buckets too */
 MclStatus MclHashBucket_Accept(const MclHashBucket*, MclHashNodeVisit, void*);
 
 void MclHashBucket_Dump(const MclHashBucket*);
@@ -13,6 +13,17 @@ MCL_INLINE bool MclHashKey_IsValid(MclHashKey self) {
 	return self != MCL_HASH_KEY_INVALID;
 }
 
+/* Keys are often ids in sequence, mixes all bits into the low ones for tables taking the low bits */
+MCL_INLINE uint64_t MclHashKey_Hash(MclHashKey self) {
+	uint64_t h = self;
+	h ^= h >> 33;
+	h *= 0xff51afd7ed558ccdULL;
+	h ^= h >> 33;
+	h *= 0xc4ceb9fe1a85ec53ULL;
+	h ^= h >> 33;
+	return h;
+}
+
 MCL_STDC_END
 
 #endif
@@ -6,11 +6,28 @@
 
 MCL_STDC_BEGIN
 
+/*
+ * Growable map grows the buckets by doubling when size passes bucket count.
+ * Growing is incremental: the old buckets are kept and each insert or remove
+ * moves a few of them to the new ones, until all moved the old ones are freed,
+ * so no single call rehashes the whole map. A key lives in its old bucket
+ * until the bucket is moved. Buckets given by Init are never freed by the map.
+ * Map by Create is growable, map on buckets given by Init or MCL_HASHMAP only
+ * grows by InitGrowable or Reserve, so a map only cleared never holds grown buckets.
+ * Buckets never come from the node allocator, so a growable map without
+ * allocator grows too; map neither growable nor with allocator never allocates.
+ */
 MCL_TYPE(MclHashMap) {
 	MclHashNodeAllocator *allocator;
     MclHashBucket *buckets;
     MclSize bucketCount;
     MclSize size;
+    MclHashBucket *oldBuckets;
+    MclSize oldBucketCount;
+    MclSize movedCount;
+    bool isBucketsOwned;
+    bool isOldBucketsOwned;
+    bool isGrowable;
 };
 
 MclHashMap* MclHashMap_CreateDefault();
@@ -20,8 +37,18 @@ void MclHashMap_Delete(MclHashMap*, MclHashValueDestroy);
 
 /* if allocator is null, should only use node apis: insertNode removeNode and findNode */
 void MclHashMap_Init(MclHashMap*, MclHashBucket*, MclSize bucketCount, MclHashNodeAllocator*);
+
+/* Grows past the given buckets when size passes bucket count, should end with Destroy */
+void MclHashMap_InitGrowable(MclHashMap*, MclHashBucket*, MclSize bucketCount, MclHashNodeAllocator*);
 void MclHashMap_Clear(MclHashMap*, MclHashValueDestroy);
 
+/* Clears and frees the buckets grown by map, map given by Init should end with it */
+void MclHashMap_Destroy(MclHashMap*, MclHashValueDestroy);
+
+/* Grows to hold count entries without growing again, rehashes at once, for bulk load,
+ * map given by Init should end with Destroy after it, fails on map that never allocates */
+MclStatus MclHashMap_Reserve(MclHashMap*, MclSize count);
+
 ///////////////////////////////////////////////////////////
 MclStatus MclHashMap_InsertNode(MclHashMap*, MclHashNode*);
 MclStatus MclHashMap_RemoveNode(MclHashMap*, MclHashNode*, MclHashValueDestroy);
@@ -34,6 +61,19 @@ MclHashValue MclHashMap_Set(MclHashMap*, MclHashKey, MclHashValue);
 
 MclHashValue MclHashMap_FindByPred(const MclHashMap*, MclHashNodePred, void*);
 
+/*
+ * Batches hash all keys of a window first and prefetch their buckets and nodes,
+ * so the memory misses of many keys overlap instead of stalling one by one.
+ * Results are the same as calling Get, Set or Remove for each key in order.
+ */
+void MclHashMap_GetBatch(const MclHashMap*, const MclHashKey *keys, MclSize count, MclHashValue *values);
+
+/* Returns the count of keys set, results (may be NULL) receive what Set returns for each key */
+MclSize MclHashMap_SetBatch(MclHashMap*, const MclHashKey *keys, const MclHashValue *values, MclSize count, MclHashValue *results);
+
+/* Returns the count of keys removed, values receive the removed values, NULL if key is absent */
+MclSize MclHashMap_RemoveBatch(MclHashMap*, const MclHashKey *keys, MclSize count, MclHashValue *values);
+
 MclHashValue MclHashMap_Remove(MclHashMap*, MclHashKey);
 MclHashValue MclHashMap_RemoveByPred(MclHashMap*, MclHashNodePred, void*);
 
@@ -52,11 +92,25 @@ MCL_INLINE bool MclHashMap_IsEmpty(const MclHashMap *self) {
     return MclHashMap_GetSize(self) == 0;
 }
 
+MCL_INLINE bool MclHashMap_IsResizing(const MclHashMap *self) {
+    return self ? (self->oldBuckets != NULL) : false;
+}
+
+MCL_INLINE MclSize MclHashMap_GetBucketCount(const MclHashMap *self) {
+    return self ? self->bucketCount : 0;
+}
+
 ///////////////////////////////////////////////////////////
-#define MCL_HASHMAP_BUCKET_COUNT_DEFAULT 127
+#define MCL_HASHMAP_BUCKET_COUNT_DEFAULT 128
+
+/* Old buckets moved by each insert or remove while growing */
+#ifndef MCL_HASHMAP_MOVE_STEP
+#define MCL_HASHMAP_MOVE_STEP 2
+#endif
 
 #define MCL_HASHMAP(MAP, BUCKETS, BUCKET_COUNT, ALLOCATOR)   		\
-	{.allocator = (ALLOCATOR), .buckets = (BUCKETS), .bucketCount = (BUCKET_COUNT), .size = 0}
+	{.allocator = (ALLOCATOR), .buckets = (BUCKETS), .bucketCount = (BUCKET_COUNT), .size = 0,	\
+	 .oldBuckets = NULL, .oldBucketCount = 0, .movedCount = 0, .isBucketsOwned = false, .isOldBucketsOwned = false, .isGrowable = false}
 
 #define MCL_HASHMAP_DEFAULT(MAP, BUCKETS, BUCKET_COUNT) 			\
 	MCL_HASHMAP(MAP, BUCKETS, BUCKET_COUNT, &MclHashNodeAllocator_Default)
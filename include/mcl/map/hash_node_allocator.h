@@ -6,6 +6,7 @@
 MCL_STDC_BEGIN
 
 MCL_TYPE_DECL(MclHashNode);
+MCL_TYPE_DECL(MclSlabCache);
 
 MCL_INTERFACE(MclHashNodeAllocator) {
     MclHashNode* (*alloc)(MclHashNodeAllocator*);
@@ -22,6 +23,11 @@ MCL_INLINE void MclHashNodeAllocator_Free(MclHashNodeAllocator *self, MclHashNod
 
 extern MclHashNodeAllocator MclHashNodeAllocator_Default;
 
+/* Nodes from a slab cache shared by all users, see mcl/mem/slab.h */
+extern MclHashNodeAllocator MclHashNodeAllocator_Slab;
+
+MclSlabCache* MclHashNodeAllocator_GetSlabCache();
+
 ///////////////////////////////////////////////////////////
 #define MCL_HASH_NODE_ALLOCATOR(ALLOC, FREE) {.alloc = ALLOC, .free = FREE}
 
@@ -6,6 +6,7 @@
 MCL_STDC_BEGIN
 
 #define MCL_ALIGNED(N) __attribute__((aligned(N)))
+#define MCL_CACHE_LINE_SIZE 64
 #define MCL_ALIGN_SIZE(size) ((size + (sizeof(void*) - 1)) & ~(sizeof(void*) - 1))
 
 MCL_INLINE MclSize MclAlign_GetSizeOf(MclSize size) {
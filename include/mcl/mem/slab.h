@@ -0,0 +1,84 @@
+#ifndef MCL_8D2F6B0E41A94C7DB5E3F19A7C26D04B
+#define MCL_8D2F6B0E41A94C7DB5E3F19A7C26D04B
+
+#include "mcl/typedef.h"
+#include "mcl/mem/align.h"
+#include "mcl/lock/mutex.h"
+#include <pthread.h>
+
+MCL_STDC_BEGIN
+
+/*
+ * Slab cache of fixed size objects, for small nodes allocated and freed often.
+ * Objects are carved from page sized slabs mapped from OS, and each thread
+ * keeps two magazines (stacks of free objects) to alloc and free without lock.
+ * A thread exchanges a full or empty magazine with the depot of the cache only
+ * when both of its own are full or empty, so the lock is taken once per many
+ * objects. Slabs left empty are unmapped beyond a few kept for reuse, Reclaim
+ * also drains the depot, so memory of an idle cache goes back to the OS.
+ * Caches are defined static with MCL_SLAB_CACHE, and live as long as program.
+ */
+typedef struct MclSlab MclSlab;
+typedef struct MclSlabMagazine MclSlabMagazine;
+
+MCL_TYPE(MclSlabCache) {
+	MclSize objSize;
+	MclMutex lock;
+	bool isKeyCreated;
+	pthread_key_t localKey;
+	MclSlab *partialSlabs;
+	MclSlab *emptySlabs;
+	MclSize emptySlabCount;
+	MclSize slabCount;
+	MclSlabMagazine *fullMagazines;
+	MclSize fullMagazineCount;
+	MclSlabMagazine *emptyMagazines;
+};
+
+void* MclSlabCache_Alloc(MclSlabCache*);
+void  MclSlabCache_Free(MclSlabCache*, void*);
+
+/* Gives back the objects cached by calling thread, e.g. before it goes idle */
+void MclSlabCache_FlushLocal(MclSlabCache*);
+
+/* Drains the depot and unmaps all empty slabs, returns the count of slabs unmapped */
+MclSize MclSlabCache_Reclaim(MclSlabCache*);
+
+MclSize MclSlabCache_GetSlabCount(MclSlabCache*);
+
+///////////////////////////////////////////////////////////
+#define MCL_SLAB_SIZE 4096
+
+/* Objects larger than this fit too few in a slab, so they are refused */
+#define MCL_SLAB_OBJ_SIZE_MAX (MCL_SLAB_SIZE / 8)
+
+#ifndef MCL_SLAB_MAGAZINE_SIZE
+#define MCL_SLAB_MAGAZINE_SIZE 32
+#endif
+
+/* Full magazines kept in depot, more are drained back to slabs */
+#ifndef MCL_SLAB_DEPOT_FULL_MAX
+#define MCL_SLAB_DEPOT_FULL_MAX 16
+#endif
+
+/* Empty slabs kept for reuse, more are unmapped */
+#ifndef MCL_SLAB_EMPTY_SLAB_MAX
+#define MCL_SLAB_EMPTY_SLAB_MAX 2
+#endif
+
+#define MCL_SLAB_CACHE(OBJ_SIZE) {      \
+	.objSize = MCL_ALIGN_SIZE(OBJ_SIZE),    \
+	.lock = MCL_MUTEX(),                    \
+	.isKeyCreated = false,                  \
+	.partialSlabs = NULL,                   \
+	.emptySlabs = NULL,                     \
+	.emptySlabCount = 0,                    \
+	.slabCount = 0,                         \
+	.fullMagazines = NULL,                  \
+	.fullMagazineCount = 0,                 \
+	.emptyMagazines = NULL,                 \
+}
+
+MCL_STDC_END
+
+#endif
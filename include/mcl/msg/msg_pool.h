@@ -0,0 +1,31 @@
+#ifndef MCL_B3F09D6E1C8A4E27954A0D6C7F21E8B5
+#define MCL_B3F09D6E1C8A4E27954A0D6C7F21E8B5
+
+#include "mcl/msg/msg.h"
+
+MCL_STDC_BEGIN
+
+/*
+ * Msg body pool with fixed size classes, each class keeps its free bodies
+ * in a lock free queue, so bodies can be allocated and released in any thread.
+ * A pooled msg sent to MclMsgQueue passes its body by pointer, the receiver
+ * takes it by MclMsgQueue_RecvOwned and releases it back by MclMsgPool_Free.
+ */
+#define MCL_MSG_POOL_CLASS_NUM      4
+#define MCL_MSG_POOL_BODY_SIZE_MAX  4096
+
+MCL_TYPE_DECL(MclMsgPool);
+
+/* bodyCount is the count of bodies of each size class, must be power of 2 */
+MclMsgPool* MclMsgPool_Create(MclSize bodyCount);
+void MclMsgPool_Delete(MclMsgPool*);
+
+/* Takes a body from the smallest class fit for bodySize, or larger class if it runs out */
+MclStatus MclMsgPool_Alloc(MclMsgPool*, MclMsg*, MclMsgType, MclMsgId, MclSize bodySize);
+MclStatus MclMsgPool_Free(MclMsgPool*, MclMsg*);
+
+MclSize MclMsgPool_GetFreeCount(const MclMsgPool*, MclSize bodySize);
+
+MCL_STDC_END
+
+#endif
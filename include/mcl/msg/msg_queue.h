@@ -3,19 +3,37 @@
 
 #include "mcl/msg/msg.h"
 #include "mcl/ringbuff/ringbuff.h"
+#include "mcl/ringbuff/mpmc_queue.h"
 #include "mcl/lock/mutex.h"
+#include "mcl/lock/event_count.h"
+#include "mcl/time/time_type.h"
 
 MCL_STDC_BEGIN
 
+struct MclMsgQueueWaiter;
+
+typedef void (*MclMsgQueueReady)(void *ctxt);
+
+/* Lock free msg queue uses MclMpmcQueue instead of ringbuff with mutex,
+ * its capacity must be power of 2. Ready callbacks are kept beside the event
+ * counts for waiters that can not park a thread, e.g. fibers. */
 MCL_TYPE(MclMsgQueue) {
     MclRingBuff ringbuff;
     MclMutex mutex;
+    MclMpmcQueue lockFreeQueue;
+    bool isLockFree;
+    MclEventCount notEmpty;
+    MclEventCount notFull;
+    struct MclMsgQueueWaiter *waiters;
+    MclAtomic waiterCount;
 };
 
 MclMsgQueue* MclMsgQueue_Create(MclSize capacity);
+MclMsgQueue* MclMsgQueue_CreateLockFree(MclSize capacity);
 void MclMsgQueue_Delete(MclMsgQueue*);
 
 MclStatus MclMsgQueue_Init(MclMsgQueue*, MclSize capacity, MclMsg* msgBuff);
+MclStatus MclMsgQueue_InitLockFree(MclMsgQueue*, MclSize capacity, uint8_t* cellBuff);
 void MclMsgQueue_Destroy(MclMsgQueue*);
 
 void MclMsgQueue_Clear(MclMsgQueue*);
@@ -28,9 +46,38 @@ MclSize MclMsgQueue_GetCount(const MclMsgQueue*);
 MclStatus MclMsgQueue_Send(MclMsgQueue*, MclMsg*);
 MclStatus MclMsgQueue_Recv(MclMsgQueue*, MclMsg*);
 
+/* Takes the body pointer of the sent msg instead of copying the body into result,
+ * the receiver owns the body then, e.g. releases it by MclMsgPool_Free. */
+MclStatus MclMsgQueue_RecvOwned(MclMsgQueue*, MclMsg*);
+
+/* Batch version takes the lock once, returns the count of msgs really sent or received. */
+MclSize MclMsgQueue_SendBatch(MclMsgQueue*, const MclMsg* msgs, MclSize count);
+MclSize MclMsgQueue_RecvBatch(MclMsgQueue*, MclMsg* results, MclSize count);
+
+/* Spin briefly then park until msg or room arrives, return MCL_TIMEDOUT after timeoutUs,
+ * MCL_TIME_US_INVALID means wait forever. */
+MclStatus MclMsgQueue_SendWait(MclMsgQueue*, MclMsg*, MclTimeUs timeoutUs);
+MclStatus MclMsgQueue_RecvWait(MclMsgQueue*, MclMsg*, MclTimeUs timeoutUs);
+MclStatus MclMsgQueue_RecvOwnedWait(MclMsgQueue*, MclMsg*, MclTimeUs timeoutUs);
+
+/* Callback runs once in the thread sending the next msg, or right now if a msg is queued,
+ * all callbacks run on a send, so the msg may be taken by another receiver first. */
+MclStatus MclMsgQueue_OnReady(MclMsgQueue*, MclMsgQueueReady, void *ctxt);
+
+/* Unregisters the callback of ctxt, fails if it is not registered or already taken to run */
+MclStatus MclMsgQueue_CancelOnReady(MclMsgQueue*, MclMsgQueueReady, void *ctxt);
+
 ///////////////////////////////////////////////////////////
 #define MCL_MSG_QUEUE(MSG_BUFF, CAPACITY) \
-{.ringbuff = MCL_RINGBUFF(CAPACITY, sizeof(MclMsg), MSG_BUFF), .mutex = MCL_MUTEX()}
+{.ringbuff = MCL_RINGBUFF(CAPACITY, sizeof(MclMsg), MSG_BUFF), .mutex = MCL_MUTEX(), .isLockFree = false, \
+ .notEmpty = MCL_EVENT_COUNT(), .notFull = MCL_EVENT_COUNT(), .waiters = NULL, .waiterCount = 0}
+
+#define MCL_MSG_QUEUE_LOCK_FREE_BUFF_SIZE(CAPACITY) \
+((CAPACITY) * MCL_MPMC_QUEUE_CELL_SIZE(sizeof(MclMsg)))
+
+#define MCL_MSG_QUEUE_LOCK_FREE(CELL_BUFF, CAPACITY) \
+{.mutex = MCL_MUTEX(), .lockFreeQueue = MCL_MPMC_QUEUE(CAPACITY, sizeof(MclMsg), CELL_BUFF), .isLockFree = true, \
+ .notEmpty = MCL_EVENT_COUNT(), .notFull = MCL_EVENT_COUNT(), .waiters = NULL, .waiterCount = 0}
 
 MCL_STDC_END
 
@@ -0,0 +1,66 @@
+#ifndef MCL_5AC7F689024147E3853B9122C9DE92F2
+#define MCL_5AC7F689024147E3853B9122C9DE92F2
+
+#include "mcl/array/array.h"
+#include "mcl/lock/atomic.h"
+#include "mcl/mem/align.h"
+
+MCL_STDC_BEGIN
+
+/*
+ * Bounded lock free queue for multiple producers and consumers.
+ * Capacity must be power of 2 and not less than 2, all slots usable.
+ * Each cell holds a lap counter followed by the element, a zeroed
+ * buffer is a valid empty queue.
+ */
+MCL_TYPE(MclMpmcQueue) {
+    MclArray cells;
+    MclSize mask;
+    MclSize elemBytes;
+    uint8_t putPadding[MCL_CACHE_LINE_SIZE];
+    MclAtomic putPos;
+    uint8_t popPadding[MCL_CACHE_LINE_SIZE];
+    MclAtomic popPos;
+    uint8_t endPadding[MCL_CACHE_LINE_SIZE];
+};
+
+MclMpmcQueue* MclMpmcQueue_Create(MclSize capacity, MclSize elemBytes);
+void MclMpmcQueue_Delete(MclMpmcQueue*);
+
+MclStatus MclMpmcQueue_Init(MclMpmcQueue*, MclSize capacity, MclSize elemBytes, uint8_t* buff);
+
+/* not thread safe, only call when no producer or consumer is running */
+void MclMpmcQueue_Reset(MclMpmcQueue*);
+
+bool MclMpmcQueue_IsFull(const MclMpmcQueue*);
+bool MclMpmcQueue_IsEmpty(const MclMpmcQueue*);
+
+MclSize MclMpmcQueue_GetCount(const MclMpmcQueue*);
+
+MclStatus MclMpmcQueue_Pop(MclMpmcQueue*, void*);
+MclStatus MclMpmcQueue_Put(MclMpmcQueue*, const void*);
+
+///////////////////////////////////////////////////////////
+#define MCL_MPMC_QUEUE_CELL_SIZE(ELEM_BYTES)                        \
+    (MCL_ALIGN_SIZE(sizeof(MclAtomic)) + MCL_ALIGN_SIZE(ELEM_BYTES))
+
+MCL_INLINE uint64_t MclMpmcQueue_GetBuffSize(MclSize capacity, MclSize elemBytes) {
+    return MclArray_GetBuffSize(capacity, MCL_MPMC_QUEUE_CELL_SIZE(elemBytes));
+}
+
+MCL_INLINE MclSize MclMpmcQueue_GetCapacity(const MclMpmcQueue *self) {
+    return self ? MclArray_GetCapacity(&self->cells) : 0;
+}
+
+MCL_INLINE void* MclMpmcQueue_GetBuff(MclMpmcQueue *self) {
+    return self ? MclArray_Begin(&self->cells) : NULL;
+}
+
+///////////////////////////////////////////////////////////
+#define MCL_MPMC_QUEUE(CAPACITY, ELEM_BYTES, BUFF)                  \
+{.cells = MCL_ARRAY(CAPACITY, MCL_MPMC_QUEUE_CELL_SIZE(ELEM_BYTES), BUFF),  \
+ .mask = (CAPACITY) - 1, .elemBytes = (ELEM_BYTES), .putPos = 0, .popPos = 0}
+
+MCL_STDC_END
+
+#endif
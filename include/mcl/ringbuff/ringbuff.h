@@ -3,19 +3,34 @@
 
 #include "mcl/array/array.h"
 #include "mcl/lock/atomic.h"
+#include "mcl/mem/align.h"
 
 MCL_STDC_BEGIN
 
+/*
+ * Default mode: any capacity, one slot kept empty, safe with external locks.
+ * SPSC mode: capacity must be power of 2, all slots usable, lock free for
+ * exactly one producer thread and one consumer thread.
+ */
 MCL_TYPE(MclRingBuff) {
     MclArray buff;
+    bool isSpsc;
+    MclSize mask;
+    uint8_t headPadding[MCL_CACHE_LINE_SIZE];
     MclAtomic head;
+    MclSize tailCache;
+    uint8_t tailPadding[MCL_CACHE_LINE_SIZE];
     MclAtomic tail;
+    MclSize headCache;
+    uint8_t endPadding[MCL_CACHE_LINE_SIZE];
 };
 
 MclRingBuff* MclRingBuff_Create(MclSize capacity, MclSize elemBytes);
+MclRingBuff* MclRingBuff_CreateSpsc(MclSize capacity, MclSize elemBytes);
 void MclRingBuff_Delete(MclRingBuff*);
 
 MclStatus MclRingBuff_Init(MclRingBuff*, MclSize capacity, MclSize elemBytes, uint8_t* buff);
+MclStatus MclRingBuff_InitSpsc(MclRingBuff*, MclSize capacity, MclSize elemBytes, uint8_t* buff);
 void MclRingBuff_Reset(MclRingBuff*);
 
 bool MclRingBuff_IsFull(const MclRingBuff*);
@@ -26,6 +41,20 @@ MclSize MclRingBuff_GetCount(const MclRingBuff*);
 MclStatus MclRingBuff_Pop(MclRingBuff*, void*);
 MclStatus MclRingBuff_Put(MclRingBuff*, void*);
 
+/* Batch version copies with at most two memcpys and publishes index once,
+ * returns the count of elements really put or popped. */
+MclSize MclRingBuff_PopN(MclRingBuff*, void* values, MclSize count);
+MclSize MclRingBuff_PutN(MclRingBuff*, const void* values, MclSize count);
+
+/* Zero copy: Reserve returns contiguous free slots (up to the wrap point) for writing
+ * in place and Commit publishes them; Peek/Release do the same for consumer.
+ * The out count may be less than wanted, NULL returned when no slot available. */
+void* MclRingBuff_Reserve(MclRingBuff*, MclSize count, MclSize *reservedCount);
+MclStatus MclRingBuff_Commit(MclRingBuff*, MclSize count);
+
+void* MclRingBuff_Peek(MclRingBuff*, MclSize count, MclSize *peekedCount);
+MclStatus MclRingBuff_Release(MclRingBuff*, MclSize count);
+
 ///////////////////////////////////////////////////////////
 MCL_INLINE void* MclRingBuff_GetBuff(MclRingBuff *self) {
     return self ? MclArray_Begin(&self->buff): NULL;
@@ -33,7 +62,10 @@ MCL_INLINE void* MclRingBuff_GetBuff(MclRingBuff *self) {
 
 ///////////////////////////////////////////////////////////
 #define MCL_RINGBUFF(CAPACITY, ELEM_BYTES, BUFF)                   \
-{.buff = MCL_ARRAY(CAPACITY, ELEM_BYTES, BUFF), .head = 0, .tail = 0}
+{.buff = MCL_ARRAY(CAPACITY, ELEM_BYTES, BUFF), .isSpsc = false, .mask = 0, .head = 0, .tail = 0}
+
+#define MCL_RINGBUFF_SPSC(CAPACITY, ELEM_BYTES, BUFF)              \
+{.buff = MCL_ARRAY(CAPACITY, ELEM_BYTES, BUFF), .isSpsc = true, .mask = (CAPACITY) - 1, .head = 0, .tail = 0}
 
 MCL_STDC_END
 
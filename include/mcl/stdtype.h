@@ -15,4 +15,7 @@
 typedef uint32_t MclSize;
 #define MCL_SIZE_MAX    (MclSize)MCL_UINT32_MAX
 
+#define MCL_MIN(A, B)   (((A) < (B)) ? (A) : (B))
+#define MCL_MAX(A, B)   (((A) > (B)) ? (A) : (B))
+
 #endif
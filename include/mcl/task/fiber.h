@@ -0,0 +1,58 @@
+#ifndef MCL_E3A96C1B4F0D4D7A9B25C8F17D60E4A2
+#define MCL_E3A96C1B4F0D4D7A9B25C8F17D60E4A2
+
+#include "mcl/typedef.h"
+#include "mcl/status.h"
+#include "mcl/task/task_key.h"
+#include "mcl/task/task_priority.h"
+#include "mcl/time/time_type.h"
+
+MCL_STDC_BEGIN
+
+MCL_TYPE_DECL(MclTaskScheduler);
+MCL_TYPE_DECL(MclFuture);
+MCL_TYPE_DECL(MclMsgQueue);
+MCL_TYPE_DECL(MclMsg);
+
+/* Usable bytes of fiber stack, a guard page below it faults on overflow */
+#ifndef MCL_FIBER_STACK_SIZE
+#define MCL_FIBER_STACK_SIZE (64 * 1024)
+#endif
+
+/* Stacks of finished fibers are cached for new fibers up to this count */
+#ifndef MCL_FIBER_STACK_POOL_MAX
+#define MCL_FIBER_STACK_POOL_MAX 64
+#endif
+
+typedef void (*MclFiberEntry)(void *arg);
+
+/*
+ * Fiber runs entry on its own stack as a task of the scheduler. Awaiting in a
+ * fiber suspends it and returns the worker to the scheduler, the fiber is
+ * submitted again by key and priority when the awaited one is ready, maybe
+ * resumed in another worker. Outside a fiber the await calls block as usual.
+ * Fiber dropped by the scheduler before it finished, e.g. by RemoveTask of its
+ * key or scheduler deleted, is freed without unwinding its stack.
+ */
+MclStatus MclFiber_Spawn(MclTaskScheduler*, MclTaskKey, MclTaskPriority, MclFiberEntry, void *arg);
+
+bool MclFiber_IsInFiber();
+
+/* Queues the fiber behind the ready tasks */
+void MclFiber_Yield();
+
+/* Resumes by the timer of scheduler, whose tick limits the precision */
+void MclFiber_Sleep(MclTimeUs us);
+
+/* Future should live until the call returns, the awaiting fiber is owned by
+ * scheduler and never resumed if it is removed or scheduler deleted before ready */
+void MclFiber_AwaitFuture(MclFuture*, MclStatus *status, void **value);
+
+/* Suspends until a msg is sent to the queue, return MCL_TIMEDOUT after timeoutUs,
+ * MCL_TIME_US_INVALID means wait forever. The awaiting fiber is owned by scheduler
+ * as AwaitFuture, queue should live until the call returns or the fiber is dropped. */
+MclStatus MclFiber_AwaitRecv(MclMsgQueue*, MclMsg*, MclTimeUs timeoutUs);
+
+MCL_STDC_END
+
+#endif
@@ -0,0 +1,36 @@
+#ifndef H9A41E6C3_2F7B_4D08_B5E9_3C8D1F60A7B2
+#define H9A41E6C3_2F7B_4D08_B5E9_3C8D1F60A7B2
+
+#include "mcl/typedef.h"
+#include "mcl/status.h"
+
+MCL_STDC_BEGIN
+
+MCL_TYPE_DECL(MclThreadPool);
+
+typedef void (*MclParallelForFunc)(MclSize begin, MclSize end, void *ctxt);
+
+/* Accumulates [begin, end) into partial, which starts as a copy of identity */
+typedef void (*MclParallelReduceFunc)(MclSize begin, MclSize end, void *ctxt, void *partial);
+
+/* Joins partial into result, should be associative and commutative */
+typedef void (*MclParallelJoinFunc)(void *result, const void *partial, void *ctxt);
+
+/*
+ * Range [begin, end) is split in halves recursively until no bigger than grain,
+ * the right halves are submitted to the pool where idle workers steal and split them further.
+ * Caller executes the left most chunk and then helps execute pool tasks until all chunks done.
+ * Range no bigger than grain is executed inline without any task, grain 0 picks one by thread count.
+ * Chunk tasks are submitted with the highest priority.
+ */
+MclStatus MclParallel_For(MclThreadPool*, MclSize begin, MclSize end, MclSize grain,
+		                  MclParallelForFunc, void *ctxt);
+
+/* Result should be initialized as identity by caller, values are valueSize bytes */
+MclStatus MclParallel_Reduce(MclThreadPool*, MclSize begin, MclSize end, MclSize grain,
+		                     MclSize valueSize, const void *identity,
+		                     MclParallelReduceFunc, MclParallelJoinFunc, void *ctxt, void *result);
+
+MCL_STDC_END
+
+#endif
@@ -0,0 +1,39 @@
+#ifndef MCL_2F8D41C6A0B94E3D87C5196E0B3A7D54
+#define MCL_2F8D41C6A0B94E3D87C5196E0B3A7D54
+
+#include "mcl/typedef.h"
+#include "mcl/status.h"
+#include "mcl/task/task_key.h"
+#include "mcl/task/task_priority.h"
+
+MCL_STDC_BEGIN
+
+MCL_TYPE_DECL(MclTask);
+MCL_TYPE_DECL(MclTaskScheduler);
+MCL_TYPE_DECL(MclStrand);
+
+/*
+ * Strand serializes tasks by key: tasks of the same key run one at a time in
+ * submitted order, tasks of different keys run in parallel. Each busy key
+ * has one lane task in the scheduler, which runs a batch of the queued tasks
+ * of the key, then is queued again if more left. An idle key takes nothing
+ * but its entry in the strand, and no worker waits for it.
+ * Removing the key from the scheduler drops the lane and all its queued tasks.
+ */
+MclStrand* MclStrand_Create(MclTaskScheduler*, MclTaskPriority);
+
+/* IMPORTANT: SHOULD INVOKE AFTER ALL TASKS IN STRAND FINISHED!!! */
+void MclStrand_Delete(MclStrand*);
+
+/* Task stays owned by caller on failure, tasks of the key submitted by others are kept */
+MclStatus MclStrand_SubmitTask(MclStrand*, MclTask*);
+
+/* Count of the tasks of key queued in strand, not including the running one */
+MclSize MclStrand_GetPendingCount(const MclStrand*, MclTaskKey);
+
+/* Count of keys having queued or running tasks */
+MclSize MclStrand_GetBusyKeyCount(const MclStrand*);
+
+MCL_STDC_END
+
+#endif
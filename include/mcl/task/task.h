@@ -4,6 +4,8 @@
 #include "mcl/interface.h"
 #include "mcl/status.h"
 #include "mcl/task/task_key.h"
+#include "mcl/task/task_priority.h"
+#include "mcl/time/time_type.h"
 
 MCL_STDC_BEGIN
 
@@ -11,6 +13,15 @@ MCL_INTERFACE(MclTask) {
 	MclTaskKey key;
 	MclStatus (*execute)(MclTask*);
 	void (*destroy)(MclTask*);
+	/* stamped by task queue by its policy, never set by user */
+	MclTimeUs deadlineUs;
+#ifdef MCL_TASK_STATS_ENABLED
+	/* stamped by scheduler, never set by user. The define comes with the mcl
+	 * target built with ENABLE_TASK_STATS, code out of cmake must define it too */
+	MclTimeUs submitUs;
+	MclTimeUs startUs;
+	MclTaskPriority priority;
+#endif
 };
 
 MclStatus MclTask_Execute(MclTask*);
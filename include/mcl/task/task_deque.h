@@ -0,0 +1,50 @@
+#ifndef MCL_2D8E6A41F7C94B0B8E35C1A9D47F6B20
+#define MCL_2D8E6A41F7C94B0B8E35C1A9D47F6B20
+
+#include "mcl/lock/atomic.h"
+#include "mcl/mem/align.h"
+#include "mcl/status.h"
+
+MCL_STDC_BEGIN
+
+MCL_TYPE_DECL(MclTask);
+
+/*
+ * Chase-Lev work stealing deque of tasks with fixed capacity (power of 2).
+ * Only the owner thread may Push and Pop at the bottom,
+ * any other thread may Steal from the top.
+ */
+MCL_TYPE(MclTaskDeque) {
+    MclTask **tasks;
+    MclSize mask;
+    uint8_t topPadding[MCL_CACHE_LINE_SIZE];
+    MclAtomic top;
+    uint8_t bottomPadding[MCL_CACHE_LINE_SIZE];
+    MclAtomic bottom;
+    uint8_t endPadding[MCL_CACHE_LINE_SIZE];
+};
+
+MclTaskDeque* MclTaskDeque_Create(MclSize capacity);
+void MclTaskDeque_Delete(MclTaskDeque*);
+
+MclStatus MclTaskDeque_Init(MclTaskDeque*, MclSize capacity, MclTask** buff);
+
+bool MclTaskDeque_IsEmpty(const MclTaskDeque*);
+MclSize MclTaskDeque_GetCount(const MclTaskDeque*);
+
+MclStatus MclTaskDeque_Push(MclTaskDeque*, MclTask*);
+MclTask* MclTaskDeque_Pop(MclTaskDeque*);
+MclTask* MclTaskDeque_Steal(MclTaskDeque*);
+
+///////////////////////////////////////////////////////////
+MCL_INLINE MclSize MclTaskDeque_GetCapacity(const MclTaskDeque *self) {
+    return self ? self->mask + 1 : 0;
+}
+
+MCL_INLINE MclTask** MclTaskDeque_GetBuff(MclTaskDeque *self) {
+    return self ? self->tasks : NULL;
+}
+
+MCL_STDC_END
+
+#endif
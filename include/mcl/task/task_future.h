@@ -0,0 +1,28 @@
+#ifndef H3E9B6C21_47AF_4D15_8C3E_D05A1B7F92E4
+#define H3E9B6C21_47AF_4D15_8C3E_D05A1B7F92E4
+
+#include "mcl/lock/future.h"
+#include "mcl/task/task_key.h"
+#include "mcl/task/task_priority.h"
+
+MCL_STDC_BEGIN
+
+MCL_TYPE_DECL(MclTaskScheduler);
+
+typedef MclStatus (*MclTaskCall)(void *arg, void **value);
+typedef MclStatus (*MclTaskThen)(MclStatus prevStatus, void *prevValue, void *arg, void **value);
+
+/* Future is completed with the status and value of call executed in the scheduler,
+ * or MCL_STATUS_DONE if the task is removed before executed.
+ * Caller owns the future and deletes it after ready. */
+MclFuture* MclTaskScheduler_SubmitAsync(MclTaskScheduler*, MclTaskKey, MclTaskPriority, MclTaskCall, void *arg);
+
+/* Continuation is submitted to the scheduler when prev is ready, no thread blocks on prev.
+ * It is owned by the scheduler until then, the future gets MCL_STATUS_DONE if the
+ * continuation is removed or the scheduler deleted first. Prev should live until
+ * the future is ready. */
+MclFuture* MclTaskScheduler_Then(MclTaskScheduler*, MclFuture *prev, MclTaskKey, MclTaskPriority, MclTaskThen, void *arg);
+
+MCL_STDC_END
+
+#endif
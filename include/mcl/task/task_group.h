@@ -0,0 +1,34 @@
+#ifndef H6F0D2B7A_93C4_4E18_A5D1_7B2E8C4F0A36
+#define H6F0D2B7A_93C4_4E18_A5D1_7B2E8C4F0A36
+
+#include "mcl/typedef.h"
+#include "mcl/status.h"
+#include "mcl/task/task_priority.h"
+#include "mcl/time/time_type.h"
+
+MCL_STDC_BEGIN
+
+MCL_TYPE_DECL(MclTask);
+MCL_TYPE_DECL(MclTaskScheduler);
+MCL_TYPE_DECL(MclTaskGroup);
+
+/* Task group tracks the tasks submitted through it until they are finished,
+ * a task is finished when destroyed, whether executed or removed from scheduler. */
+MclTaskGroup* MclTaskGroup_Create(MclTaskScheduler*);
+
+/* IMPORTANT: SHOULD INVOKE AFTER ALL TASKS IN GROUP FINISHED!!! */
+void MclTaskGroup_Delete(MclTaskGroup*);
+
+MclStatus MclTaskGroup_SubmitTask(MclTaskGroup*, MclTask*, MclTaskPriority);
+
+/* Parks until all submitted tasks finished, return MCL_TIMEDOUT after timeoutUs,
+ * MCL_TIME_US_INVALID means wait forever. */
+MclStatus MclTaskGroup_Wait(MclTaskGroup*, MclTimeUs timeoutUs);
+
+MclSize MclTaskGroup_GetSubmittedCount(const MclTaskGroup*);
+MclSize MclTaskGroup_GetRunningCount(const MclTaskGroup*);
+MclSize MclTaskGroup_GetFinishedCount(const MclTaskGroup*);
+
+MCL_STDC_END
+
+#endif
@@ -0,0 +1,43 @@
+#ifndef MCL_5B0E8A3C71D94F26B8E4A1C07D3F9265
+#define MCL_5B0E8A3C71D94F26B8E4A1C07D3F9265
+
+#include "mcl/typedef.h"
+#include "mcl/time/time_type.h"
+
+MCL_STDC_BEGIN
+
+/*
+ * Policy of task queue chooses the next task over priorities:
+ *   PRIORITY : first non empty priority, thresholds skip a priority after
+ *              threshold pops in a row to keep lower ones progressing;
+ *   EDF      : earliest deadline first over all priorities, task submitted
+ *              without deadline gets now + budgetsUs[priority];
+ *   WFQ      : priorities share pops by weights, a task waited longer than
+ *              budgetsUs[priority] is aged and served before all in time.
+ * Missing budgets mean no deadline, missing weights give priority i the
+ * weight of (priorities - i). Arrays are copied when the queue is created.
+ * Tasks of the same key and priority are always popped in submitted order
+ * unless an explicit deadline reorders them.
+ */
+typedef enum {
+	MCL_TASK_POLICY_PRIORITY = 0,
+	MCL_TASK_POLICY_EDF,
+	MCL_TASK_POLICY_WFQ,
+} MclTaskPolicyType;
+
+MCL_TYPE(MclTaskPolicy) {
+	MclTaskPolicyType type;
+	const MclTimeUs *budgetsUs;
+	const MclSize *weights;
+};
+
+///////////////////////////////////////////////////////////
+#define MCL_TASK_POLICY(TYPE, BUDGETS_US, WEIGHTS) \
+{.type = (TYPE), .budgetsUs = (BUDGETS_US), .weights = (WEIGHTS)}
+
+#define MCL_TASK_POLICY_EDF(BUDGETS_US) MCL_TASK_POLICY(MCL_TASK_POLICY_EDF, BUDGETS_US, NULL)
+#define MCL_TASK_POLICY_WFQ(WEIGHTS, BUDGETS_US) MCL_TASK_POLICY(MCL_TASK_POLICY_WFQ, BUDGETS_US, WEIGHTS)
+
+MCL_STDC_END
+
+#endif
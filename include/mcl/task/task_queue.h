@@ -5,13 +5,16 @@
 #include "mcl/status.h"
 #include "mcl/task/task_key.h"
 #include "mcl/task/task_priority.h"
+#include "mcl/task/task_policy.h"
 
 MCL_STDC_BEGIN
 
 MCL_TYPE_DECL(MclTask);
 MCL_TYPE_DECL(MclTaskQueue);
+MCL_TYPE_DECL(MclTaskStats);
 
 MclTaskQueue* MclTaskQueue_Create(MclSize priorities, MclSize *thresholds);
+MclTaskQueue* MclTaskQueue_CreateWithPolicy(MclSize priorities, const MclTaskPolicy*);
 void MclTaskQueue_Delete(MclTaskQueue*);
 
 void MclTaskQueue_Start(MclTaskQueue *self);
@@ -20,11 +23,48 @@ void MclTaskQueue_Stop(MclTaskQueue *self);
 bool MclTaskQueue_IsRunning(const MclTaskQueue*);
 
 bool MclTaskQueue_IsEmpty(const MclTaskQueue*);
+MclSize MclTaskQueue_GetCount(const MclTaskQueue*);
+
+/* NULL unless built with MCL_TASK_STATS_ENABLED */
+MclTaskStats* MclTaskQueue_GetStats(MclTaskQueue*);
+
+MclTaskPolicyType MclTaskQueue_GetPolicy(const MclTaskQueue*);
+MclSize MclTaskQueue_GetPriorities(const MclTaskQueue*);
+MclSize MclTaskQueue_GetThreshold(const MclTaskQueue*, MclTaskPriority);
+
+/* Highest priority having queued tasks, or the count of priorities if empty, never locks */
+MclTaskPriority MclTaskQueue_GetTopPriority(const MclTaskQueue*);
 
 MclStatus MclTaskQueue_AddTask(MclTaskQueue*, MclTask*, MclTaskPriority);
+
+/* Deadline is relative to now, orders the task under EDF and ages it under WFQ,
+ * MCL_TIME_US_INVALID takes the budget of the priority. */
+MclStatus MclTaskQueue_AddTaskWithDeadline(MclTaskQueue*, MclTask*, MclTaskPriority, MclTimeUs deadlineUs);
+
 MclStatus MclTaskQueue_DelTask(MclTaskQueue*, MclTaskKey, MclTaskPriority);
+
+/* Removes and destroys the queued tasks of the same key, then adds the task to the tail */
+MclStatus MclTaskQueue_ReplaceTask(MclTaskQueue*, MclTask*, MclTaskPriority);
+
+/* Looks up the key index, O(1) and never scans the queue */
+bool MclTaskQueue_HasTask(const MclTaskQueue*, MclTaskKey, MclTaskPriority);
 MclTask*  MclTaskQueue_PopTask(MclTaskQueue *);
 
+/* Batch version takes the lock once and signals once, returns the count of tasks added */
+MclSize MclTaskQueue_AddTasks(MclTaskQueue*, MclTask **tasks, MclSize count, MclTaskPriority);
+
+/* Never blocks, returns NULL when no task is ready */
+MclTask*  MclTaskQueue_TryPopTask(MclTaskQueue *);
+
+/* Never blocks, pops at most count tasks by one lock in the same order as TryPopTask,
+ * priorities receives the priority of each popped task if not NULL. */
+MclSize MclTaskQueue_TryPopTasks(MclTaskQueue*, MclTask **tasks, MclTaskPriority *priorities, MclSize count);
+
+/* Pops the first task as TryPopTask, then more tasks of its priority only while the
+ * select would take them in turn and they are unkeyed, a keyed task stays queued
+ * to be removed or replaced by key. Under EDF or WFQ policy pops only one. */
+MclSize MclTaskQueue_TryPopBatch(MclTaskQueue*, MclTask **tasks, MclTaskPriority *priorities, MclSize count);
+
 MCL_STDC_END
 
 #endif
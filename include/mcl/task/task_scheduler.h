@@ -5,23 +5,66 @@
 #include "mcl/status.h"
 #include "mcl/task/task_key.h"
 #include "mcl/task/task_priority.h"
+#include "mcl/task/task_policy.h"
+#include "mcl/time/time_type.h"
 
 MCL_STDC_BEGIN
 
 MCL_TYPE_DECL(MclTask);
 MCL_TYPE_DECL(MclTaskScheduler);
+MCL_TYPE_DECL(MclThreadPoolConfig);
+MCL_TYPE_DECL(MclThreadPool);
+MCL_TYPE_DECL(MclTaskPriorityStats);
+MCL_TYPE_DECL(MclFuture);
 
 MclTaskScheduler* MclTaskScheduler_Create(MclSize threadCount, MclSize priorities, MclSize *thresholds);
+MclTaskScheduler* MclTaskScheduler_CreateElastic(const MclThreadPoolConfig*, MclSize priorities, MclSize *thresholds);
+/* Policy chooses next task over priorities, see MclTaskPolicy */
+MclTaskScheduler* MclTaskScheduler_CreateWithPolicy(const MclThreadPoolConfig*, MclSize priorities, const MclTaskPolicy*);
 void MclTaskScheduler_Delete(MclTaskScheduler*);
 
 MclStatus MclTaskScheduler_Start(MclTaskScheduler*);
 MclStatus MclTaskScheduler_Stop(MclTaskScheduler*);
 
 bool MclTaskScheduler_IsRunning(const MclTaskScheduler*);
+MclSize MclTaskScheduler_GetThreadCount(const MclTaskScheduler*);
+
+/* Snapshot of submitted, executed, cancelled and threshold skipped counters and
+ * queue wait, run time and end to end latency histograms of the priority,
+ * fails unless built with MCL_TASK_STATS_ENABLED. */
+MclStatus MclTaskScheduler_GetStats(MclTaskScheduler*, MclTaskPriority, MclTaskPriorityStats*);
+
+/* For the pool based primitives, e.g. MclParallel_For */
+MclThreadPool* MclTaskScheduler_GetThreadPool(MclTaskScheduler*);
 
 MclStatus MclTaskScheduler_SubmitTask(MclTaskScheduler*, MclTask*, MclTaskPriority);
+/* Enqueues all tasks by one critical section, returns the count submitted from the front,
+ * tasks not submitted still belong to caller */
+MclSize MclTaskScheduler_SubmitTasks(MclTaskScheduler*, MclTask **tasks, MclSize count, MclTaskPriority);
+/* Deadline is relative to now: EDF policy pops the task of earliest deadline first,
+ * WFQ policy serves the task before others once its deadline passed. */
+MclStatus MclTaskScheduler_SubmitWithDeadline(MclTaskScheduler*, MclTask*, MclTaskPriority, MclTimeUs deadlineUs);
+/* Delayed task is queued after delayUs on the monotonic clock.
+ * Periodic task is executed every periodUs and destroyed when removed or scheduler deleted,
+ * one period is skipped if the last execution is still queued. */
+MclStatus MclTaskScheduler_SubmitDelayed(MclTaskScheduler*, MclTask*, MclTaskPriority, MclTimeUs delayUs);
+MclStatus MclTaskScheduler_SubmitPeriodic(MclTaskScheduler*, MclTask*, MclTaskPriority, MclTimeUs periodUs);
+
+/* Task is submitted when the future is ready, until then it is owned by scheduler:
+ * destroyed when removed or scheduler deleted, and the future is no longer referred.
+ * The future should live until it is ready or the task is destroyed. */
+MclStatus MclTaskScheduler_SubmitOnReady(MclTaskScheduler*, MclTask*, MclTaskPriority, MclFuture*);
+
+/* Coalesces work: the queued tasks of the same key and priority are destroyed
+ * before the task is queued, tasks already popped by workers are not affected. */
+MclStatus MclTaskScheduler_ReplaceTask(MclTaskScheduler*, MclTask*, MclTaskPriority);
+
+/* Also cancels the delayed, periodic and on ready tasks of the key */
 MclStatus MclTaskScheduler_RemoveTask(MclTaskScheduler*, MclTaskKey, MclTaskPriority);
 
+/* True if task of the key is queued and not yet popped by workers */
+bool MclTaskScheduler_IsPending(const MclTaskScheduler*, MclTaskKey, MclTaskPriority);
+
 void MclTaskScheduler_LocalExecute(MclTaskScheduler*);
 void MclTaskScheduler_WaitDone(MclTaskScheduler*);
 
@@ -0,0 +1,53 @@
+#ifndef MCL_8E2C5D91A04F4B7C9D6E3A1F0B8C7264
+#define MCL_8E2C5D91A04F4B7C9D6E3A1F0B8C7264
+
+#include "mcl/typedef.h"
+#include "mcl/status.h"
+#include "mcl/task/task_priority.h"
+#include "mcl/time/time_type.h"
+
+MCL_STDC_BEGIN
+
+/* Bucket 0 counts 0us, bucket i counts [2^(i-1), 2^i) us, the last one counts all above */
+#define MCL_TASK_HISTOGRAM_BUCKETS 32
+
+MCL_TYPE(MclTaskHistogram) {
+	uint64_t buckets[MCL_TASK_HISTOGRAM_BUCKETS];
+	uint64_t count;
+	uint64_t sumUs;
+	uint64_t maxUs;
+};
+
+MCL_TYPE(MclTaskPriorityStats) {
+	uint64_t submittedCount;
+	uint64_t executedCount;
+	uint64_t cancelledCount;
+	uint64_t thresholdSkipCount;
+	MclTaskHistogram queueWait;
+	MclTaskHistogram runTime;
+	MclTaskHistogram latency;
+};
+
+MCL_TYPE_DECL(MclTaskStats);
+
+/* Scheduler feeds the stats only when built with MCL_TASK_STATS_ENABLED (cmake ENABLE_TASK_STATS),
+ * all of its hooks and task timestamps are compiled out otherwise. */
+MclTaskStats* MclTaskStats_Create(MclSize priorities);
+void MclTaskStats_Delete(MclTaskStats*);
+
+void MclTaskStats_Reset(MclTaskStats*);
+
+void MclTaskStats_AddSubmitted(MclTaskStats*, MclTaskPriority, MclSize count);
+void MclTaskStats_AddExecuted(MclTaskStats*, MclTaskPriority, MclTimeUs queueWaitUs, MclTimeUs runUs);
+void MclTaskStats_AddCancelled(MclTaskStats*, MclTaskPriority, MclSize count);
+void MclTaskStats_AddThresholdSkip(MclTaskStats*, MclTaskPriority);
+
+/* Counters are read one by one without lock, a snapshot under load is nearly but not exactly consistent */
+MclStatus MclTaskStats_GetSnapshot(const MclTaskStats*, MclTaskPriority, MclTaskPriorityStats*);
+
+/* Upper bound of the bucket reaching permille of count, e.g. 990 for p99 */
+MclTimeUs MclTaskHistogram_GetPercentileUs(const MclTaskHistogram*, MclSize permille);
+
+MCL_STDC_END
+
+#endif
@@ -3,13 +3,47 @@
 
 #include "mcl/typedef.h"
 #include "mcl/status.h"
+#include "mcl/task/task_priority.h"
+#include "mcl/time/time_type.h"
+#include "mcl/thread/thread_options.h"
 
 MCL_STDC_BEGIN
 
 MCL_TYPE_DECL(MclThreadPool);
 MCL_TYPE_DECL(MclTaskQueue);
+MCL_TYPE_DECL(MclTask);
+
+/* Pinning places workers over the candidate cpus, which are the cpus list if given,
+ * else the cpus allowed to the thread creating the pool, e.g. those of its cpuset:
+ *   COMPACT  : worker i on the i-th candidate, neighbour workers share caches;
+ *   SCATTER  : workers spread evenly over the candidates;
+ *   EXPLICIT : every worker may run on any of the cpus list, e.g. keeps a pool
+ *              on the cores of one numa node and off the cores of other pools.
+ * The cpus list is only read when the pool is created. */
+typedef enum {
+	MCL_THREAD_PIN_NONE = 0,
+	MCL_THREAD_PIN_COMPACT,
+	MCL_THREAD_PIN_SCATTER,
+	MCL_THREAD_PIN_EXPLICIT,
+} MclThreadPinning;
+
+/* Elastic pool runs minThreads workers since start, grows toward maxThreads when
+ * queued tasks per running worker exceed queueDepthTarget and no worker is idle,
+ * worker above minThreads retires after idle for idleTimeoutUs.
+ * Options except affinity apply to every worker, affinity comes from pinning. */
+MCL_TYPE(MclThreadPoolConfig) {
+	MclSize minThreads;
+	MclSize maxThreads;
+	MclSize queueDepthTarget;
+	MclTimeUs idleTimeoutUs;
+	MclThreadPinning pinning;
+	const MclSize *cpus;
+	MclSize cpuCount;
+	MclThreadOptions options;
+};
 
 MclThreadPool* MclThreadPool_Create(const char *name, MclSize threadCount);
+MclThreadPool* MclThreadPool_CreateElastic(const char *name, const MclThreadPoolConfig*);
 void MclThreadPool_Delete(MclThreadPool*);
 
 MclStatus MclThreadPool_Start(MclThreadPool*);
@@ -17,12 +51,41 @@ MclStatus MclThreadPool_Stop(MclThreadPool*);
 
 bool MclThreadPool_IsRunning(const MclThreadPool*);
 
+/* Count of running workers, changes with scaling in elastic pool */
+MclSize MclThreadPool_GetThreadCount(const MclThreadPool*);
+
 MclStatus MclThreadPool_SubmitTaskQueue(MclThreadPool*, MclTaskQueue*);
 MclTaskQueue* MclThreadPool_RemoveTaskQueue(MclThreadPool*);
 
+/* Task of invalid key submitted in a worker of the pool goes to its own deque for stealing,
+ * else goes to the submitted task queue, where it stays removable and replaceable by key.
+ * Worker prefers its own deque only over tasks of no higher priority in the queue. */
+MclStatus MclThreadPool_SubmitTask(MclThreadPool*, MclTask*, MclTaskPriority);
+
+/* Task of deadline always goes to the submitted task queue, where the policy orders it */
+MclStatus MclThreadPool_SubmitTaskWithDeadline(MclThreadPool*, MclTask*, MclTaskPriority, MclTimeUs deadlineUs);
+
+/* Replaced task always goes to the submitted task queue, where tasks of the same key are */
+MclStatus MclThreadPool_ReplaceTask(MclThreadPool*, MclTask*, MclTaskPriority);
+
+/* Batch version takes the queue lock once and wakes min(count, idle workers) workers,
+ * returns the count of tasks submitted from the front, the rest still belongs to caller */
+MclSize MclThreadPool_SubmitTasks(MclThreadPool*, MclTask **tasks, MclSize count, MclTaskPriority);
+
 void MclThreadPool_LocalExecute(MclThreadPool*);
+
+/* Executes one queued or stealable task in the calling thread, returns false if none found,
+ * lets a thread waiting for pool work help instead of idle. */
+bool MclThreadPool_TryLocalExecute(MclThreadPool*);
 void MclThreadPool_WaitDone(MclThreadPool*);
 
+///////////////////////////////////////////////////////////
+#define MCL_THREAD_POOL_CONFIG_FIXED(THREAD_COUNT) \
+{.minThreads = (THREAD_COUNT), .maxThreads = (THREAD_COUNT), .queueDepthTarget = 0, .idleTimeoutUs = MCL_TIME_US_INVALID}
+
+#define MCL_THREAD_POOL_CONFIG_ELASTIC(MIN_THREADS, MAX_THREADS, QUEUE_DEPTH, IDLE_TIMEOUT_US) \
+{.minThreads = (MIN_THREADS), .maxThreads = (MAX_THREADS), .queueDepthTarget = (QUEUE_DEPTH), .idleTimeoutUs = (IDLE_TIMEOUT_US)}
+
 MCL_STDC_END
 
 #endif
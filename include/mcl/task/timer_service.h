@@ -0,0 +1,37 @@
+#ifndef H7A3D19C4_E5B2_4C08_93F6_1B8E2D4C6A57
+#define H7A3D19C4_E5B2_4C08_93F6_1B8E2D4C6A57
+
+#include "mcl/task/timer_wheel.h"
+#include "mcl/time/time_type.h"
+
+MCL_STDC_BEGIN
+
+MCL_TYPE_DECL(MclTimerService);
+
+/*
+ * One thread drives a timer wheel on the monotonic clock for any number of timers,
+ * it sleeps until the next tick something is due, and adding a timer wakes it.
+ * Timer expires in the service thread with the service locked, the lock is
+ * recursive so expire may add or cancel timers, but it should return quickly.
+ */
+MclTimerService* MclTimerService_Create(const char *name, MclTimeUs tickUs);
+
+/* Pending timers are destroyed */
+void MclTimerService_Delete(MclTimerService*);
+
+MclStatus MclTimerService_Start(MclTimerService*);
+MclStatus MclTimerService_Stop(MclTimerService*);
+
+bool MclTimerService_IsRunning(const MclTimerService*);
+
+/* Timer fires after delayUs, then every periodUs if periodUs is not 0, rounded up to ticks */
+MclStatus MclTimerService_Add(MclTimerService*, MclTimer*, MclTimeUs delayUs, MclTimeUs periodUs);
+MclStatus MclTimerService_Cancel(MclTimerService*, MclTimer*);
+
+MclSize MclTimerService_RemoveAllByPred(MclTimerService*, MclTimerPred, void*);
+
+MclSize MclTimerService_GetCount(MclTimerService*);
+
+MCL_STDC_END
+
+#endif
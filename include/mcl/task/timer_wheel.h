@@ -0,0 +1,90 @@
+#ifndef H0C6E3B57_8D2A_4F19_B4E1_6A9D35C07F28
+#define H0C6E3B57_8D2A_4F19_B4E1_6A9D35C07F28
+
+#include "mcl/link/link.h"
+#include "mcl/typedef.h"
+#include "mcl/status.h"
+
+MCL_STDC_BEGIN
+
+#define MCL_TIMER_WHEEL_LEVEL0_BITS  8
+#define MCL_TIMER_WHEEL_LEVEL_BITS   6
+#define MCL_TIMER_WHEEL_LEVEL_NUM    4
+
+#define MCL_TIMER_WHEEL_LEVEL0_SIZE  (1u << MCL_TIMER_WHEEL_LEVEL0_BITS)
+#define MCL_TIMER_WHEEL_LEVEL_SIZE   (1u << MCL_TIMER_WHEEL_LEVEL_BITS)
+
+/* Range of the wheel, timer beyond it is cascaded in the top level once per round until in range */
+#define MCL_TIMER_WHEEL_TICKS_MAX    \
+((uint64_t)1 << (MCL_TIMER_WHEEL_LEVEL0_BITS + MCL_TIMER_WHEEL_LEVEL_BITS * (MCL_TIMER_WHEEL_LEVEL_NUM - 1)))
+
+typedef uint64_t MclTimerTick;
+
+MCL_TYPE_DECL(MclTimer);
+
+typedef void (*MclTimerExpire)(MclTimer*);
+typedef void (*MclTimerDestroy)(MclTimer*);
+typedef bool (*MclTimerPred)(MclTimer*, void*);
+
+typedef MCL_LINK(MclTimer) MclTimerLink;
+
+/* Timer is embedded in its owner, expire is called when it is due,
+ * destroy is called when it is removed or cleared from the wheel without firing. */
+MCL_TYPE(MclTimer) {
+	MCL_LINK_NODE(MclTimer) link;
+	MclTimerTick expireTick;
+	MclTimerTick periodTicks;
+	MclTimerExpire expire;
+	MclTimerDestroy destroy;
+};
+
+/*
+ * Hierarchical timer wheel: level 0 holds timers due in next 256 ticks one slot
+ * per tick, each upper level holds 64 times longer range per slot and cascades
+ * its slot down when lower level turns round. Add and cancel are O(1).
+ * NOT thread safe, the owner should protect it.
+ */
+MCL_TYPE(MclTimerWheel) {
+	MclTimerTick currentTick;
+	MclSize timerCount;
+	MclTimerLink level0[MCL_TIMER_WHEEL_LEVEL0_SIZE];
+	MclTimerLink levels[MCL_TIMER_WHEEL_LEVEL_NUM - 1][MCL_TIMER_WHEEL_LEVEL_SIZE];
+	MclTimerLink dueTimers;
+};
+
+void MclTimer_Init(MclTimer*, MclTimerExpire, MclTimerDestroy);
+bool MclTimer_IsPending(const MclTimer*);
+
+void MclTimerWheel_Init(MclTimerWheel*, MclTimerTick currentTick);
+void MclTimerWheel_Clear(MclTimerWheel*);
+
+/* Timer fires after delayTicks, then every periodTicks if periodTicks is not 0 */
+MclStatus MclTimerWheel_Add(MclTimerWheel*, MclTimer*, MclTimerTick delayTicks, MclTimerTick periodTicks);
+MclStatus MclTimerWheel_Cancel(MclTimerWheel*, MclTimer*);
+
+/* Removes and destroys all timers matching pred, returns the removed count */
+MclSize MclTimerWheel_RemoveAllByPred(MclTimerWheel*, MclTimerPred, void*);
+
+/* Fires all timers due before and on tick, returns the fired count.
+ * Timer is out of the wheel when its expire called, periodic timer is added back before it. */
+MclSize MclTimerWheel_Advance(MclTimerWheel*, MclTimerTick tick);
+
+/* First tick on which a timer may fire or cascade, nothing happens before it,
+ * so the driver may sleep until it. It is beyond the range if wheel is empty. */
+MclTimerTick MclTimerWheel_GetNextTick(const MclTimerWheel*);
+
+MCL_INLINE MclSize MclTimerWheel_GetCount(const MclTimerWheel *self) {
+	return self ? self->timerCount : 0;
+}
+
+MCL_INLINE MclTimerTick MclTimerWheel_GetCurrentTick(const MclTimerWheel *self) {
+	return self ? self->currentTick : 0;
+}
+
+///////////////////////////////////////////////////////////
+#define MCL_TIMER(EXPIRE, DESTROY)	\
+{.link = MCL_LINK_NODE_INITIALIZER(), .expireTick = 0, .periodTicks = 0, .expire = (EXPIRE), .destroy = (DESTROY)}
+
+MCL_STDC_END
+
+#endif
@@ -1,7 +1,7 @@
 #ifndef H6321B778_C5D0_4722_A771_3DFA00560B07
 #define H6321B778_C5D0_4722_A771_3DFA00560B07
 
-#include "mcl/thread/thread.h"
+#include "mcl/thread/thread_options.h"
 
 MCL_STDC_BEGIN
 
@@ -11,6 +11,7 @@ MCL_TYPE(MclThreadInfo) {
 	void (*run)(void *ctxt);
 	void (*stop)(void *ctxt);
 	void *ctxt;
+	MclThreadOptions options;
 };
 
 MclStatus MclThreadLauncher_Launch(MclThreadInfo*, MclSize threadNum);
@@ -20,6 +21,9 @@ void MclThreadLauncher_WaitDone(MclThreadInfo*, MclSize threadNum);
 #define MCL_THREAD_INFO(NAME, RUN, STOP, CTXT)				\
 {.name = (NAME), .run = (RUN), .stop = (STOP), .ctxt = (CTXT)}
 
+#define MCL_THREAD_INFO_WITH_OPTIONS(NAME, RUN, STOP, CTXT, OPTIONS)	\
+{.name = (NAME), .run = (RUN), .stop = (STOP), .ctxt = (CTXT), .options = OPTIONS}
+
 MCL_STDC_END
 
 #endif
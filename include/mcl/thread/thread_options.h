@@ -0,0 +1,69 @@
+#ifndef MCL_5B3E9F0C7A2D4E61B8D40C9F2E7A13B5
+#define MCL_5B3E9F0C7A2D4E61B8D40C9F2E7A13B5
+
+#include "mcl/thread/thread.h"
+
+MCL_STDC_BEGIN
+
+#define MCL_CPU_SET_MAX 256
+#define MCL_CPU_SET_WORD_BITS 64
+
+MCL_TYPE(MclCpuSet) {
+	uint64_t bits[MCL_CPU_SET_MAX / MCL_CPU_SET_WORD_BITS];
+};
+
+typedef enum {
+	MCL_THREAD_POLICY_DEFAULT = 0,  /* inherits from the launcher */
+	MCL_THREAD_POLICY_OTHER,
+	MCL_THREAD_POLICY_FIFO,
+	MCL_THREAD_POLICY_RR,
+} MclThreadPolicy;
+
+/* All zero means default attributes: no affinity, default stack size, inherited policy */
+MCL_TYPE(MclThreadOptions) {
+	MclCpuSet affinity;
+	MclSize stackSize;
+	MclThreadPolicy policy;
+	int priority;
+};
+
+bool MclThreadOptions_IsDefault(const MclThreadOptions*);
+
+/* Attr should be destroyed by MclThreadOptions_DestroyAttr after thread created */
+MclStatus MclThreadOptions_InitAttr(const MclThreadOptions*, MclThreadAttr*);
+void MclThreadOptions_DestroyAttr(MclThreadAttr*);
+
+/* Count of online cpus, at least 1 */
+MclSize MclThread_GetCpuCount();
+
+/* Fills ids of the cpus the calling thread may run on, e.g. within its cpuset,
+ * returns the count filled, falls back to online cpus 0..N-1 where unsupported */
+MclSize MclThread_GetAllowedCpus(MclSize *cpus, MclSize capacity);
+
+///////////////////////////////////////////////////////////
+MCL_INLINE void MclCpuSet_Clear(MclCpuSet *self) {
+	for (MclSize i = 0; i < MCL_CPU_SET_MAX / MCL_CPU_SET_WORD_BITS; i++) {
+		self->bits[i] = 0;
+	}
+}
+
+MCL_INLINE void MclCpuSet_Add(MclCpuSet *self, MclSize cpu) {
+	if (cpu >= MCL_CPU_SET_MAX) return;
+	self->bits[cpu / MCL_CPU_SET_WORD_BITS] |= ((uint64_t)1 << (cpu % MCL_CPU_SET_WORD_BITS));
+}
+
+MCL_INLINE bool MclCpuSet_Has(const MclCpuSet *self, MclSize cpu) {
+	if (cpu >= MCL_CPU_SET_MAX) return false;
+	return (self->bits[cpu / MCL_CPU_SET_WORD_BITS] >> (cpu % MCL_CPU_SET_WORD_BITS)) & 1;
+}
+
+MCL_INLINE bool MclCpuSet_IsEmpty(const MclCpuSet *self) {
+	for (MclSize i = 0; i < MCL_CPU_SET_MAX / MCL_CPU_SET_WORD_BITS; i++) {
+		if (self->bits[i]) return false;
+	}
+	return true;
+}
+
+MCL_STDC_END
+
+#endif
@@ -1,6 +1,7 @@
 #include "mcl/list/list_node_allocator.h"
 #include "mcl/list/list_node.h"
 #include "mcl/mem/memory.h"
+#include "mcl/mem/slab.h"
 
 MCL_PRIVATE MclListNode* MclListNodeAllocator_AllocDefault(MclListNodeAllocator *self) {
     return MCL_MALLOC(sizeof(MclListNode));
@@ -14,3 +15,23 @@ MclListNodeAllocator MclListNodeAllocator_Default = {
         .alloc = MclListNodeAllocator_AllocDefault,
         .free = MclListNodeAllocator_FreeDefault
 };
+
+/////////////////////////////////////////////////////////
+MCL_PRIVATE MclSlabCache listNodeCache = MCL_SLAB_CACHE(sizeof(MclListNode));
+
+MCL_PRIVATE MclListNode* MclListNodeAllocator_AllocSlab(MclListNodeAllocator *self) {
+    return MclSlabCache_Alloc(&listNodeCache);
+}
+
+MCL_PRIVATE void MclListNodeAllocator_FreeSlab(MclListNodeAllocator *self, MclListNode *node) {
+    MclSlabCache_Free(&listNodeCache, node);
+}
+
+MclListNodeAllocator MclListNodeAllocator_Slab = {
+        .alloc = MclListNodeAllocator_AllocSlab,
+        .free = MclListNodeAllocator_FreeSlab
+};
+
+MclSlabCache* MclListNodeAllocator_GetSlabCache() {
+    return &listNodeCache;
+}
@@ -0,0 +1,60 @@
+#include "mcl/list/list_node_pool.h"
+#include "mcl/list/list_node.h"
+#include "mcl/mem/memory.h"
+#include "mcl/assert.h"
+
+MCL_PRIVATE void MclListNodePool_Recycle(MclListNodePool *self, MclListNode *node) {
+    node->link.next = self->freeNodes;
+    node->link.prev = NULL;
+    self->freeNodes = node;
+    self->freeCount++;
+}
+
+MCL_PRIVATE MclListNode* MclListNodePool_Alloc(MclListNodeAllocator *allocator) {
+    MclListNodePool *self = (MclListNodePool*)allocator;
+
+    MclListNode *node = self->freeNodes;
+    if (!node) return MCL_MALLOC(sizeof(MclListNode));
+
+    self->freeNodes = node->link.next;
+    self->freeCount--;
+    return node;
+}
+
+MCL_PRIVATE void MclListNodePool_Free(MclListNodeAllocator *allocator, MclListNode *node) {
+    if (!node) return;
+
+    MclListNodePool *self = (MclListNodePool*)allocator;
+    MclListNodePool_Recycle(self, node);
+}
+
+MclStatus MclListNodePool_Init(MclListNodePool *self, MclSize preallocCount) {
+    MCL_ASSERT_VALID_PTR(self);
+
+    self->allocator.alloc = MclListNodePool_Alloc;
+    self->allocator.free = MclListNodePool_Free;
+    self->freeNodes = NULL;
+    self->freeCount = 0;
+
+    for (MclSize i = 0; i < preallocCount; i++) {
+        MclListNode *node = MCL_MALLOC(sizeof(MclListNode));
+        if (!node) {
+            MCL_LOG_ERR("List node pool prealloc %u nodes failed!", preallocCount);
+            MclListNodePool_Destroy(self);
+            return MCL_FAILURE;
+        }
+        MclListNodePool_Recycle(self, node);
+    }
+    return MCL_SUCCESS;
+}
+
+void MclListNodePool_Destroy(MclListNodePool *self) {
+    MCL_ASSERT_VALID_PTR_VOID(self);
+
+    while (self->freeNodes) {
+        MclListNode *node = self->freeNodes;
+        self->freeNodes = node->link.next;
+        MCL_FREE(node);
+    }
+    self->freeCount = 0;
+}
@@ -0,0 +1,149 @@
+#include "mcl/lock/event_count.h"
+#include "mcl/assert.h"
+#include <errno.h>
+#include <limits.h>
+#include <time.h>
+
+#ifdef MCL_EVENT_COUNT_FUTEX
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#define MCL_US_PER_SEC  1000000
+#define MCL_NS_PER_US   1000
+
+#define MCL_EVENT_COUNT_WAKE_ALL INT_MAX
+
+MCL_PRIVATE MclTimeUs MclEventCount_GetNowUs(clockid_t clock) {
+    struct timespec now;
+    clock_gettime(clock, &now);
+    return (MclTimeUs)now.tv_sec * MCL_US_PER_SEC + (MclTimeUs)now.tv_nsec / MCL_NS_PER_US;
+}
+
+MCL_PRIVATE struct timespec MclEventCount_ToTimeSpec(MclTimeUs us) {
+    struct timespec ts;
+    ts.tv_sec = us / MCL_US_PER_SEC;
+    ts.tv_nsec = (us % MCL_US_PER_SEC) * MCL_NS_PER_US;
+    return ts;
+}
+
+#ifdef MCL_EVENT_COUNT_FUTEX
+MCL_PRIVATE MclStatus MclEventCount_Park(MclEventCount *self, MclSize key, MclTimeUs timeoutUs) {
+    struct timespec ts = MclEventCount_ToTimeSpec(timeoutUs);
+    long ret = syscall(SYS_futex, &self->epoch, FUTEX_WAIT_PRIVATE, key,
+                       MclTimeUs_IsValid(timeoutUs) ? &ts : NULL, NULL, 0);
+    return ((ret == -1) && (errno == ETIMEDOUT)) ? MCL_TIMEDOUT : MCL_SUCCESS;
+}
+
+MCL_PRIVATE void MclEventCount_Wake(MclEventCount *self, int count) {
+    MclAtomic_AddFetch(&self->epoch, 1);
+    syscall(SYS_futex, &self->epoch, FUTEX_WAKE_PRIVATE, count, NULL, NULL, 0);
+}
+#else
+MCL_PRIVATE MclStatus MclEventCount_Park(MclEventCount *self, MclSize key, MclTimeUs timeoutUs) {
+    struct timespec ts = MclEventCount_ToTimeSpec(MclEventCount_GetNowUs(CLOCK_REALTIME) + timeoutUs);
+
+    MCL_LOCK_AUTO(self->mutex);
+    while (MclAtomic_LoadAcquire(&self->epoch) == key) {
+        if (!MclTimeUs_IsValid(timeoutUs)) {
+            MclCond_Wait(&self->cond, &self->mutex);
+        } else if (MCL_FAILED(MclCond_TimedWait(&self->cond, &self->mutex, &ts))) {
+            return MCL_TIMEDOUT;
+        }
+    }
+    return MCL_SUCCESS;
+}
+
+MCL_PRIVATE void MclEventCount_Wake(MclEventCount *self, int count) {
+    MCL_LOCK_AUTO(self->mutex);
+    MclAtomic_AddFetch(&self->epoch, 1);
+    if (count == 1) {
+        MclCond_Signal(&self->cond);
+    } else {
+        MclCond_Broadcast(&self->cond);
+    }
+}
+#endif
+
+MclStatus MclEventCount_Init(MclEventCount *self) {
+    MCL_ASSERT_VALID_PTR(self);
+
+    MclAtomic_Clear(&self->epoch);
+    MclAtomic_Clear(&self->waiters);
+#ifndef MCL_EVENT_COUNT_FUTEX
+    MCL_ASSERT_SUCC_CALL(MclMutex_Init(&self->mutex, NULL));
+    MCL_ASSERT_SUCC_CALL(MclCond_Init(&self->cond, NULL));
+#endif
+    return MCL_SUCCESS;
+}
+
+void MclEventCount_Destroy(MclEventCount *self) {
+    MCL_ASSERT_VALID_PTR_VOID(self);
+#ifndef MCL_EVENT_COUNT_FUTEX
+    MCL_PEEK_SUCC_CALL(MclCond_Destroy(&self->cond));
+    MCL_PEEK_SUCC_CALL(MclMutex_Destroy(&self->mutex));
+#endif
+}
+
+MclSize MclEventCount_PrepareWait(MclEventCount *self) {
+    MCL_ASSERT_VALID_PTR_NIL(self);
+
+    /* full barrier: the waiter is visible before condition is checked again */
+    MclAtomic_FetchAdd(&self->waiters, 1);
+    return MclAtomic_LoadAcquire(&self->epoch);
+}
+
+void MclEventCount_CancelWait(MclEventCount *self) {
+    MCL_ASSERT_VALID_PTR_VOID(self);
+    MclAtomic_FetchSub(&self->waiters, 1);
+}
+
+MclStatus MclEventCount_WaitUntil(MclEventCount *self, MclSize key, MclTimeUs deadline) {
+    MCL_ASSERT_VALID_PTR(self);
+
+    MclTimeUs timeoutUs = MCL_TIME_US_INVALID;
+    if (MclTimeUs_IsValid(deadline)) {
+        MclTimeUs now = MclEventCount_GetNowUs(CLOCK_MONOTONIC);
+        if (now >= deadline) {
+            MclEventCount_CancelWait(self);
+            return MCL_TIMEDOUT;
+        }
+        timeoutUs = deadline - now;
+    }
+
+    MclStatus status = MclEventCount_Park(self, key, timeoutUs);
+    MclEventCount_CancelWait(self);
+    return status;
+}
+
+void MclEventCount_Notify(MclEventCount *self) {
+    MCL_ASSERT_VALID_PTR_VOID(self);
+
+    /* full barrier: the changed condition is visible before waiters is checked */
+    MCL_ATOMIC_SYNC();
+    if (MclAtomic_LoadRelaxed(&self->waiters) == 0) return;
+    MclEventCount_Wake(self, 1);
+}
+
+void MclEventCount_NotifyAll(MclEventCount *self) {
+    MCL_ASSERT_VALID_PTR_VOID(self);
+
+    MCL_ATOMIC_SYNC();
+    if (MclAtomic_LoadRelaxed(&self->waiters) == 0) return;
+    MclEventCount_Wake(self, MCL_EVENT_COUNT_WAKE_ALL);
+}
+
+void MclEventCount_NotifyN(MclEventCount *self, MclSize count) {
+    MCL_ASSERT_VALID_PTR_VOID(self);
+    if (count == 0) return;
+
+    MCL_ATOMIC_SYNC();
+    if (MclAtomic_LoadRelaxed(&self->waiters) == 0) return;
+    MclEventCount_Wake(self, (count >= MCL_EVENT_COUNT_WAKE_ALL) ? MCL_EVENT_COUNT_WAKE_ALL : (int)count);
+}
+
+MclTimeUs MclEventCount_GetDeadline(MclTimeUs timeoutUs) {
+    if (!MclTimeUs_IsValid(timeoutUs)) return MCL_TIME_US_INVALID;
+    return MclEventCount_GetNowUs(CLOCK_MONOTONIC) + timeoutUs;
+}
@@ -4,14 +4,44 @@
 #include "mcl/lock/cond.h"
 #include "mcl/mem/memory.h"
 
+typedef struct MclFutureCallbackNode {
+    struct MclFutureCallbackNode *next;
+    MclFutureCallback callback;
+    void *ctxt;
+} MclFutureCallbackNode;
+
 MCL_TYPE(MclFuture) {
     MclMutex mutex;
     MclCond cond;
     MclAtomic isReady;
     MclStatus status;
     void *value;
+    MclFutureCallbackNode *callbacks;
+    MclFutureCallbackNode **lastCallback;
 };
 
+MCL_PRIVATE void MclFuture_RunCallbacks(MclFutureCallbackNode *callbacks, MclStatus status, void *value) {
+    while (callbacks) {
+        MclFutureCallbackNode *node = callbacks;
+        callbacks = node->next;
+        node->callback(status, value, node->ctxt);
+        MCL_FREE(node);
+    }
+}
+
+/* IMPORTANT: SHOULD INVOKE WITH MUTEX LOCKED!!! */
+MCL_PRIVATE MclFutureCallbackNode* MclFuture_Ready(MclFuture *self, MclStatus status, void *value) {
+    self->status = status;
+    self->value = value;
+    MclAtomic_Set(&self->isReady, 1);
+    MclCond_Broadcast(&self->cond);
+
+    MclFutureCallbackNode *callbacks = self->callbacks;
+    self->callbacks = NULL;
+    self->lastCallback = &self->callbacks;
+    return callbacks;
+}
+
 MCL_PRIVATE MclStatus MclFuture_Init(MclFuture *self) {
     if (MCL_FAILED(MclMutex_Init(&self->mutex, NULL))) {
         MCL_LOG_ERR("Init mutex failed!");
@@ -25,10 +55,17 @@ MCL_PRIVATE MclStatus MclFuture_Init(MclFuture *self) {
     MclAtomic_Clear(&self->isReady);
     self->status = MCL_UNINITIALIZED;
     self->value = NULL;
+    self->callbacks = NULL;
+    self->lastCallback = &self->callbacks;
     return MCL_SUCCESS;
 }
 
 MCL_PRIVATE void MclFuture_Destroy(MclFuture *self) {
+    while (self->callbacks) {
+        MclFutureCallbackNode *node = self->callbacks;
+        self->callbacks = node->next;
+        MCL_FREE(node);
+    }
     MCL_PEEK_SUCC_CALL(MclMutex_Destroy(&self->mutex));
     MCL_PEEK_SUCC_CALL(MclCond_Destroy(&self->cond));
     MclAtomic_Clear(&self->isReady);
@@ -55,26 +92,31 @@ void MclFuture_Delete(MclFuture *self) {
 void MclFuture_Stop(MclFuture *self) {
     if (MclAtomic_IsTrue(&self->isReady)) return;
 
-    MCL_LOCK_AUTO(self->mutex);
-    MclAtomic_Set(&self->isReady, 1);
-    self->status = MCL_STATUS_DONE;
-    MclCond_Broadcast(&self->cond);
+    MclFutureCallbackNode *callbacks = NULL;
+    {
+        MCL_LOCK_AUTO(self->mutex);
+        if (MclAtomic_IsTrue(&self->isReady)) return;
+        callbacks = MclFuture_Ready(self, MCL_STATUS_DONE, NULL);
+    }
+    MclFuture_RunCallbacks(callbacks, MCL_STATUS_DONE, NULL);
 }
 
 bool MclFuture_IsReady(const MclFuture *self) {
     return MclAtomic_IsTrue(&((MclFuture*)self)->isReady);
 }
 
-void MclFuture_Set(MclFuture *self, MclStatus status, void *value) {
-    MCL_ASSERT_VALID_PTR_VOID(self);
-    MCL_ASSERT_TRUE_VOID(!MclAtomic_IsTrue(&self->isReady));
-
-    MCL_LOCK_AUTO(self->mutex);
+/* Checked under lock, as the future may be stopped by another thread meanwhile */
+MclStatus MclFuture_Set(MclFuture *self, MclStatus status, void *value) {
+    MCL_ASSERT_VALID_PTR(self);
 
-    MclAtomic_Set(&self->isReady, 1);
-    self->status = status;
-    self->value = value;
-    MclCond_Signal(&self->cond);
+    MclFutureCallbackNode *callbacks = NULL;
+    {
+        MCL_LOCK_AUTO(self->mutex);
+        if (MclAtomic_IsTrue(&self->isReady)) return MCL_FAILURE;
+        callbacks = MclFuture_Ready(self, status, value);
+    }
+    MclFuture_RunCallbacks(callbacks, status, value);
+    return MCL_SUCCESS;
 }
 
 void MclFuture_Get(MclFuture *self, MclStatus *status, void **value) {
@@ -87,3 +129,147 @@ void MclFuture_Get(MclFuture *self, MclStatus *status, void **value) {
     *status = self->status;
     (*value) = self->value;
 }
+
+MclStatus MclFuture_OnReady(MclFuture *self, MclFutureCallback callback, void *ctxt) {
+    MCL_ASSERT_VALID_PTR(self);
+    MCL_ASSERT_VALID_PTR(callback);
+
+    MclFutureCallbackNode *node = MCL_MALLOC(sizeof(MclFutureCallbackNode));
+    MCL_ASSERT_VALID_PTR(node);
+    node->next = NULL;
+    node->callback = callback;
+    node->ctxt = ctxt;
+
+    MclStatus status = MCL_SUCCESS;
+    void *value = NULL;
+    {
+        MCL_LOCK_AUTO(self->mutex);
+        if (!MclAtomic_IsTrue(&self->isReady)) {
+            *self->lastCallback = node;
+            self->lastCallback = &node->next;
+            return MCL_SUCCESS;
+        }
+        status = self->status;
+        value = self->value;
+    }
+    MclFuture_RunCallbacks(node, status, value);
+    return MCL_SUCCESS;
+}
+
+MclStatus MclFuture_CancelOnReady(MclFuture *self, MclFutureCallback callback, void *ctxt) {
+    MCL_ASSERT_VALID_PTR(self);
+    MCL_ASSERT_VALID_PTR(callback);
+
+    MclFutureCallbackNode *node = NULL;
+    {
+        MCL_LOCK_AUTO(self->mutex);
+        MclFutureCallbackNode **prev = &self->callbacks;
+        while (*prev && (((*prev)->callback != callback) || ((*prev)->ctxt != ctxt))) {
+            prev = &(*prev)->next;
+        }
+        node = *prev;
+        if (!node) return MCL_FAILURE;
+
+        *prev = node->next;
+        if (self->lastCallback == &node->next) self->lastCallback = prev;
+    }
+    MCL_FREE(node);
+    return MCL_SUCCESS;
+}
+
+///////////////////////////////////////////////////////////
+typedef struct {
+    MclFuture *result;
+    MclAtomic remaining;
+    MclAtomic isSettled;
+    bool isAny;
+    MclStatus status;
+    void *value;
+} MclFutureJoin;
+
+MCL_PRIVATE MclFutureJoin* MclFutureJoin_Create(MclSize count, bool isAny) {
+    MclFutureJoin *self = MCL_MALLOC(sizeof(MclFutureJoin));
+    MCL_ASSERT_VALID_PTR_NIL(self);
+
+    self->result = MclFuture_Create();
+    if (!self->result) {
+        MCL_FREE(self);
+        return NULL;
+    }
+    MclAtomic_Set(&self->remaining, count);
+    MclAtomic_Clear(&self->isSettled);
+    self->isAny = isAny;
+    self->status = MCL_SUCCESS;
+    self->value = NULL;
+    return self;
+}
+
+/* Only the first one settles the join */
+MCL_PRIVATE bool MclFutureJoin_TrySettle(MclFutureJoin *self, MclStatus status, void *value) {
+    MclSize isSettled = 0;
+    if (!MclAtomic_CompareExchange(&self->isSettled, &isSettled, 1)) return false;
+
+    self->status = status;
+    self->value = value;
+    return true;
+}
+
+/* The last one leaving completes WhenAll, or WhenAny of nothing */
+MCL_PRIVATE void MclFutureJoin_Leave(MclFutureJoin *self) {
+    if (MclAtomic_SubFetch(&self->remaining, 1) != 0) return;
+
+    MclFuture *result = self->result;
+    bool isSettled = MclAtomic_IsTrue(&self->isSettled);
+    bool isAny = self->isAny;
+    MclStatus status = self->status;
+    MCL_FREE(self);
+
+    if (!isAny) {
+        (void)MclFuture_Set(result, isSettled ? status : MCL_SUCCESS, NULL);
+    } else if (!isSettled) {
+        (void)MclFuture_Set(result, MCL_FAILURE, NULL);
+    }
+}
+
+MCL_PRIVATE void MclFutureJoin_ArriveAll(MclStatus status, void *value, void *ctxt) {
+    MclFutureJoin *self = (MclFutureJoin*)ctxt;
+    (void)value;
+
+    if (MclStatus_IsFailed(status)) (void)MclFutureJoin_TrySettle(self, status, NULL);
+    MclFutureJoin_Leave(self);
+}
+
+MCL_PRIVATE void MclFutureJoin_ArriveAny(MclStatus status, void *value, void *ctxt) {
+    MclFutureJoin *self = (MclFutureJoin*)ctxt;
+
+    if (MclFutureJoin_TrySettle(self, status, value)) {
+        (void)MclFuture_Set(self->result, status, value);
+    }
+    MclFutureJoin_Leave(self);
+}
+
+MCL_PRIVATE MclFuture* MclFuture_Join(MclFuture **futures, MclSize count, bool isAny) {
+    MCL_ASSERT_TRUE_NIL(count == 0 || futures != NULL);
+
+    /* the extra count keeps join alive until all callbacks registered */
+    MclFutureJoin *join = MclFutureJoin_Create(count + 1, isAny);
+    MCL_ASSERT_VALID_PTR_NIL(join);
+
+    MclFuture *result = join->result;
+    MclFutureCallback arrive = isAny ? MclFutureJoin_ArriveAny : MclFutureJoin_ArriveAll;
+    for (MclSize i = 0; i < count; i++) {
+        if (!futures[i] || MCL_FAILED(MclFuture_OnReady(futures[i], arrive, join))) {
+            arrive(MCL_FAILURE, NULL, join);
+        }
+    }
+    MclFutureJoin_Leave(join);
+    return result;
+}
+
+MclFuture* MclFuture_WhenAll(MclFuture **futures, MclSize count) {
+    return MclFuture_Join(futures, count, false);
+}
+
+MclFuture* MclFuture_WhenAny(MclFuture **futures, MclSize count) {
+    return MclFuture_Join(futures, count, true);
+}
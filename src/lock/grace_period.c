@@ -0,0 +1,204 @@
+#include "mcl/lock/grace_period.h"
+#include "mcl/lock/mutex.h"
+#include "mcl/lock/atomic.h"
+#include "mcl/mem/memory.h"
+#include "mcl/mem/align.h"
+#include "mcl/assert.h"
+#include <sched.h>
+
+/*
+ * Epoch based: a reader publishes the global epoch it entered with, and a node
+ * retired is stamped with the epoch bumped after it was unlinked. A node is
+ * freed once no reader is active with an epoch older than its stamp, since
+ * such reader could have loaded the node before it was unlinked.
+ * Each reader writes only its own record, padded on its own cache lines.
+ */
+typedef struct MclGraceReader {
+	uint8_t headPadding[MCL_CACHE_LINE_SIZE];
+	uint64_t epoch;
+	MclSize nesting;
+	bool isUsed;
+	struct MclGraceReader *next;
+	uint8_t endPadding[MCL_CACHE_LINE_SIZE];
+} MclGraceReader;
+
+/* Epoch 0 marks an idle reader */
+MCL_PRIVATE uint64_t globalEpoch = 1;
+
+MCL_PRIVATE MclGraceReader *readers = NULL;
+MCL_PRIVATE MclMutex readersLock = MCL_MUTEX();
+
+MCL_PRIVATE MclGraceNode *retiredNodes = NULL;
+MCL_PRIVATE MclSize retiredCount = 0;
+MCL_PRIVATE MclMutex retiredLock = MCL_MUTEX();
+
+MCL_PRIVATE pthread_key_t readerKey;
+MCL_PRIVATE pthread_once_t readerKeyOnce = PTHREAD_ONCE_INIT;
+
+MCL_PRIVATE _Thread_local MclGraceReader *localReader = NULL;
+
+///////////////////////////////////////////////////////////
+MCL_PRIVATE void MclGraceReader_Release(void *arg) {
+	MclGraceReader *reader = arg;
+	reader->nesting = 0;
+	__atomic_store_n(&reader->epoch, 0, __ATOMIC_RELEASE);
+	__atomic_store_n(&reader->isUsed, false, __ATOMIC_RELEASE);
+}
+
+MCL_PRIVATE void MclGraceReader_CreateKey() {
+	if (pthread_key_create(&readerKey, MclGraceReader_Release)) {
+		MCL_LOG_FATAL("Grace period create reader key failed!");
+	}
+}
+
+/* Records of exited threads are reused, records are never freed as scanners walk the list without lock */
+MCL_PRIVATE MclGraceReader* MclGraceReader_Acquire() {
+	MclGraceReader *reader = __atomic_load_n(&readers, __ATOMIC_ACQUIRE);
+	for (; reader; reader = reader->next) {
+		bool isUsed = false;
+		if (__atomic_compare_exchange_n(&reader->isUsed, &isUsed, true, false, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) {
+			break;
+		}
+	}
+
+	if (!reader) {
+		reader = MCL_MALLOC(sizeof(MclGraceReader));
+		MCL_ASSERT_VALID_PTR_NIL(reader);
+
+		reader->epoch = 0;
+		reader->nesting = 0;
+		reader->isUsed = true;
+
+		MCL_LOCK_AUTO(readersLock);
+		reader->next = readers;
+		__atomic_store_n(&readers, reader, __ATOMIC_RELEASE);
+	}
+
+	(void)pthread_once(&readerKeyOnce, MclGraceReader_CreateKey);
+	(void)pthread_setspecific(readerKey, reader);
+	return reader;
+}
+
+MCL_PRIVATE MclGraceReader* MclGraceReader_GetLocal() {
+	if (!localReader) {
+		localReader = MclGraceReader_Acquire();
+	}
+	return localReader;
+}
+
+/* Called after a full barrier, so readers which entered before are seen */
+MCL_PRIVATE uint64_t MclGracePeriod_GetOldestEpoch() {
+	uint64_t oldest = __atomic_load_n(&globalEpoch, __ATOMIC_ACQUIRE);
+	for (MclGraceReader *reader = __atomic_load_n(&readers, __ATOMIC_ACQUIRE); reader; reader = reader->next) {
+		uint64_t epoch = __atomic_load_n(&reader->epoch, __ATOMIC_ACQUIRE);
+		if (epoch && epoch < oldest) {
+			oldest = epoch;
+		}
+	}
+	return oldest;
+}
+
+///////////////////////////////////////////////////////////
+void MclGracePeriod_ReadLock() {
+	MclGraceReader *reader = MclGraceReader_GetLocal();
+	if (!reader) {
+		MCL_LOG_FATAL("Grace period read lock without reader record!");
+		return;
+	}
+	if (reader->nesting++) return;
+
+	__atomic_store_n(&reader->epoch, __atomic_load_n(&globalEpoch, __ATOMIC_RELAXED), __ATOMIC_RELAXED);
+	MCL_ATOMIC_SYNC();
+}
+
+void MclGracePeriod_ReadUnlock() {
+	MclGraceReader *reader = localReader;
+	if (!reader || !reader->nesting) {
+		MCL_LOG_ERR("Grace period read unlock without read lock!");
+		return;
+	}
+	if (--reader->nesting) return;
+
+	__atomic_store_n(&reader->epoch, 0, __ATOMIC_RELEASE);
+}
+
+bool MclGracePeriod_IsReading() {
+	return localReader && localReader->nesting;
+}
+
+void MclGracePeriod_Synchronize() {
+	if (MclGracePeriod_IsReading()) {
+		MCL_LOG_ERR("Grace period synchronize in read section would never return!");
+		return;
+	}
+
+	uint64_t target = __atomic_add_fetch(&globalEpoch, 1, __ATOMIC_SEQ_CST);
+	MCL_ATOMIC_SYNC();
+
+	for (MclGraceReader *reader = __atomic_load_n(&readers, __ATOMIC_ACQUIRE); reader; reader = reader->next) {
+		for (;;) {
+			uint64_t epoch = __atomic_load_n(&reader->epoch, __ATOMIC_ACQUIRE);
+			if (!epoch || epoch >= target) break;
+			(void)sched_yield();
+		}
+	}
+	(void)MclGracePeriod_Reclaim();
+}
+
+void MclGracePeriod_Retire(MclGraceNode *node, MclGraceNodeFree nodeFree) {
+	MCL_ASSERT_VALID_PTR_VOID(node);
+	MCL_ASSERT_VALID_PTR_VOID(nodeFree);
+
+	node->free = nodeFree;
+	node->epoch = __atomic_add_fetch(&globalEpoch, 1, __ATOMIC_SEQ_CST);
+
+	bool shouldReclaim = false;
+	MCL_LOCK_SCOPE(retiredLock) {
+		node->next = retiredNodes;
+		retiredNodes = node;
+		shouldReclaim = (++retiredCount >= MCL_GRACE_PERIOD_RECLAIM_BATCH);
+	}
+	if (shouldReclaim) {
+		(void)MclGracePeriod_Reclaim();
+	}
+}
+
+MclSize MclGracePeriod_Reclaim() {
+	MclGraceNode *nodes = NULL;
+	MCL_LOCK_SCOPE(retiredLock) {
+		nodes = retiredNodes;
+		retiredNodes = NULL;
+		retiredCount = 0;
+	}
+	if (!nodes) return 0;
+
+	MCL_ATOMIC_SYNC();
+	uint64_t oldest = MclGracePeriod_GetOldestEpoch();
+
+	MclGraceNode *pending = NULL;
+	MclGraceNode *pendingTail = NULL;
+	MclSize pendingCount = 0;
+	MclSize freedCount = 0;
+
+	while (nodes) {
+		MclGraceNode *node = nodes;
+		nodes = node->next;
+		if (node->epoch <= oldest) {
+			node->free(node);
+			freedCount++;
+			continue;
+		}
+		node->next = pending;
+		pending = node;
+		if (!pendingTail) pendingTail = node;
+		pendingCount++;
+	}
+
+	if (pending) {
+		MCL_LOCK_AUTO(retiredLock);
+		pendingTail->next = retiredNodes;
+		retiredNodes = pending;
+		retiredCount += pendingCount;
+	}
+	return freedCount;
+}
@@ -0,0 +1,318 @@
+#include "mcl/map/concurrent_hash_map.h"
+#include "mcl/lock/grace_period.h"
+#include "mcl/lock/mutex.h"
+#include "mcl/mem/memory.h"
+#include "mcl/mem/align.h"
+#include "mcl/algo/loop.h"
+#include "mcl/assert.h"
+
+typedef struct MclConcurrentHashNode {
+	MclGraceNode grace;
+	struct MclConcurrentHashNode *next;
+	MclHashKey key;
+	MclHashValue value;
+} MclConcurrentHashNode;
+
+/* Table is replaced as a whole when growing, so readers never see a half moved table */
+typedef struct {
+	MclGraceNode grace;
+	MclSize bucketCount;
+	MclConcurrentHashNode *buckets[];
+} MclConcurrentHashTable;
+
+/* Stripe locks every bucket whose index equals its own modulo the stripe count */
+typedef struct {
+	MclMutex mutex;
+	MclSize count;
+	uint8_t endPadding[MCL_CACHE_LINE_SIZE];
+} MclConcurrentHashStripe;
+
+MCL_TYPE(MclConcurrentHashMap) {
+	MclConcurrentHashTable *table;
+	uint8_t tablePadding[MCL_CACHE_LINE_SIZE];
+	MclConcurrentHashStripe stripes[MCL_CONCURRENT_HASHMAP_STRIPE_COUNT];
+};
+
+/* Average nodes per bucket of a stripe which triggers growing */
+#define MCL_CONCURRENT_HASHMAP_LOAD_MAX 2
+
+///////////////////////////////////////////////////////////
+MCL_PRIVATE MclConcurrentHashNode* MclConcurrentHashNode_Create(MclHashKey key, MclHashValue value) {
+	MclConcurrentHashNode *self = MCL_MALLOC(sizeof(MclConcurrentHashNode));
+	MCL_ASSERT_VALID_PTR_NIL(self);
+
+	self->next = NULL;
+	self->key = key;
+	self->value = value;
+	return self;
+}
+
+MCL_PRIVATE void MclConcurrentHashNode_Free(MclGraceNode *grace) {
+	MCL_FREE(grace);
+}
+
+MCL_PRIVATE MclConcurrentHashNode* MclConcurrentHashNode_LoadNext(MclConcurrentHashNode *const *link) {
+	return __atomic_load_n(link, __ATOMIC_ACQUIRE);
+}
+
+///////////////////////////////////////////////////////////
+MCL_PRIVATE MclConcurrentHashTable* MclConcurrentHashTable_Create(MclSize bucketCount) {
+	MclConcurrentHashTable *self = MCL_MALLOC(sizeof(MclConcurrentHashTable) + sizeof(MclConcurrentHashNode*) * bucketCount);
+	MCL_ASSERT_VALID_PTR_NIL(self);
+
+	self->bucketCount = bucketCount;
+	MCL_LOOP_FOREACH_INDEX(i, bucketCount) {
+		self->buckets[i] = NULL;
+	}
+	return self;
+}
+
+MCL_PRIVATE void MclConcurrentHashTable_Delete(MclConcurrentHashTable *self, MclHashValueDestroy destroy) {
+	MCL_LOOP_FOREACH_INDEX(i, self->bucketCount) {
+		MclConcurrentHashNode *node = self->buckets[i];
+		while (node) {
+			MclConcurrentHashNode *next = node->next;
+			if (destroy) destroy(node->value);
+			MCL_FREE(node);
+			node = next;
+		}
+	}
+	MCL_FREE(self);
+}
+
+/* Frees a table replaced by growing, values live on in the nodes of the new table */
+MCL_PRIVATE void MclConcurrentHashTable_Free(MclGraceNode *grace) {
+	MclConcurrentHashTable_Delete((MclConcurrentHashTable*)grace, NULL);
+}
+
+MCL_PRIVATE MclSize MclConcurrentHashTable_GetIndex(const MclConcurrentHashTable *self, uint64_t hash) {
+	return (MclSize)(hash & (self->bucketCount - 1));
+}
+
+MCL_PRIVATE MclConcurrentHashNode** MclConcurrentHashTable_Find(MclConcurrentHashTable *self, MclHashKey key, uint64_t hash) {
+	MclConcurrentHashNode **link = &self->buckets[MclConcurrentHashTable_GetIndex(self, hash)];
+	while (*link && (*link)->key != key) {
+		link = &(*link)->next;
+	}
+	return link;
+}
+
+/* Copies every node, the old ones stay intact for readers still walking them */
+MCL_PRIVATE MclConcurrentHashTable* MclConcurrentHashTable_Copy(const MclConcurrentHashTable *self, MclSize bucketCount) {
+	MclConcurrentHashTable *table = MclConcurrentHashTable_Create(bucketCount);
+	MCL_ASSERT_VALID_PTR_NIL(table);
+
+	MCL_LOOP_FOREACH_INDEX(i, self->bucketCount) {
+		for (MclConcurrentHashNode *node = self->buckets[i]; node; node = node->next) {
+			MclConcurrentHashNode *copy = MclConcurrentHashNode_Create(node->key, node->value);
+			if (!copy) {
+				MclConcurrentHashTable_Delete(table, NULL);
+				return NULL;
+			}
+			MclConcurrentHashNode **head = &table->buckets[MclConcurrentHashTable_GetIndex(table, MclHashKey_Hash(node->key))];
+			copy->next = *head;
+			*head = copy;
+		}
+	}
+	return table;
+}
+
+///////////////////////////////////////////////////////////
+MCL_PRIVATE MclConcurrentHashStripe* MclConcurrentHashMap_GetStripe(MclConcurrentHashMap *self, uint64_t hash) {
+	return &self->stripes[hash & (MCL_CONCURRENT_HASHMAP_STRIPE_COUNT - 1)];
+}
+
+MCL_PRIVATE MclConcurrentHashTable* MclConcurrentHashMap_LoadTable(const MclConcurrentHashMap *self) {
+	return __atomic_load_n(&self->table, __ATOMIC_ACQUIRE);
+}
+
+MCL_PRIVATE bool MclConcurrentHashMap_IsOverloaded(const MclConcurrentHashTable *table, MclSize stripeCount) {
+	return stripeCount > (table->bucketCount / MCL_CONCURRENT_HASHMAP_STRIPE_COUNT) * MCL_CONCURRENT_HASHMAP_LOAD_MAX;
+}
+
+MCL_PRIVATE MclSize MclConcurrentHashMap_GetBucketCountFor(MclSize bucketCount) {
+	MclSize count = MCL_CONCURRENT_HASHMAP_STRIPE_COUNT;
+	while (count < bucketCount) {
+		if (count > (MCL_UINT32_MAX >> 1)) return 0;
+		count *= 2;
+	}
+	return count;
+}
+
+/* Locks all stripes in order, so it excludes every writer and never deadlocks with another grower */
+MCL_PRIVATE void MclConcurrentHashMap_Grow(MclConcurrentHashMap *self, const MclConcurrentHashTable *overloaded) {
+	MCL_LOOP_FOREACH_INDEX(i, MCL_CONCURRENT_HASHMAP_STRIPE_COUNT) {
+		(void)MclMutex_Lock(&self->stripes[i].mutex);
+	}
+
+	MclConcurrentHashTable *table = self->table;
+	MclConcurrentHashTable *grown = NULL;
+	if ((table == overloaded) && (table->bucketCount <= (MCL_UINT32_MAX >> 1))) {
+		grown = MclConcurrentHashTable_Copy(table, table->bucketCount * 2);
+		if (grown) {
+			__atomic_store_n(&self->table, grown, __ATOMIC_RELEASE);
+		}
+	}
+
+	MCL_LOOP_FOREACH_INDEX(i, MCL_CONCURRENT_HASHMAP_STRIPE_COUNT) {
+		(void)MclMutex_UnLock(&self->stripes[i].mutex);
+	}
+
+	if (grown) {
+		MclGracePeriod_Retire(&table->grace, MclConcurrentHashTable_Free);
+	}
+}
+
+///////////////////////////////////////////////////////////
+MclConcurrentHashMap* MclConcurrentHashMap_CreateDefault() {
+	return MclConcurrentHashMap_Create(MCL_CONCURRENT_HASHMAP_BUCKET_COUNT_DEFAULT);
+}
+
+MclConcurrentHashMap* MclConcurrentHashMap_Create(MclSize bucketCount) {
+	MclSize count = MclConcurrentHashMap_GetBucketCountFor(bucketCount);
+	MCL_ASSERT_TRUE_NIL(count > 0);
+
+	MclConcurrentHashMap *self = MCL_MALLOC(sizeof(MclConcurrentHashMap));
+	MCL_ASSERT_VALID_PTR_NIL(self);
+
+	self->table = MclConcurrentHashTable_Create(count);
+	if (!self->table) {
+		MCL_FREE(self);
+		return NULL;
+	}
+
+	MCL_LOOP_FOREACH_INDEX(i, MCL_CONCURRENT_HASHMAP_STRIPE_COUNT) {
+		(void)MclMutex_Init(&self->stripes[i].mutex, NULL);
+		self->stripes[i].count = 0;
+	}
+	return self;
+}
+
+void MclConcurrentHashMap_Delete(MclConcurrentHashMap *self, MclHashValueDestroy destroy) {
+	MCL_ASSERT_VALID_PTR_VOID(self);
+
+	MclConcurrentHashTable_Delete(self->table, destroy);
+	MCL_LOOP_FOREACH_INDEX(i, MCL_CONCURRENT_HASHMAP_STRIPE_COUNT) {
+		(void)MclMutex_Destroy(&self->stripes[i].mutex);
+	}
+	MCL_FREE(self);
+}
+
+MclHashValue MclConcurrentHashMap_Get(const MclConcurrentHashMap *self, MclHashKey key) {
+	MCL_ASSERT_VALID_PTR_NIL(self);
+	MCL_ASSERT_TRUE_NIL(MclHashKey_IsValid(key));
+
+	MclHashValue value = MCL_HASH_VALUE_INVALID;
+	uint64_t hash = MclHashKey_Hash(key);
+
+	MclGracePeriod_ReadLock();
+	MclConcurrentHashTable *table = MclConcurrentHashMap_LoadTable(self);
+	MclConcurrentHashNode *node = MclConcurrentHashNode_LoadNext(&table->buckets[MclConcurrentHashTable_GetIndex(table, hash)]);
+	for (; node; node = MclConcurrentHashNode_LoadNext(&node->next)) {
+		if (node->key == key) {
+			value = __atomic_load_n(&node->value, __ATOMIC_ACQUIRE);
+			break;
+		}
+	}
+	MclGracePeriod_ReadUnlock();
+	return value;
+}
+
+MclHashValue MclConcurrentHashMap_Set(MclConcurrentHashMap *self, MclHashKey key, MclHashValue value) {
+	MCL_ASSERT_VALID_PTR_NIL(self);
+	MCL_ASSERT_TRUE_NIL(MclHashKey_IsValid(key));
+	MCL_ASSERT_TRUE_NIL(MclHashValue_IsValid(value));
+
+	uint64_t hash = MclHashKey_Hash(key);
+	MclConcurrentHashStripe *stripe = MclConcurrentHashMap_GetStripe(self, hash);
+	MclConcurrentHashTable *table = NULL;
+	MclHashValue result = MCL_HASH_VALUE_INVALID;
+	bool shouldGrow = false;
+
+	MCL_LOCK_SCOPE(stripe->mutex) {
+		table = self->table;
+		MclConcurrentHashNode **link = MclConcurrentHashTable_Find(table, key, hash);
+		if (*link) {
+			result = (*link)->value;
+			__atomic_store_n(&(*link)->value, value, __ATOMIC_RELEASE);
+			break;
+		}
+
+		MclConcurrentHashNode *node = MclConcurrentHashNode_Create(key, value);
+		if (!node) break;
+
+		node->next = *link;
+		__atomic_store_n(link, node, __ATOMIC_RELEASE);
+		__atomic_store_n(&stripe->count, stripe->count + 1, __ATOMIC_RELAXED);
+		shouldGrow = MclConcurrentHashMap_IsOverloaded(table, stripe->count);
+		result = value;
+	}
+
+	if (shouldGrow) {
+		MclConcurrentHashMap_Grow(self, table);
+	}
+	return result;
+}
+
+MclHashValue MclConcurrentHashMap_Remove(MclConcurrentHashMap *self, MclHashKey key) {
+	MCL_ASSERT_VALID_PTR_NIL(self);
+	MCL_ASSERT_TRUE_NIL(MclHashKey_IsValid(key));
+
+	uint64_t hash = MclHashKey_Hash(key);
+	MclConcurrentHashStripe *stripe = MclConcurrentHashMap_GetStripe(self, hash);
+	MclConcurrentHashNode *node = NULL;
+
+	MCL_LOCK_SCOPE(stripe->mutex) {
+		MclConcurrentHashNode **link = MclConcurrentHashTable_Find(self->table, key, hash);
+		node = *link;
+		if (!node) break;
+
+		__atomic_store_n(link, node->next, __ATOMIC_RELEASE);
+		__atomic_store_n(&stripe->count, stripe->count - 1, __ATOMIC_RELAXED);
+	}
+	if (!node) return MCL_HASH_VALUE_INVALID;
+
+	MclHashValue value = node->value;
+	MclGracePeriod_Retire(&node->grace, MclConcurrentHashNode_Free);
+	return value;
+}
+
+MclStatus MclConcurrentHashMap_Accept(const MclConcurrentHashMap *self, MclConcurrentHashVisit visit, void *arg) {
+	MCL_ASSERT_VALID_PTR(self);
+	MCL_ASSERT_VALID_PTR(visit);
+
+	MclStatus result = MCL_SUCCESS;
+
+	MclGracePeriod_ReadLock();
+	MclConcurrentHashTable *table = MclConcurrentHashMap_LoadTable(self);
+	for (MclSize i = 0; (i < table->bucketCount) && (result == MCL_SUCCESS); i++) {
+		MclConcurrentHashNode *node = MclConcurrentHashNode_LoadNext(&table->buckets[i]);
+		for (; node; node = MclConcurrentHashNode_LoadNext(&node->next)) {
+			MclStatus ret = visit(node->key, __atomic_load_n(&node->value, __ATOMIC_ACQUIRE), arg);
+			if (MCL_DONE(ret)) {
+				result = MCL_STATUS_DONE;
+				break;
+			}
+			if (MCL_FAILED(ret)) {
+				result = ret;
+				break;
+			}
+		}
+	}
+	MclGracePeriod_ReadUnlock();
+	return MCL_DONE(result) ? MCL_SUCCESS : result;
+}
+
+MclSize MclConcurrentHashMap_GetSize(const MclConcurrentHashMap *self) {
+	if (!self) return 0;
+
+	MclSize size = 0;
+	MCL_LOOP_FOREACH_INDEX(i, MCL_CONCURRENT_HASHMAP_STRIPE_COUNT) {
+		size += __atomic_load_n(&self->stripes[i].count, __ATOMIC_RELAXED);
+	}
+	return size;
+}
+
+MclSize MclConcurrentHashMap_GetBucketCount(const MclConcurrentHashMap *self) {
+	return self ? MclConcurrentHashMap_LoadTable(self)->bucketCount : 0;
+}
@@ -0,0 +1,290 @@
+#include "mcl/map/flat_hash_map.h"
+#include "mcl/mem/memory.h"
+#include "mcl/assert.h"
+#include <string.h>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define MCL_FLAT_GROUP_WIDTH 32
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define MCL_FLAT_GROUP_WIDTH 16
+#else
+#define MCL_FLAT_GROUP_WIDTH 16
+#endif
+
+/* Control byte is empty with the high bit set, otherwise the low 7 bits of hash */
+#define MCL_FLAT_CTRL_EMPTY ((uint8_t)0x80)
+
+/* Table is never smaller than a group, so a group load never wraps twice */
+#define MCL_FLAT_CAPACITY_MIN MCL_FLAT_GROUP_WIDTH
+
+typedef uint32_t MclFlatMask;
+
+MCL_PRIVATE bool MclFlatCtrl_IsEmpty(uint8_t ctrl) {
+	return (ctrl & MCL_FLAT_CTRL_EMPTY) != 0;
+}
+
+///////////////////////////////////////////////////////////
+/* Bit i of mask stands for slot i of the group */
+#if defined(__AVX2__)
+MCL_PRIVATE MclFlatMask MclFlatGroup_Match(const uint8_t *ctrls, uint8_t h2) {
+	__m256i group = _mm256_loadu_si256((const __m256i*)ctrls);
+	return (MclFlatMask)_mm256_movemask_epi8(_mm256_cmpeq_epi8(group, _mm256_set1_epi8((char)h2)));
+}
+
+MCL_PRIVATE MclFlatMask MclFlatGroup_MatchEmpty(const uint8_t *ctrls) {
+	return (MclFlatMask)_mm256_movemask_epi8(_mm256_loadu_si256((const __m256i*)ctrls));
+}
+#elif defined(__SSE2__)
+MCL_PRIVATE MclFlatMask MclFlatGroup_Match(const uint8_t *ctrls, uint8_t h2) {
+	__m128i group = _mm_loadu_si128((const __m128i*)ctrls);
+	return (MclFlatMask)_mm_movemask_epi8(_mm_cmpeq_epi8(group, _mm_set1_epi8((char)h2)));
+}
+
+MCL_PRIVATE MclFlatMask MclFlatGroup_MatchEmpty(const uint8_t *ctrls) {
+	return (MclFlatMask)_mm_movemask_epi8(_mm_loadu_si128((const __m128i*)ctrls));
+}
+#else
+MCL_PRIVATE MclFlatMask MclFlatGroup_Match(const uint8_t *ctrls, uint8_t h2) {
+	MclFlatMask mask = 0;
+	for (MclSize i = 0; i < MCL_FLAT_GROUP_WIDTH; i++) {
+		if (ctrls[i] == h2) mask |= (MclFlatMask)1 << i;
+	}
+	return mask;
+}
+
+MCL_PRIVATE MclFlatMask MclFlatGroup_MatchEmpty(const uint8_t *ctrls) {
+	MclFlatMask mask = 0;
+	for (MclSize i = 0; i < MCL_FLAT_GROUP_WIDTH; i++) {
+		if (MclFlatCtrl_IsEmpty(ctrls[i])) mask |= (MclFlatMask)1 << i;
+	}
+	return mask;
+}
+#endif
+
+MCL_PRIVATE MclSize MclFlatMask_Lowest(MclFlatMask mask) {
+	return (MclSize)__builtin_ctz(mask);
+}
+
+///////////////////////////////////////////////////////////
+MCL_PRIVATE uint8_t MclFlatHash_H2(uint64_t hash) {
+	return (uint8_t)(hash & 0x7f);
+}
+
+MCL_PRIVATE MclSize MclFlatHashMap_GetHome(const MclFlatHashMap *self, uint64_t hash) {
+	return (MclSize)(hash >> 7) & (self->capacity - 1);
+}
+
+MCL_PRIVATE MclSize MclFlatHashMap_GetGrowthLimit(MclSize capacity) {
+	return capacity - capacity / 8;
+}
+
+MCL_PRIVATE MclSize MclFlatHashMap_GetCtrlCount(MclSize capacity) {
+	return capacity + MCL_FLAT_GROUP_WIDTH - 1;
+}
+
+/* Control bytes of the first group are mirrored after the table for unaligned group loads at the tail */
+MCL_PRIVATE void MclFlatHashMap_SetCtrl(MclFlatHashMap *self, MclSize index, uint8_t ctrl) {
+	self->ctrls[index] = ctrl;
+	if (index < MCL_FLAT_GROUP_WIDTH - 1) {
+		self->ctrls[self->capacity + index] = ctrl;
+	}
+}
+
+/* Returns the slot of key, or capacity if not found with the first empty slot on the probe path */
+MCL_PRIVATE MclSize MclFlatHashMap_Find(const MclFlatHashMap *self, MclHashKey key, uint64_t hash, MclSize *empty) {
+	MclSize mask = self->capacity - 1;
+	MclSize pos = MclFlatHashMap_GetHome(self, hash);
+	uint8_t h2 = MclFlatHash_H2(hash);
+
+	/* most keys sit at or near home, load the slot while matching the control bytes */
+	__builtin_prefetch(&self->slots[pos]);
+	while (true) {
+		const uint8_t *group = self->ctrls + pos;
+		MclFlatMask match = MclFlatGroup_Match(group, h2);
+		while (match) {
+			MclSize index = (pos + MclFlatMask_Lowest(match)) & mask;
+			if (self->slots[index].key == key) return index;
+			match &= match - 1;
+		}
+		MclFlatMask emptyMask = MclFlatGroup_MatchEmpty(group);
+		if (emptyMask) {
+			if (empty) *empty = (pos + MclFlatMask_Lowest(emptyMask)) & mask;
+			return self->capacity;
+		}
+		pos = (pos + MCL_FLAT_GROUP_WIDTH) & mask;
+	}
+}
+
+MCL_PRIVATE void MclFlatHashMap_Place(MclFlatHashMap *self, MclSize index, uint64_t hash, MclHashKey key, MclHashValue value) {
+	self->slots[index].key = key;
+	self->slots[index].value = value;
+	MclFlatHashMap_SetCtrl(self, index, MclFlatHash_H2(hash));
+	self->size++;
+}
+
+/* Fills the hole by the following slots which may live there, keeps linear probe chains unbroken */
+MCL_PRIVATE void MclFlatHashMap_EraseSlot(MclFlatHashMap *self, MclSize hole) {
+	MclSize mask = self->capacity - 1;
+	MclSize next = (hole + 1) & mask;
+
+	while (!MclFlatCtrl_IsEmpty(self->ctrls[next])) {
+		MclSize home = MclFlatHashMap_GetHome(self, MclHashKey_Hash(self->slots[next].key));
+		if (((next - home) & mask) >= ((next - hole) & mask)) {
+			self->slots[hole] = self->slots[next];
+			MclFlatHashMap_SetCtrl(self, hole, self->ctrls[next]);
+			hole = next;
+		}
+		next = (next + 1) & mask;
+	}
+	MclFlatHashMap_SetCtrl(self, hole, MCL_FLAT_CTRL_EMPTY);
+	self->size--;
+}
+
+MCL_PRIVATE MclStatus MclFlatHashMap_Alloc(MclFlatHashMap *self, MclSize capacity) {
+	self->ctrls = MCL_MALLOC(MclFlatHashMap_GetCtrlCount(capacity));
+	MCL_ASSERT_VALID_PTR(self->ctrls);
+
+	self->slots = MCL_MALLOC(sizeof(MclFlatHashSlot) * capacity);
+	if (!self->slots) {
+		MCL_LOG_ERR("Malloc for flat hash slots failed!");
+		MCL_FREE(self->ctrls);
+		return MCL_FAILURE;
+	}
+	memset(self->ctrls, MCL_FLAT_CTRL_EMPTY, MclFlatHashMap_GetCtrlCount(capacity));
+	self->capacity = capacity;
+	self->size = 0;
+	return MCL_SUCCESS;
+}
+
+MCL_PRIVATE MclStatus MclFlatHashMap_Grow(MclFlatHashMap *self) {
+	MCL_ASSERT_TRUE(self->capacity <= (MCL_UINT32_MAX >> 2));
+
+	uint8_t *ctrls = self->ctrls;
+	MclFlatHashSlot *slots = self->slots;
+	MclSize capacity = self->capacity;
+
+	if (MCL_FAILED(MclFlatHashMap_Alloc(self, capacity * 2))) {
+		MCL_LOG_ERR("Grow flat hash map to (%u) failed!", capacity * 2);
+		self->ctrls = ctrls;
+		self->slots = slots;
+		return MCL_FAILURE;
+	}
+	for (MclSize i = 0; i < capacity; i++) {
+		if (MclFlatCtrl_IsEmpty(ctrls[i])) continue;
+
+		uint64_t hash = MclHashKey_Hash(slots[i].key);
+		MclSize empty = 0;
+		(void)MclFlatHashMap_Find(self, slots[i].key, hash, &empty);
+		MclFlatHashMap_Place(self, empty, hash, slots[i].key, slots[i].value);
+	}
+	MCL_FREE(ctrls);
+	MCL_FREE(slots);
+	return MCL_SUCCESS;
+}
+
+MCL_PRIVATE MclSize MclFlatHashMap_GetCapacityFor(MclSize count) {
+	MclSize capacity = MCL_FLAT_CAPACITY_MIN;
+	while (MclFlatHashMap_GetGrowthLimit(capacity) <= count) {
+		if (capacity > (MCL_UINT32_MAX >> 2)) return 0;
+		capacity *= 2;
+	}
+	return capacity;
+}
+
+///////////////////////////////////////////////////////////
+MclFlatHashMap* MclFlatHashMap_CreateDefault() {
+	return MclFlatHashMap_Create(MCL_FLAT_HASHMAP_COUNT_DEFAULT);
+}
+
+MclFlatHashMap* MclFlatHashMap_Create(MclSize count) {
+	MclSize capacity = MclFlatHashMap_GetCapacityFor(count);
+	MCL_ASSERT_TRUE_NIL(capacity > 0);
+
+	MclFlatHashMap *self = MCL_MALLOC(sizeof(MclFlatHashMap));
+	MCL_ASSERT_VALID_PTR_NIL(self);
+
+	if (MCL_FAILED(MclFlatHashMap_Alloc(self, capacity))) {
+		MCL_FREE(self);
+		return NULL;
+	}
+	return self;
+}
+
+void MclFlatHashMap_Delete(MclFlatHashMap *self, MclHashValueDestroy destroy) {
+	MCL_ASSERT_VALID_PTR_VOID(self);
+
+	MclFlatHashMap_Clear(self, destroy);
+	MCL_FREE(self->ctrls);
+	MCL_FREE(self->slots);
+	MCL_FREE(self);
+}
+
+void MclFlatHashMap_Clear(MclFlatHashMap *self, MclHashValueDestroy destroy) {
+	MCL_ASSERT_VALID_PTR_VOID(self);
+
+	if (destroy) {
+		for (MclSize i = 0; i < self->capacity; i++) {
+			if (!MclFlatCtrl_IsEmpty(self->ctrls[i])) destroy(self->slots[i].value);
+		}
+	}
+	memset(self->ctrls, MCL_FLAT_CTRL_EMPTY, MclFlatHashMap_GetCtrlCount(self->capacity));
+	self->size = 0;
+}
+
+MclHashValue MclFlatHashMap_Get(const MclFlatHashMap *self, MclHashKey key) {
+	MCL_ASSERT_VALID_PTR_NIL(self);
+	MCL_ASSERT_TRUE_NIL(MclHashKey_IsValid(key));
+
+	MclSize index = MclFlatHashMap_Find(self, key, MclHashKey_Hash(key), NULL);
+	return (index < self->capacity) ? self->slots[index].value : NULL;
+}
+
+MclHashValue MclFlatHashMap_Set(MclFlatHashMap *self, MclHashKey key, MclHashValue value) {
+	MCL_ASSERT_VALID_PTR_NIL(self);
+	MCL_ASSERT_TRUE_NIL(MclHashKey_IsValid(key));
+	MCL_ASSERT_TRUE_NIL(MclHashValue_IsValid(value));
+
+	uint64_t hash = MclHashKey_Hash(key);
+	MclSize empty = 0;
+	MclSize index = MclFlatHashMap_Find(self, key, hash, &empty);
+	if (index < self->capacity) {
+		MclHashValue oriValue = self->slots[index].value;
+		self->slots[index].value = value;
+		return oriValue;
+	}
+
+	if (self->size + 1 >= MclFlatHashMap_GetGrowthLimit(self->capacity)) {
+		MCL_ASSERT_SUCC_CALL_NIL(MclFlatHashMap_Grow(self));
+		(void)MclFlatHashMap_Find(self, key, hash, &empty);
+	}
+	MclFlatHashMap_Place(self, empty, hash, key, value);
+	return value;
+}
+
+MclHashValue MclFlatHashMap_Remove(MclFlatHashMap *self, MclHashKey key) {
+	MCL_ASSERT_VALID_PTR_NIL(self);
+	MCL_ASSERT_TRUE_NIL(MclHashKey_IsValid(key));
+
+	MclSize index = MclFlatHashMap_Find(self, key, MclHashKey_Hash(key), NULL);
+	if (index >= self->capacity) return NULL;
+
+	MclHashValue value = self->slots[index].value;
+	MclFlatHashMap_EraseSlot(self, index);
+	return value;
+}
+
+MclStatus MclFlatHashMap_Accept(const MclFlatHashMap *self, MclFlatHashVisit visit, void *arg) {
+	MCL_ASSERT_VALID_PTR(self);
+	MCL_ASSERT_VALID_PTR(visit);
+
+	for (MclSize i = 0; i < self->capacity; i++) {
+		if (MclFlatCtrl_IsEmpty(self->ctrls[i])) continue;
+
+		MclStatus ret = visit(self->slots[i].key, self->slots[i].value, arg);
+		if (MCL_DONE(ret)) return MCL_SUCCESS;
+		if (MCL_FAILED(ret)) return ret;
+	}
+	return MCL_SUCCESS;
+}
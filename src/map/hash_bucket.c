@@ -114,8 +114,7 @@ MclStatus MclHashBucket_Accept(const MclHashBucket *self, MclHashNodeVisit visit
 	MclHashNode *node;
 	MCL_LINK_FOREACH(&self->nodes, MclHashNode, link, node) {
 		MclStatus ret = MclHashNode_Visit(node, visit, arg);
-		if (MCL_DONE(ret)) return MCL_SUCCESS;
-		if (MCL_FAILED(ret)) return ret;
+		if (MCL_DONE(ret) || MCL_FAILED(ret)) return ret;
 	}
 	return MCL_SUCCESS;
 }
@@ -4,8 +4,114 @@
 
 typedef MclSize MclHashBucketId;
 
-MCL_PRIVATE MclHashBucketId MclHashMap_GetBucketId(const MclHashMap *self, MclHashKey key) {
-    return key % self->bucketCount;
+#define MCL_HASHMAP_BUCKET_COUNT_MAX ((MclSize)1 << 30)
+
+/* Keys of batch are looked up by windows, enough misses in flight to hide memory latency */
+#define MCL_HASHMAP_BATCH_WINDOW 16
+
+MCL_PRIVATE bool MclHashMap_IsPowerOfTwo(MclSize count) {
+    return (count & (count - 1)) == 0;
+}
+
+/* Buckets given by Init may be not power of two, which takes the modulo */
+MCL_PRIVATE MclHashBucketId MclHashMap_GetBucketId(MclSize bucketCount, MclHashKey key) {
+    uint64_t hash = MclHashKey_Hash(key);
+    return MclHashMap_IsPowerOfTwo(bucketCount) ? (MclHashBucketId)(hash & (bucketCount - 1)) : (MclHashBucketId)(hash % bucketCount);
+}
+
+MCL_PRIVATE MclHashBucket* MclHashMap_GetBucket(const MclHashMap *self, MclHashKey key) {
+    if (self->oldBuckets) {
+        MclHashBucketId oldId = MclHashMap_GetBucketId(self->oldBucketCount, key);
+        if (oldId >= self->movedCount) return &self->oldBuckets[oldId];
+    }
+    return &self->buckets[MclHashMap_GetBucketId(self->bucketCount, key)];
+}
+
+/* Walks old buckets first then the current ones, moved old buckets are empty */
+MCL_PRIVATE MclSize MclHashMap_GetAllBucketCount(const MclHashMap *self) {
+    return self->oldBucketCount + self->bucketCount;
+}
+
+MCL_PRIVATE MclHashBucket* MclHashMap_GetBucketAt(const MclHashMap *self, MclHashBucketId id) {
+    return (id < self->oldBucketCount) ? &self->oldBuckets[id] : &self->buckets[id - self->oldBucketCount];
+}
+
+MCL_PRIVATE MclSize MclHashMap_GetBucketCountFor(MclSize count) {
+    MclSize bucketCount = 1;
+    while ((bucketCount < count) && (bucketCount < MCL_HASHMAP_BUCKET_COUNT_MAX)) {
+        bucketCount <<= 1;
+    }
+    return bucketCount;
+}
+
+MCL_PRIVATE MclHashBucket* MclHashMap_CreateBuckets(MclSize bucketCount) {
+    MclHashBucket *buckets = MCL_MALLOC(sizeof(MclHashBucket) * bucketCount);
+    if (!buckets) {
+        MCL_LOG_ERR("Malloc for (%u) buckets failed!", bucketCount);
+        return NULL;
+    }
+    for (MclSize i = 0; i < bucketCount; i++) {
+        MclHashBucket_Init(&buckets[i]);
+    }
+    return buckets;
+}
+
+MCL_PRIVATE void MclHashMap_FreeOldBuckets(MclHashMap *self) {
+    if (self->isOldBucketsOwned) MCL_FREE(self->oldBuckets);
+    self->oldBuckets = NULL;
+    self->oldBucketCount = 0;
+    self->movedCount = 0;
+    self->isOldBucketsOwned = false;
+}
+
+MCL_PRIVATE void MclHashMap_MoveBucket(MclHashMap *self, MclHashBucket *bucket) {
+    MclHashNode *node, *tmpNode;
+    MCL_LINK_FOREACH_SAFE(&bucket->nodes, MclHashNode, link, node, tmpNode) {
+        MCL_LINK_REMOVE(node, link);
+        MclHashBucket *target = &self->buckets[MclHashMap_GetBucketId(self->bucketCount, node->key)];
+        MCL_LINK_INSERT_TAIL(&target->nodes, node, MclHashNode, link);
+    }
+}
+
+MCL_PRIVATE void MclHashMap_MoveBuckets(MclHashMap *self, MclSize count) {
+    if (!self->oldBuckets) return;
+
+    for (MclSize i = 0; (i < count) && (self->movedCount < self->oldBucketCount); i++) {
+        MclHashMap_MoveBucket(self, &self->oldBuckets[self->movedCount++]);
+    }
+    if (self->movedCount == self->oldBucketCount) {
+        MclHashMap_FreeOldBuckets(self);
+    }
+}
+
+MCL_PRIVATE MclStatus MclHashMap_Resize(MclHashMap *self, MclSize bucketCount) {
+    MclHashBucket *buckets = MclHashMap_CreateBuckets(bucketCount);
+    MCL_ASSERT_VALID_PTR(buckets);
+
+    self->oldBuckets = self->buckets;
+    self->oldBucketCount = self->bucketCount;
+    self->movedCount = 0;
+    self->isOldBucketsOwned = self->isBucketsOwned;
+    self->buckets = buckets;
+    self->bucketCount = bucketCount;
+    self->isBucketsOwned = true;
+    return MCL_SUCCESS;
+}
+
+/* Moves some old buckets if growing, otherwise starts growing when size passes bucket count */
+MCL_PRIVATE void MclHashMap_Step(MclHashMap *self) {
+    if (self->oldBuckets) {
+        MclHashMap_MoveBuckets(self, MCL_HASHMAP_MOVE_STEP);
+        return;
+    }
+    if (!self->isGrowable || (self->size <= self->bucketCount)) return;
+    if (self->bucketCount >= MCL_HASHMAP_BUCKET_COUNT_MAX) return;
+
+    if (MCL_FAILED(MclHashMap_Resize(self, MclHashMap_GetBucketCountFor(self->bucketCount * 2)))) {
+        MCL_LOG_WARN("Grow hash map of size (%u) failed!", self->size);
+        return;
+    }
+    MclHashMap_MoveBuckets(self, MCL_HASHMAP_MOVE_STEP);
 }
 
 MclHashMap* MclHashMap_CreateDefault() {
@@ -25,15 +131,15 @@ MclHashMap* MclHashMap_Create(MclSize bucketCount, MclHashNodeAllocator *allocat
         return NULL;
     }
 
-    MclHashMap_Init(self, buckets, bucketCount, allocator);
+    MclHashMap_InitGrowable(self, buckets, bucketCount, allocator);
+    self->isBucketsOwned = true;
     return self;
 }
 
 void MclHashMap_Delete(MclHashMap *self, MclHashValueDestroy destroy) {
     MCL_ASSERT_VALID_PTR_VOID(self);
 
-    MclHashMap_Clear(self, destroy);
-    MCL_FREE(self->buckets);
+    MclHashMap_Destroy(self, destroy);
     MCL_FREE(self);
 }
 
@@ -45,25 +151,61 @@ void MclHashMap_Init(MclHashMap *self, MclHashBucket *buckets, MclSize bucketCou
     self->size = 0;
     self->allocator = allocator;
     self->buckets = buckets;
+    self->oldBuckets = NULL;
+    self->oldBucketCount = 0;
+    self->movedCount = 0;
+    self->isBucketsOwned = false;
+    self->isOldBucketsOwned = false;
+    self->isGrowable = false;
     for (MclSize i = 0; i < bucketCount; i++) {
         MclHashBucket_Init(&self->buckets[i]);
     }
 }
 
+void MclHashMap_InitGrowable(MclHashMap *self, MclHashBucket *buckets, MclSize bucketCount, MclHashNodeAllocator *allocator) {
+    MCL_ASSERT_VALID_PTR_VOID(self);
+
+    MclHashMap_Init(self, buckets, bucketCount, allocator);
+    self->isGrowable = true;
+}
+
 void MclHashMap_Clear(MclHashMap *self, MclHashValueDestroy destroy) {
-	for (MclSize i = 0; i < self->bucketCount; i++) {
-		MclHashBucket_Clear(&self->buckets[i], self->allocator, destroy);
+	for (MclHashBucketId i = 0; i < MclHashMap_GetAllBucketCount(self); i++) {
+		MclHashBucket_Clear(MclHashMap_GetBucketAt(self, i), self->allocator, destroy);
 	}
+	MclHashMap_FreeOldBuckets(self);
 	self->size = 0;
 }
 
+void MclHashMap_Destroy(MclHashMap *self, MclHashValueDestroy destroy) {
+    MCL_ASSERT_VALID_PTR_VOID(self);
+
+    MclHashMap_Clear(self, destroy);
+    if (self->isBucketsOwned) MCL_FREE(self->buckets);
+    self->buckets = NULL;
+    self->bucketCount = 0;
+    self->isBucketsOwned = false;
+}
+
+MclStatus MclHashMap_Reserve(MclHashMap *self, MclSize count) {
+    MCL_ASSERT_VALID_PTR(self);
+
+    MclHashMap_MoveBuckets(self, self->oldBucketCount);
+    if (count <= self->bucketCount) return MCL_SUCCESS;
+    if (!self->allocator && !self->isGrowable) return MCL_FAILURE;
+
+    MCL_ASSERT_SUCC_CALL(MclHashMap_Resize(self, MclHashMap_GetBucketCountFor(count)));
+    MclHashMap_MoveBuckets(self, self->oldBucketCount);
+    return MCL_SUCCESS;
+}
+
 MclStatus MclHashMap_InsertNode(MclHashMap *self, MclHashNode *node) {
     MCL_ASSERT_VALID_PTR(self);
     MCL_ASSERT_VALID_PTR(node);
 
-    MclHashBucketId bucketId = MclHashMap_GetBucketId(self, node->key);
-    MCL_ASSERT_SUCC_CALL(MclHashBucket_PushBackNode(&self->buckets[bucketId], node));
+    MCL_ASSERT_SUCC_CALL(MclHashBucket_PushBackNode(MclHashMap_GetBucket(self, node->key), node));
     self->size++;
+    MclHashMap_Step(self);
     return MCL_SUCCESS;
 }
 
@@ -71,11 +213,11 @@ MclStatus MclHashMap_RemoveNode(MclHashMap *self, MclHashNode *node, MclHashValu
     MCL_ASSERT_VALID_PTR(self);
     MCL_ASSERT_VALID_PTR(node);
 
-    MclHashBucketId bucketId = MclHashMap_GetBucketId(self, node->key);
-    if (MCL_FAILED(MclHashBucket_RemoveNode(&self->buckets[bucketId], node, self->allocator, destroy))) {
+    if (MCL_FAILED(MclHashBucket_RemoveNode(MclHashMap_GetBucket(self, node->key), node, self->allocator, destroy))) {
     	return MCL_FAILURE;
     }
 	self->size--;
+	MclHashMap_Step(self);
     return MCL_SUCCESS;
 }
 
@@ -83,8 +225,7 @@ MclHashNode* MclHashMap_FindNode(const MclHashMap *self, MclHashKey key) {
     MCL_ASSERT_VALID_PTR_NIL(self);
     MCL_ASSERT_TRUE_NIL(MclHashKey_IsValid(key));
 
-    MclHashBucketId bucketId = MclHashMap_GetBucketId(self, key);
-	return MclHashBucket_FindNode(&self->buckets[bucketId], key);
+	return MclHashBucket_FindNode(MclHashMap_GetBucket(self, key), key);
 }
 
 MclHashValue MclHashMap_Get(const MclHashMap *self, MclHashKey key) {
@@ -120,12 +261,27 @@ MclHashValue MclHashMap_Set(MclHashMap *self, MclHashKey key, MclHashValue value
     return value;
 }
 
+/* Hashes all keys of window and prefetches their buckets, then prefetches the first node of each */
+MCL_PRIVATE void MclHashMap_PrefetchWindow(const MclHashMap *self, const MclHashKey *keys, MclSize count, MclHashBucket **buckets) {
+    for (MclSize i = 0; i < count; i++) {
+        buckets[i] = MclHashKey_IsValid(keys[i]) ? MclHashMap_GetBucket(self, keys[i]) : NULL;
+        if (buckets[i]) __builtin_prefetch(buckets[i]);
+    }
+    for (MclSize i = 0; i < count; i++) {
+        if (buckets[i]) __builtin_prefetch(MCL_LINK_FIRST(&buckets[i]->nodes));
+    }
+}
+
+MCL_PRIVATE MclSize MclHashMap_GetWindow(MclSize base, MclSize count) {
+    return ((count - base) < MCL_HASHMAP_BATCH_WINDOW) ? (count - base) : MCL_HASHMAP_BATCH_WINDOW;
+}
+
 MclHashValue MclHashMap_FindByPred(const MclHashMap *self, MclHashNodePred pred, void *arg) {
 	MCL_ASSERT_VALID_PTR_NIL(self);
 	MCL_ASSERT_VALID_PTR_NIL(pred);
 
-    for (MclHashBucketId i = 0; i < self->bucketCount; i++) {
-    	MclHashValue value = MclHashBucket_FindByPred(&self->buckets[i], pred, arg);
+    for (MclHashBucketId i = 0; i < MclHashMap_GetAllBucketCount(self); i++) {
+    	MclHashValue value = MclHashBucket_FindByPred(MclHashMap_GetBucketAt(self, i), pred, arg);
     	if (MclHashValue_IsValid(value)) {
     		return value;
     	}
@@ -137,19 +293,101 @@ MclHashValue MclHashMap_Remove(MclHashMap *self, MclHashKey key) {
 	MCL_ASSERT_VALID_PTR_NIL(self);
 	MCL_ASSERT_TRUE_NIL(MclHashKey_IsValid(key));
 
-	MclHashBucketId bucketId = MclHashMap_GetBucketId(self, key);
-
-	MclHashValue value = MclHashBucket_Remove(&self->buckets[bucketId], key, self->allocator);
-	if (MclHashValue_IsValid(value)) self->size--;
+	MclHashValue value = MclHashBucket_Remove(MclHashMap_GetBucket(self, key), key, self->allocator);
+	if (MclHashValue_IsValid(value)) {
+		self->size--;
+		MclHashMap_Step(self);
+	}
 	return value;
 }
 
+void MclHashMap_GetBatch(const MclHashMap *self, const MclHashKey *keys, MclSize count, MclHashValue *values) {
+    MCL_ASSERT_VALID_PTR_VOID(self);
+    MCL_ASSERT_VALID_PTR_VOID(keys);
+    MCL_ASSERT_VALID_PTR_VOID(values);
+
+    MclHashBucket *buckets[MCL_HASHMAP_BATCH_WINDOW];
+    MclHashNode *nodes[MCL_HASHMAP_BATCH_WINDOW];
+
+    for (MclSize base = 0; base < count; base += MCL_HASHMAP_BATCH_WINDOW) {
+        MclSize window = MclHashMap_GetWindow(base, count);
+        MclHashMap_PrefetchWindow(self, keys + base, window, buckets);
+
+        for (MclSize i = 0; i < window; i++) {
+            values[base + i] = NULL;
+            nodes[i] = buckets[i] ? MCL_LINK_FIRST(&buckets[i]->nodes) : NULL;
+        }
+
+        /* Steps every chain by one node per round, so the misses of all chains overlap */
+        for (MclSize pending = window; pending > 0;) {
+            pending = 0;
+            for (MclSize i = 0; i < window; i++) {
+                MclHashNode *node = nodes[i];
+                if (!node) continue;
+
+                if (node == MCL_LINK_SENTINEL(&buckets[i]->nodes, MclHashNode, link)) {
+                    nodes[i] = NULL;
+                } else if (node->key == keys[base + i]) {
+                    values[base + i] = node->value;
+                    nodes[i] = NULL;
+                } else {
+                    nodes[i] = MCL_LINK_NODE_NEXT(node, link);
+                    __builtin_prefetch(nodes[i]);
+                    pending++;
+                }
+            }
+        }
+    }
+}
+
+MclSize MclHashMap_SetBatch(MclHashMap *self, const MclHashKey *keys, const MclHashValue *values, MclSize count, MclHashValue *results) {
+    MCL_ASSERT_VALID_PTR_R(self, 0);
+    MCL_ASSERT_VALID_PTR_R(keys, 0);
+    MCL_ASSERT_VALID_PTR_R(values, 0);
+
+    MclHashBucket *buckets[MCL_HASHMAP_BATCH_WINDOW];
+    MclSize setCount = 0;
+
+    for (MclSize base = 0; base < count; base += MCL_HASHMAP_BATCH_WINDOW) {
+        MclSize window = MclHashMap_GetWindow(base, count);
+        MclHashMap_PrefetchWindow(self, keys + base, window, buckets);
+
+        /* Sets in order after prefetching, as a key may repeat and setting may move buckets */
+        for (MclSize i = base; i < base + window; i++) {
+            MclHashValue result = MclHashMap_Set(self, keys[i], values[i]);
+            if (MclHashValue_IsValid(result)) setCount++;
+            if (results) results[i] = result;
+        }
+    }
+    return setCount;
+}
+
+MclSize MclHashMap_RemoveBatch(MclHashMap *self, const MclHashKey *keys, MclSize count, MclHashValue *values) {
+    MCL_ASSERT_VALID_PTR_R(self, 0);
+    MCL_ASSERT_VALID_PTR_R(keys, 0);
+    MCL_ASSERT_VALID_PTR_R(values, 0);
+
+    MclHashBucket *buckets[MCL_HASHMAP_BATCH_WINDOW];
+    MclSize removedCount = 0;
+
+    for (MclSize base = 0; base < count; base += MCL_HASHMAP_BATCH_WINDOW) {
+        MclSize window = MclHashMap_GetWindow(base, count);
+        MclHashMap_PrefetchWindow(self, keys + base, window, buckets);
+
+        for (MclSize i = base; i < base + window; i++) {
+            values[i] = MclHashKey_IsValid(keys[i]) ? MclHashMap_Remove(self, keys[i]) : NULL;
+            if (MclHashValue_IsValid(values[i])) removedCount++;
+        }
+    }
+    return removedCount;
+}
+
 MclHashValue MclHashMap_RemoveByPred(MclHashMap *self, MclHashNodePred pred, void *arg) {
 	MCL_ASSERT_VALID_PTR_NIL(self);
 	MCL_ASSERT_VALID_PTR_NIL(pred);
 
-    for (MclHashBucketId i = 0; i < self->bucketCount; i++) {
-    	MclHashValue value = MclHashBucket_RemoveByPred(&self->buckets[i], pred, arg, self->allocator);
+    for (MclHashBucketId i = 0; i < MclHashMap_GetAllBucketCount(self); i++) {
+    	MclHashValue value = MclHashBucket_RemoveByPred(MclHashMap_GetBucketAt(self, i), pred, arg, self->allocator);
     	if (MclHashValue_IsValid(value)) {
     		self->size--;
     		return value;
@@ -164,8 +402,8 @@ MclSize MclHashMap_RemoveAllByPred(MclHashMap *self, MclHashNodePred pred, void
 
 	MclSize removedCount = 0;
 
-    for (MclSize i = 0; i < self->bucketCount; i++) {
-    	removedCount += MclHashBucket_RemoveAllByPred(&self->buckets[i], pred, arg, self->allocator, destroy);
+    for (MclHashBucketId i = 0; i < MclHashMap_GetAllBucketCount(self); i++) {
+    	removedCount += MclHashBucket_RemoveAllByPred(MclHashMap_GetBucketAt(self, i), pred, arg, self->allocator, destroy);
     }
 
 	if (removedCount > self->size) {
@@ -181,8 +419,8 @@ MclStatus MclHashMap_Accept(const MclHashMap *self, MclHashNodeVisit visit, void
 	MCL_ASSERT_VALID_PTR(self);
 	MCL_ASSERT_VALID_PTR(visit);
 
-    for (MclHashBucketId i = 0; i < self->bucketCount; i++) {
-        MclStatus ret = MclHashBucket_Accept(&self->buckets[i], visit, arg);
+    for (MclHashBucketId i = 0; i < MclHashMap_GetAllBucketCount(self); i++) {
+        MclStatus ret = MclHashBucket_Accept(MclHashMap_GetBucketAt(self, i), visit, arg);
 		if (MCL_DONE(ret)) return MCL_SUCCESS;
 		if (MCL_FAILED(ret)) return ret;
     }
@@ -192,10 +430,10 @@ MclStatus MclHashMap_Accept(const MclHashMap *self, MclHashNodeVisit visit, void
 void MclHashMap_Dump(const MclHashMap *self) {
 	MCL_ASSERT_VALID_PTR_VOID(self);
 
-    for (MclHashBucketId i = 0; i < self->bucketCount; i++) {
-    	if (!MclHashBucket_IsEmpty(&self->buckets[i])) {
+    for (MclHashBucketId i = 0; i < MclHashMap_GetAllBucketCount(self); i++) {
+    	if (!MclHashBucket_IsEmpty(MclHashMap_GetBucketAt(self, i))) {
     		MCL_LOG("HashMap dump : bucket %u \n", i);
-    		MclHashBucket_Dump(&self->buckets[i]);
+    		MclHashBucket_Dump(MclHashMap_GetBucketAt(self, i));
     	}
     }
 }
@@ -1,6 +1,7 @@
 #include "mcl/map/hash_node_allocator.h"
 #include "mcl/map/hash_node.h"
 #include "mcl/mem/memory.h"
+#include "mcl/mem/slab.h"
 
 MCL_PRIVATE MclHashNode* MclHashNodeAllocator_AllocDefault(MclHashNodeAllocator *self) {
     return MCL_MALLOC(sizeof(MclHashNode));
@@ -14,3 +15,23 @@ MclHashNodeAllocator MclHashNodeAllocator_Default = {
     .alloc = MclHashNodeAllocator_AllocDefault,
     .free = MclHashNodeAllocator_FreeDefault
 };
+
+///////////////////////////////////////////////////////////
+MCL_PRIVATE MclSlabCache hashNodeCache = MCL_SLAB_CACHE(sizeof(MclHashNode));
+
+MCL_PRIVATE MclHashNode* MclHashNodeAllocator_AllocSlab(MclHashNodeAllocator *self) {
+    return MclSlabCache_Alloc(&hashNodeCache);
+}
+
+MCL_PRIVATE void MclHashNodeAllocator_FreeSlab(MclHashNodeAllocator *self, MclHashNode *node) {
+    MclSlabCache_Free(&hashNodeCache, node);
+}
+
+MclHashNodeAllocator MclHashNodeAllocator_Slab = {
+    .alloc = MclHashNodeAllocator_AllocSlab,
+    .free = MclHashNodeAllocator_FreeSlab
+};
+
+MclSlabCache* MclHashNodeAllocator_GetSlabCache() {
+    return &hashNodeCache;
+}
@@ -0,0 +1,383 @@
+#include "mcl/mem/slab.h"
+#include "mcl/mem/memory.h"
+#include "mcl/assert.h"
+#include <sys/mman.h>
+
+/* Slab is one page aligned to its size, so the slab of an object is found by masking its address */
+struct MclSlab {
+	MclSlab *prev;
+	MclSlab *next;
+	void *freeObjs;
+	MclSize freeCount;
+	MclSize capacity;
+};
+
+struct MclSlabMagazine {
+	MclSlabMagazine *next;
+	MclSize rounds;
+	void *objs[MCL_SLAB_MAGAZINE_SIZE];
+};
+
+typedef struct {
+	MclSlabCache *cache;
+	MclSlabMagazine *loaded;
+	MclSlabMagazine *previous;
+} MclSlabLocal;
+
+#define MCL_SLAB_HEADER_SIZE MCL_ALIGN_SIZE(sizeof(MclSlab))
+
+///////////////////////////////////////////////////////////
+MCL_PRIVATE MclSlab* MclSlab_OfObj(void *obj) {
+	return (MclSlab*)((uintptr_t)obj & ~(uintptr_t)(MCL_SLAB_SIZE - 1));
+}
+
+MCL_PRIVATE bool MclSlab_IsEmpty(const MclSlab *self) {
+	return self->freeCount == self->capacity;
+}
+
+MCL_PRIVATE void MclSlab_Link(MclSlab *self, MclSlab **list) {
+	self->prev = NULL;
+	self->next = *list;
+	if (*list) (*list)->prev = self;
+	*list = self;
+}
+
+MCL_PRIVATE void MclSlab_Unlink(MclSlab *self, MclSlab **list) {
+	if (self->prev) self->prev->next = self->next;
+	else *list = self->next;
+	if (self->next) self->next->prev = self->prev;
+	self->prev = self->next = NULL;
+}
+
+MCL_PRIVATE void* MclSlab_Take(MclSlab *self) {
+	void *obj = self->freeObjs;
+	self->freeObjs = *(void**)obj;
+	self->freeCount--;
+	return obj;
+}
+
+MCL_PRIVATE void MclSlab_Give(MclSlab *self, void *obj) {
+	*(void**)obj = self->freeObjs;
+	self->freeObjs = obj;
+	self->freeCount++;
+}
+
+///////////////////////////////////////////////////////////
+/* Slab layer and depot below are called with the cache locked */
+MCL_PRIVATE MclSlab* MclSlabCache_MapSlab(MclSlabCache *self) {
+	/* mmap returns page aligned memory, which is the slab alignment as slab is one page */
+	void *page = mmap(NULL, MCL_SLAB_SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	if (page == MAP_FAILED) {
+		MCL_LOG_ERR("Slab cache map slab failed!");
+		return NULL;
+	}
+
+	MclSlab *slab = page;
+	slab->prev = slab->next = NULL;
+	slab->freeObjs = NULL;
+	slab->freeCount = 0;
+	slab->capacity = (MCL_SLAB_SIZE - MCL_SLAB_HEADER_SIZE) / self->objSize;
+
+	uint8_t *objs = (uint8_t*)page + MCL_SLAB_HEADER_SIZE;
+	for (MclSize i = slab->capacity; i > 0; i--) {
+		MclSlab_Give(slab, objs + (i - 1) * self->objSize);
+	}
+	self->slabCount++;
+	return slab;
+}
+
+MCL_PRIVATE void MclSlabCache_UnmapSlab(MclSlabCache *self, MclSlab *slab) {
+	self->slabCount--;
+	(void)munmap(slab, MCL_SLAB_SIZE);
+}
+
+MCL_PRIVATE MclSize MclSlabCache_TakeObjs(MclSlabCache *self, void **objs, MclSize count) {
+	MclSize taken = 0;
+	while (taken < count) {
+		MclSlab *slab = self->partialSlabs;
+		if (!slab && self->emptySlabs) {
+			slab = self->emptySlabs;
+			MclSlab_Unlink(slab, &self->emptySlabs);
+			self->emptySlabCount--;
+			MclSlab_Link(slab, &self->partialSlabs);
+		}
+		if (!slab) {
+			slab = MclSlabCache_MapSlab(self);
+			if (!slab) break;
+			MclSlab_Link(slab, &self->partialSlabs);
+		}
+		while ((taken < count) && slab->freeCount) {
+			objs[taken++] = MclSlab_Take(slab);
+		}
+		/* Full slabs are in no list, they are found again by address when an object is given back */
+		if (!slab->freeCount) {
+			MclSlab_Unlink(slab, &self->partialSlabs);
+		}
+	}
+	return taken;
+}
+
+MCL_PRIVATE void MclSlabCache_GiveObj(MclSlabCache *self, void *obj) {
+	MclSlab *slab = MclSlab_OfObj(obj);
+	if (!slab->freeCount) {
+		MclSlab_Link(slab, &self->partialSlabs);
+	}
+	MclSlab_Give(slab, obj);
+	if (!MclSlab_IsEmpty(slab)) return;
+
+	MclSlab_Unlink(slab, &self->partialSlabs);
+	if (self->emptySlabCount < MCL_SLAB_EMPTY_SLAB_MAX) {
+		MclSlab_Link(slab, &self->emptySlabs);
+		self->emptySlabCount++;
+	} else {
+		MclSlabCache_UnmapSlab(self, slab);
+	}
+}
+
+MCL_PRIVATE void MclSlabCache_DrainMagazine(MclSlabCache *self, MclSlabMagazine *magazine) {
+	while (magazine->rounds) {
+		MclSlabCache_GiveObj(self, magazine->objs[--magazine->rounds]);
+	}
+}
+
+MCL_PRIVATE void MclSlabCache_PushMagazine(MclSlabMagazine **list, MclSlabMagazine *magazine) {
+	magazine->next = *list;
+	*list = magazine;
+}
+
+MCL_PRIVATE MclSlabMagazine* MclSlabCache_PopMagazine(MclSlabMagazine **list) {
+	MclSlabMagazine *magazine = *list;
+	if (magazine) *list = magazine->next;
+	return magazine;
+}
+
+///////////////////////////////////////////////////////////
+MCL_PRIVATE MclSlabMagazine* MclSlabMagazine_Create() {
+	MclSlabMagazine *self = MCL_MALLOC(sizeof(MclSlabMagazine));
+	MCL_ASSERT_VALID_PTR_NIL(self);
+
+	self->next = NULL;
+	self->rounds = 0;
+	return self;
+}
+
+MCL_PRIVATE void MclSlabLocal_Delete(void *arg) {
+	MclSlabLocal *self = arg;
+	MclSlabCache *cache = self->cache;
+
+	MCL_LOCK_SCOPE(cache->lock) {
+		MclSlabCache_DrainMagazine(cache, self->loaded);
+		MclSlabCache_DrainMagazine(cache, self->previous);
+		MclSlabCache_PushMagazine(&cache->emptyMagazines, self->loaded);
+		MclSlabCache_PushMagazine(&cache->emptyMagazines, self->previous);
+	}
+	MCL_FREE(self);
+}
+
+MCL_PRIVATE MclSlabLocal* MclSlabLocal_Create(MclSlabCache *cache) {
+	MclSlabLocal *self = MCL_MALLOC(sizeof(MclSlabLocal));
+	MCL_ASSERT_VALID_PTR_NIL(self);
+
+	self->cache = cache;
+	MCL_LOCK_SCOPE(cache->lock) {
+		self->loaded = MclSlabCache_PopMagazine(&cache->emptyMagazines);
+		self->previous = MclSlabCache_PopMagazine(&cache->emptyMagazines);
+	}
+	if (!self->loaded) self->loaded = MclSlabMagazine_Create();
+	if (!self->previous) self->previous = MclSlabMagazine_Create();
+
+	if (!self->loaded || !self->previous) {
+		if (self->loaded) MCL_FREE(self->loaded);
+		if (self->previous) MCL_FREE(self->previous);
+		MCL_FREE(self);
+		return NULL;
+	}
+	return self;
+}
+
+MCL_PRIVATE bool MclSlabCache_IsValid(const MclSlabCache *self) {
+	return (self->objSize >= sizeof(void*)) && (self->objSize <= MCL_SLAB_OBJ_SIZE_MAX);
+}
+
+MCL_PRIVATE MclStatus MclSlabCache_CreateKey(MclSlabCache *self) {
+	if (__atomic_load_n(&self->isKeyCreated, __ATOMIC_ACQUIRE)) return MCL_SUCCESS;
+
+	MCL_LOCK_AUTO(self->lock);
+	if (self->isKeyCreated) return MCL_SUCCESS;
+
+	if (!MclSlabCache_IsValid(self)) {
+		MCL_LOG_ERR("Slab cache refuses object size %u!", self->objSize);
+		return MCL_FAILURE;
+	}
+	if (pthread_key_create(&self->localKey, MclSlabLocal_Delete)) {
+		MCL_LOG_ERR("Slab cache create local key failed!");
+		return MCL_FAILURE;
+	}
+	__atomic_store_n(&self->isKeyCreated, true, __ATOMIC_RELEASE);
+	return MCL_SUCCESS;
+}
+
+MCL_PRIVATE MclSlabLocal* MclSlabCache_GetLocal(MclSlabCache *self) {
+	MCL_ASSERT_SUCC_CALL_NIL(MclSlabCache_CreateKey(self));
+
+	MclSlabLocal *local = pthread_getspecific(self->localKey);
+	if (local) return local;
+
+	local = MclSlabLocal_Create(self);
+	MCL_ASSERT_VALID_PTR_NIL(local);
+
+	if (pthread_setspecific(self->localKey, local)) {
+		MclSlabLocal_Delete(local);
+		return NULL;
+	}
+	return local;
+}
+
+MCL_PRIVATE void MclSlabLocal_Swap(MclSlabLocal *self) {
+	MclSlabMagazine *magazine = self->loaded;
+	self->loaded = self->previous;
+	self->previous = magazine;
+}
+
+/* Both magazines are empty: exchange the previous with a full one of depot, or refill from slabs */
+MCL_PRIVATE void* MclSlabCache_AllocSlow(MclSlabCache *self, MclSlabLocal *local) {
+	MCL_LOCK_SCOPE(self->lock) {
+		MclSlabMagazine *full = MclSlabCache_PopMagazine(&self->fullMagazines);
+		if (full) {
+			self->fullMagazineCount--;
+			MclSlabCache_PushMagazine(&self->emptyMagazines, local->previous);
+			local->previous = local->loaded;
+			local->loaded = full;
+		} else {
+			local->loaded->rounds = MclSlabCache_TakeObjs(self, local->loaded->objs, MCL_SLAB_MAGAZINE_SIZE);
+		}
+	}
+	return local->loaded->rounds ? local->loaded->objs[--local->loaded->rounds] : NULL;
+}
+
+/* Both magazines are full: exchange the previous with an empty one of depot, or drain it if depot is full */
+MCL_PRIVATE void MclSlabCache_FreeSlow(MclSlabCache *self, MclSlabLocal *local, void *obj) {
+	MclSlabMagazine *empty = NULL;
+
+	MCL_LOCK_SCOPE(self->lock) {
+		if (self->fullMagazineCount >= MCL_SLAB_DEPOT_FULL_MAX) {
+			MclSlabCache_DrainMagazine(self, local->previous);
+			empty = local->previous;
+			break;
+		}
+		empty = MclSlabCache_PopMagazine(&self->emptyMagazines);
+		if (empty) {
+			MclSlabCache_PushMagazine(&self->fullMagazines, local->previous);
+			self->fullMagazineCount++;
+		}
+	}
+
+	if (!empty) {
+		/* Depot has room but no empty magazine, so one more magazine joins */
+		MclSlabMagazine *magazine = MclSlabMagazine_Create();
+		MCL_LOCK_SCOPE(self->lock) {
+			if (magazine) {
+				MclSlabCache_PushMagazine(&self->fullMagazines, local->previous);
+				self->fullMagazineCount++;
+				empty = magazine;
+			} else {
+				MclSlabCache_DrainMagazine(self, local->previous);
+				empty = local->previous;
+			}
+		}
+	}
+
+	local->previous = local->loaded;
+	local->loaded = empty;
+	local->loaded->objs[local->loaded->rounds++] = obj;
+}
+
+///////////////////////////////////////////////////////////
+void* MclSlabCache_Alloc(MclSlabCache *self) {
+	MCL_ASSERT_VALID_PTR_NIL(self);
+
+	MclSlabLocal *local = MclSlabCache_GetLocal(self);
+	MCL_ASSERT_VALID_PTR_NIL(local);
+
+	if (!local->loaded->rounds && local->previous->rounds) {
+		MclSlabLocal_Swap(local);
+	}
+	if (local->loaded->rounds) {
+		return local->loaded->objs[--local->loaded->rounds];
+	}
+	return MclSlabCache_AllocSlow(self, local);
+}
+
+void MclSlabCache_Free(MclSlabCache *self, void *obj) {
+	MCL_ASSERT_VALID_PTR_VOID(self);
+	if (!obj) return;
+
+	MclSlabLocal *local = MclSlabCache_GetLocal(self);
+	if (!local) {
+		MCL_LOCK_AUTO(self->lock);
+		MclSlabCache_GiveObj(self, obj);
+		return;
+	}
+
+	if ((local->loaded->rounds == MCL_SLAB_MAGAZINE_SIZE) && (local->previous->rounds < MCL_SLAB_MAGAZINE_SIZE)) {
+		MclSlabLocal_Swap(local);
+	}
+	if (local->loaded->rounds < MCL_SLAB_MAGAZINE_SIZE) {
+		local->loaded->objs[local->loaded->rounds++] = obj;
+		return;
+	}
+	MclSlabCache_FreeSlow(self, local, obj);
+}
+
+void MclSlabCache_FlushLocal(MclSlabCache *self) {
+	MCL_ASSERT_VALID_PTR_VOID(self);
+	if (!__atomic_load_n(&self->isKeyCreated, __ATOMIC_ACQUIRE)) return;
+
+	MclSlabLocal *local = pthread_getspecific(self->localKey);
+	if (!local) return;
+
+	MCL_LOCK_AUTO(self->lock);
+	MclSlabCache_DrainMagazine(self, local->loaded);
+	MclSlabCache_DrainMagazine(self, local->previous);
+}
+
+MclSize MclSlabCache_Reclaim(MclSlabCache *self) {
+	MCL_ASSERT_VALID_PTR_R(self, 0);
+
+	MclSlabMagazine *magazines = NULL;
+	MclSize slabCount = 0;
+
+	MCL_LOCK_SCOPE(self->lock) {
+		slabCount = self->slabCount;
+
+		MclSlabMagazine *magazine = NULL;
+		while ((magazine = MclSlabCache_PopMagazine(&self->fullMagazines))) {
+			MclSlabCache_DrainMagazine(self, magazine);
+			MclSlabCache_PushMagazine(&magazines, magazine);
+		}
+		self->fullMagazineCount = 0;
+		while ((magazine = MclSlabCache_PopMagazine(&self->emptyMagazines))) {
+			MclSlabCache_PushMagazine(&magazines, magazine);
+		}
+		while (self->emptySlabs) {
+			MclSlab *slab = self->emptySlabs;
+			MclSlab_Unlink(slab, &self->emptySlabs);
+			MclSlabCache_UnmapSlab(self, slab);
+		}
+		self->emptySlabCount = 0;
+		slabCount -= self->slabCount;
+	}
+
+	MclSlabMagazine *magazine = NULL;
+	while ((magazine = MclSlabCache_PopMagazine(&magazines))) {
+		MCL_FREE(magazine);
+	}
+	return slabCount;
+}
+
+MclSize MclSlabCache_GetSlabCount(MclSlabCache *self) {
+	MCL_ASSERT_VALID_PTR_R(self, 0);
+
+	MCL_LOCK_AUTO(self->lock);
+	return self->slabCount;
+}
@@ -0,0 +1,124 @@
+#include "mcl/msg/msg_pool.h"
+#include "mcl/ringbuff/mpmc_queue.h"
+#include "mcl/mem/memory.h"
+#include "mcl/algo/bit.h"
+#include "mcl/assert.h"
+
+MCL_TYPE(MclMsgPool) {
+    MclMpmcQueue freeBodies[MCL_MSG_POOL_CLASS_NUM];
+    uint8_t *bodies[MCL_MSG_POOL_CLASS_NUM];
+    MclSize bodyCount;
+};
+
+MCL_PRIVATE const MclSize MCL_MSG_POOL_CLASS_SIZES[MCL_MSG_POOL_CLASS_NUM] = {64, 256, 1024, MCL_MSG_POOL_BODY_SIZE_MAX};
+
+MCL_PRIVATE MclSize MclMsgPool_GetClassIndex(MclSize bodySize) {
+    for (MclSize i = 0; i < MCL_MSG_POOL_CLASS_NUM; i++) {
+        if (bodySize <= MCL_MSG_POOL_CLASS_SIZES[i]) return i;
+    }
+    return MCL_MSG_POOL_CLASS_NUM;
+}
+
+MCL_PRIVATE MclSize MclMsgPool_GetOwnerClass(const MclMsgPool *self, const uint8_t *body) {
+    for (MclSize i = 0; i < MCL_MSG_POOL_CLASS_NUM; i++) {
+        MclSize classBytes = self->bodyCount * MCL_MSG_POOL_CLASS_SIZES[i];
+        if ((body >= self->bodies[i]) && (body < self->bodies[i] + classBytes)
+            && ((MclSize)(body - self->bodies[i]) % MCL_MSG_POOL_CLASS_SIZES[i] == 0)) {
+            return i;
+        }
+    }
+    return MCL_MSG_POOL_CLASS_NUM;
+}
+
+MCL_PRIVATE void MclMsgPool_Destroy(MclMsgPool *self) {
+    for (MclSize i = 0; i < MCL_MSG_POOL_CLASS_NUM; i++) {
+        void *cells = MclMpmcQueue_GetBuff(&self->freeBodies[i]);
+        if (cells) MCL_FREE(cells);
+        if (self->bodies[i]) MCL_FREE(self->bodies[i]);
+    }
+}
+
+MCL_PRIVATE MclStatus MclMsgPool_InitClass(MclMsgPool *self, MclSize classIndex) {
+    MclSize bodySize = MCL_MSG_POOL_CLASS_SIZES[classIndex];
+
+    uint8_t *cells = MCL_MALLOC(MclMpmcQueue_GetBuffSize(self->bodyCount, sizeof(void*)));
+    MCL_ASSERT_VALID_PTR(cells);
+    if (MCL_FAILED(MclMpmcQueue_Init(&self->freeBodies[classIndex], self->bodyCount, sizeof(void*), cells))) {
+        MCL_FREE(cells);
+        return MCL_FAILURE;
+    }
+
+    self->bodies[classIndex] = MCL_MALLOC(self->bodyCount * bodySize);
+    MCL_ASSERT_VALID_PTR(self->bodies[classIndex]);
+
+    for (MclSize i = 0; i < self->bodyCount; i++) {
+        void *body = self->bodies[classIndex] + i * bodySize;
+        MCL_ASSERT_SUCC_CALL(MclMpmcQueue_Put(&self->freeBodies[classIndex], &body));
+    }
+    return MCL_SUCCESS;
+}
+
+MclMsgPool* MclMsgPool_Create(MclSize bodyCount) {
+    MCL_ASSERT_TRUE_NIL(bodyCount > 1);
+    MCL_ASSERT_TRUE_NIL(MCL_BIT_IS_POWER_OF_2(bodyCount));
+
+    MclMsgPool *self = MCL_MALLOC(sizeof(MclMsgPool));
+    MCL_ASSERT_VALID_PTR_NIL(self);
+
+    MCL_MEM_CLEAR(self, sizeof(MclMsgPool));
+    self->bodyCount = bodyCount;
+
+    for (MclSize i = 0; i < MCL_MSG_POOL_CLASS_NUM; i++) {
+        if (MCL_FAILED(MclMsgPool_InitClass(self, i))) {
+            MCL_LOG_ERR("Init class %u of msg pool failed!", i);
+            MclMsgPool_Destroy(self);
+            MCL_FREE(self);
+            return NULL;
+        }
+    }
+    return self;
+}
+
+void MclMsgPool_Delete(MclMsgPool *self) {
+    MCL_ASSERT_VALID_PTR_VOID(self);
+
+    MclMsgPool_Destroy(self);
+    MCL_FREE(self);
+}
+
+MclStatus MclMsgPool_Alloc(MclMsgPool *self, MclMsg *msg, MclMsgType type, MclMsgId id, MclSize bodySize) {
+    MCL_ASSERT_VALID_PTR(self);
+    MCL_ASSERT_VALID_PTR(msg);
+    MCL_ASSERT_TRUE(bodySize > 0);
+
+    for (MclSize i = MclMsgPool_GetClassIndex(bodySize); i < MCL_MSG_POOL_CLASS_NUM; i++) {
+        void *body = NULL;
+        if (!MCL_FAILED(MclMpmcQueue_Pop(&self->freeBodies[i], &body))) {
+            return MclMsg_Init(msg, type, id, bodySize, body);
+        }
+    }
+    return MCL_FAILURE;
+}
+
+MclStatus MclMsgPool_Free(MclMsgPool *self, MclMsg *msg) {
+    MCL_ASSERT_VALID_PTR(self);
+    MCL_ASSERT_VALID_PTR(msg);
+    MCL_ASSERT_VALID_PTR(msg->body);
+
+    MclSize classIndex = MclMsgPool_GetOwnerClass(self, msg->body);
+    MCL_ASSERT_TRUE(classIndex < MCL_MSG_POOL_CLASS_NUM);
+
+    MCL_ASSERT_SUCC_CALL(MclMpmcQueue_Put(&self->freeBodies[classIndex], &msg->body));
+    msg->body = NULL;
+    msg->bodyBytes = 0;
+    return MCL_SUCCESS;
+}
+
+MclSize MclMsgPool_GetFreeCount(const MclMsgPool *self, MclSize bodySize) {
+    MCL_ASSERT_VALID_PTR_NIL(self);
+
+    MclSize classIndex = MclMsgPool_GetClassIndex(bodySize);
+    MCL_ASSERT_TRUE_NIL(classIndex < MCL_MSG_POOL_CLASS_NUM);
+
+    return MclMpmcQueue_GetCount(&self->freeBodies[classIndex]);
+}
@@ -1,5 +1,119 @@
 #include "mcl/msg/msg_queue.h"
 #include "mcl/mem/memory.h"
+#include "mcl/thread/thread.h"
+
+#define MCL_MSG_QUEUE_SPIN_COUNT 16
+
+typedef struct MclMsgQueueWaiter {
+    struct MclMsgQueueWaiter *next;
+    MclMsgQueueReady ready;
+    void *ctxt;
+} MclMsgQueueWaiter;
+
+MCL_PRIVATE void MclMsgQueue_InitWaiters(MclMsgQueue *self) {
+    self->waiters = NULL;
+    MclAtomic_Clear(&self->waiterCount);
+}
+
+/* Full barrier as event count: the sent msg is visible before waiterCount is checked */
+MCL_PRIVATE void MclMsgQueue_NotifyReady(MclMsgQueue *self) {
+    MCL_ATOMIC_SYNC();
+    if (MclAtomic_LoadRelaxed(&self->waiterCount) == 0) return;
+
+    MclMsgQueueWaiter *waiters = NULL;
+    {
+        MCL_LOCK_AUTO(self->mutex);
+        waiters = self->waiters;
+        MclMsgQueue_InitWaiters(self);
+    }
+    while (waiters) {
+        MclMsgQueueWaiter *next = waiters->next;
+        waiters->ready(waiters->ctxt);
+        MCL_FREE(waiters);
+        waiters = next;
+    }
+}
+
+MCL_PRIVATE MclStatus MclMsgQueue_TrySend(MclMsgQueue *self, MclMsg *msg) {
+    if (self->isLockFree) return MclMpmcQueue_Put(&self->lockFreeQueue, msg);
+
+    MCL_LOCK_AUTO(self->mutex);
+    return MclRingBuff_Put(&self->ringbuff, msg);
+}
+
+MCL_PRIVATE MclStatus MclMsgQueue_TryRecv(MclMsgQueue *self, MclMsg *result, bool isOwned) {
+    MclMsg msg;
+    MclMsg *popped = isOwned ? result : &msg;
+    if (self->isLockFree) {
+        if (MCL_FAILED(MclMpmcQueue_Pop(&self->lockFreeQueue, popped))) {
+            return MCL_FAILURE;
+        }
+        if (!isOwned) MCL_ASSERT_SUCC_CALL(MclMsg_Copy(&msg, result));
+        return MCL_SUCCESS;
+    }
+
+    MCL_LOCK_AUTO(self->mutex);
+
+    if (MCL_FAILED(MclRingBuff_Pop(&self->ringbuff, popped))) {
+        return MCL_FAILURE;
+    }
+    if (!isOwned) MCL_ASSERT_SUCC_CALL(MclMsg_Copy(&msg, result));
+    return MCL_SUCCESS;
+}
+
+MCL_PRIVATE MclSize MclMsgQueue_TrySendBatch(MclMsgQueue *self, const MclMsg *msgs, MclSize count) {
+    if (self->isLockFree) {
+        MclSize sentCount = 0;
+        while ((sentCount < count) && !MCL_FAILED(MclMpmcQueue_Put(&self->lockFreeQueue, &msgs[sentCount]))) {
+            sentCount++;
+        }
+        return sentCount;
+    }
+
+    MCL_LOCK_AUTO(self->mutex);
+    return MclRingBuff_PutN(&self->ringbuff, msgs, count);
+}
+
+MCL_PRIVATE MclSize MclMsgQueue_TryRecvBatch(MclMsgQueue *self, MclMsg *results, MclSize count) {
+    MclSize recvCount = 0;
+    MclMsg msg;
+    if (self->isLockFree) {
+        while ((recvCount < count) && !MCL_FAILED(MclMpmcQueue_Pop(&self->lockFreeQueue, &msg))) {
+            if (MCL_FAILED(MclMsg_Copy(&msg, &results[recvCount]))) break;
+            recvCount++;
+        }
+        return recvCount;
+    }
+
+    MCL_LOCK_AUTO(self->mutex);
+    while ((recvCount < count) && !MCL_FAILED(MclRingBuff_Pop(&self->ringbuff, &msg))) {
+        if (MCL_FAILED(MclMsg_Copy(&msg, &results[recvCount]))) break;
+        recvCount++;
+    }
+    return recvCount;
+}
+
+typedef MclStatus (*MclMsgQueueTryCall)(MclMsgQueue*, MclMsg*);
+
+MCL_PRIVATE MclStatus MclMsgQueue_WaitFor(MclMsgQueue *self, MclMsg *msg, MclTimeUs timeoutUs,
+                                          MclMsgQueueTryCall tryCall, MclEventCount *event) {
+    for (MclSize i = 0; i < MCL_MSG_QUEUE_SPIN_COUNT; i++) {
+        if (!MCL_FAILED(tryCall(self, msg))) return MCL_SUCCESS;
+        MclThread_Yield();
+    }
+
+    MclTimeUs deadline = MclEventCount_GetDeadline(timeoutUs);
+    while (true) {
+        MclSize key = MclEventCount_PrepareWait(event);
+        if (!MCL_FAILED(tryCall(self, msg))) {
+            MclEventCount_CancelWait(event);
+            return MCL_SUCCESS;
+        }
+        if (MclEventCount_WaitUntil(event, key, deadline) == MCL_TIMEDOUT) {
+            return tryCall(self, msg) == MCL_SUCCESS ? MCL_SUCCESS : MCL_TIMEDOUT;
+        }
+    }
+}
 
 MclMsgQueue* MclMsgQueue_Create(MclSize capacity) {
     MCL_ASSERT_TRUE_NIL(capacity > 0);
@@ -24,12 +138,34 @@ MclMsgQueue* MclMsgQueue_Create(MclSize capacity) {
     return self;
 }
 
+MclMsgQueue* MclMsgQueue_CreateLockFree(MclSize capacity) {
+    MCL_ASSERT_TRUE_NIL(capacity > 1);
+
+    MclMsgQueue *self = MCL_MALLOC(sizeof(MclMsgQueue));
+    MCL_ASSERT_VALID_PTR_NIL(self);
+
+    uint8_t *cellBuff = MCL_MALLOC(MclMpmcQueue_GetBuffSize(capacity, sizeof(MclMsg)));
+    if (!cellBuff) {
+        MCL_LOG_ERR("malloc memory of msg cell buff failed!");
+        MCL_FREE(self);
+        return NULL;
+    }
+
+    if (MCL_FAILED(MclMsgQueue_InitLockFree(self, capacity, cellBuff))) {
+        MCL_LOG_ERR("Init lock free msg queue failed!");
+        MCL_FREE(cellBuff);
+        MCL_FREE(self);
+        return NULL;
+    }
+    return self;
+}
+
 void MclMsgQueue_Delete(MclMsgQueue *self) {
     MCL_ASSERT_VALID_PTR_VOID(self);
 
     MclMsgQueue_Destroy(self);
 
-    void *buff = MclRingBuff_GetBuff(&self->ringbuff);
+    void *buff = self->isLockFree ? MclMpmcQueue_GetBuff(&self->lockFreeQueue) : MclRingBuff_GetBuff(&self->ringbuff);
     if (buff) MCL_FREE(buff);
     MCL_FREE(self);
 }
@@ -41,36 +177,83 @@ MclStatus MclMsgQueue_Init(MclMsgQueue *self, MclSize capacity, MclMsg* msgBuff)
 
     MCL_ASSERT_SUCC_CALL(MclRingBuff_Init(&self->ringbuff, capacity, sizeof(MclMsg), (uint8_t*)msgBuff));
     MCL_ASSERT_SUCC_CALL(MclMutex_Init(&self->mutex, NULL));
+    MCL_ASSERT_SUCC_CALL(MclEventCount_Init(&self->notEmpty));
+    MCL_ASSERT_SUCC_CALL(MclEventCount_Init(&self->notFull));
+    MclMsgQueue_InitWaiters(self);
+    self->isLockFree = false;
+
+    return MCL_SUCCESS;
+}
+
+MclStatus MclMsgQueue_InitLockFree(MclMsgQueue *self, MclSize capacity, uint8_t* cellBuff) {
+    MCL_ASSERT_VALID_PTR(self);
+    MCL_ASSERT_VALID_PTR(cellBuff);
+    MCL_ASSERT_TRUE(capacity > 1);
+
+    MCL_ASSERT_SUCC_CALL(MclMpmcQueue_Init(&self->lockFreeQueue, capacity, sizeof(MclMsg), cellBuff));
+    MCL_ASSERT_SUCC_CALL(MclMutex_Init(&self->mutex, NULL));
+    MCL_ASSERT_SUCC_CALL(MclEventCount_Init(&self->notEmpty));
+    MCL_ASSERT_SUCC_CALL(MclEventCount_Init(&self->notFull));
+    MclMsgQueue_InitWaiters(self);
+    self->isLockFree = true;
 
     return MCL_SUCCESS;
 }
 
 void MclMsgQueue_Destroy(MclMsgQueue *self) {
 	MCL_ASSERT_VALID_PTR_VOID(self);
+	while (self->waiters) {
+		MclMsgQueueWaiter *waiter = self->waiters;
+		self->waiters = waiter->next;
+		MCL_FREE(waiter);
+	}
+	MclAtomic_Clear(&self->waiterCount);
 	MCL_ASSERT_SUCC_CALL_VOID(MclMutex_Destroy(&self->mutex));
-	MclRingBuff_Reset(&self->ringbuff);
+	MclEventCount_Destroy(&self->notEmpty);
+	MclEventCount_Destroy(&self->notFull);
+	if (self->isLockFree) {
+		MclMpmcQueue_Reset(&self->lockFreeQueue);
+	} else {
+		MclRingBuff_Reset(&self->ringbuff);
+	}
 }
 
 void MclMsgQueue_Clear(MclMsgQueue *self) {
     MCL_ASSERT_VALID_PTR_VOID(self);
-    MCL_LOCK_AUTO(self->mutex);
-    MclRingBuff_Reset(&self->ringbuff);
+
+    if (self->isLockFree) {
+        MclMsg msg;
+        while (!MCL_FAILED(MclMpmcQueue_Pop(&self->lockFreeQueue, &msg)));
+    } else {
+        MCL_LOCK_AUTO(self->mutex);
+        MclRingBuff_Reset(&self->ringbuff);
+    }
+    MclEventCount_NotifyAll(&self->notFull);
 }
 
 bool MclMsgQueue_IsFull(const MclMsgQueue *self) {
     MCL_ASSERT_VALID_PTR_R(self, true);
+
+    if (self->isLockFree) return MclMpmcQueue_IsFull(&self->lockFreeQueue);
+
     MCL_LOCK_AUTO(self->mutex);
     return MclRingBuff_IsFull(&self->ringbuff);
 }
 
 bool MclMsgQueue_IsEmpty(const MclMsgQueue *self) {
     MCL_ASSERT_VALID_PTR_R(self, true);
+
+    if (self->isLockFree) return MclMpmcQueue_IsEmpty(&self->lockFreeQueue);
+
     MCL_LOCK_AUTO(self->mutex);
     return MclRingBuff_IsEmpty(&self->ringbuff);
 }
 
 MclSize MclMsgQueue_GetCount(const MclMsgQueue *self) {
     MCL_ASSERT_VALID_PTR_NIL(self);
+
+    if (self->isLockFree) return MclMpmcQueue_GetCount(&self->lockFreeQueue);
+
     MCL_LOCK_AUTO(self->mutex);
     return MclRingBuff_GetCount(&self->ringbuff);
 }
@@ -79,20 +262,109 @@ MclStatus MclMsgQueue_Send(MclMsgQueue *self, MclMsg *msg) {
     MCL_ASSERT_VALID_PTR(self);
     MCL_ASSERT_VALID_PTR(msg);
 
-    MCL_LOCK_AUTO(self->mutex);
-    return MclRingBuff_Put(&self->ringbuff, msg);
+    if (MCL_FAILED(MclMsgQueue_TrySend(self, msg))) return MCL_FAILURE;
+    MclEventCount_Notify(&self->notEmpty);
+    MclMsgQueue_NotifyReady(self);
+    return MCL_SUCCESS;
 }
 
 MclStatus MclMsgQueue_Recv(MclMsgQueue *self, MclMsg *result) {
     MCL_ASSERT_VALID_PTR(self);
     MCL_ASSERT_VALID_PTR(result);
 
-    MCL_LOCK_AUTO(self->mutex);
+    if (MCL_FAILED(MclMsgQueue_TryRecv(self, result, false))) return MCL_FAILURE;
+    MclEventCount_Notify(&self->notFull);
+    return MCL_SUCCESS;
+}
 
-    MclMsg msg;
-    if (MCL_FAILED(MclRingBuff_Pop(&self->ringbuff, &msg))) {
-        return MCL_FAILURE;
+MclStatus MclMsgQueue_RecvOwned(MclMsgQueue *self, MclMsg *result) {
+    MCL_ASSERT_VALID_PTR(self);
+    MCL_ASSERT_VALID_PTR(result);
+
+    if (MCL_FAILED(MclMsgQueue_TryRecv(self, result, true))) return MCL_FAILURE;
+    MclEventCount_Notify(&self->notFull);
+    return MCL_SUCCESS;
+}
+
+MclSize MclMsgQueue_SendBatch(MclMsgQueue *self, const MclMsg *msgs, MclSize count) {
+    MCL_ASSERT_VALID_PTR_NIL(self);
+    MCL_ASSERT_VALID_PTR_NIL(msgs);
+
+    MclSize sentCount = MclMsgQueue_TrySendBatch(self, msgs, count);
+    if (sentCount > 0) {
+        MclEventCount_NotifyAll(&self->notEmpty);
+        MclMsgQueue_NotifyReady(self);
+    }
+    return sentCount;
+}
+
+MclSize MclMsgQueue_RecvBatch(MclMsgQueue *self, MclMsg *results, MclSize count) {
+    MCL_ASSERT_VALID_PTR_NIL(self);
+    MCL_ASSERT_VALID_PTR_NIL(results);
+
+    MclSize recvCount = MclMsgQueue_TryRecvBatch(self, results, count);
+    if (recvCount > 0) MclEventCount_NotifyAll(&self->notFull);
+    return recvCount;
+}
+
+MclStatus MclMsgQueue_SendWait(MclMsgQueue *self, MclMsg *msg, MclTimeUs timeoutUs) {
+    MCL_ASSERT_VALID_PTR(self);
+    MCL_ASSERT_VALID_PTR(msg);
+
+    return MclMsgQueue_WaitFor(self, msg, timeoutUs, MclMsgQueue_Send, &self->notFull);
+}
+
+MclStatus MclMsgQueue_RecvWait(MclMsgQueue *self, MclMsg *result, MclTimeUs timeoutUs) {
+    MCL_ASSERT_VALID_PTR(self);
+    MCL_ASSERT_VALID_PTR(result);
+
+    return MclMsgQueue_WaitFor(self, result, timeoutUs, MclMsgQueue_Recv, &self->notEmpty);
+}
+
+MclStatus MclMsgQueue_RecvOwnedWait(MclMsgQueue *self, MclMsg *result, MclTimeUs timeoutUs) {
+    MCL_ASSERT_VALID_PTR(self);
+    MCL_ASSERT_VALID_PTR(result);
+
+    return MclMsgQueue_WaitFor(self, result, timeoutUs, MclMsgQueue_RecvOwned, &self->notEmpty);
+}
+
+MclStatus MclMsgQueue_OnReady(MclMsgQueue *self, MclMsgQueueReady ready, void *ctxt) {
+    MCL_ASSERT_VALID_PTR(self);
+    MCL_ASSERT_VALID_PTR(ready);
+
+    MclMsgQueueWaiter *waiter = MCL_MALLOC(sizeof(MclMsgQueueWaiter));
+    MCL_ASSERT_VALID_PTR(waiter);
+    waiter->ready = ready;
+    waiter->ctxt = ctxt;
+    {
+        MCL_LOCK_AUTO(self->mutex);
+        waiter->next = self->waiters;
+        self->waiters = waiter;
+        MclAtomic_AddFetch(&self->waiterCount, 1);
+    }
+    /* pairs with the barrier of sender: either it sees the waiter or the msg is seen here */
+    MCL_ATOMIC_SYNC();
+    if (!MclMsgQueue_IsEmpty(self)) MclMsgQueue_NotifyReady(self);
+    return MCL_SUCCESS;
+}
+
+MclStatus MclMsgQueue_CancelOnReady(MclMsgQueue *self, MclMsgQueueReady ready, void *ctxt) {
+    MCL_ASSERT_VALID_PTR(self);
+    MCL_ASSERT_VALID_PTR(ready);
+
+    MclMsgQueueWaiter *waiter = NULL;
+    {
+        MCL_LOCK_AUTO(self->mutex);
+        MclMsgQueueWaiter **prev = &self->waiters;
+        while (*prev && (((*prev)->ready != ready) || ((*prev)->ctxt != ctxt))) {
+            prev = &(*prev)->next;
+        }
+        waiter = *prev;
+        if (!waiter) return MCL_FAILURE;
+
+        *prev = waiter->next;
+        MclAtomic_SubFetch(&self->waiterCount, 1);
     }
-    MCL_ASSERT_SUCC_CALL(MclMsg_Copy(&msg, result));
+    MCL_FREE(waiter);
     return MCL_SUCCESS;
 }
@@ -0,0 +1,145 @@
+#include "mcl/ringbuff/mpmc_queue.h"
+#include "mcl/mem/memory.h"
+#include "mcl/algo/bit.h"
+#include "mcl/assert.h"
+
+/* The lap of a cell is stored relative to its index, so for position pos:
+ * lap == base(pos)     : cell is free for the put of pos;
+ * lap == base(pos) + 1 : cell is filled for the pop of pos;
+ * after pop the lap moves to base(pos) + capacity, the base of next round. */
+MCL_PRIVATE MclSize MclMpmcQueue_GetBase(const MclMpmcQueue *self, MclSize pos) {
+    return pos & ~self->mask;
+}
+
+MCL_PRIVATE MclAtomic* MclMpmcQueue_GetLap(MclMpmcQueue *self, MclSize pos) {
+    return (MclAtomic*)(MclArray_Begin(&self->cells) + (pos & self->mask) * MclArray_GetElemSize(&self->cells));
+}
+
+MCL_PRIVATE void* MclMpmcQueue_GetElem(MclAtomic *lap) {
+    return (uint8_t*)lap + MclAlign_GetSizeOf(sizeof(MclAtomic));
+}
+
+MCL_PRIVATE int32_t MclMpmcQueue_GetDiff(MclSize lap, MclSize expected) {
+    return (int32_t)(lap - expected);
+}
+
+MclMpmcQueue* MclMpmcQueue_Create(MclSize capacity, MclSize elemBytes) {
+    MCL_ASSERT_TRUE_NIL(capacity > 1);
+    MCL_ASSERT_TRUE_NIL(elemBytes > 0);
+
+    MclMpmcQueue *self = MCL_MALLOC(sizeof(MclMpmcQueue));
+    MCL_ASSERT_VALID_PTR_NIL(self);
+
+    uint8_t *buff = MCL_MALLOC(MclMpmcQueue_GetBuffSize(capacity, elemBytes));
+    if (!buff) {
+        MCL_LOG_ERR("Malloc cells for mpmc queue failed!");
+        MCL_FREE(self);
+        return NULL;
+    }
+
+    if (MCL_FAILED(MclMpmcQueue_Init(self, capacity, elemBytes, buff))) {
+        MCL_LOG_ERR("Init mpmc queue failed!");
+        MCL_FREE(buff);
+        MCL_FREE(self);
+        return NULL;
+    }
+    return self;
+}
+
+void MclMpmcQueue_Delete(MclMpmcQueue *self) {
+    MCL_ASSERT_VALID_PTR_VOID(self);
+
+    void *buff = MclArray_Begin(&self->cells);
+    if (buff) {
+        MCL_FREE(buff);
+    }
+    MCL_FREE(self);
+}
+
+MclStatus MclMpmcQueue_Init(MclMpmcQueue *self, MclSize capacity, MclSize elemBytes, uint8_t* buff) {
+    MCL_ASSERT_VALID_PTR(self);
+    MCL_ASSERT_VALID_PTR(buff);
+    MCL_ASSERT_TRUE(capacity > 1);
+    MCL_ASSERT_TRUE(MCL_BIT_IS_POWER_OF_2(capacity));
+    MCL_ASSERT_TRUE(elemBytes > 0);
+
+    MCL_ASSERT_SUCC_CALL(MclArray_Init(&self->cells, capacity, MCL_MPMC_QUEUE_CELL_SIZE(elemBytes), buff));
+    self->mask = capacity - 1;
+    self->elemBytes = elemBytes;
+    MclMpmcQueue_Reset(self);
+    return MCL_SUCCESS;
+}
+
+void MclMpmcQueue_Reset(MclMpmcQueue *self) {
+    MCL_ASSERT_VALID_PTR_VOID(self);
+
+    MclArray_Clear(&self->cells);
+    MclAtomic_Clear(&self->putPos);
+    MclAtomic_Clear(&self->popPos);
+}
+
+MclSize MclMpmcQueue_GetCount(const MclMpmcQueue *self) {
+    MCL_ASSERT_VALID_PTR_NIL(self);
+
+    MclSize popPos = MclAtomic_LoadAcquire(&self->popPos);
+    MclSize putPos = MclAtomic_LoadAcquire(&self->putPos);
+    int32_t count = MclMpmcQueue_GetDiff(putPos, popPos);
+    if (count <= 0) return 0;
+
+    MclSize capacity = MclMpmcQueue_GetCapacity(self);
+    return ((MclSize)count > capacity) ? capacity : (MclSize)count;
+}
+
+bool MclMpmcQueue_IsFull(const MclMpmcQueue *self) {
+    MCL_ASSERT_VALID_PTR_R(self, true);
+    return MclMpmcQueue_GetCount(self) >= MclMpmcQueue_GetCapacity(self);
+}
+
+bool MclMpmcQueue_IsEmpty(const MclMpmcQueue *self) {
+    MCL_ASSERT_VALID_PTR_R(self, true);
+    return MclMpmcQueue_GetCount(self) == 0;
+}
+
+MclStatus MclMpmcQueue_Put(MclMpmcQueue *self, const void *value) {
+    MCL_ASSERT_VALID_PTR(self);
+    MCL_ASSERT_VALID_PTR(value);
+
+    MclSize pos = MclAtomic_LoadRelaxed(&self->putPos);
+    while (true) {
+        MclAtomic *lap = MclMpmcQueue_GetLap(self, pos);
+        int32_t diff = MclMpmcQueue_GetDiff(MclAtomic_LoadAcquire(lap), MclMpmcQueue_GetBase(self, pos));
+        if (diff == 0) {
+            if (MclAtomic_CompareExchangeRelaxed(&self->putPos, &pos, pos + 1)) {
+                MCL_MEM_COPY(MclMpmcQueue_GetElem(lap), (void*)value, self->elemBytes);
+                MclAtomic_StoreRelease(lap, MclMpmcQueue_GetBase(self, pos) + 1);
+                return MCL_SUCCESS;
+            }
+        } else if (diff < 0) {
+            return MCL_FAILURE;
+        } else {
+            pos = MclAtomic_LoadRelaxed(&self->putPos);
+        }
+    }
+}
+
+MclStatus MclMpmcQueue_Pop(MclMpmcQueue *self, void *value) {
+    MCL_ASSERT_VALID_PTR(self);
+    MCL_ASSERT_VALID_PTR(value);
+
+    MclSize pos = MclAtomic_LoadRelaxed(&self->popPos);
+    while (true) {
+        MclAtomic *lap = MclMpmcQueue_GetLap(self, pos);
+        int32_t diff = MclMpmcQueue_GetDiff(MclAtomic_LoadAcquire(lap), MclMpmcQueue_GetBase(self, pos) + 1);
+        if (diff == 0) {
+            if (MclAtomic_CompareExchangeRelaxed(&self->popPos, &pos, pos + 1)) {
+                MCL_MEM_COPY(value, MclMpmcQueue_GetElem(lap), self->elemBytes);
+                MclAtomic_StoreRelease(lap, MclMpmcQueue_GetBase(self, pos) + MclMpmcQueue_GetCapacity(self));
+                return MCL_SUCCESS;
+            }
+        } else if (diff < 0) {
+            return MCL_FAILURE;
+        } else {
+            pos = MclAtomic_LoadRelaxed(&self->popPos);
+        }
+    }
+}
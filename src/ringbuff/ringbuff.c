@@ -1,8 +1,11 @@
 #include "mcl/ringbuff/ringbuff.h"
 #include "mcl/mem/memory.h"
 #include "mcl/mem/align.h"
+#include "mcl/algo/bit.h"
 #include "mcl/assert.h"
 
+typedef MclStatus (*MclRingBuffInit)(MclRingBuff*, MclSize, MclSize, uint8_t*);
+
 MCL_PRIVATE MclArrayIndex MclRingBuff_GetNextPos(const MclRingBuff *self, MclArrayIndex pos) {
     return (pos + 1) % MclArray_GetCapacity(&self->buff);
 }
@@ -15,7 +18,120 @@ MCL_PRIVATE MclArrayIndex MclRingBuff_GetNextTail(const MclRingBuff *self) {
     return MclRingBuff_GetNextPos(self, MclAtomic_Get(&((MclRingBuff*)self)->tail));
 }
 
-MclRingBuff* MclRingBuff_Create(MclSize capacity, MclSize elemBytes) {
+///////////////////////////////////////////////////////////
+/* SPSC mode: head and tail run freely and are masked on access,
+ * each side caches the opposite index and only reloads it when
+ * the cached value says the ring is empty or full. */
+MCL_PRIVATE uint8_t* MclRingBuff_GetSlotSpsc(MclRingBuff *self, MclSize pos) {
+    return MclArray_Begin(&self->buff) + (pos & self->mask) * MclArray_GetElemSize(&self->buff);
+}
+
+MCL_PRIVATE MclSize MclRingBuff_GetCountSpsc(const MclRingBuff *self) {
+    MclSize head = MclAtomic_LoadAcquire(&self->head);
+    return MclAtomic_LoadAcquire(&self->tail) - head;
+}
+
+MCL_PRIVATE MclStatus MclRingBuff_PutSpsc(MclRingBuff *self, void *value) {
+    MclSize tail = MclAtomic_LoadRelaxed(&self->tail);
+    MclSize capacity = MclArray_GetCapacity(&self->buff);
+
+    if (tail - self->headCache >= capacity) {
+        self->headCache = MclAtomic_LoadAcquire(&self->head);
+        if (tail - self->headCache >= capacity) return MCL_FAILURE;
+    }
+
+    MCL_MEM_COPY(MclRingBuff_GetSlotSpsc(self, tail), value, MclArray_GetElemSize(&self->buff));
+    MclAtomic_StoreRelease(&self->tail, tail + 1);
+    return MCL_SUCCESS;
+}
+
+MCL_PRIVATE MclStatus MclRingBuff_PopSpsc(MclRingBuff *self, void *value) {
+    MclSize head = MclAtomic_LoadRelaxed(&self->head);
+
+    if (head == self->tailCache) {
+        self->tailCache = MclAtomic_LoadAcquire(&self->tail);
+        if (head == self->tailCache) return MCL_FAILURE;
+    }
+
+    MCL_MEM_COPY(value, MclRingBuff_GetSlotSpsc(self, head), MclArray_GetElemSize(&self->buff));
+    MclAtomic_StoreRelease(&self->head, head + 1);
+    return MCL_SUCCESS;
+}
+
+///////////////////////////////////////////////////////////
+/* Batch copy a run of count elements starting at slot, split into
+ * at most two copies around the end of the buffer. */
+MCL_PRIVATE void MclRingBuff_CopyIn(MclRingBuff *self, MclSize slot, const uint8_t *values, MclSize count) {
+    MclSize elemBytes = MclArray_GetElemSize(&self->buff);
+    MclSize firstCount = MCL_MIN(count, MclArray_GetCapacity(&self->buff) - slot);
+
+    MCL_MEM_COPY(MclArray_Begin(&self->buff) + slot * elemBytes, (void*)values, firstCount * elemBytes);
+    if (count > firstCount) {
+        MCL_MEM_COPY(MclArray_Begin(&self->buff), (void*)(values + firstCount * elemBytes), (count - firstCount) * elemBytes);
+    }
+}
+
+MCL_PRIVATE void MclRingBuff_CopyOut(MclRingBuff *self, MclSize slot, uint8_t *values, MclSize count) {
+    MclSize elemBytes = MclArray_GetElemSize(&self->buff);
+    MclSize firstCount = MCL_MIN(count, MclArray_GetCapacity(&self->buff) - slot);
+
+    MCL_MEM_COPY(values, MclArray_Begin(&self->buff) + slot * elemBytes, firstCount * elemBytes);
+    if (count > firstCount) {
+        MCL_MEM_COPY(values + firstCount * elemBytes, MclArray_Begin(&self->buff), (count - firstCount) * elemBytes);
+    }
+}
+
+/* Producer and consumer views shared by batch and zero-copy apis,
+ * SPSC mode only reloads the opposite index when the cache is not enough. */
+MCL_PRIVATE MclSize MclRingBuff_GetFreeCount(MclRingBuff *self, MclSize wanted) {
+    MclSize capacity = MclArray_GetCapacity(&self->buff);
+    if (!self->isSpsc) return capacity - 1 - MclRingBuff_GetCount(self);
+
+    MclSize tail = MclAtomic_LoadRelaxed(&self->tail);
+    if (capacity - (tail - self->headCache) < wanted) {
+        self->headCache = MclAtomic_LoadAcquire(&self->head);
+    }
+    return capacity - (tail - self->headCache);
+}
+
+MCL_PRIVATE MclSize MclRingBuff_GetUsedCount(MclRingBuff *self, MclSize wanted) {
+    if (!self->isSpsc) return MclRingBuff_GetCount(self);
+
+    MclSize head = MclAtomic_LoadRelaxed(&self->head);
+    if (self->tailCache - head < wanted) {
+        self->tailCache = MclAtomic_LoadAcquire(&self->tail);
+    }
+    return self->tailCache - head;
+}
+
+MCL_PRIVATE MclSize MclRingBuff_GetTailSlot(MclRingBuff *self) {
+    MclSize tail = self->isSpsc ? MclAtomic_LoadRelaxed(&self->tail) : MclAtomic_Get(&self->tail);
+    return self->isSpsc ? (tail & self->mask) : tail;
+}
+
+MCL_PRIVATE MclSize MclRingBuff_GetHeadSlot(MclRingBuff *self) {
+    MclSize head = self->isSpsc ? MclAtomic_LoadRelaxed(&self->head) : MclAtomic_Get(&self->head);
+    return self->isSpsc ? (head & self->mask) : head;
+}
+
+MCL_PRIVATE void MclRingBuff_AdvanceTail(MclRingBuff *self, MclSize count) {
+    if (self->isSpsc) {
+        MclAtomic_StoreRelease(&self->tail, MclAtomic_LoadRelaxed(&self->tail) + count);
+        return;
+    }
+    MclAtomic_Set(&self->tail, (MclAtomic_Get(&self->tail) + count) % MclArray_GetCapacity(&self->buff));
+}
+
+MCL_PRIVATE void MclRingBuff_AdvanceHead(MclRingBuff *self, MclSize count) {
+    if (self->isSpsc) {
+        MclAtomic_StoreRelease(&self->head, MclAtomic_LoadRelaxed(&self->head) + count);
+        return;
+    }
+    MclAtomic_Set(&self->head, (MclAtomic_Get(&self->head) + count) % MclArray_GetCapacity(&self->buff));
+}
+
+///////////////////////////////////////////////////////////
+MCL_PRIVATE MclRingBuff* MclRingBuff_CreateBy(MclSize capacity, MclSize elemBytes, MclRingBuffInit init) {
     MCL_ASSERT_TRUE_NIL(capacity > 0);
     MCL_ASSERT_TRUE_NIL(elemBytes > 0);
 
@@ -31,7 +147,7 @@ MclRingBuff* MclRingBuff_Create(MclSize capacity, MclSize elemBytes) {
         return NULL;
     }
 
-    if (MCL_FAILED(MclRingBuff_Init(self, capacity, elemBytes, buff))) {
+    if (MCL_FAILED(init(self, capacity, elemBytes, buff))) {
         MCL_LOG_ERR("Init ringbuff failed!");
         MCL_FREE(buff);
         MCL_FREE(self);
@@ -40,6 +156,14 @@ MclRingBuff* MclRingBuff_Create(MclSize capacity, MclSize elemBytes) {
     return self;
 }
 
+MclRingBuff* MclRingBuff_Create(MclSize capacity, MclSize elemBytes) {
+    return MclRingBuff_CreateBy(capacity, elemBytes, MclRingBuff_Init);
+}
+
+MclRingBuff* MclRingBuff_CreateSpsc(MclSize capacity, MclSize elemBytes) {
+    return MclRingBuff_CreateBy(capacity, elemBytes, MclRingBuff_InitSpsc);
+}
+
 void MclRingBuff_Delete(MclRingBuff *self) {
     MCL_ASSERT_VALID_PTR_VOID(self);
 
@@ -57,31 +181,57 @@ MclStatus MclRingBuff_Init(MclRingBuff *self, MclSize capacity, MclSize elemByte
     MCL_ASSERT_TRUE(elemBytes > 0);
 
     MclArray_Init(&self->buff, capacity, elemBytes, buff);
+    self->isSpsc = false;
+    self->mask = 0;
+    self->tailCache = 0;
+    self->headCache = 0;
     MclAtomic_Set(&self->head, 0);
     MclAtomic_Set(&self->tail, 0);
     return MCL_SUCCESS;
 }
 
+MclStatus MclRingBuff_InitSpsc(MclRingBuff *self, MclSize capacity, MclSize elemBytes, uint8_t* buff) {
+    MCL_ASSERT_TRUE(MCL_BIT_IS_POWER_OF_2(capacity));
+
+    MCL_ASSERT_SUCC_CALL(MclRingBuff_Init(self, capacity, elemBytes, buff));
+    self->isSpsc = true;
+    self->mask = capacity - 1;
+    return MCL_SUCCESS;
+}
+
 void MclRingBuff_Reset(MclRingBuff *self) {
     MCL_ASSERT_VALID_PTR_VOID(self);
     MclArray_Clear(&self->buff);
+    self->tailCache = 0;
+    self->headCache = 0;
     MclAtomic_Clear(&self->head);
     MclAtomic_Clear(&self->tail);
 }
 
 bool MclRingBuff_IsFull(const MclRingBuff *self) {
     MCL_ASSERT_VALID_PTR_R(self, true);
+
+    if (self->isSpsc) {
+        return MclRingBuff_GetCountSpsc(self) >= MclArray_GetCapacity(&self->buff);
+    }
     return MclRingBuff_GetNextTail(self) == MclAtomic_Get(&((MclRingBuff*)self)->head);
 }
 
 bool MclRingBuff_IsEmpty(const MclRingBuff *self) {
     MCL_ASSERT_VALID_PTR_R(self, true);
+
+    if (self->isSpsc) {
+        return MclRingBuff_GetCountSpsc(self) == 0;
+    }
     return MclAtomic_Get(&((MclRingBuff*)self)->head) == MclAtomic_Get(&((MclRingBuff*)self)->tail);
 }
 
 MclSize MclRingBuff_GetCount(const MclRingBuff *self) {
     MCL_ASSERT_VALID_PTR_NIL(self);
 
+    if (self->isSpsc) {
+        return MclRingBuff_GetCountSpsc(self);
+    }
     MclSize capacity = MclArray_GetCapacity(&self->buff);
     return (MclAtomic_Get(&((MclRingBuff*)self)->tail) + capacity - MclAtomic_Get(&((MclRingBuff*)self)->head)) % capacity;
 }
@@ -90,6 +240,8 @@ MclStatus MclRingBuff_Pop(MclRingBuff *self, void *value) {
     MCL_ASSERT_VALID_PTR(self);
     MCL_ASSERT_VALID_PTR(value);
 
+    if (self->isSpsc) return MclRingBuff_PopSpsc(self, value);
+
     if (MclRingBuff_IsEmpty(self)) return MCL_FAILURE;
 
     void *result = MclArray_Get(&self->buff, MclAtomic_Get(&self->head));
@@ -104,9 +256,75 @@ MclStatus MclRingBuff_Put(MclRingBuff *self, void *value) {
     MCL_ASSERT_VALID_PTR(self);
     MCL_ASSERT_VALID_PTR(value);
 
+    if (self->isSpsc) return MclRingBuff_PutSpsc(self, value);
+
     if (MclRingBuff_IsFull(self)) return MCL_FAILURE;
 
     MCL_ASSERT_SUCC_CALL(MclArray_Set(&self->buff, MclAtomic_Get(&self->tail), value));
     MclAtomic_Set(&self->tail, MclRingBuff_GetNextTail(self));
     return MCL_SUCCESS;
 }
+
+MclSize MclRingBuff_PutN(MclRingBuff *self, const void *values, MclSize count) {
+    MCL_ASSERT_VALID_PTR_NIL(self);
+    MCL_ASSERT_VALID_PTR_NIL(values);
+
+    MclSize putCount = MCL_MIN(count, MclRingBuff_GetFreeCount(self, count));
+    if (putCount == 0) return 0;
+
+    MclRingBuff_CopyIn(self, MclRingBuff_GetTailSlot(self), values, putCount);
+    MclRingBuff_AdvanceTail(self, putCount);
+    return putCount;
+}
+
+MclSize MclRingBuff_PopN(MclRingBuff *self, void *values, MclSize count) {
+    MCL_ASSERT_VALID_PTR_NIL(self);
+    MCL_ASSERT_VALID_PTR_NIL(values);
+
+    MclSize popCount = MCL_MIN(count, MclRingBuff_GetUsedCount(self, count));
+    if (popCount == 0) return 0;
+
+    MclRingBuff_CopyOut(self, MclRingBuff_GetHeadSlot(self), values, popCount);
+    MclRingBuff_AdvanceHead(self, popCount);
+    return popCount;
+}
+
+void* MclRingBuff_Reserve(MclRingBuff *self, MclSize count, MclSize *reservedCount) {
+    MCL_ASSERT_VALID_PTR_NIL(self);
+    MCL_ASSERT_VALID_PTR_NIL(reservedCount);
+
+    MclSize slot = MclRingBuff_GetTailSlot(self);
+    MclSize contiguousCount = MclArray_GetCapacity(&self->buff) - slot;
+    *reservedCount = MCL_MIN(MCL_MIN(count, contiguousCount), MclRingBuff_GetFreeCount(self, count));
+    if (*reservedCount == 0) return NULL;
+
+    return MclArray_Get(&self->buff, slot);
+}
+
+MclStatus MclRingBuff_Commit(MclRingBuff *self, MclSize count) {
+    MCL_ASSERT_VALID_PTR(self);
+    MCL_ASSERT_TRUE(count <= MclRingBuff_GetFreeCount(self, count));
+
+    MclRingBuff_AdvanceTail(self, count);
+    return MCL_SUCCESS;
+}
+
+void* MclRingBuff_Peek(MclRingBuff *self, MclSize count, MclSize *peekedCount) {
+    MCL_ASSERT_VALID_PTR_NIL(self);
+    MCL_ASSERT_VALID_PTR_NIL(peekedCount);
+
+    MclSize slot = MclRingBuff_GetHeadSlot(self);
+    MclSize contiguousCount = MclArray_GetCapacity(&self->buff) - slot;
+    *peekedCount = MCL_MIN(MCL_MIN(count, contiguousCount), MclRingBuff_GetUsedCount(self, count));
+    if (*peekedCount == 0) return NULL;
+
+    return MclArray_Get(&self->buff, slot);
+}
+
+MclStatus MclRingBuff_Release(MclRingBuff *self, MclSize count) {
+    MCL_ASSERT_VALID_PTR(self);
+    MCL_ASSERT_TRUE(count <= MclRingBuff_GetUsedCount(self, count));
+
+    MclRingBuff_AdvanceHead(self, count);
+    return MCL_SUCCESS;
+}
@@ -0,0 +1,396 @@
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+#include "mcl/task/fiber.h"
+#include "mcl/task/task_scheduler.h"
+#include "mcl/task/task.h"
+#include "mcl/lock/future.h"
+#include "mcl/lock/mutex.h"
+#include "mcl/lock/event_count.h"
+#include "mcl/msg/msg_queue.h"
+#include "mcl/mem/memory.h"
+#include "mcl/assert.h"
+#include <ucontext.h>
+#include <sys/mman.h>
+#include <sched.h>
+#include <unistd.h>
+
+typedef enum {
+	MCL_FIBER_READY = 0,
+	MCL_FIBER_RUNNING,
+	MCL_FIBER_SUSPENDING,
+	MCL_FIBER_DONE,
+} MclFiberState;
+
+typedef enum {
+	MCL_FIBER_AWAIT_YIELD = 0,
+	MCL_FIBER_AWAIT_SLEEP,
+	MCL_FIBER_AWAIT_FUTURE,
+} MclFiberAwait;
+
+/*
+ * Fiber is a task executed once per resume. Suspending fiber swaps back to
+ * the worker, and the await is registered when the worker destroys the task,
+ * which is the last touch of the task by the worker, so the fiber is never
+ * resumed in another worker before both its stack and its task are released.
+ */
+MCL_TYPE(MclFiber) {
+	MclTask task;
+	ucontext_t context;
+	ucontext_t *caller;
+	void *stack;
+	MclFiberEntry entry;
+	void *arg;
+	MclTaskScheduler *scheduler;
+	MclTaskPriority priority;
+	MclFiberState state;
+	MclFiberAwait await;
+	MclTimeUs sleepUs;
+	MclFuture *future;
+	struct MclFiberRecvWait *recvWait;
+	MclMsgQueue *recvQueue;
+};
+
+MCL_PRIVATE _Thread_local MclFiber *currentFiber = NULL;
+
+///////////////////////////////////////////////////////////
+typedef struct MclFiberStackNode {
+	struct MclFiberStackNode *next;
+} MclFiberStackNode;
+
+MCL_PRIVATE MclMutex stackPoolLock = MCL_MUTEX();
+MCL_PRIVATE MclFiberStackNode *stackPool = NULL;
+MCL_PRIVATE MclSize stackPoolCount = 0;
+
+MCL_PRIVATE MclSize MclFiberStack_GetGuardSize() {
+	long pageSize = sysconf(_SC_PAGESIZE);
+	return (pageSize > 0) ? (MclSize)pageSize : 4096;
+}
+
+/* Returns the usable bottom, the guard page is right below it */
+MCL_PRIVATE void* MclFiberStack_Map() {
+	MclSize guardSize = MclFiberStack_GetGuardSize();
+	uint8_t *base = mmap(NULL, guardSize + MCL_FIBER_STACK_SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	if (base == MAP_FAILED) {
+		MCL_LOG_ERR("Map fiber stack failed!");
+		return NULL;
+	}
+	if (mprotect(base, guardSize, PROT_NONE)) {
+		MCL_LOG_ERR("Protect fiber stack guard failed!");
+		(void)munmap(base, guardSize + MCL_FIBER_STACK_SIZE);
+		return NULL;
+	}
+	return base + guardSize;
+}
+
+MCL_PRIVATE void MclFiberStack_Unmap(void *stack) {
+	MclSize guardSize = MclFiberStack_GetGuardSize();
+	(void)munmap((uint8_t*)stack - guardSize, guardSize + MCL_FIBER_STACK_SIZE);
+}
+
+MCL_PRIVATE void* MclFiberStack_Alloc() {
+	MclFiberStackNode *node = NULL;
+	{
+		MCL_LOCK_AUTO(stackPoolLock);
+		node = stackPool;
+		if (node) {
+			stackPool = node->next;
+			stackPoolCount--;
+		}
+	}
+	return node ? (void*)node : MclFiberStack_Map();
+}
+
+MCL_PRIVATE void MclFiberStack_Free(void *stack) {
+	{
+		MCL_LOCK_AUTO(stackPoolLock);
+		if (stackPoolCount < MCL_FIBER_STACK_POOL_MAX) {
+			MclFiberStackNode *node = (MclFiberStackNode*)stack;
+			node->next = stackPool;
+			stackPool = node;
+			stackPoolCount++;
+			return;
+		}
+	}
+	MclFiberStack_Unmap(stack);
+}
+
+///////////////////////////////////////////////////////////
+/*
+ * Msg queue readiness as a future, so AwaitRecv is resumed by the scheduler
+ * as AwaitFuture. It is shared by the awaiting fiber, the ready callback of
+ * the queue and the timeout task, each holds a reference and the last frees it.
+ */
+typedef struct MclFiberRecvWait {
+	MclTask timeoutTask;
+	MclFuture *ready;
+	MclAtomic refCount;
+} MclFiberRecvWait;
+
+MCL_PRIVATE void MclFiberRecvWait_Release(MclFiberRecvWait *self) {
+	if (MclAtomic_SubFetch(&self->refCount, 1) > 0) return;
+	MclFuture_Delete(self->ready);
+	MCL_FREE(self);
+}
+
+MCL_PRIVATE void MclFiberRecvWait_OnMsg(void *ctxt) {
+	MclFiberRecvWait *self = (MclFiberRecvWait*)ctxt;
+
+	(void)MclFuture_Set(self->ready, MCL_SUCCESS, NULL);
+	MclFiberRecvWait_Release(self);
+}
+
+MCL_PRIVATE MclStatus MclFiberRecvWait_Timeout(MclTask *task) {
+	MclFiberRecvWait *self = (MclFiberRecvWait*)task;
+
+	(void)MclFuture_Set(self->ready, MCL_TIMEDOUT, NULL);
+	return MCL_SUCCESS;
+}
+
+MCL_PRIVATE void MclFiberRecvWait_DestroyTimeout(MclTask *task) {
+	MclFiberRecvWait_Release((MclFiberRecvWait*)task);
+}
+
+/* Callback failed to cancel is running or ran, and releases its own reference */
+MCL_PRIVATE void MclFiberRecvWait_Leave(MclFiberRecvWait *self, MclMsgQueue *queue) {
+	if (MCL_SUCCESS == MclMsgQueue_CancelOnReady(queue, MclFiberRecvWait_OnMsg, self)) {
+		MclFiberRecvWait_Release(self);
+	}
+	MclFiberRecvWait_Release(self);
+}
+
+/* Timeout task is not cancelled by msg, it only sets the ready future if still waiting */
+MCL_PRIVATE MclFiberRecvWait* MclFiberRecvWait_Create(MclTaskScheduler *scheduler, MclTaskPriority priority,
+		MclMsgQueue *queue, MclTimeUs timeoutUs) {
+	MclFiberRecvWait *self = MCL_MALLOC(sizeof(MclFiberRecvWait));
+	MCL_ASSERT_VALID_PTR_NIL(self);
+
+	self->ready = MclFuture_Create();
+	if (!self->ready) {
+		MCL_FREE(self);
+		return NULL;
+	}
+	MclTask task = MCL_TASK(MCL_TASK_KEY_INVALID, MclFiberRecvWait_Timeout, MclFiberRecvWait_DestroyTimeout);
+	self->timeoutTask = task;
+	MclAtomic_Set(&self->refCount, 2);
+
+	if (MCL_FAILED(MclMsgQueue_OnReady(queue, MclFiberRecvWait_OnMsg, self))) {
+		MclFiberRecvWait_Release(self);
+		MclFiberRecvWait_Release(self);
+		return NULL;
+	}
+	if (MclTimeUs_IsValid(timeoutUs)) {
+		MclAtomic_AddFetch(&self->refCount, 1);
+		if (MCL_FAILED(MclTaskScheduler_SubmitDelayed(scheduler, &self->timeoutTask, priority, timeoutUs))) {
+			MclFiberRecvWait_Release(self);
+			MclFiberRecvWait_Leave(self, queue);
+			return NULL;
+		}
+	}
+	return self;
+}
+
+///////////////////////////////////////////////////////////
+MCL_PRIVATE void MclFiber_Delete(MclFiber *self) {
+	if (self->recvWait) MclFiberRecvWait_Leave(self->recvWait, self->recvQueue);
+	MclFiberStack_Free(self->stack);
+	MCL_FREE(self);
+}
+
+/* Current fiber is only read before suspend, the thread may change after it */
+MCL_PRIVATE void MclFiber_Run() {
+	MclFiber *self = currentFiber;
+
+	self->entry(self->arg);
+	self->state = MCL_FIBER_DONE;
+	(void)setcontext(self->caller);
+}
+
+MCL_PRIVATE void MclFiber_Suspend(MclFiber *self, MclFiberAwait await) {
+	self->await = await;
+	self->state = MCL_FIBER_SUSPENDING;
+	(void)swapcontext(&self->context, self->caller);
+}
+
+MCL_PRIVATE void MclFiber_SleepIn(MclFiber *self, MclTimeUs us) {
+	self->sleepUs = us;
+	MclFiber_Suspend(self, us ? MCL_FIBER_AWAIT_SLEEP : MCL_FIBER_AWAIT_YIELD);
+}
+
+MCL_PRIVATE void MclFiber_Resume(MclFiber *self) {
+	if (MCL_FAILED(MclTaskScheduler_SubmitTask(self->scheduler, &self->task, self->priority))) {
+		MCL_LOG_ERR("Resume fiber (%u) failed!", self->task.key);
+		MclFiber_Delete(self);
+	}
+}
+
+/* Fiber may be resumed in another worker as soon as the await registered,
+ * fiber awaiting a future is held by the scheduler until the future is ready */
+MCL_PRIVATE void MclFiber_CommitAwait(MclFiber *self) {
+	self->state = MCL_FIBER_READY;
+
+	switch (self->await) {
+	case MCL_FIBER_AWAIT_SLEEP:
+		if (MCL_FAILED(MclTaskScheduler_SubmitDelayed(self->scheduler, &self->task, self->priority, self->sleepUs))) {
+			MclFiber_Delete(self);
+		}
+		break;
+	case MCL_FIBER_AWAIT_FUTURE:
+		if (MCL_FAILED(MclTaskScheduler_SubmitOnReady(self->scheduler, &self->task, self->priority, self->future))) {
+			MclFiber_Delete(self);
+		}
+		break;
+	default:
+		MclFiber_Resume(self);
+		break;
+	}
+}
+
+MCL_PRIVATE MclStatus MclFiber_Execute(MclTask *task) {
+	MclFiber *self = (MclFiber*)task;
+
+	ucontext_t caller;
+	MclFiber *outer = currentFiber;
+	self->caller = &caller;
+	self->state = MCL_FIBER_RUNNING;
+	currentFiber = self;
+	(void)swapcontext(&caller, &self->context);
+	currentFiber = outer;
+	return MCL_SUCCESS;
+}
+
+MCL_PRIVATE void MclFiber_Destroy(MclTask *task) {
+	MclFiber *self = (MclFiber*)task;
+
+	if (self->state == MCL_FIBER_SUSPENDING) {
+		MclFiber_CommitAwait(self);
+		return;
+	}
+	MclFiber_Delete(self);
+}
+
+/* Kept out of Create and never inlined, so no local of the caller lives across getcontext */
+MCL_PRIVATE MCL_NOINLINE MclStatus MclFiber_InitContext(MclFiber *self) {
+	if (getcontext(&self->context)) {
+		MCL_LOG_ERR("Get fiber context failed!");
+		return MCL_FAILURE;
+	}
+	self->context.uc_stack.ss_sp = self->stack;
+	self->context.uc_stack.ss_size = MCL_FIBER_STACK_SIZE;
+	self->context.uc_link = NULL;
+	makecontext(&self->context, MclFiber_Run, 0);
+	return MCL_SUCCESS;
+}
+
+MCL_PRIVATE MclFiber* MclFiber_Create(MclTaskScheduler *scheduler, MclTaskKey key, MclTaskPriority priority,
+		MclFiberEntry entry, void *arg) {
+	MclFiber *self = MCL_MALLOC(sizeof(MclFiber));
+	MCL_ASSERT_VALID_PTR_NIL(self);
+
+	self->stack = MclFiberStack_Alloc();
+	if (!self->stack) {
+		MCL_FREE(self);
+		return NULL;
+	}
+	if (MCL_FAILED(MclFiber_InitContext(self))) {
+		MclFiber_Delete(self);
+		return NULL;
+	}
+
+	MclTask task = MCL_TASK(key, MclFiber_Execute, MclFiber_Destroy);
+	self->task = task;
+	self->caller = NULL;
+	self->entry = entry;
+	self->arg = arg;
+	self->scheduler = scheduler;
+	self->priority = priority;
+	self->state = MCL_FIBER_READY;
+	self->await = MCL_FIBER_AWAIT_YIELD;
+	self->sleepUs = 0;
+	self->future = NULL;
+	self->recvWait = NULL;
+	self->recvQueue = NULL;
+	return self;
+}
+
+MclStatus MclFiber_Spawn(MclTaskScheduler *scheduler, MclTaskKey key, MclTaskPriority priority, MclFiberEntry entry, void *arg) {
+	MCL_ASSERT_VALID_PTR(scheduler);
+	MCL_ASSERT_VALID_PTR(entry);
+
+	MclFiber *self = MclFiber_Create(scheduler, key, priority, entry, arg);
+	MCL_ASSERT_VALID_PTR(self);
+
+	if (MCL_FAILED(MclTaskScheduler_SubmitTask(scheduler, &self->task, priority))) {
+		MCL_LOG_ERR("Spawn fiber (%u) failed!", key);
+		MclFiber_Delete(self);
+		return MCL_FAILURE;
+	}
+	return MCL_SUCCESS;
+}
+
+bool MclFiber_IsInFiber() {
+	return currentFiber != NULL;
+}
+
+void MclFiber_Yield() {
+	MclFiber *self = currentFiber;
+	if (!self) {
+		(void)sched_yield();
+		return;
+	}
+	MclFiber_Suspend(self, MCL_FIBER_AWAIT_YIELD);
+}
+
+void MclFiber_Sleep(MclTimeUs us) {
+	MclFiber *self = currentFiber;
+	if (!self) {
+		(void)usleep(us);
+		return;
+	}
+	MclFiber_SleepIn(self, us);
+}
+
+void MclFiber_AwaitFuture(MclFuture *future, MclStatus *status, void **value) {
+	MCL_ASSERT_VALID_PTR_VOID(future);
+	MCL_ASSERT_VALID_PTR_VOID(status);
+	MCL_ASSERT_VALID_PTR_VOID(value);
+
+	MclFiber *self = currentFiber;
+	if (!self || MclFuture_IsReady(future)) {
+		MclFuture_Get(future, status, value);
+		return;
+	}
+	self->future = future;
+	MclFiber_Suspend(self, MCL_FIBER_AWAIT_FUTURE);
+	self->future = NULL;
+	MclFuture_Get(future, status, value);
+}
+
+MclStatus MclFiber_AwaitRecv(MclMsgQueue *queue, MclMsg *msg, MclTimeUs timeoutUs) {
+	MCL_ASSERT_VALID_PTR(queue);
+	MCL_ASSERT_VALID_PTR(msg);
+
+	MclFiber *self = currentFiber;
+	if (!self) return MclMsgQueue_RecvWait(queue, msg, timeoutUs);
+
+	MclTimeUs deadline = MclEventCount_GetDeadline(timeoutUs);
+	while (MCL_FAILED(MclMsgQueue_Recv(queue, msg))) {
+		MclTimeUs nowUs = MclEventCount_GetDeadline(0);
+		if (MclTimeUs_IsValid(deadline) && (nowUs >= deadline)) {
+			return MCL_TIMEDOUT;
+		}
+		MclFiberRecvWait *wait = MclFiberRecvWait_Create(self->scheduler, self->priority, queue,
+				MclTimeUs_IsValid(deadline) ? deadline - nowUs : MCL_TIME_US_INVALID);
+		MCL_ASSERT_VALID_PTR(wait);
+
+		self->recvWait = wait;
+		self->recvQueue = queue;
+		self->future = wait->ready;
+		MclFiber_Suspend(self, MCL_FIBER_AWAIT_FUTURE);
+		self->future = NULL;
+		self->recvWait = NULL;
+		self->recvQueue = NULL;
+		MclFiberRecvWait_Leave(wait, queue);
+	}
+	return MCL_SUCCESS;
+}
@@ -0,0 +1,209 @@
+#include "mcl/task/parallel.h"
+#include "mcl/task/thread_pool.h"
+#include "mcl/task/task.h"
+#include "mcl/lock/event_count.h"
+#include "mcl/lock/mutex.h"
+#include "mcl/lock/atomic.h"
+#include "mcl/thread/thread.h"
+#include "mcl/mem/memory.h"
+#include "mcl/assert.h"
+#include <string.h>
+
+#define MCL_PARALLEL_CHUNKS_PER_THREAD 8
+#define MCL_PARALLEL_PRIORITY 0
+
+typedef struct {
+	MclThreadPool *pool;
+	MclSize grain;
+	MclParallelForFunc forFunc;
+	MclParallelReduceFunc reduceFunc;
+	MclParallelJoinFunc joinFunc;
+	void *ctxt;
+	MclSize valueSize;
+	const void *identity;
+	void *result;
+	MclMutex resultLock;
+	MclAtomic pendingCount;
+	MclAtomic notifyingCount;
+	MclEventCount allDone;
+} MclParallelJob;
+
+typedef struct {
+	MclTask task;
+	MclParallelJob *job;
+	MclSize begin;
+	MclSize end;
+	uint8_t partial[];
+} MclRangeTask;
+
+MCL_PRIVATE void MclParallelJob_Run(MclParallelJob *self, MclSize begin, MclSize end, void *partial);
+
+MCL_PRIVATE MclStatus MclRangeTask_Execute(MclTask *task) {
+	MclRangeTask *self = (MclRangeTask*)task;
+	MclParallelJob_Run(self->job, self->begin, self->end, self->partial);
+	return MCL_SUCCESS;
+}
+
+/* Notifying count keeps the job on caller stack alive until the last one leaves the event count */
+MCL_PRIVATE void MclRangeTask_Destroy(MclTask *task) {
+	MclRangeTask *self = (MclRangeTask*)task;
+	MclParallelJob *job = self->job;
+	MCL_FREE(self);
+
+	MclAtomic_AddFetch(&job->notifyingCount, 1);
+	if (MclAtomic_SubFetch(&job->pendingCount, 1) == 0) {
+		MclEventCount_NotifyAll(&job->allDone);
+	}
+	MclAtomic_SubFetch(&job->notifyingCount, 1);
+}
+
+MCL_PRIVATE MclRangeTask* MclRangeTask_Create(MclParallelJob *job, MclSize begin, MclSize end) {
+	MclRangeTask *self = MCL_MALLOC(sizeof(MclRangeTask) + job->valueSize);
+	MCL_ASSERT_VALID_PTR_NIL(self);
+
+	/* invalid key keeps chunks away from RemoveTask, which would lose them */
+	MclTask task = MCL_TASK(MCL_TASK_KEY_INVALID, MclRangeTask_Execute, MclRangeTask_Destroy);
+	self->task = task;
+	self->job = job;
+	self->begin = begin;
+	self->end = end;
+	return self;
+}
+
+MCL_PRIVATE MclStatus MclParallelJob_Spawn(MclParallelJob *self, MclSize begin, MclSize end) {
+	MclRangeTask *task = MclRangeTask_Create(self, begin, end);
+	MCL_ASSERT_VALID_PTR(task);
+
+	MclAtomic_AddFetch(&self->pendingCount, 1);
+	if (MCL_FAILED(MclThreadPool_SubmitTask(self->pool, &task->task, MCL_PARALLEL_PRIORITY))) {
+		MclAtomic_SubFetch(&self->pendingCount, 1);
+		MCL_FREE(task);
+		return MCL_FAILURE;
+	}
+	return MCL_SUCCESS;
+}
+
+MCL_PRIVATE void MclParallelJob_Execute(MclParallelJob *self, MclSize begin, MclSize end, void *partial) {
+	if (!self->reduceFunc) {
+		self->forFunc(begin, end, self->ctxt);
+		return;
+	}
+
+	memcpy(partial, self->identity, self->valueSize);
+	self->reduceFunc(begin, end, self->ctxt, partial);
+
+	MCL_LOCK_AUTO(self->resultLock);
+	self->joinFunc(self->result, partial, self->ctxt);
+}
+
+/* Keeps the left half and gives away the right half, failed split runs the rest inline */
+MCL_PRIVATE void MclParallelJob_Run(MclParallelJob *self, MclSize begin, MclSize end, void *partial) {
+	while (end - begin > self->grain) {
+		MclSize mid = begin + (end - begin) / 2;
+		if (MCL_FAILED(MclParallelJob_Spawn(self, mid, end))) break;
+		end = mid;
+	}
+	MclParallelJob_Execute(self, begin, end, partial);
+}
+
+MCL_PRIVATE void MclParallelJob_WaitDone(MclParallelJob *self) {
+	while (MclAtomic_LoadAcquire(&self->pendingCount) != 0) {
+		if (MclThreadPool_TryLocalExecute(self->pool)) continue;
+
+		MclSize key = MclEventCount_PrepareWait(&self->allDone);
+		if (MclAtomic_LoadAcquire(&self->pendingCount) == 0) {
+			MclEventCount_CancelWait(&self->allDone);
+			break;
+		}
+		/* wakes up in a while to help again, chunks may be queued behind the running ones */
+		(void)MclEventCount_WaitUntil(&self->allDone, key, MclEventCount_GetDeadline(1000));
+	}
+	while (MclAtomic_LoadAcquire(&self->notifyingCount) != 0) {
+		MclThread_Yield();
+	}
+}
+
+MCL_PRIVATE MclSize MclParallel_GetGrain(MclThreadPool *pool, MclSize count, MclSize grain) {
+	if (grain > 0) return grain;
+
+	MclSize chunks = (MclThreadPool_GetThreadCount(pool) + 1) * MCL_PARALLEL_CHUNKS_PER_THREAD;
+	return (count > chunks) ? count / chunks : 1;
+}
+
+MCL_PRIVATE MclStatus MclParallel_Run(MclParallelJob *job, MclSize begin, MclSize end) {
+	void *partial = NULL;
+	if (job->valueSize > 0) {
+		partial = MCL_MALLOC(job->valueSize);
+		MCL_ASSERT_VALID_PTR(partial);
+	}
+
+	if (end - begin <= job->grain) {
+		MclParallelJob_Execute(job, begin, end, partial);
+	} else {
+		if (MCL_FAILED(MclEventCount_Init(&job->allDone))) {
+			MCL_LOG_ERR("Init event count of parallel job failed!");
+			if (partial) MCL_FREE(partial);
+			return MCL_FAILURE;
+		}
+		MclParallelJob_Run(job, begin, end, partial);
+		MclParallelJob_WaitDone(job);
+		MclEventCount_Destroy(&job->allDone);
+	}
+	if (partial) MCL_FREE(partial);
+	return MCL_SUCCESS;
+}
+
+MCL_PRIVATE void MclParallelJob_Init(MclParallelJob *self, MclThreadPool *pool, MclSize grain, void *ctxt) {
+	self->pool = pool;
+	self->grain = grain;
+	self->forFunc = NULL;
+	self->reduceFunc = NULL;
+	self->joinFunc = NULL;
+	self->ctxt = ctxt;
+	self->valueSize = 0;
+	self->identity = NULL;
+	self->result = NULL;
+	MclAtomic_Clear(&self->pendingCount);
+	MclAtomic_Clear(&self->notifyingCount);
+}
+
+MclStatus MclParallel_For(MclThreadPool *pool, MclSize begin, MclSize end, MclSize grain,
+		                  MclParallelForFunc func, void *ctxt) {
+	MCL_ASSERT_VALID_PTR(pool);
+	MCL_ASSERT_VALID_PTR(func);
+	MCL_ASSERT_TRUE(begin <= end);
+
+	if (begin == end) return MCL_SUCCESS;
+
+	MclParallelJob job;
+	MclParallelJob_Init(&job, pool, MclParallel_GetGrain(pool, end - begin, grain), ctxt);
+	job.forFunc = func;
+	return MclParallel_Run(&job, begin, end);
+}
+
+MclStatus MclParallel_Reduce(MclThreadPool *pool, MclSize begin, MclSize end, MclSize grain,
+		                     MclSize valueSize, const void *identity,
+		                     MclParallelReduceFunc reduce, MclParallelJoinFunc join, void *ctxt, void *result) {
+	MCL_ASSERT_VALID_PTR(pool);
+	MCL_ASSERT_VALID_PTR(reduce);
+	MCL_ASSERT_VALID_PTR(join);
+	MCL_ASSERT_VALID_PTR(identity);
+	MCL_ASSERT_VALID_PTR(result);
+	MCL_ASSERT_TRUE(valueSize > 0);
+	MCL_ASSERT_TRUE(begin <= end);
+
+	if (begin == end) return MCL_SUCCESS;
+
+	MclParallelJob job;
+	MclParallelJob_Init(&job, pool, MclParallel_GetGrain(pool, end - begin, grain), ctxt);
+	job.reduceFunc = reduce;
+	job.joinFunc = join;
+	job.valueSize = valueSize;
+	job.identity = identity;
+	job.result = result;
+	MCL_ASSERT_SUCC_CALL(MclMutex_Init(&job.resultLock, NULL));
+
+	MclStatus ret = MclParallel_Run(&job, begin, end);
+	(void)MclMutex_Destroy(&job.resultLock);
+	return ret;
+}
@@ -0,0 +1,209 @@
+#include "mcl/task/strand.h"
+#include "mcl/task/task_scheduler.h"
+#include "mcl/task/task.h"
+#include "mcl/lock/mutex.h"
+#include "mcl/list/list.h"
+#include "mcl/map/hash_map.h"
+#include "mcl/algo/loop.h"
+#include "mcl/mem/memory.h"
+#include "mcl/assert.h"
+
+/* Tasks run by one dispatch of a lane, amortizes requeue without starving other keys */
+#define MCL_STRAND_LANE_BATCH 16
+
+#define MCL_STRAND_BUCKET_COUNT MCL_HASHMAP_BUCKET_COUNT_DEFAULT
+
+/* Lane of key is in lanes map exactly while it is queued or running in scheduler,
+ * or holds the tasks left by a failed submit, which the next submit of key queues again */
+MCL_TYPE(MclStrand) {
+	MclTaskScheduler *scheduler;
+	MclTaskPriority priority;
+	MclMutex mutex;
+	MclSize laneCount;
+	MclHashMap lanes;
+	MclHashBucket buckets[MCL_STRAND_BUCKET_COUNT];
+};
+
+typedef struct {
+	MclTask task;
+	MclStrand *strand;
+	MclList pending;
+	bool isQueued;
+	bool isExecuted;
+} MclStrandLane;
+
+/* IMPORTANT: SHOULD INVOKE WITH MUTEX LOCKED!!! */
+MCL_PRIVATE void MclStrand_RemoveLane(MclStrand *self, MclStrandLane *lane) {
+	(void)MclHashMap_Remove(&self->lanes, lane->task.key);
+	self->laneCount--;
+}
+
+MCL_PRIVATE void MclStrandLane_Delete(MclStrandLane *self) {
+	MclList_Clear(&self->pending, (MclListDataDestroy)MclTask_Destroy);
+	MCL_FREE(self);
+}
+
+MCL_PRIVATE void MclStrandLane_Drop(MclStrandLane *self) {
+	MclStrand *strand = self->strand;
+	{
+		MCL_LOCK_AUTO(strand->mutex);
+		MclStrand_RemoveLane(strand, self);
+	}
+	MCL_LOG_WARN("Strand lane of key (%u) dropped with %u tasks!", self->task.key, MclList_GetSize(&self->pending));
+	MclStrandLane_Delete(self);
+}
+
+MCL_PRIVATE MclTask* MclStrandLane_PopTask(MclStrandLane *self) {
+	MCL_LOCK_AUTO(self->strand->mutex);
+	return (MclTask*)MclList_RemoveFirst(&self->pending);
+}
+
+MCL_PRIVATE MclStatus MclStrandLane_Execute(MclTask *task) {
+	MclStrandLane *self = (MclStrandLane*)task;
+
+	self->isExecuted = true;
+	MCL_LOOP_FOREACH_INDEX(i, MCL_STRAND_LANE_BATCH) {
+		MclTask *inner = MclStrandLane_PopTask(self);
+		if (!inner) break;
+
+		MCL_PEEK_SUCC_CALL(MclTask_Execute(inner));
+		MclTask_Destroy(inner);
+	}
+	return MCL_SUCCESS;
+}
+
+/* Destroy is the last touch of the lane by the worker, so requeue happens here */
+MCL_PRIVATE void MclStrandLane_Destroy(MclTask *task) {
+	MclStrandLane *self = (MclStrandLane*)task;
+	MclStrand *strand = self->strand;
+
+	if (!self->isExecuted) {
+		MclStrandLane_Drop(self);
+		return;
+	}
+	{
+		MCL_LOCK_AUTO(strand->mutex);
+		if (MclList_IsEmpty(&self->pending)) {
+			MclStrand_RemoveLane(strand, self);
+			MCL_FREE(self);
+			return;
+		}
+		self->isExecuted = false;
+	}
+	if (MCL_FAILED(MclTaskScheduler_SubmitTask(strand->scheduler, &self->task, strand->priority))) {
+		MclStrandLane_Drop(self);
+	}
+}
+
+MCL_PRIVATE MclStrandLane* MclStrandLane_Create(MclStrand *strand, MclTaskKey key) {
+	MclStrandLane *self = MCL_MALLOC(sizeof(MclStrandLane));
+	MCL_ASSERT_VALID_PTR_NIL(self);
+
+	MclTask task = MCL_TASK(key, MclStrandLane_Execute, MclStrandLane_Destroy);
+	self->task = task;
+	self->strand = strand;
+	MclList_Init(&self->pending, &MclListNodeAllocator_Default);
+	self->isQueued = false;
+	self->isExecuted = false;
+	return self;
+}
+
+/* Returns the lane to be queued in scheduler if it is not queued yet */
+MCL_PRIVATE MclStatus MclStrand_Enqueue(MclStrand *self, MclTask *task, MclStrandLane **idleLane) {
+	MCL_LOCK_AUTO(self->mutex);
+
+	MclStrandLane *lane = (MclStrandLane*)MclHashMap_Get(&self->lanes, task->key);
+	if (!lane) {
+		lane = MclStrandLane_Create(self, task->key);
+		MCL_ASSERT_VALID_PTR(lane);
+
+		if (!MclHashMap_Set(&self->lanes, task->key, lane)) {
+			MCL_FREE(lane);
+			return MCL_FAILURE;
+		}
+		self->laneCount++;
+	}
+	if (!MclList_PushBack(&lane->pending, task)) {
+		if (!lane->isQueued && MclList_IsEmpty(&lane->pending)) {
+			MclStrand_RemoveLane(self, lane);
+			MCL_FREE(lane);
+		}
+		return MCL_FAILURE;
+	}
+	if (!lane->isQueued) {
+		lane->isQueued = true;
+		*idleLane = lane;
+	}
+	return MCL_SUCCESS;
+}
+
+/* Takes back only the task of caller, tasks of others wait in the lane for the next submit of key */
+MCL_PRIVATE void MclStrand_Unqueue(MclStrand *self, MclStrandLane *lane, MclTask *task) {
+	MCL_LOCK_AUTO(self->mutex);
+
+	(void)MclList_RemoveData(&lane->pending, task, NULL);
+	lane->isQueued = false;
+	if (!MclList_IsEmpty(&lane->pending)) return;
+
+	MclStrand_RemoveLane(self, lane);
+	MCL_FREE(lane);
+}
+
+MclStrand* MclStrand_Create(MclTaskScheduler *scheduler, MclTaskPriority priority) {
+	MCL_ASSERT_VALID_PTR_NIL(scheduler);
+
+	MclStrand *self = MCL_MALLOC(sizeof(MclStrand));
+	MCL_ASSERT_VALID_PTR_NIL(self);
+
+	if (MCL_FAILED(MclMutex_Init(&self->mutex, NULL))) {
+		MCL_LOG_ERR("Init mutex of strand failed!");
+		MCL_FREE(self);
+		return NULL;
+	}
+	self->scheduler = scheduler;
+	self->priority = priority;
+	self->laneCount = 0;
+	MclHashMap_InitGrowable(&self->lanes, self->buckets, MCL_STRAND_BUCKET_COUNT, &MclHashNodeAllocator_Default);
+	return self;
+}
+
+void MclStrand_Delete(MclStrand *self) {
+	MCL_ASSERT_VALID_PTR_VOID(self);
+	MCL_ASSERT_TRUE_VOID(MclStrand_GetBusyKeyCount(self) == 0);
+
+	MclHashMap_Destroy(&self->lanes, NULL);
+	MCL_PEEK_SUCC_CALL(MclMutex_Destroy(&self->mutex));
+	MCL_FREE(self);
+}
+
+MclStatus MclStrand_SubmitTask(MclStrand *self, MclTask *task) {
+	MCL_ASSERT_VALID_PTR(self);
+	MCL_ASSERT_VALID_PTR(task);
+
+	MclStrandLane *idleLane = NULL;
+	MCL_ASSERT_SUCC_CALL(MclStrand_Enqueue(self, task, &idleLane));
+	if (!idleLane) return MCL_SUCCESS;
+
+	if (MCL_FAILED(MclTaskScheduler_SubmitTask(self->scheduler, &idleLane->task, self->priority))) {
+		MCL_LOG_ERR("Submit strand lane of key (%u) failed!", task->key);
+		/* the task stays owned by caller on failure */
+		MclStrand_Unqueue(self, idleLane, task);
+		return MCL_FAILURE;
+	}
+	return MCL_SUCCESS;
+}
+
+MclSize MclStrand_GetPendingCount(const MclStrand *self, MclTaskKey key) {
+	MCL_ASSERT_VALID_PTR_R(self, 0);
+
+	MCL_LOCK_AUTO(self->mutex);
+	MclStrandLane *lane = (MclStrandLane*)MclHashMap_Get(&self->lanes, key);
+	return lane ? MclList_GetSize(&lane->pending) : 0;
+}
+
+MclSize MclStrand_GetBusyKeyCount(const MclStrand *self) {
+	MCL_ASSERT_VALID_PTR_R(self, 0);
+
+	MCL_LOCK_AUTO(self->mutex);
+	return self->laneCount;
+}
@@ -0,0 +1,122 @@
+#include "mcl/task/task_deque.h"
+#include "mcl/mem/memory.h"
+#include "mcl/algo/bit.h"
+#include "mcl/assert.h"
+
+/* top and bottom run freely, their distance is compared as signed value */
+MCL_PRIVATE int32_t MclTaskDeque_GetDiff(MclSize bottom, MclSize top) {
+    return (int32_t)(bottom - top);
+}
+
+MCL_PRIVATE MclTask** MclTaskDeque_GetSlot(MclTaskDeque *self, MclSize pos) {
+    return &self->tasks[pos & self->mask];
+}
+
+MclTaskDeque* MclTaskDeque_Create(MclSize capacity) {
+    MCL_ASSERT_TRUE_NIL(MCL_BIT_IS_POWER_OF_2(capacity));
+
+    MclTaskDeque *self = MCL_MALLOC(sizeof(MclTaskDeque));
+    MCL_ASSERT_VALID_PTR_NIL(self);
+
+    MclTask **buff = MCL_MALLOC(sizeof(MclTask*) * capacity);
+    if (!buff) {
+        MCL_LOG_ERR("Malloc buff for task deque failed!");
+        MCL_FREE(self);
+        return NULL;
+    }
+
+    if (MCL_FAILED(MclTaskDeque_Init(self, capacity, buff))) {
+        MCL_LOG_ERR("Init task deque failed!");
+        MCL_FREE(buff);
+        MCL_FREE(self);
+        return NULL;
+    }
+    return self;
+}
+
+void MclTaskDeque_Delete(MclTaskDeque *self) {
+    MCL_ASSERT_VALID_PTR_VOID(self);
+
+    if (self->tasks) MCL_FREE(self->tasks);
+    MCL_FREE(self);
+}
+
+MclStatus MclTaskDeque_Init(MclTaskDeque *self, MclSize capacity, MclTask** buff) {
+    MCL_ASSERT_VALID_PTR(self);
+    MCL_ASSERT_VALID_PTR(buff);
+    MCL_ASSERT_TRUE(MCL_BIT_IS_POWER_OF_2(capacity));
+
+    self->tasks = buff;
+    self->mask = capacity - 1;
+    MclAtomic_Clear(&self->top);
+    MclAtomic_Clear(&self->bottom);
+    return MCL_SUCCESS;
+}
+
+MclSize MclTaskDeque_GetCount(const MclTaskDeque *self) {
+    MCL_ASSERT_VALID_PTR_NIL(self);
+
+    MclSize top = MclAtomic_LoadAcquire(&self->top);
+    int32_t count = MclTaskDeque_GetDiff(MclAtomic_LoadAcquire(&self->bottom), top);
+    return (count > 0) ? (MclSize)count : 0;
+}
+
+bool MclTaskDeque_IsEmpty(const MclTaskDeque *self) {
+    MCL_ASSERT_VALID_PTR_R(self, true);
+    return MclTaskDeque_GetCount(self) == 0;
+}
+
+MclStatus MclTaskDeque_Push(MclTaskDeque *self, MclTask *task) {
+    MCL_ASSERT_VALID_PTR(self);
+    MCL_ASSERT_VALID_PTR(task);
+
+    MclSize bottom = MclAtomic_LoadRelaxed(&self->bottom);
+    MclSize top = MclAtomic_LoadAcquire(&self->top);
+    if (MclTaskDeque_GetDiff(bottom, top) >= (int32_t)MclTaskDeque_GetCapacity(self)) {
+        return MCL_FAILURE;
+    }
+
+    __atomic_store_n(MclTaskDeque_GetSlot(self, bottom), task, __ATOMIC_RELAXED);
+    MclAtomic_StoreRelease(&self->bottom, bottom + 1);
+    return MCL_SUCCESS;
+}
+
+MclTask* MclTaskDeque_Pop(MclTaskDeque *self) {
+    MCL_ASSERT_VALID_PTR_NIL(self);
+
+    MclSize bottom = MclAtomic_LoadRelaxed(&self->bottom) - 1;
+    MclAtomic_StoreRelaxed(&self->bottom, bottom);
+    MCL_ATOMIC_SYNC();
+    MclSize top = MclAtomic_LoadRelaxed(&self->top);
+
+    if (MclTaskDeque_GetDiff(bottom, top) < 0) {
+        MclAtomic_StoreRelaxed(&self->bottom, bottom + 1);
+        return NULL;
+    }
+
+    MclTask *task = __atomic_load_n(MclTaskDeque_GetSlot(self, bottom), __ATOMIC_RELAXED);
+    if (bottom != top) return task;
+
+    /* the last task, race with thieves by top */
+    if (!MclAtomic_CompareExchange(&self->top, &top, top + 1)) {
+        task = NULL;
+    }
+    MclAtomic_StoreRelaxed(&self->bottom, bottom + 1);
+    return task;
+}
+
+MclTask* MclTaskDeque_Steal(MclTaskDeque *self) {
+    MCL_ASSERT_VALID_PTR_NIL(self);
+
+    MclSize top = MclAtomic_LoadAcquire(&self->top);
+    MCL_ATOMIC_SYNC();
+    MclSize bottom = MclAtomic_LoadAcquire(&self->bottom);
+
+    if (MclTaskDeque_GetDiff(bottom, top) <= 0) return NULL;
+
+    MclTask *task = __atomic_load_n(MclTaskDeque_GetSlot(self, top), __ATOMIC_RELAXED);
+    if (!MclAtomic_CompareExchange(&self->top, &top, top + 1)) {
+        return NULL;
+    }
+    return task;
+}
@@ -0,0 +1,104 @@
+#include "mcl/task/task_future.h"
+#include "mcl/task/task_scheduler.h"
+#include "mcl/task/task.h"
+#include "mcl/mem/memory.h"
+#include "mcl/assert.h"
+
+typedef struct {
+	MclTask task;
+	MclFuture *future;
+	MclTaskCall call;
+	MclTaskThen then;
+	void *arg;
+	MclFuture *prev;
+	MclTaskScheduler *scheduler;
+	MclTaskPriority priority;
+	bool isDone;
+} MclFutureTask;
+
+/* Result goes to the future, task itself always succeeds */
+MCL_PRIVATE MclStatus MclFutureTask_Execute(MclTask *task) {
+	MclFutureTask *self = (MclFutureTask*)task;
+
+	void *value = NULL;
+	MclStatus status = MCL_UNINITIALIZED;
+	if (self->call) {
+		status = self->call(self->arg, &value);
+	} else {
+		MclStatus prevStatus = MCL_UNINITIALIZED;
+		void *prevValue = NULL;
+		MclFuture_Get(self->prev, &prevStatus, &prevValue);
+		status = self->then(prevStatus, prevValue, self->arg, &value);
+	}
+	self->isDone = true;
+	(void)MclFuture_Set(self->future, status, value);
+	return MCL_SUCCESS;
+}
+
+MCL_PRIVATE void MclFutureTask_Destroy(MclTask *task) {
+	MclFutureTask *self = (MclFutureTask*)task;
+
+	if (!self->isDone) MclFuture_Stop(self->future);
+	MCL_FREE(self);
+}
+
+MCL_PRIVATE MclFutureTask* MclFutureTask_Create(MclTaskScheduler *scheduler, MclTaskKey key, MclTaskPriority priority, void *arg) {
+	MclFutureTask *self = MCL_MALLOC(sizeof(MclFutureTask));
+	MCL_ASSERT_VALID_PTR_NIL(self);
+
+	self->future = MclFuture_Create();
+	if (!self->future) {
+		MCL_FREE(self);
+		return NULL;
+	}
+
+	MclTask task = MCL_TASK(key, MclFutureTask_Execute, MclFutureTask_Destroy);
+	self->task = task;
+	self->call = NULL;
+	self->then = NULL;
+	self->arg = arg;
+	self->prev = NULL;
+	self->scheduler = scheduler;
+	self->priority = priority;
+	self->isDone = false;
+	return self;
+}
+
+MCL_PRIVATE void MclFutureTask_Submit(MclFutureTask *self) {
+	if (MCL_FAILED(MclTaskScheduler_SubmitTask(self->scheduler, &self->task, self->priority))) {
+		MCL_LOG_ERR("Submit future task (%u) failed!", self->task.key);
+		MclFutureTask_Destroy(&self->task);
+	}
+}
+
+MclFuture* MclTaskScheduler_SubmitAsync(MclTaskScheduler *scheduler, MclTaskKey key, MclTaskPriority priority, MclTaskCall call, void *arg) {
+	MCL_ASSERT_VALID_PTR_NIL(scheduler);
+	MCL_ASSERT_VALID_PTR_NIL(call);
+
+	MclFutureTask *self = MclFutureTask_Create(scheduler, key, priority, arg);
+	MCL_ASSERT_VALID_PTR_NIL(self);
+
+	self->call = call;
+	MclFuture *future = self->future;
+	MclFutureTask_Submit(self);
+	return future;
+}
+
+MclFuture* MclTaskScheduler_Then(MclTaskScheduler *scheduler, MclFuture *prev, MclTaskKey key, MclTaskPriority priority, MclTaskThen then, void *arg) {
+	MCL_ASSERT_VALID_PTR_NIL(scheduler);
+	MCL_ASSERT_VALID_PTR_NIL(prev);
+	MCL_ASSERT_VALID_PTR_NIL(then);
+
+	MclFutureTask *self = MclFutureTask_Create(scheduler, key, priority, arg);
+	MCL_ASSERT_VALID_PTR_NIL(self);
+
+	self->then = then;
+	self->prev = prev;
+	MclFuture *future = self->future;
+	if (MCL_FAILED(MclTaskScheduler_SubmitOnReady(scheduler, &self->task, priority, prev))) {
+		MclFuture_Delete(future);
+		MCL_FREE(self);
+		return NULL;
+	}
+	return future;
+}
@@ -0,0 +1,145 @@
+#include "mcl/task/task_group.h"
+#include "mcl/task/task_scheduler.h"
+#include "mcl/task/task.h"
+#include "mcl/lock/atomic.h"
+#include "mcl/lock/event_count.h"
+#include "mcl/thread/thread.h"
+#include "mcl/mem/memory.h"
+#include "mcl/assert.h"
+
+MCL_TYPE(MclTaskGroup) {
+	MclTaskScheduler *scheduler;
+	MclAtomic submittedCount;
+	MclAtomic runningCount;
+	MclAtomic finishedCount;
+	MclAtomic notifyingCount;
+	MclEventCount allFinished;
+};
+
+typedef struct {
+	MclTask task;
+	MclTask *inner;
+	MclTaskGroup *group;
+} MclGroupTask;
+
+MCL_PRIVATE bool MclTaskGroup_IsFinished(const MclTaskGroup *self) {
+	return MclAtomic_LoadAcquire(&self->finishedCount) == MclAtomic_LoadAcquire(&self->submittedCount);
+}
+
+/* Notifying count keeps group alive until the last finisher leaves the event count */
+MCL_PRIVATE void MclTaskGroup_Finish(MclTaskGroup *self) {
+	MclAtomic_AddFetch(&self->notifyingCount, 1);
+	MclAtomic_AddFetch(&self->finishedCount, 1);
+	if (MclTaskGroup_IsFinished(self)) {
+		MclEventCount_NotifyAll(&self->allFinished);
+	}
+	MclAtomic_SubFetch(&self->notifyingCount, 1);
+}
+
+MCL_PRIVATE MclStatus MclGroupTask_Execute(MclTask *task) {
+	MclGroupTask *self = (MclGroupTask*)task;
+
+	MclAtomic_AddFetch(&self->group->runningCount, 1);
+	MclStatus ret = MclTask_Execute(self->inner);
+	MclAtomic_SubFetch(&self->group->runningCount, 1);
+	return ret;
+}
+
+MCL_PRIVATE void MclGroupTask_Destroy(MclTask *task) {
+	MclGroupTask *self = (MclGroupTask*)task;
+
+	MclTaskGroup *group = self->group;
+	MclTask_Destroy(self->inner);
+	MCL_FREE(self);
+	MclTaskGroup_Finish(group);
+}
+
+MCL_PRIVATE MclGroupTask* MclGroupTask_Create(MclTaskGroup *group, MclTask *inner) {
+	MclGroupTask *self = MCL_MALLOC(sizeof(MclGroupTask));
+	MCL_ASSERT_VALID_PTR_NIL(self);
+
+	MclTask task = MCL_TASK(inner->key, MclGroupTask_Execute, MclGroupTask_Destroy);
+	self->task = task;
+	self->inner = inner;
+	self->group = group;
+	return self;
+}
+
+MclTaskGroup* MclTaskGroup_Create(MclTaskScheduler *scheduler) {
+	MCL_ASSERT_VALID_PTR_NIL(scheduler);
+
+	MclTaskGroup *self = MCL_MALLOC(sizeof(MclTaskGroup));
+	MCL_ASSERT_VALID_PTR_NIL(self);
+
+	if (MCL_FAILED(MclEventCount_Init(&self->allFinished))) {
+		MCL_LOG_ERR("Init event count of task group failed!");
+		MCL_FREE(self);
+		return NULL;
+	}
+	self->scheduler = scheduler;
+	MclAtomic_Clear(&self->submittedCount);
+	MclAtomic_Clear(&self->runningCount);
+	MclAtomic_Clear(&self->finishedCount);
+	MclAtomic_Clear(&self->notifyingCount);
+	return self;
+}
+
+void MclTaskGroup_Delete(MclTaskGroup *self) {
+	MCL_ASSERT_VALID_PTR_VOID(self);
+	MCL_ASSERT_TRUE_VOID(MclTaskGroup_IsFinished(self));
+
+	while (MclAtomic_LoadAcquire(&self->notifyingCount) != 0) {
+		MclThread_Yield();
+	}
+	MclEventCount_Destroy(&self->allFinished);
+	MCL_FREE(self);
+}
+
+MclStatus MclTaskGroup_SubmitTask(MclTaskGroup *self, MclTask *task, MclTaskPriority priority) {
+	MCL_ASSERT_VALID_PTR(self);
+	MCL_ASSERT_VALID_PTR(task);
+
+	MclGroupTask *groupTask = MclGroupTask_Create(self, task);
+	MCL_ASSERT_VALID_PTR(groupTask);
+
+	/* Counted before submit, so a fast finisher never sees finished beyond submitted */
+	MclAtomic_AddFetch(&self->submittedCount, 1);
+	if (MCL_FAILED(MclTaskScheduler_SubmitTask(self->scheduler, &groupTask->task, priority))) {
+		MCL_LOG_ERR("Submit group task (%u) failed!", task->key);
+		MCL_FREE(groupTask);
+		MclAtomic_SubFetch(&self->submittedCount, 1);
+		return MCL_FAILURE;
+	}
+	return MCL_SUCCESS;
+}
+
+MclStatus MclTaskGroup_Wait(MclTaskGroup *self, MclTimeUs timeoutUs) {
+	MCL_ASSERT_VALID_PTR(self);
+
+	MclTimeUs deadline = MclEventCount_GetDeadline(timeoutUs);
+	while (true) {
+		MclSize key = MclEventCount_PrepareWait(&self->allFinished);
+		if (MclTaskGroup_IsFinished(self)) {
+			MclEventCount_CancelWait(&self->allFinished);
+			return MCL_SUCCESS;
+		}
+		if (MclEventCount_WaitUntil(&self->allFinished, key, deadline) == MCL_TIMEDOUT) {
+			return MclTaskGroup_IsFinished(self) ? MCL_SUCCESS : MCL_TIMEDOUT;
+		}
+	}
+}
+
+MclSize MclTaskGroup_GetSubmittedCount(const MclTaskGroup *self) {
+	MCL_ASSERT_VALID_PTR_NIL(self);
+	return MclAtomic_LoadAcquire(&self->submittedCount);
+}
+
+MclSize MclTaskGroup_GetRunningCount(const MclTaskGroup *self) {
+	MCL_ASSERT_VALID_PTR_NIL(self);
+	return MclAtomic_LoadAcquire(&self->runningCount);
+}
+
+MclSize MclTaskGroup_GetFinishedCount(const MclTaskGroup *self) {
+	MCL_ASSERT_VALID_PTR_NIL(self);
+	return MclAtomic_LoadAcquire(&self->finishedCount);
+}
@@ -1,42 +1,373 @@
 #include "mcl/task/task_queue.h"
 #include "mcl/lock/cond.h"
 #include "mcl/lock/atomic.h"
+#include "mcl/lock/event_count.h"
 #include "mcl/task/task.h"
-#include "mcl/list/list.h"
-#include "mcl/list/list_node_allocator.h"
+#include "mcl/link/link.h"
+#include "mcl/map/hash_map.h"
+#include "task_stats_hook.h"
 #include "mcl/mem/memory.h"
 #include "mcl/assert.h"
+#include <string.h>
+
+/* Nodes and key entries are recycled in the queue's pool, no heap allocation in steady state */
+#define MCL_TASK_QUEUE_NODE_PREALLOC 64
+#define MCL_TASK_QUEUE_KEY_PREALLOC 64
+
+#define MCL_TASK_QUEUE_INDEX_BUCKETS MCL_HASHMAP_BUCKET_COUNT_DEFAULT
+
+/* Deadline heap of a priority doubles from it, and is only allocated when more tasks are queued than ever before */
+#define MCL_TASK_QUEUE_HEAP_MIN 64
+
+/* WFQ pass advances by STRIDE / weight for each pop */
+#define MCL_TASK_QUEUE_WFQ_STRIDE (1u << 16)
+
+/*
+ * Each queued task has one node, held by the queue of its priority and,
+ * if its key is valid, linked in the list of its key in order of tasks. Index maps
+ * the key to its entry holding that list, so removal by key and pending
+ * lookup only touch the tasks of the key, and a popped node leaves its key
+ * in O(1) wherever it is in the list. Unkeyed tasks are never indexed, as
+ * they are never removed or looked up by key. The index grows its buckets
+ * with the keys, the entry goes back to the pool when its last task leaves.
+ * Under PRIORITY policy a queue links its nodes in FIFO order. Under EDF and
+ * WFQ policies it keeps them in a binary min heap of (deadline, push sequence),
+ * so push, pop and removal are O(log n) and tasks of one deadline stay FIFO.
+ * Node knows its heap slot, so removal by key takes it out of the heap directly.
+ */
+typedef struct TaskQueueKey TaskQueueKey;
+
+typedef struct TaskQueueNode {
+	MCL_LINK_NODE(struct TaskQueueNode) link;
+	MCL_LINK_NODE(struct TaskQueueNode) keyLink;
+	MclTask *task;
+	TaskQueueKey *key;
+	MclSize heapIndex;
+	uint64_t seq;
+} TaskQueueNode;
+
+typedef MCL_LINK(TaskQueueNode) TaskQueueLink;
+
+struct TaskQueueKey {
+	MclHashNode node;
+	TaskQueueLink nodes;
+	TaskQueueKey *nextFree;
+};
 
+/* NOT thread safe, used under the mutex of task queue */
 typedef struct {
-	MclList  tasks;
+	TaskQueueNode *freeNodes;
+	TaskQueueKey *freeKeys;
+} TaskQueuePool;
+
+MCL_PRIVATE void TaskQueuePool_RecycleNode(TaskQueuePool *pool, TaskQueueNode *node) {
+	node->link.next = pool->freeNodes;
+	pool->freeNodes = node;
+}
+
+MCL_PRIVATE void TaskQueuePool_RecycleKey(TaskQueuePool *pool, TaskQueueKey *entry) {
+	entry->nextFree = pool->freeKeys;
+	pool->freeKeys = entry;
+}
+
+MCL_PRIVATE void TaskQueuePool_Destroy(TaskQueuePool *pool) {
+	while (pool->freeNodes) {
+		TaskQueueNode *node = pool->freeNodes;
+		pool->freeNodes = node->link.next;
+		MCL_FREE(node);
+	}
+	while (pool->freeKeys) {
+		TaskQueueKey *entry = pool->freeKeys;
+		pool->freeKeys = entry->nextFree;
+		MCL_FREE(entry);
+	}
+}
+
+MCL_PRIVATE MclStatus TaskQueuePool_Init(TaskQueuePool *pool, MclSize nodeCount, MclSize keyCount) {
+	pool->freeNodes = NULL;
+	pool->freeKeys = NULL;
+	for (MclSize i = 0; i < nodeCount; i++) {
+		TaskQueueNode *node = MCL_MALLOC(sizeof(TaskQueueNode));
+		if (!node) {
+			TaskQueuePool_Destroy(pool);
+			return MCL_FAILURE;
+		}
+		TaskQueuePool_RecycleNode(pool, node);
+	}
+	for (MclSize i = 0; i < keyCount; i++) {
+		TaskQueueKey *entry = MCL_MALLOC(sizeof(TaskQueueKey));
+		if (!entry) {
+			TaskQueuePool_Destroy(pool);
+			return MCL_FAILURE;
+		}
+		TaskQueuePool_RecycleKey(pool, entry);
+	}
+	return MCL_SUCCESS;
+}
+
+/* Heap is only touched when more tasks are queued than ever before */
+MCL_PRIVATE TaskQueueNode* TaskQueuePool_AllocNode(TaskQueuePool *pool, MclTask *task) {
+	TaskQueueNode *node = pool->freeNodes;
+	if (node) {
+		pool->freeNodes = node->link.next;
+	} else {
+		node = MCL_MALLOC(sizeof(TaskQueueNode));
+		MCL_ASSERT_VALID_PTR_NIL(node);
+	}
+	node->link.next = node->link.prev = NULL;
+	node->keyLink.next = node->keyLink.prev = NULL;
+	node->task = task;
+	node->key = NULL;
+	node->heapIndex = 0;
+	node->seq = 0;
+	return node;
+}
+
+/* Heap is only touched when more keys are queued than ever before */
+MCL_PRIVATE TaskQueueKey* TaskQueuePool_AllocKey(TaskQueuePool *pool, MclTaskKey key) {
+	TaskQueueKey *entry = pool->freeKeys;
+	if (entry) {
+		pool->freeKeys = entry->nextFree;
+	} else {
+		entry = MCL_MALLOC(sizeof(TaskQueueKey));
+		MCL_ASSERT_VALID_PTR_NIL(entry);
+	}
+	MclHashNode_Init(&entry->node, key, entry);
+	MCL_LINK_INIT(&entry->nodes, TaskQueueNode, keyLink);
+	entry->nextFree = NULL;
+	return entry;
+}
+
+typedef struct {
+	TaskQueueLink tasks;
+	TaskQueueNode **heap;
+	MclSize heapSize;
+	MclSize heapCapacity;
+	uint64_t seq;
+	bool isOrdered;
+	MclAtomic count;
+	TaskQueuePool *pool;
+	MclHashMap index;
+	MclHashBucket buckets[MCL_TASK_QUEUE_INDEX_BUCKETS];
 	MclSize threshold;
 	MclSize poppedCount;
+	MclTimeUs budgetUs;
+	uint64_t stride;
+	uint64_t pass;
 } TaskQueue;
 
-MCL_PRIVATE void TaskQueue_Init(TaskQueue *queue, MclSize threshold) {
-	MclList_Init(&queue->tasks, &MclListNodeAllocator_Default);
+MCL_PRIVATE void TaskQueue_Init(TaskQueue *queue, MclSize threshold, TaskQueuePool *pool) {
+	MCL_LINK_INIT(&queue->tasks, TaskQueueNode, link);
+	queue->heap = NULL;
+	queue->heapSize = 0;
+	queue->heapCapacity = 0;
+	queue->seq = 0;
+	queue->isOrdered = false;
+	MclAtomic_Clear(&queue->count);
+	queue->pool = pool;
+	MclHashMap_InitGrowable(&queue->index, queue->buckets, MCL_TASK_QUEUE_INDEX_BUCKETS, NULL);
 	queue->threshold = threshold;
 	queue->poppedCount = 0;
+	queue->budgetUs = MCL_TIME_US_INVALID;
+	queue->stride = 0;
+	queue->pass = 0;
 }
 
-MCL_PRIVATE void TaskQueue_Destroy(TaskQueue *queue) {
-	MclList_Clear(&queue->tasks, (MclListDataDestroy)MclTask_Destroy);
+MCL_PRIVATE bool TaskQueueNode_IsBefore(const TaskQueueNode *node, const TaskQueueNode *other) {
+	if (node->task->deadlineUs != other->task->deadlineUs) {
+		return node->task->deadlineUs < other->task->deadlineUs;
+	}
+	return node->seq < other->seq;
+}
+
+MCL_PRIVATE void TaskQueue_HeapPlace(TaskQueue *queue, MclSize index, TaskQueueNode *node) {
+	queue->heap[index] = node;
+	node->heapIndex = index;
+}
+
+MCL_PRIVATE void TaskQueue_HeapSiftUp(TaskQueue *queue, TaskQueueNode *node) {
+	MclSize index = node->heapIndex;
+	while (index > 0) {
+		MclSize parent = (index - 1) / 2;
+		if (!TaskQueueNode_IsBefore(node, queue->heap[parent])) break;
+		TaskQueue_HeapPlace(queue, index, queue->heap[parent]);
+		index = parent;
+	}
+	TaskQueue_HeapPlace(queue, index, node);
+}
+
+MCL_PRIVATE void TaskQueue_HeapSiftDown(TaskQueue *queue, TaskQueueNode *node) {
+	MclSize index = node->heapIndex;
+	while (true) {
+		MclSize child = index * 2 + 1;
+		if (child >= queue->heapSize) break;
+		if ((child + 1 < queue->heapSize) && TaskQueueNode_IsBefore(queue->heap[child + 1], queue->heap[child])) {
+			child++;
+		}
+		if (!TaskQueueNode_IsBefore(queue->heap[child], node)) break;
+		TaskQueue_HeapPlace(queue, index, queue->heap[child]);
+		index = child;
+	}
+	TaskQueue_HeapPlace(queue, index, node);
+}
+
+MCL_PRIVATE MclStatus TaskQueue_HeapGrow(TaskQueue *queue) {
+	MclSize capacity = queue->heapCapacity ? queue->heapCapacity * 2 : MCL_TASK_QUEUE_HEAP_MIN;
+	TaskQueueNode **heap = MCL_MALLOC(sizeof(TaskQueueNode*) * capacity);
+	MCL_ASSERT_VALID_PTR(heap);
+
+	if (queue->heap) {
+		memcpy(heap, queue->heap, sizeof(TaskQueueNode*) * queue->heapSize);
+		MCL_FREE(queue->heap);
+	}
+	queue->heap = heap;
+	queue->heapCapacity = capacity;
+	return MCL_SUCCESS;
+}
+
+MCL_PRIVATE MclStatus TaskQueue_HeapPush(TaskQueue *queue, TaskQueueNode *node) {
+	if (queue->heapSize == queue->heapCapacity) {
+		MCL_ASSERT_SUCC_CALL(TaskQueue_HeapGrow(queue));
+	}
+	node->seq = queue->seq++;
+	node->heapIndex = queue->heapSize++;
+	TaskQueue_HeapSiftUp(queue, node);
+	return MCL_SUCCESS;
+}
+
+/* The last node fills the hole, then goes up or down from it */
+MCL_PRIVATE void TaskQueue_HeapRemove(TaskQueue *queue, TaskQueueNode *node) {
+	TaskQueueNode *last = queue->heap[--queue->heapSize];
+	if (last == node) return;
+
+	last->heapIndex = node->heapIndex;
+	TaskQueue_HeapSiftUp(queue, last);
+	TaskQueue_HeapSiftDown(queue, last);
+}
+
+MCL_PRIVATE TaskQueueNode* TaskQueue_GetFirst(const TaskQueue *queue) {
+	if (queue->isOrdered) return queue->heapSize ? queue->heap[0] : NULL;
+
+	TaskQueueNode *node = MCL_LINK_FIRST(&queue->tasks);
+	return (node == MCL_LINK_SENTINEL(&queue->tasks, TaskQueueNode, link)) ? NULL : node;
+}
+
+MCL_PRIVATE void TaskQueue_DetachNode(TaskQueue *queue, TaskQueueNode *node) {
+	if (queue->isOrdered) {
+		TaskQueue_HeapRemove(queue, node);
+	} else {
+		MCL_LINK_REMOVE(node, link);
+	}
 }
 
-MCL_PRIVATE bool MclTaskKeyPred_IsEqual(MclListData data, void *arg) {
-	return ((MclTask*)data)->key == *(MclTaskKey*)arg;
+MCL_PRIVATE TaskQueueKey* TaskQueue_GetKey(const TaskQueue *queue, MclTaskKey key) {
+	return (TaskQueueKey*)MclHashMap_FindNode(&queue->index, key);
 }
 
-MCL_PRIVATE void TaskQueue_Remove(TaskQueue *queue, MclTaskKey key) {
-	MclList_RemoveAllByPred(&queue->tasks, MclTaskKeyPred_IsEqual, &key, (MclListDataDestroy)MclTask_Destroy);
+MCL_PRIVATE void TaskQueue_ReleaseKey(TaskQueue *queue, TaskQueueKey *entry) {
+	(void)MclHashMap_RemoveNode(&queue->index, &entry->node, NULL);
+	TaskQueuePool_RecycleKey(queue->pool, entry);
+}
+
+MCL_PRIVATE MclStatus TaskQueue_IndexNode(TaskQueue *queue, TaskQueueNode *node) {
+	MclTaskKey key = node->task->key;
+	if (!MclTaskKey_IsValid(key)) return MCL_SUCCESS;
+
+	TaskQueueKey *entry = TaskQueue_GetKey(queue, key);
+	if (!entry) {
+		entry = TaskQueuePool_AllocKey(queue->pool, key);
+		MCL_ASSERT_VALID_PTR(entry);
+
+		if (MCL_FAILED(MclHashMap_InsertNode(&queue->index, &entry->node))) {
+			TaskQueuePool_RecycleKey(queue->pool, entry);
+			return MCL_FAILURE;
+		}
+	}
+	MCL_LINK_INSERT_TAIL(&entry->nodes, node, TaskQueueNode, keyLink);
+	node->key = entry;
+	return MCL_SUCCESS;
+}
+
+MCL_PRIVATE void TaskQueue_UnindexNode(TaskQueue *queue, TaskQueueNode *node) {
+	TaskQueueKey *entry = node->key;
+	if (!entry) return;
+
+	MCL_LINK_REMOVE(node, keyLink);
+	node->key = NULL;
+	if (MCL_LINK_EMPTY(&entry->nodes, TaskQueueNode, keyLink)) TaskQueue_ReleaseKey(queue, entry);
+}
+
+/* Task is destroyed under the mutex of task queue, as it was by the list before */
+MCL_PRIVATE MclSize TaskQueue_Remove(TaskQueue *queue, MclTaskKey key) {
+	TaskQueueKey *entry = TaskQueue_GetKey(queue, key);
+	if (!entry) return 0;
+
+	MclSize removedCount = 0;
+	while (!MCL_LINK_EMPTY(&entry->nodes, TaskQueueNode, keyLink)) {
+		TaskQueueNode *node = MCL_LINK_FIRST(&entry->nodes);
+		MCL_LINK_REMOVE(node, keyLink);
+		TaskQueue_DetachNode(queue, node);
+		MclTask_Destroy(node->task);
+		TaskQueuePool_RecycleNode(queue->pool, node);
+		removedCount++;
+	}
+	TaskQueue_ReleaseKey(queue, entry);
+	MclAtomic_FetchSub(&queue->count, removedCount);
+	return removedCount;
+}
+
+/* Only at destroy, the entry is freed instead of recycled as the pool goes soon */
+MCL_PRIVATE void TaskQueue_DeleteKey(MclHashValue value) {
+	TaskQueueKey *entry = (TaskQueueKey*)value;
+	MCL_FREE(entry);
+}
+
+MCL_PRIVATE void TaskQueue_Destroy(TaskQueue *queue) {
+	MclHashMap_Destroy(&queue->index, TaskQueue_DeleteKey);
+	TaskQueueNode *node = NULL;
+	while ((node = TaskQueue_GetFirst(queue))) {
+		TaskQueue_DetachNode(queue, node);
+		MclTask_Destroy(node->task);
+		TaskQueuePool_RecycleNode(queue->pool, node);
+	}
+	if (queue->heap) MCL_FREE(queue->heap);
+	queue->heap = NULL;
+	queue->heapCapacity = 0;
+	MclAtomic_Clear(&queue->count);
+}
+
+MCL_PRIVATE bool TaskQueue_HasKey(const TaskQueue *queue, MclTaskKey key) {
+	return TaskQueue_GetKey(queue, key) != NULL;
 }
 
 MCL_PRIVATE bool TaskQueue_IsEmpty(const TaskQueue *queue) {
-	return MclList_IsEmpty(&queue->tasks);
+	return TaskQueue_GetFirst(queue) == NULL;
 }
 
-MCL_PRIVATE void TaskQueue_Push(TaskQueue *queue, MclTask *task) {
-	MclList_PushBack(&queue->tasks, task);
+MCL_PRIVATE MclTask* TaskQueue_Peek(const TaskQueue *queue) {
+	TaskQueueNode *node = TaskQueue_GetFirst(queue);
+	return node ? node->task : NULL;
+}
+
+MCL_PRIVATE MclStatus TaskQueue_Push(TaskQueue *queue, MclTask *task) {
+	TaskQueueNode *node = TaskQueuePool_AllocNode(queue->pool, task);
+	MCL_ASSERT_VALID_PTR(node);
+
+	if (MCL_FAILED(TaskQueue_IndexNode(queue, node))) {
+		TaskQueuePool_RecycleNode(queue->pool, node);
+		return MCL_FAILURE;
+	}
+	if (queue->isOrdered) {
+		if (MCL_FAILED(TaskQueue_HeapPush(queue, node))) {
+			TaskQueue_UnindexNode(queue, node);
+			TaskQueuePool_RecycleNode(queue->pool, node);
+			return MCL_FAILURE;
+		}
+	} else {
+		MCL_LINK_INSERT_TAIL(&queue->tasks, node, TaskQueueNode, link);
+	}
+	MclAtomic_FetchAdd(&queue->count, 1);
+	return MCL_SUCCESS;
 }
 
 MCL_PRIVATE bool TaskQueue_IsReachThreshold(const TaskQueue *queue) {
@@ -48,12 +379,20 @@ MCL_PRIVATE void TaskQueue_ResetPoppedCount(TaskQueue *queue) {
 	queue->poppedCount = 0;
 }
 
-MCL_PRIVATE MclTask* TaskQueue_Pop(TaskQueue *queue) {
-	if (MclList_IsEmpty(&queue->tasks)) return NULL;
-
-	MclTask *task = (MclTask*)MclList_RemoveFirst(&queue->tasks);
-	if (!task) return NULL;
+MCL_PRIVATE MclTimeUs TaskQueue_GetFirstDeadline(const TaskQueue *queue) {
+	MclTask *task = TaskQueue_Peek(queue);
+	return task ? task->deadlineUs : MCL_TIME_US_INVALID;
+}
 
+MCL_PRIVATE MclTask* TaskQueue_Pop(TaskQueue *queue) {
+	TaskQueueNode *node = TaskQueue_GetFirst(queue);
+	if (!node) return NULL;
+
+	MclTask *task = node->task;
+	TaskQueue_DetachNode(queue, node);
+	TaskQueue_UnindexNode(queue, node);
+	TaskQueuePool_RecycleNode(queue->pool, node);
+	MclAtomic_FetchSub(&queue->count, 1);
 	queue->poppedCount += 1;
 	return task;
 }
@@ -61,8 +400,15 @@ MCL_PRIVATE MclTask* TaskQueue_Pop(TaskQueue *queue) {
 ///////////////////////////////////////////////////////////
 MCL_TYPE(MclTaskQueue) {
 	MclAtomic  isRunning;
+	MclAtomic  taskCount;
 	MclMutex mutex;
 	MclCond   cond;
+	TaskQueuePool pool;
+	MclTaskPolicyType policy;
+	uint64_t virtualPass;
+#ifdef MCL_TASK_STATS_ENABLED
+	MclTaskStats *stats;
+#endif
 	MclSize queueCount;
 	TaskQueue queues[];
 };
@@ -80,16 +426,95 @@ MCL_PRIVATE void MclTaskQueue_WaitReady(MclTaskQueue *self) {
     }
 }
 
-MCL_PRIVATE MclTask* MclTaskQueue_PopTaskImpl(MclTaskQueue *self) {
+MCL_PRIVATE bool MclTaskQueue_IsOrdered(const MclTaskQueue *self) {
+    return self->policy != MCL_TASK_POLICY_PRIORITY;
+}
+
+MCL_PRIVATE MclTimeUs MclTaskQueue_GetNowUs() {
+    return MclEventCount_GetDeadline(0);
+}
+
+/* Relative deadline, MCL_TIME_US_INVALID takes the budget of the priority */
+MCL_PRIVATE void MclTaskQueue_StampDeadline(MclTaskQueue *self, MclTask *task, MclTaskPriority priority,
+        MclTimeUs deadlineUs, MclTimeUs nowUs) {
+    if (!MclTimeUs_IsValid(deadlineUs)) deadlineUs = self->queues[priority].budgetUs;
+    task->deadlineUs = MclTimeUs_IsValid(deadlineUs) ? nowUs + deadlineUs : MCL_TIME_US_INVALID;
+}
+
+/* Fresh WFQ priority starts from the pass of the last pop, never spends credits saved while empty */
+MCL_PRIVATE MclStatus MclTaskQueue_Push(MclTaskQueue *self, MclTask *task, MclTaskPriority priority) {
+    TaskQueue *queue = &self->queues[priority];
+    if (TaskQueue_IsEmpty(queue) && queue->pass < self->virtualPass) {
+        queue->pass = self->virtualPass;
+    }
+    return TaskQueue_Push(queue, task);
+}
+
+MCL_PRIVATE MclSize MclTaskQueue_SelectByThreshold(MclTaskQueue *self) {
     for (MclSize i = 0; i < self->queueCount; i++) {
         if (TaskQueue_IsEmpty(&self->queues[i])) continue;
         if (TaskQueue_IsReachThreshold(&self->queues[i])) {
             TaskQueue_ResetPoppedCount(&self->queues[i]);
+            MCL_TASK_STATS_ON_THRESHOLD_SKIP(self->stats, i);
             continue;
         }
-        return TaskQueue_Pop(&self->queues[i]);
+        return i;
+    }
+    return self->queueCount;
+}
+
+/* Earliest first deadline no later than limit, the higher priority wins a tie */
+MCL_PRIVATE MclSize MclTaskQueue_SelectEarliest(MclTaskQueue *self, MclTimeUs limitUs) {
+    MclSize selected = self->queueCount;
+    MclTimeUs earliest = limitUs;
+    for (MclSize i = 0; i < self->queueCount; i++) {
+        if (TaskQueue_IsEmpty(&self->queues[i])) continue;
+
+        MclTimeUs deadline = TaskQueue_GetFirstDeadline(&self->queues[i]);
+        if (selected == self->queueCount ? (deadline <= earliest) : (deadline < earliest)) {
+            selected = i;
+            earliest = deadline;
+        }
+    }
+    return selected;
+}
+
+MCL_PRIVATE MclSize MclTaskQueue_SelectFair(MclTaskQueue *self) {
+    MclSize selected = MclTaskQueue_SelectEarliest(self, MclTaskQueue_GetNowUs());
+    if (selected == self->queueCount) {
+        for (MclSize i = 0; i < self->queueCount; i++) {
+            if (TaskQueue_IsEmpty(&self->queues[i])) continue;
+            if ((selected == self->queueCount) || (self->queues[i].pass < self->queues[selected].pass)) {
+                selected = i;
+            }
+        }
+    }
+    if (selected == self->queueCount) return selected;
+
+    self->virtualPass = self->queues[selected].pass;
+    self->queues[selected].pass += self->queues[selected].stride;
+    return selected;
+}
+
+MCL_PRIVATE MclSize MclTaskQueue_Select(MclTaskQueue *self) {
+    switch (self->policy) {
+    case MCL_TASK_POLICY_EDF:
+        return MclTaskQueue_SelectEarliest(self, MCL_TIME_US_INVALID);
+    case MCL_TASK_POLICY_WFQ:
+        return MclTaskQueue_SelectFair(self);
+    default:
+        return MclTaskQueue_SelectByThreshold(self);
     }
-    return NULL;
+}
+
+MCL_PRIVATE MclTask* MclTaskQueue_PopTaskImpl(MclTaskQueue *self, MclTaskPriority *priority) {
+    MclSize i = MclTaskQueue_Select(self);
+    if (i >= self->queueCount) return NULL;
+
+    MclTask *task = TaskQueue_Pop(&self->queues[i]);
+    if (task) MclAtomic_FetchSub(&self->taskCount, 1);
+    if (priority) *priority = i;
+    return task;
 }
 
 MCL_PRIVATE void MclTaskQueue_DestroyQueues(MclTaskQueue *self) {
@@ -102,6 +527,12 @@ MCL_PRIVATE void MclTaskQueue_DestroyQueues(MclTaskQueue *self) {
 MCL_PRIVATE void  MclTaskQueue_Destroy(MclTaskQueue *self) {
     MclAtomic_Clear(&self->isRunning);
     MclTaskQueue_DestroyQueues(self);
+    TaskQueuePool_Destroy(&self->pool);
+#ifdef MCL_TASK_STATS_ENABLED
+    MclTaskStats_Delete(self->stats);
+    self->stats = NULL;
+#endif
+    MclAtomic_Clear(&self->taskCount);
     MCL_PEEK_SUCC_CALL(MclMutex_Destroy(&self->mutex));
     MCL_PEEK_SUCC_CALL(MclCond_Destroy(&self->cond));
 }
@@ -110,11 +541,27 @@ MCL_PRIVATE void MclTaskQueue_InitQueues(MclTaskQueue *self, MclSize priorities,
 	self->queueCount = priorities;
 	for (MclSize i = 0; i < priorities; i++) {
 		MclSize threshold = ((thresholds == NULL) || (i + 1 >= priorities)) ? 0 : thresholds[i];
-		TaskQueue_Init(&self->queues[i], threshold);
+		TaskQueue_Init(&self->queues[i], threshold, &self->pool);
+	}
+}
+
+/* Thresholds only work for PRIORITY policy, the others never starve any priority */
+MCL_PRIVATE void MclTaskQueue_InitPolicy(MclTaskQueue *self, const MclTaskPolicy *policy) {
+	self->policy = policy ? policy->type : MCL_TASK_POLICY_PRIORITY;
+	self->virtualPass = 0;
+	if (!policy) return;
+
+	for (MclSize i = 0; i < self->queueCount; i++) {
+		TaskQueue *queue = &self->queues[i];
+		MclSize weight = policy->weights ? policy->weights[i] : self->queueCount - i;
+		queue->stride = MCL_TASK_QUEUE_WFQ_STRIDE / (weight ? weight : 1);
+		queue->budgetUs = policy->budgetsUs ? policy->budgetsUs[i] : MCL_TIME_US_INVALID;
+		queue->isOrdered = MclTaskQueue_IsOrdered(self);
+		if (queue->isOrdered) queue->threshold = 0;
 	}
 }
 
-MCL_PRIVATE MclStatus MclTaskQueue_Init(MclTaskQueue *self, MclSize priorities, MclSize *thresholds) {
+MCL_PRIVATE MclStatus MclTaskQueue_Init(MclTaskQueue *self, MclSize priorities, MclSize *thresholds, const MclTaskPolicy *policy) {
 	if (MCL_FAILED(MclMutex_Init(&self->mutex, NULL))) {
 		MCL_LOG_ERR("Init mutex failed!");
 		return MCL_FAILURE;
@@ -124,24 +571,51 @@ MCL_PRIVATE MclStatus MclTaskQueue_Init(MclTaskQueue *self, MclSize priorities,
         (void)MclMutex_Destroy(&self->mutex);
 		return MCL_FAILURE;
 	}
+	if (MCL_FAILED(TaskQueuePool_Init(&self->pool, MCL_TASK_QUEUE_NODE_PREALLOC, MCL_TASK_QUEUE_KEY_PREALLOC))) {
+		MCL_LOG_ERR("Init node pool failed!");
+        (void)MclCond_Destroy(&self->cond);
+        (void)MclMutex_Destroy(&self->mutex);
+		return MCL_FAILURE;
+	}
+#ifdef MCL_TASK_STATS_ENABLED
+	self->stats = MclTaskStats_Create(priorities);
+	if (!self->stats) {
+		MCL_LOG_ERR("Create task stats failed!");
+        TaskQueuePool_Destroy(&self->pool);
+        (void)MclCond_Destroy(&self->cond);
+        (void)MclMutex_Destroy(&self->mutex);
+		return MCL_FAILURE;
+	}
+#endif
     MclTaskQueue_InitQueues(self, priorities, thresholds);
+    MclTaskQueue_InitPolicy(self, policy);
     MclAtomic_Clear(&self->isRunning);
+    MclAtomic_Clear(&self->taskCount);
     return MCL_SUCCESS;
 }
 
-MclTaskQueue* MclTaskQueue_Create(MclSize priorities, MclSize *thresholds) {
+MCL_PRIVATE MclTaskQueue* MclTaskQueue_CreateImpl(MclSize priorities, MclSize *thresholds, const MclTaskPolicy *policy) {
 	MCL_ASSERT_TRUE_NIL(priorities > 0);
 
 	MclTaskQueue *self = MCL_MALLOC(sizeof(MclTaskQueue) + sizeof(TaskQueue) * priorities);
 	MCL_ASSERT_VALID_PTR_NIL(self);
 
-	if (MCL_FAILED(MclTaskQueue_Init(self, priorities, thresholds))) {
+	if (MCL_FAILED(MclTaskQueue_Init(self, priorities, thresholds, policy))) {
 		MCL_FREE(self);
 		return NULL;
 	}
 	return self;
 }
 
+MclTaskQueue* MclTaskQueue_Create(MclSize priorities, MclSize *thresholds) {
+	return MclTaskQueue_CreateImpl(priorities, thresholds, NULL);
+}
+
+MclTaskQueue* MclTaskQueue_CreateWithPolicy(MclSize priorities, const MclTaskPolicy *policy) {
+	MCL_ASSERT_VALID_PTR_NIL(policy);
+	return MclTaskQueue_CreateImpl(priorities, NULL, policy);
+}
+
 /* IMPORTANT: SHOULD INVOKE AFTER ALL CONSUMER THREADS STOPPED!!! */
 void MclTaskQueue_Delete(MclTaskQueue *self) {
 	MCL_ASSERT_VALID_PTR_VOID(self);
@@ -167,23 +641,90 @@ bool MclTaskQueue_IsRunning(const MclTaskQueue *self) {
 
 bool MclTaskQueue_IsEmpty(const MclTaskQueue *self) {
     MCL_ASSERT_VALID_PTR_R(self, true);
+    return MclAtomic_LoadAcquire(&self->taskCount) == 0;
+}
 
-    MCL_LOCK_AUTO(self->mutex);
-    return MclTaskQueue_IsEmptyImpl(self);
+MclSize MclTaskQueue_GetCount(const MclTaskQueue *self) {
+    MCL_ASSERT_VALID_PTR_R(self, 0);
+    return MclAtomic_LoadAcquire(&self->taskCount);
+}
+
+MclTaskStats* MclTaskQueue_GetStats(MclTaskQueue *self) {
+    MCL_ASSERT_VALID_PTR_NIL(self);
+#ifdef MCL_TASK_STATS_ENABLED
+    return self->stats;
+#else
+    return NULL;
+#endif
+}
+
+MclTaskPolicyType MclTaskQueue_GetPolicy(const MclTaskQueue *self) {
+    MCL_ASSERT_VALID_PTR_R(self, MCL_TASK_POLICY_PRIORITY);
+    return self->policy;
+}
+
+MclSize MclTaskQueue_GetPriorities(const MclTaskQueue *self) {
+    MCL_ASSERT_VALID_PTR_NIL(self);
+    return self->queueCount;
+}
+
+MclTaskPriority MclTaskQueue_GetTopPriority(const MclTaskQueue *self) {
+    MCL_ASSERT_VALID_PTR_NIL(self);
+
+    for (MclSize i = 0; i < self->queueCount; i++) {
+        if (MclAtomic_LoadAcquire(&self->queues[i].count) > 0) return i;
+    }
+    return self->queueCount;
+}
+
+MclSize MclTaskQueue_GetThreshold(const MclTaskQueue *self, MclTaskPriority priority) {
+    MCL_ASSERT_VALID_PTR_NIL(self);
+    MCL_ASSERT_TRUE_NIL(priority < self->queueCount);
+    return self->queues[priority].threshold;
 }
 
 MclStatus MclTaskQueue_AddTask(MclTaskQueue *self, MclTask *task, MclTaskPriority priority) {
+	return MclTaskQueue_AddTaskWithDeadline(self, task, priority, MCL_TIME_US_INVALID);
+}
+
+MclStatus MclTaskQueue_AddTaskWithDeadline(MclTaskQueue *self, MclTask *task, MclTaskPriority priority, MclTimeUs deadlineUs) {
 	MCL_ASSERT_VALID_PTR(self);
 	MCL_ASSERT_VALID_PTR(task);
 	MCL_ASSERT_TRUE(priority < self->queueCount);
 
+	MclTimeUs nowUs = MclTaskQueue_IsOrdered(self) ? MclTaskQueue_GetNowUs() : 0;
+	MclTaskQueue_StampDeadline(self, task, priority, deadlineUs, nowUs);
+
 	MCL_LOCK_AUTO(self->mutex);
 
-	TaskQueue_Push(&self->queues[priority], task);
+	MCL_ASSERT_SUCC_CALL(MclTaskQueue_Push(self, task, priority));
+	MclAtomic_FetchAdd(&self->taskCount, 1);
 	MclCond_Signal(&self->cond);
 	return MCL_SUCCESS;
 }
 
+MclSize MclTaskQueue_AddTasks(MclTaskQueue *self, MclTask **tasks, MclSize count, MclTaskPriority priority) {
+	MCL_ASSERT_VALID_PTR_R(self, 0);
+	MCL_ASSERT_TRUE_R(count == 0 || tasks != NULL, 0);
+	MCL_ASSERT_TRUE_R(priority < self->queueCount, 0);
+
+	MclTimeUs nowUs = MclTaskQueue_IsOrdered(self) ? MclTaskQueue_GetNowUs() : 0;
+
+	MCL_LOCK_AUTO(self->mutex);
+
+	MclSize added = 0;
+	while (added < count) {
+		if (!tasks[added]) break;
+
+		MclTaskQueue_StampDeadline(self, tasks[added], priority, MCL_TIME_US_INVALID, nowUs);
+		if (MCL_FAILED(MclTaskQueue_Push(self, tasks[added], priority))) break;
+		added++;
+	}
+	MclAtomic_FetchAdd(&self->taskCount, added);
+	if (added > 0) MclCond_Broadcast(&self->cond);
+	return added;
+}
+
 MclStatus MclTaskQueue_DelTask(MclTaskQueue *self, MclTaskKey key, MclTaskPriority priority) {
 	MCL_ASSERT_VALID_PTR(self);
 	MCL_ASSERT_TRUE(MclTaskKey_IsValid(key));
@@ -191,15 +732,112 @@ MclStatus MclTaskQueue_DelTask(MclTaskQueue *self, MclTaskKey key, MclTaskPriori
 
 	MCL_LOCK_AUTO(self->mutex);
 
-	TaskQueue_Remove(&self->queues[priority], key);
+	MclSize removedCount = TaskQueue_Remove(&self->queues[priority], key);
+	MclAtomic_FetchSub(&self->taskCount, removedCount);
+	MCL_TASK_STATS_ON_CANCEL(self->stats, priority, removedCount);
 	return MCL_SUCCESS;
 }
 
+MclStatus MclTaskQueue_ReplaceTask(MclTaskQueue *self, MclTask *task, MclTaskPriority priority) {
+	MCL_ASSERT_VALID_PTR(self);
+	MCL_ASSERT_VALID_PTR(task);
+	MCL_ASSERT_TRUE(priority < self->queueCount);
+
+	MclTimeUs nowUs = MclTaskQueue_IsOrdered(self) ? MclTaskQueue_GetNowUs() : 0;
+	MclTaskQueue_StampDeadline(self, task, priority, MCL_TIME_US_INVALID, nowUs);
+
+	MCL_LOCK_AUTO(self->mutex);
+
+	MclSize removedCount = TaskQueue_Remove(&self->queues[priority], task->key);
+	MclAtomic_FetchSub(&self->taskCount, removedCount);
+	MCL_TASK_STATS_ON_CANCEL(self->stats, priority, removedCount);
+	MCL_ASSERT_SUCC_CALL(MclTaskQueue_Push(self, task, priority));
+	MclAtomic_FetchAdd(&self->taskCount, 1);
+	MclCond_Signal(&self->cond);
+	return MCL_SUCCESS;
+}
+
+bool MclTaskQueue_HasTask(const MclTaskQueue *self, MclTaskKey key, MclTaskPriority priority) {
+	MCL_ASSERT_VALID_PTR_BOOL(self);
+	MCL_ASSERT_TRUE_BOOL(priority < self->queueCount);
+
+	MCL_LOCK_AUTO(self->mutex);
+	return TaskQueue_HasKey(&self->queues[priority], key);
+}
+
 MclTask* MclTaskQueue_PopTask(MclTaskQueue *self) {
     MCL_ASSERT_VALID_PTR_NIL(self);
 
     MCL_LOCK_AUTO(self->mutex);
 
     MclTaskQueue_WaitReady(self);
-    return MclTaskQueue_PopTaskImpl(self);
+    return MclTaskQueue_PopTaskImpl(self, NULL);
+}
+
+MclTask* MclTaskQueue_TryPopTask(MclTaskQueue *self) {
+    MCL_ASSERT_VALID_PTR_NIL(self);
+
+    if (MclAtomic_LoadAcquire(&self->taskCount) == 0) return NULL;
+
+    MCL_LOCK_AUTO(self->mutex);
+    return MclTaskQueue_PopTaskImpl(self, NULL);
+}
+
+MclSize MclTaskQueue_TryPopTasks(MclTaskQueue *self, MclTask **tasks, MclTaskPriority *priorities, MclSize count) {
+    MCL_ASSERT_VALID_PTR_R(self, 0);
+    MCL_ASSERT_VALID_PTR_R(tasks, 0);
+
+    if (MclAtomic_LoadAcquire(&self->taskCount) == 0) return 0;
+
+    MCL_LOCK_AUTO(self->mutex);
+
+    MclSize popped = 0;
+    while (popped < count) {
+        MclTask *task = MclTaskQueue_PopTaskImpl(self, priorities ? &priorities[popped] : NULL);
+        if (!task) break;
+        tasks[popped++] = task;
+    }
+    return popped;
+}
+
+/* The batch goes on only where select would take the same priority again without
+ * skipping anything: no higher priority queued and its threshold not reached */
+MCL_PRIVATE MclTask* MclTaskQueue_PopBatchNext(MclTaskQueue *self, MclTaskPriority priority) {
+    if (MclTaskQueue_IsOrdered(self)) return NULL;
+
+    for (MclSize i = 0; i < priority; i++) {
+        if (!TaskQueue_IsEmpty(&self->queues[i])) return NULL;
+    }
+
+    TaskQueue *queue = &self->queues[priority];
+    if (TaskQueue_IsReachThreshold(queue)) return NULL;
+
+    MclTask *task = TaskQueue_Peek(queue);
+    if (!task || MclTaskKey_IsValid(task->key)) return NULL;
+
+    (void)TaskQueue_Pop(queue);
+    MclAtomic_FetchSub(&self->taskCount, 1);
+    return task;
+}
+
+MclSize MclTaskQueue_TryPopBatch(MclTaskQueue *self, MclTask **tasks, MclTaskPriority *priorities, MclSize count) {
+    MCL_ASSERT_VALID_PTR_R(self, 0);
+    MCL_ASSERT_VALID_PTR_R(tasks, 0);
+    MCL_ASSERT_VALID_PTR_R(priorities, 0);
+
+    if ((count == 0) || (MclAtomic_LoadAcquire(&self->taskCount) == 0)) return 0;
+
+    MCL_LOCK_AUTO(self->mutex);
+
+    tasks[0] = MclTaskQueue_PopTaskImpl(self, &priorities[0]);
+    if (!tasks[0]) return 0;
+
+    MclSize popped = 1;
+    while (popped < count) {
+        MclTask *task = MclTaskQueue_PopBatchNext(self, priorities[0]);
+        if (!task) break;
+        priorities[popped] = priorities[0];
+        tasks[popped++] = task;
+    }
+    return popped;
 }
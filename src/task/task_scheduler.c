@@ -1,23 +1,328 @@
 #include "mcl/task/task_scheduler.h"
 #include "mcl/task/task_queue.h"
 #include "mcl/task/thread_pool.h"
+#include "mcl/task/timer_service.h"
+#include "mcl/task/task_stats.h"
+#include "mcl/lock/atomic.h"
+#include "mcl/lock/mutex.h"
+#include "mcl/lock/cond.h"
+#include "mcl/lock/future.h"
+#include "mcl/map/hash_map.h"
 #include "mcl/task/task.h"
 #include "mcl/mem/memory.h"
 #include "mcl/assert.h"
 
-#define MCL_TASK_SCHEDULER_THREAD_MAX 8
-#define MCL_TASK_SCHEDULER_LEVEL_MAX  3
+#define MCL_TASK_SCHEDULER_TIMER_TICK_US 1000
+
+#define MCL_TASK_SCHEDULER_TIMER_BUCKETS MCL_HASHMAP_BUCKET_COUNT_DEFAULT
 
 MCL_TYPE(MclTaskScheduler) {
 	MclThreadPool *threadPool;
 	MclTaskQueue  *taskQueue;
+	MclTimerService *timerService;
+	MclMutex timerLock;
+	MclHashMap timers;
+	MclHashBucket timerBuckets[MCL_TASK_SCHEDULER_TIMER_BUCKETS];
+	MclMutex waiterLock;
+	MclCond waiterDone;
+	struct MclTaskWaiter *waiters;
+	bool isClosing;
 };
 
-MCL_PRIVATE MclStatus MclTaskScheduler_Init(MclTaskScheduler *self, MclSize threadCount, MclSize priorities, MclSize *thresholds) {
-	self->threadPool = MclThreadPool_Create("TaskScheduler", threadCount);
+/*
+ * Delayed task is submitted when its timer expires, then the timer is freed.
+ * Periodic task is executed by the timer's own fire task, which is skipped if
+ * the last one is still queued, the task is destroyed when the timer is removed.
+ * Timer and queued fire task each hold a reference of the timer.
+ * Timers of valid key are chained by key in the timers map under timerLock,
+ * so RemoveTask cancels them without scanning the wheel. timerLock is taken
+ * inside the lock of timer service by expire, so RemoveTask unchains timers
+ * first and cancels them after timerLock released.
+ */
+typedef struct MclTaskTimer {
+	MclTimer timer;
+	MclTask fireTask;
+	MclTask *task;
+	MclTaskPriority priority;
+	MclTaskScheduler *scheduler;
+	struct MclTaskTimer *prevOfKey;
+	struct MclTaskTimer *nextOfKey;
+	bool isIndexed;
+	MclAtomic refCount;
+	MclAtomic isQueued;
+	MclAtomic isCancelled;
+} MclTaskTimer;
+
+/* IMPORTANT: SHOULD INVOKE WITH timerLock LOCKED!!! */
+MCL_PRIVATE void MclTaskScheduler_IndexTimer(MclTaskScheduler *self, MclTaskTimer *timer) {
+	MclTaskTimer *head = (MclTaskTimer*)MclHashMap_Get(&self->timers, timer->fireTask.key);
+	if (head != timer && !MclHashMap_Set(&self->timers, timer->fireTask.key, timer)) return;
+
+	timer->prevOfKey = NULL;
+	timer->nextOfKey = head;
+	if (head) head->prevOfKey = timer;
+	timer->isIndexed = true;
+}
+
+/* IMPORTANT: SHOULD INVOKE WITH timerLock LOCKED!!! */
+MCL_PRIVATE void MclTaskScheduler_UnindexTimer(MclTaskScheduler *self, MclTaskTimer *timer) {
+	if (!timer->isIndexed) return;
+
+	if (timer->prevOfKey) {
+		timer->prevOfKey->nextOfKey = timer->nextOfKey;
+	} else if (timer->nextOfKey) {
+		(void)MclHashMap_Set(&self->timers, timer->fireTask.key, timer->nextOfKey);
+	} else {
+		(void)MclHashMap_Remove(&self->timers, timer->fireTask.key);
+	}
+	if (timer->nextOfKey) timer->nextOfKey->prevOfKey = timer->prevOfKey;
+	timer->prevOfKey = timer->nextOfKey = NULL;
+	timer->isIndexed = false;
+}
+
+MCL_PRIVATE void MclTaskTimer_Unindex(MclTaskTimer *self) {
+	MCL_LOCK_AUTO(self->scheduler->timerLock);
+	MclTaskScheduler_UnindexTimer(self->scheduler, self);
+}
+
+MCL_PRIVATE void MclTaskTimer_Release(MclTaskTimer *self) {
+	if (MclAtomic_SubFetch(&self->refCount, 1) != 0) return;
+
+	if (self->task) MclTask_Destroy(self->task);
+	MCL_FREE(self);
+}
+
+MCL_PRIVATE MclStatus MclTaskTimer_ExecuteFire(MclTask *task) {
+	MclTaskTimer *self = (MclTaskTimer*)((char*)task - offsetof(MclTaskTimer, fireTask));
+
+	MclAtomic_Clear(&self->isQueued);
+	if (MclAtomic_IsTrue(&self->isCancelled)) return MCL_SUCCESS;
+	return MclTask_Execute(self->task);
+}
+
+MCL_PRIVATE void MclTaskTimer_DestroyFire(MclTask *task) {
+	MclTaskTimer *self = (MclTaskTimer*)((char*)task - offsetof(MclTaskTimer, fireTask));
+	MclTaskTimer_Release(self);
+}
+
+MCL_PRIVATE void MclTaskTimer_Expire(MclTimer *timer) {
+	MclTaskTimer *self = (MclTaskTimer*)timer;
+
+	if (!timer->periodTicks) {
+		MclTaskTimer_Unindex(self);
+		MclTask *task = self->task;
+		self->task = NULL;
+		if (MCL_FAILED(MclThreadPool_SubmitTask(self->scheduler->threadPool, task, self->priority))) {
+			MclTask_Destroy(task);
+		}
+		MclTaskTimer_Release(self);
+		return;
+	}
+
+	MclSize isQueued = 0;
+	if (!MclAtomic_CompareExchange(&self->isQueued, &isQueued, 1)) return;
+
+	MclAtomic_AddFetch(&self->refCount, 1);
+	if (MCL_FAILED(MclThreadPool_SubmitTask(self->scheduler->threadPool, &self->fireTask, self->priority))) {
+		MclAtomic_Clear(&self->isQueued);
+		MclTaskTimer_Release(self);
+	}
+}
+
+MCL_PRIVATE void MclTaskTimer_Destroy(MclTimer *timer) {
+	MclTaskTimer *self = (MclTaskTimer*)timer;
+
+	MclTaskTimer_Unindex(self);
+	MclAtomic_Set(&self->isCancelled, 1);
+	MclTaskTimer_Release(self);
+}
+
+MCL_PRIVATE MclTaskTimer* MclTaskTimer_Create(MclTaskScheduler *scheduler, MclTask *task, MclTaskPriority priority) {
+	MclTaskTimer *self = MCL_MALLOC(sizeof(MclTaskTimer));
+	MCL_ASSERT_VALID_PTR_NIL(self);
+
+	MclTimer_Init(&self->timer, MclTaskTimer_Expire, MclTaskTimer_Destroy);
+	MclTask fireTask = MCL_TASK(task->key, MclTaskTimer_ExecuteFire, MclTaskTimer_DestroyFire);
+	self->fireTask = fireTask;
+	self->task = task;
+	self->priority = priority;
+	self->scheduler = scheduler;
+	self->prevOfKey = NULL;
+	self->nextOfKey = NULL;
+	self->isIndexed = false;
+	MclAtomic_Set(&self->refCount, 1);
+	MclAtomic_Clear(&self->isQueued);
+	MclAtomic_Clear(&self->isCancelled);
+	return self;
+}
+
+/* Indexed before added to the service, as expire may unindex it right after added */
+MCL_PRIVATE MclStatus MclTaskScheduler_AddTimer(MclTaskScheduler *self, MclTask *task, MclTaskPriority priority,
+		MclTimeUs delayUs, MclTimeUs periodUs) {
+	MclTaskTimer *timer = MclTaskTimer_Create(self, task, priority);
+	MCL_ASSERT_VALID_PTR(timer);
+
+	if (MclTaskKey_IsValid(task->key)) {
+		MCL_LOCK_AUTO(self->timerLock);
+		MclTaskScheduler_IndexTimer(self, timer);
+	}
+	if (MCL_FAILED(MclTimerService_Add(self->timerService, &timer->timer, delayUs, periodUs))) {
+		MCL_LOG_ERR("Task scheduler add timer of task (%u) failed!", task->key);
+		MclTaskTimer_Unindex(timer);
+		timer->task = NULL;
+		MclTaskTimer_Release(timer);
+		return MCL_FAILURE;
+	}
+	return MCL_SUCCESS;
+}
+
+/* Unchains the timers of key and priority, each held by one more reference until cancelled */
+MCL_PRIVATE MclTaskTimer* MclTaskScheduler_TakeTimers(MclTaskScheduler *self, MclTaskKey key, MclTaskPriority priority) {
+	MCL_LOCK_AUTO(self->timerLock);
+
+	MclTaskTimer *taken = NULL;
+	MclTaskTimer *timer = (MclTaskTimer*)MclHashMap_Get(&self->timers, key);
+	while (timer) {
+		MclTaskTimer *next = timer->nextOfKey;
+		if (timer->priority == priority) {
+			MclTaskScheduler_UnindexTimer(self, timer);
+			MclAtomic_AddFetch(&timer->refCount, 1);
+			timer->nextOfKey = taken;
+			taken = timer;
+		}
+		timer = next;
+	}
+	return taken;
+}
+
+/* Timer failed to cancel is firing, its delayed task goes to the queue as if it was popped */
+MCL_PRIVATE void MclTaskScheduler_CancelTimers(MclTaskScheduler *self, MclTaskKey key, MclTaskPriority priority) {
+	MclTaskTimer *timer = MclTaskScheduler_TakeTimers(self, key, priority);
+	while (timer) {
+		MclTaskTimer *next = timer->nextOfKey;
+		timer->nextOfKey = NULL;
+		if (MCL_SUCCESS == MclTimerService_Cancel(self->timerService, &timer->timer)) {
+			MclTaskTimer_Destroy(&timer->timer);
+		}
+		MclTaskTimer_Release(timer);
+		timer = next;
+	}
+}
+
+/*
+ * Task submitted on ready is held by its waiter in the waiters list, so it is
+ * owned by scheduler while the future is not ready. The future callback takes
+ * the waiter off the list and submits the task, or destroys it once closing.
+ * RemoveTask and delete destroy the waiters whose callback is cancelled,
+ * delete then waits for the callbacks already taken to run by the future.
+ */
+typedef struct MclTaskWaiter {
+	MclTask *task;
+	MclTaskPriority priority;
+	MclFuture *future;
+	MclTaskScheduler *scheduler;
+	struct MclTaskWaiter *prev;
+	struct MclTaskWaiter *next;
+} MclTaskWaiter;
+
+/* IMPORTANT: SHOULD INVOKE WITH waiterLock LOCKED!!! */
+MCL_PRIVATE void MclTaskScheduler_LinkWaiter(MclTaskScheduler *self, MclTaskWaiter *waiter) {
+	waiter->prev = NULL;
+	waiter->next = self->waiters;
+	if (self->waiters) self->waiters->prev = waiter;
+	self->waiters = waiter;
+}
+
+/* IMPORTANT: SHOULD INVOKE WITH waiterLock LOCKED!!! */
+MCL_PRIVATE void MclTaskScheduler_UnlinkWaiter(MclTaskScheduler *self, MclTaskWaiter *waiter) {
+	if (waiter->prev) {
+		waiter->prev->next = waiter->next;
+	} else {
+		self->waiters = waiter->next;
+	}
+	if (waiter->next) waiter->next->prev = waiter->prev;
+	waiter->prev = waiter->next = NULL;
+}
+
+/* Submits under waiterLock, so delete never tears the pool down under it */
+MCL_PRIVATE void MclTaskWaiter_OnReady(MclStatus status, void *value, void *ctxt) {
+	(void)status;
+	(void)value;
+
+	MclTaskWaiter *self = (MclTaskWaiter*)ctxt;
+	MclTaskScheduler *scheduler = self->scheduler;
+	MclTask *task = self->task;
+	{
+		MCL_LOCK_AUTO(scheduler->waiterLock);
+		MclTaskScheduler_UnlinkWaiter(scheduler, self);
+		if (!scheduler->isClosing && (MCL_SUCCESS == MclThreadPool_SubmitTask(scheduler->threadPool, task, self->priority))) {
+			task = NULL;
+		}
+		(void)MclCond_Broadcast(&scheduler->waiterDone);
+	}
+	if (task) MclTask_Destroy(task);
+	MCL_FREE(self);
+}
+
+MCL_PRIVATE void MclTaskScheduler_DestroyWaiters(MclTaskWaiter *waiter) {
+	while (waiter) {
+		MclTaskWaiter *next = waiter->next;
+		MclTask_Destroy(waiter->task);
+		MCL_FREE(waiter);
+		waiter = next;
+	}
+}
+
+/* IMPORTANT: SHOULD INVOKE WITH waiterLock LOCKED!!! */
+MCL_PRIVATE MclTaskWaiter* MclTaskScheduler_TakeWaiter(MclTaskScheduler *self, MclTaskWaiter *waiter, MclTaskWaiter *taken) {
+	if (MCL_FAILED(MclFuture_CancelOnReady(waiter->future, MclTaskWaiter_OnReady, waiter))) return taken;
+
+	MclTaskScheduler_UnlinkWaiter(self, waiter);
+	waiter->next = taken;
+	return waiter;
+}
+
+/* Waiter failed to cancel is taken to run by the future, its task goes to the queue as if it was popped */
+MCL_PRIVATE void MclTaskScheduler_CancelWaiters(MclTaskScheduler *self, MclTaskKey key, MclTaskPriority priority) {
+	MclTaskWaiter *taken = NULL;
+	{
+		MCL_LOCK_AUTO(self->waiterLock);
+		MclTaskWaiter *waiter = self->waiters;
+		while (waiter) {
+			MclTaskWaiter *next = waiter->next;
+			if ((waiter->task->key == key) && (waiter->priority == priority)) {
+				taken = MclTaskScheduler_TakeWaiter(self, waiter, taken);
+			}
+			waiter = next;
+		}
+	}
+	MclTaskScheduler_DestroyWaiters(taken);
+}
+
+MCL_PRIVATE void MclTaskScheduler_CloseWaiters(MclTaskScheduler *self) {
+	MclTaskWaiter *taken = NULL;
+	{
+		MCL_LOCK_AUTO(self->waiterLock);
+		self->isClosing = true;
+		MclTaskWaiter *waiter = self->waiters;
+		while (waiter) {
+			MclTaskWaiter *next = waiter->next;
+			taken = MclTaskScheduler_TakeWaiter(self, waiter, taken);
+			waiter = next;
+		}
+		while (self->waiters) {
+			(void)MclCond_Wait(&self->waiterDone, &self->waiterLock);
+		}
+	}
+	MclTaskScheduler_DestroyWaiters(taken);
+}
+
+MCL_PRIVATE MclStatus MclTaskScheduler_Init(MclTaskScheduler *self, const MclThreadPoolConfig *config,
+		MclSize priorities, MclSize *thresholds, const MclTaskPolicy *policy) {
+	self->threadPool = MclThreadPool_CreateElastic("TaskScheduler", config);
 	MCL_ASSERT_VALID_PTR(self->threadPool);
 
-	self->taskQueue = MclTaskQueue_Create(priorities, thresholds);
+	self->taskQueue = policy ? MclTaskQueue_CreateWithPolicy(priorities, policy) : MclTaskQueue_Create(priorities, thresholds);
 	if (!self->taskQueue) {
 		MclThreadPool_Delete(self->threadPool);
 		MCL_LOG_ERR("Create task queue failed!");
@@ -30,17 +335,63 @@ MCL_PRIVATE MclStatus MclTaskScheduler_Init(MclTaskScheduler *self, MclSize thre
 		MCL_LOG_ERR("Submit task queue to thread pool failed!");
 		return MCL_FAILURE;
 	}
+
+	if (MCL_FAILED(MclMutex_Init(&self->timerLock, NULL))) {
+		MclThreadPool_Delete(self->threadPool);
+		MclTaskQueue_Delete(self->taskQueue);
+		MCL_LOG_ERR("Init timer lock failed!");
+		return MCL_FAILURE;
+	}
+	MclHashMap_InitGrowable(&self->timers, self->timerBuckets, MCL_TASK_SCHEDULER_TIMER_BUCKETS, &MclHashNodeAllocator_Default);
+
+	if (MCL_FAILED(MclMutex_Init(&self->waiterLock, NULL))) {
+		MclHashMap_Destroy(&self->timers, NULL);
+		(void)MclMutex_Destroy(&self->timerLock);
+		MclThreadPool_Delete(self->threadPool);
+		MclTaskQueue_Delete(self->taskQueue);
+		MCL_LOG_ERR("Init waiter lock failed!");
+		return MCL_FAILURE;
+	}
+	if (MCL_FAILED(MclCond_Init(&self->waiterDone, NULL))) {
+		(void)MclMutex_Destroy(&self->waiterLock);
+		MclHashMap_Destroy(&self->timers, NULL);
+		(void)MclMutex_Destroy(&self->timerLock);
+		MclThreadPool_Delete(self->threadPool);
+		MclTaskQueue_Delete(self->taskQueue);
+		MCL_LOG_ERR("Init waiter cond failed!");
+		return MCL_FAILURE;
+	}
+	self->waiters = NULL;
+	self->isClosing = false;
+
+	self->timerService = MclTimerService_Create("TaskTimer", MCL_TASK_SCHEDULER_TIMER_TICK_US);
+	if (!self->timerService) {
+		(void)MclCond_Destroy(&self->waiterDone);
+		(void)MclMutex_Destroy(&self->waiterLock);
+		MclHashMap_Destroy(&self->timers, NULL);
+		(void)MclMutex_Destroy(&self->timerLock);
+		MclThreadPool_Delete(self->threadPool);
+		MclTaskQueue_Delete(self->taskQueue);
+		MCL_LOG_ERR("Create timer service failed!");
+		return MCL_FAILURE;
+	}
 	return MCL_SUCCESS;
 }
 
 MclTaskScheduler* MclTaskScheduler_Create(MclSize threadCount, MclSize priorities, MclSize *thresholds) {
-	MCL_ASSERT_TRUE_NIL(threadCount <= MCL_TASK_SCHEDULER_THREAD_MAX);
-	MCL_ASSERT_TRUE_NIL(priorities <= MCL_TASK_SCHEDULER_LEVEL_MAX);
+	MclThreadPoolConfig config = MCL_THREAD_POOL_CONFIG_FIXED(threadCount);
+	return MclTaskScheduler_CreateElastic(&config, priorities, thresholds);
+}
+
+MCL_PRIVATE MclTaskScheduler* MclTaskScheduler_CreateImpl(const MclThreadPoolConfig *config,
+		MclSize priorities, MclSize *thresholds, const MclTaskPolicy *policy) {
+	MCL_ASSERT_VALID_PTR_NIL(config);
+	MCL_ASSERT_TRUE_NIL(priorities > 0);
 
 	MclTaskScheduler *self = MCL_MALLOC(sizeof(MclTaskScheduler));
 	MCL_ASSERT_VALID_PTR_NIL(self);
 
-	if (MCL_FAILED(MclTaskScheduler_Init(self, threadCount, priorities, thresholds))) {
+	if (MCL_FAILED(MclTaskScheduler_Init(self, config, priorities, thresholds, policy))) {
 		MCL_LOG_ERR("Task scheduler init failed!");
 		MCL_FREE(self);
 		return NULL;
@@ -50,7 +401,22 @@ MclTaskScheduler* MclTaskScheduler_Create(MclSize threadCount, MclSize prioritie
 	return self;
 }
 
+MclTaskScheduler* MclTaskScheduler_CreateElastic(const MclThreadPoolConfig *config, MclSize priorities, MclSize *thresholds) {
+	return MclTaskScheduler_CreateImpl(config, priorities, thresholds, NULL);
+}
+
+MclTaskScheduler* MclTaskScheduler_CreateWithPolicy(const MclThreadPoolConfig *config, MclSize priorities, const MclTaskPolicy *policy) {
+	MCL_ASSERT_VALID_PTR_NIL(policy);
+	return MclTaskScheduler_CreateImpl(config, priorities, NULL, policy);
+}
+
 MCL_PRIVATE void MclTaskScheduler_Destroy(MclTaskScheduler *self) {
+	MclTimerService_Delete(self->timerService);
+	MclHashMap_Destroy(&self->timers, NULL);
+	MCL_PEEK_SUCC_CALL(MclMutex_Destroy(&self->timerLock));
+	MclTaskScheduler_CloseWaiters(self);
+	MCL_PEEK_SUCC_CALL(MclCond_Destroy(&self->waiterDone));
+	MCL_PEEK_SUCC_CALL(MclMutex_Destroy(&self->waiterLock));
 	MclThreadPool_Delete(self->threadPool);
 	MclTaskQueue_Delete(self->taskQueue);
 }
@@ -69,14 +435,35 @@ bool MclTaskScheduler_IsRunning(const MclTaskScheduler *self){
 	return MclThreadPool_IsRunning(self->threadPool);
 }
 
+MclSize MclTaskScheduler_GetThreadCount(const MclTaskScheduler *self) {
+	MCL_ASSERT_VALID_PTR_R(self, 0);
+	return MclThreadPool_GetThreadCount(self->threadPool);
+}
+
+MclStatus MclTaskScheduler_GetStats(MclTaskScheduler *self, MclTaskPriority priority, MclTaskPriorityStats *stats) {
+	MCL_ASSERT_VALID_PTR(self);
+	MCL_ASSERT_VALID_PTR(stats);
+
+	MclTaskStats *taskStats = MclTaskQueue_GetStats(self->taskQueue);
+	if (!taskStats) return MCL_FAILURE;
+	return MclTaskStats_GetSnapshot(taskStats, priority, stats);
+}
+
+MclThreadPool* MclTaskScheduler_GetThreadPool(MclTaskScheduler *self) {
+	MCL_ASSERT_VALID_PTR_NIL(self);
+	return self->threadPool;
+}
+
 MclStatus MclTaskScheduler_Start(MclTaskScheduler *self) {
 	MCL_ASSERT_VALID_PTR(self);
     MCL_ASSERT_SUCC_CALL(MclThreadPool_Start(self->threadPool));
+    MCL_ASSERT_SUCC_CALL(MclTimerService_Start(self->timerService));
 	return MCL_SUCCESS;
 }
 
 MclStatus MclTaskScheduler_Stop(MclTaskScheduler *self) {
 	MCL_ASSERT_VALID_PTR(self);
+	MCL_ASSERT_SUCC_CALL(MclTimerService_Stop(self->timerService));
 	MCL_ASSERT_SUCC_CALL(MclThreadPool_Stop(self->threadPool));
     return MCL_SUCCESS;
 }
@@ -84,25 +471,136 @@ MclStatus MclTaskScheduler_Stop(MclTaskScheduler *self) {
 MclStatus MclTaskScheduler_SubmitTask(MclTaskScheduler *self, MclTask *task, MclTaskPriority priority) {
 	MCL_ASSERT_VALID_PTR(self);
 	MCL_ASSERT_VALID_PTR(task);
-	MCL_ASSERT_TRUE(priority < MCL_TASK_SCHEDULER_LEVEL_MAX);
+	MCL_ASSERT_TRUE(priority < MclTaskQueue_GetPriorities(self->taskQueue));
 
-	MCL_ASSERT_SUCC_CALL(MclTaskQueue_AddTask(self->taskQueue, task, priority));
+	MclTaskKey key = task->key;
+	MCL_ASSERT_SUCC_CALL(MclThreadPool_SubmitTask(self->threadPool, task, priority));
 
-    MCL_LOG_DBG("Task scheduler submit task (%u) of pri (%u).", task->key, priority);
+    MCL_LOG_DBG("Task scheduler submit task (%u) of pri (%u).", key, priority);
+	return MCL_SUCCESS;
+}
+
+MclSize MclTaskScheduler_SubmitTasks(MclTaskScheduler *self, MclTask **tasks, MclSize count, MclTaskPriority priority) {
+	MCL_ASSERT_VALID_PTR_R(self, 0);
+	MCL_ASSERT_TRUE_R(count == 0 || tasks != NULL, 0);
+	MCL_ASSERT_TRUE_R(priority < MclTaskQueue_GetPriorities(self->taskQueue), 0);
+
+	MclSize submitted = MclThreadPool_SubmitTasks(self->threadPool, tasks, count, priority);
+	if (submitted < count) {
+		MCL_LOG_ERR("Task scheduler submit %u of %u tasks of pri (%u)!", submitted, count, priority);
+	}
+
+    MCL_LOG_DBG("Task scheduler submit %u tasks of pri (%u).", submitted, priority);
+	return submitted;
+}
+
+MclStatus MclTaskScheduler_SubmitWithDeadline(MclTaskScheduler *self, MclTask *task, MclTaskPriority priority, MclTimeUs deadlineUs) {
+	MCL_ASSERT_VALID_PTR(self);
+	MCL_ASSERT_VALID_PTR(task);
+	MCL_ASSERT_TRUE(priority < MclTaskQueue_GetPriorities(self->taskQueue));
+
+	MclTaskKey key = task->key;
+	MCL_ASSERT_SUCC_CALL(MclThreadPool_SubmitTaskWithDeadline(self->threadPool, task, priority, deadlineUs));
+
+    MCL_LOG_DBG("Task scheduler submit task (%u) of pri (%u) deadline %llu us.", key, priority, (unsigned long long)deadlineUs);
+	return MCL_SUCCESS;
+}
+
+MclStatus MclTaskScheduler_SubmitDelayed(MclTaskScheduler *self, MclTask *task, MclTaskPriority priority, MclTimeUs delayUs) {
+	MCL_ASSERT_VALID_PTR(self);
+	MCL_ASSERT_VALID_PTR(task);
+	MCL_ASSERT_TRUE(priority < MclTaskQueue_GetPriorities(self->taskQueue));
+
+	MclTaskKey key = task->key;
+	MCL_ASSERT_SUCC_CALL(MclTaskScheduler_AddTimer(self, task, priority, delayUs, 0));
+
+    MCL_LOG_DBG("Task scheduler submit task (%u) of pri (%u) delayed %llu us.", key, priority, (unsigned long long)delayUs);
+	return MCL_SUCCESS;
+}
+
+MclStatus MclTaskScheduler_SubmitPeriodic(MclTaskScheduler *self, MclTask *task, MclTaskPriority priority, MclTimeUs periodUs) {
+	MCL_ASSERT_VALID_PTR(self);
+	MCL_ASSERT_VALID_PTR(task);
+	MCL_ASSERT_TRUE(periodUs > 0);
+	MCL_ASSERT_TRUE(priority < MclTaskQueue_GetPriorities(self->taskQueue));
+
+	MclTaskKey key = task->key;
+	MCL_ASSERT_SUCC_CALL(MclTaskScheduler_AddTimer(self, task, priority, periodUs, periodUs));
+
+    MCL_LOG_DBG("Task scheduler submit task (%u) of pri (%u) every %llu us.", key, priority, (unsigned long long)periodUs);
+	return MCL_SUCCESS;
+}
+
+MclStatus MclTaskScheduler_SubmitOnReady(MclTaskScheduler *self, MclTask *task, MclTaskPriority priority, MclFuture *future) {
+	MCL_ASSERT_VALID_PTR(self);
+	MCL_ASSERT_VALID_PTR(task);
+	MCL_ASSERT_VALID_PTR(future);
+	MCL_ASSERT_TRUE(priority < MclTaskQueue_GetPriorities(self->taskQueue));
+
+	MclTaskWaiter *waiter = MCL_MALLOC(sizeof(MclTaskWaiter));
+	MCL_ASSERT_VALID_PTR(waiter);
+
+	waiter->task = task;
+	waiter->priority = priority;
+	waiter->future = future;
+	waiter->scheduler = self;
+
+	MclTaskKey key = task->key;
+	{
+		MCL_LOCK_AUTO(self->waiterLock);
+		if (self->isClosing) {
+			MCL_FREE(waiter);
+			MCL_LOG_ERR("Task scheduler submit task (%u) on ready while closing!", key);
+			return MCL_FAILURE;
+		}
+		MclTaskScheduler_LinkWaiter(self, waiter);
+	}
+	if (MCL_FAILED(MclFuture_OnReady(future, MclTaskWaiter_OnReady, waiter))) {
+		{
+			MCL_LOCK_AUTO(self->waiterLock);
+			MclTaskScheduler_UnlinkWaiter(self, waiter);
+		}
+		MCL_FREE(waiter);
+		MCL_LOG_ERR("Task scheduler submit task (%u) on ready failed!", key);
+		return MCL_FAILURE;
+	}
+
+    MCL_LOG_DBG("Task scheduler submit task (%u) of pri (%u) on ready.", key, priority);
+	return MCL_SUCCESS;
+}
+
+MclStatus MclTaskScheduler_ReplaceTask(MclTaskScheduler *self, MclTask *task, MclTaskPriority priority) {
+	MCL_ASSERT_VALID_PTR(self);
+	MCL_ASSERT_VALID_PTR(task);
+	MCL_ASSERT_TRUE(MclTaskKey_IsValid(task->key));
+	MCL_ASSERT_TRUE(priority < MclTaskQueue_GetPriorities(self->taskQueue));
+
+	MCL_ASSERT_SUCC_CALL(MclThreadPool_ReplaceTask(self->threadPool, task, priority));
+
+    MCL_LOG_DBG("Task scheduler replace task (%u) of pri (%u).", task->key, priority);
 	return MCL_SUCCESS;
 }
 
 MclStatus MclTaskScheduler_RemoveTask(MclTaskScheduler *self, MclTaskKey key, MclTaskPriority priority) {
 	MCL_ASSERT_VALID_PTR(self);
 	MCL_ASSERT_TRUE(MclTaskKey_IsValid(key));
-	MCL_ASSERT_TRUE(priority < MCL_TASK_SCHEDULER_LEVEL_MAX);
+	MCL_ASSERT_TRUE(priority < MclTaskQueue_GetPriorities(self->taskQueue));
 
+	MclTaskScheduler_CancelTimers(self, key, priority);
+	MclTaskScheduler_CancelWaiters(self, key, priority);
 	MCL_ASSERT_SUCC_CALL(MclTaskQueue_DelTask(self->taskQueue, key, priority));
 
     MCL_LOG_DBG("Task scheduler remove task (%u) of pri (%u).", key, priority);
 	return MCL_SUCCESS;
 }
 
+bool MclTaskScheduler_IsPending(const MclTaskScheduler *self, MclTaskKey key, MclTaskPriority priority) {
+	MCL_ASSERT_VALID_PTR_BOOL(self);
+	MCL_ASSERT_TRUE_BOOL(MclTaskKey_IsValid(key));
+
+	return MclTaskQueue_HasTask(self->taskQueue, key, priority);
+}
+
 void MclTaskScheduler_LocalExecute(MclTaskScheduler *self) {
 	MCL_ASSERT_VALID_PTR_VOID(self);
 	MclThreadPool_LocalExecute(self->threadPool);
@@ -0,0 +1,131 @@
+#include "mcl/task/task_stats.h"
+#include "mcl/mem/memory.h"
+#include "mcl/assert.h"
+#include <string.h>
+
+MCL_TYPE(MclTaskStats) {
+	MclSize priorities;
+	MclTaskPriorityStats stats[];
+};
+
+/* Relaxed is enough, counters are statistics and never order other memory */
+MCL_PRIVATE void MclTaskCounter_Add(uint64_t *counter, uint64_t value) {
+	(void)__atomic_fetch_add(counter, value, __ATOMIC_RELAXED);
+}
+
+MCL_PRIVATE uint64_t MclTaskCounter_Get(const uint64_t *counter) {
+	return __atomic_load_n(counter, __ATOMIC_RELAXED);
+}
+
+MCL_PRIVATE void MclTaskCounter_Max(uint64_t *counter, uint64_t value) {
+	uint64_t current = __atomic_load_n(counter, __ATOMIC_RELAXED);
+	while (value > current) {
+		if (__atomic_compare_exchange_n(counter, &current, value, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) return;
+	}
+}
+
+MCL_PRIVATE MclSize MclTaskHistogram_GetBucket(MclTimeUs us) {
+	if (us == 0) return 0;
+
+	MclSize bucket = 64 - __builtin_clzll(us);
+	return (bucket < MCL_TASK_HISTOGRAM_BUCKETS) ? bucket : MCL_TASK_HISTOGRAM_BUCKETS - 1;
+}
+
+MCL_PRIVATE void MclTaskHistogram_Add(MclTaskHistogram *self, MclTimeUs us) {
+	MclTaskCounter_Add(&self->buckets[MclTaskHistogram_GetBucket(us)], 1);
+	MclTaskCounter_Add(&self->count, 1);
+	MclTaskCounter_Add(&self->sumUs, us);
+	MclTaskCounter_Max(&self->maxUs, us);
+}
+
+MCL_PRIVATE void MclTaskHistogram_Copy(MclTaskHistogram *self, const MclTaskHistogram *from) {
+	for (MclSize i = 0; i < MCL_TASK_HISTOGRAM_BUCKETS; i++) {
+		self->buckets[i] = MclTaskCounter_Get(&from->buckets[i]);
+	}
+	self->count = MclTaskCounter_Get(&from->count);
+	self->sumUs = MclTaskCounter_Get(&from->sumUs);
+	self->maxUs = MclTaskCounter_Get(&from->maxUs);
+}
+
+MclTaskStats* MclTaskStats_Create(MclSize priorities) {
+	MCL_ASSERT_TRUE_NIL(priorities > 0);
+
+	MclTaskStats *self = MCL_MALLOC(sizeof(MclTaskStats) + sizeof(MclTaskPriorityStats) * priorities);
+	MCL_ASSERT_VALID_PTR_NIL(self);
+
+	self->priorities = priorities;
+	MclTaskStats_Reset(self);
+	return self;
+}
+
+void MclTaskStats_Delete(MclTaskStats *self) {
+	MCL_ASSERT_VALID_PTR_VOID(self);
+	MCL_FREE(self);
+}
+
+void MclTaskStats_Reset(MclTaskStats *self) {
+	MCL_ASSERT_VALID_PTR_VOID(self);
+	memset(self->stats, 0, sizeof(MclTaskPriorityStats) * self->priorities);
+}
+
+void MclTaskStats_AddSubmitted(MclTaskStats *self, MclTaskPriority priority, MclSize count) {
+	MCL_ASSERT_VALID_PTR_VOID(self);
+	MCL_ASSERT_TRUE_VOID(priority < self->priorities);
+	MclTaskCounter_Add(&self->stats[priority].submittedCount, count);
+}
+
+void MclTaskStats_AddExecuted(MclTaskStats *self, MclTaskPriority priority, MclTimeUs queueWaitUs, MclTimeUs runUs) {
+	MCL_ASSERT_VALID_PTR_VOID(self);
+	MCL_ASSERT_TRUE_VOID(priority < self->priorities);
+
+	MclTaskPriorityStats *stats = &self->stats[priority];
+	MclTaskCounter_Add(&stats->executedCount, 1);
+	MclTaskHistogram_Add(&stats->queueWait, queueWaitUs);
+	MclTaskHistogram_Add(&stats->runTime, runUs);
+	MclTaskHistogram_Add(&stats->latency, queueWaitUs + runUs);
+}
+
+void MclTaskStats_AddCancelled(MclTaskStats *self, MclTaskPriority priority, MclSize count) {
+	MCL_ASSERT_VALID_PTR_VOID(self);
+	MCL_ASSERT_TRUE_VOID(priority < self->priorities);
+	if (count == 0) return;
+	MclTaskCounter_Add(&self->stats[priority].cancelledCount, count);
+}
+
+void MclTaskStats_AddThresholdSkip(MclTaskStats *self, MclTaskPriority priority) {
+	MCL_ASSERT_VALID_PTR_VOID(self);
+	MCL_ASSERT_TRUE_VOID(priority < self->priorities);
+	MclTaskCounter_Add(&self->stats[priority].thresholdSkipCount, 1);
+}
+
+MclStatus MclTaskStats_GetSnapshot(const MclTaskStats *self, MclTaskPriority priority, MclTaskPriorityStats *snapshot) {
+	MCL_ASSERT_VALID_PTR(self);
+	MCL_ASSERT_VALID_PTR(snapshot);
+	MCL_ASSERT_TRUE(priority < self->priorities);
+
+	const MclTaskPriorityStats *stats = &self->stats[priority];
+	snapshot->submittedCount = MclTaskCounter_Get(&stats->submittedCount);
+	snapshot->executedCount = MclTaskCounter_Get(&stats->executedCount);
+	snapshot->cancelledCount = MclTaskCounter_Get(&stats->cancelledCount);
+	snapshot->thresholdSkipCount = MclTaskCounter_Get(&stats->thresholdSkipCount);
+	MclTaskHistogram_Copy(&snapshot->queueWait, &stats->queueWait);
+	MclTaskHistogram_Copy(&snapshot->runTime, &stats->runTime);
+	MclTaskHistogram_Copy(&snapshot->latency, &stats->latency);
+	return MCL_SUCCESS;
+}
+
+MclTimeUs MclTaskHistogram_GetPercentileUs(const MclTaskHistogram *self, MclSize permille) {
+	MCL_ASSERT_VALID_PTR_R(self, 0);
+	if (self->count == 0) return 0;
+
+	uint64_t target = (self->count * (permille > 1000 ? 1000 : permille) + 999) / 1000;
+	uint64_t accumulated = 0;
+	for (MclSize i = 0; i < MCL_TASK_HISTOGRAM_BUCKETS - 1; i++) {
+		accumulated += self->buckets[i];
+		if (accumulated >= target && accumulated > 0) {
+			MclTimeUs upper = (i == 0) ? 0 : (((MclTimeUs)1 << i) - 1);
+			return (upper < self->maxUs) ? upper : self->maxUs;
+		}
+	}
+	return self->maxUs;
+}
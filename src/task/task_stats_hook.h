@@ -0,0 +1,61 @@
+#ifndef MCL_3F7A0E6B92C14D58A1B4E7D20C9F5A83
+#define MCL_3F7A0E6B92C14D58A1B4E7D20C9F5A83
+
+#include "mcl/task/task_stats.h"
+#include "mcl/task/task.h"
+
+MCL_STDC_BEGIN
+
+#ifdef MCL_TASK_STATS_ENABLED
+
+#include "mcl/lock/event_count.h"
+
+/* Deadline of 0 timeout is just the monotonic now */
+MCL_INLINE MclTimeUs MclTaskStats_GetNowUs() {
+	return MclEventCount_GetDeadline(0);
+}
+
+/* Stamped before the task is pushed, as it may be started by others right after */
+MCL_INLINE void MclTaskStats_OnStamp(MclTask *task, MclTaskPriority priority) {
+	task->submitUs = MclTaskStats_GetNowUs();
+	task->startUs = task->submitUs;
+	task->priority = priority;
+}
+
+MCL_INLINE void MclTaskStats_OnSubmit(MclTaskStats *stats, MclTask *task, MclTaskPriority priority) {
+	MclTaskStats_OnStamp(task, priority);
+	MclTaskStats_AddSubmitted(stats, priority, 1);
+}
+
+MCL_INLINE void MclTaskStats_OnStart(MclTask *task) {
+	task->startUs = MclTaskStats_GetNowUs();
+}
+
+MCL_INLINE void MclTaskStats_OnFinish(MclTaskStats *stats, MclTask *task) {
+	MclTimeUs nowUs = MclTaskStats_GetNowUs();
+	MclTaskStats_AddExecuted(stats, task->priority, task->startUs - task->submitUs, nowUs - task->startUs);
+}
+
+#define MCL_TASK_STATS_ON_STAMP(TASK, PRIORITY)         MclTaskStats_OnStamp(TASK, PRIORITY)
+#define MCL_TASK_STATS_ON_SUBMIT(STATS, TASK, PRIORITY) MclTaskStats_OnSubmit(STATS, TASK, PRIORITY)
+#define MCL_TASK_STATS_ON_SUBMITTED(STATS, PRIORITY, COUNT) MclTaskStats_AddSubmitted(STATS, PRIORITY, COUNT)
+#define MCL_TASK_STATS_ON_START(TASK)                   MclTaskStats_OnStart(TASK)
+#define MCL_TASK_STATS_ON_FINISH(STATS, TASK)           MclTaskStats_OnFinish(STATS, TASK)
+#define MCL_TASK_STATS_ON_CANCEL(STATS, PRIORITY, COUNT) MclTaskStats_AddCancelled(STATS, PRIORITY, COUNT)
+#define MCL_TASK_STATS_ON_THRESHOLD_SKIP(STATS, PRIORITY) MclTaskStats_AddThresholdSkip(STATS, PRIORITY)
+
+#else
+
+#define MCL_TASK_STATS_ON_STAMP(TASK, PRIORITY)           (void)0
+#define MCL_TASK_STATS_ON_SUBMIT(STATS, TASK, PRIORITY)   (void)0
+#define MCL_TASK_STATS_ON_SUBMITTED(STATS, PRIORITY, COUNT) (void)0
+#define MCL_TASK_STATS_ON_START(TASK)                     (void)0
+#define MCL_TASK_STATS_ON_FINISH(STATS, TASK)             (void)0
+#define MCL_TASK_STATS_ON_CANCEL(STATS, PRIORITY, COUNT)  (void)0
+#define MCL_TASK_STATS_ON_THRESHOLD_SKIP(STATS, PRIORITY) (void)0
+
+#endif
+
+MCL_STDC_END
+
+#endif
@@ -1,45 +1,366 @@
 #include "mcl/task/thread_pool.h"
 #include "mcl/thread/thread_launcher.h"
 #include "mcl/task/task_queue.h"
+#include "mcl/task/task_deque.h"
+#include "mcl/lock/event_count.h"
+#include "mcl/lock/mutex.h"
+#include "mcl/lock/atomic.h"
 #include "mcl/thread/thread.h"
 #include "mcl/task/task.h"
 #include "mcl/algo/loop.h"
 #include "mcl/mem/memory.h"
 #include "mcl/assert.h"
+#include "task_stats_hook.h"
+
+#define MCL_THREAD_POOL_DEQUE_CAPACITY 256
+#define MCL_THREAD_POOL_POP_BATCH 8
+
+typedef enum {
+	MCL_THREAD_WORKER_FREE = 0,
+	MCL_THREAD_WORKER_RUNNING,
+	MCL_THREAD_WORKER_EXITED,
+} MclThreadWorkerState;
+
+/*
+ * Work stealing: each worker owns a deque per priority for tasks of invalid
+ * key submitted inside the pool, keyed tasks and tasks submitted outside go
+ * to the shared task queue, where RemoveTask, ReplaceTask and IsPending of
+ * the scheduler find them by key. Worker pops its own deques unless the
+ * shared queue holds a task of higher priority, then the shared queue, then
+ * steals from other workers starting from a random one, at last parks on workReady.
+ * Worker pops a batch of its fair share from the shared queue by one lock
+ * while no worker is parked, executes the first task and pushes the rest of
+ * unkeyed ones to its own deques, where they are executed in order or stolen.
+ * A keyed task stops the batch, it stays in the shared queue for its key.
+ * Under EDF or WFQ policy of the queue all tasks go to the shared queue and
+ * worker pops one by one, so the policy orders every task.
+ *
+ * Elastic scaling: workers are slots of maxThreads, minThreads of them run
+ * since start. A slot is launched when queued tasks per running worker exceed
+ * queueDepthTarget and no worker is parked, a running worker above minThreads
+ * retires after parked for idleTimeoutUs, its thread is joined when the slot
+ * is launched again or the pool quits.
+ */
+typedef struct {
+	MclTaskDeque deque;
+	MclSize threshold;
+	MclSize poppedCount;
+} MclWorkerLevel;
+
+typedef struct {
+	MclThreadPool *pool;
+	MclSize index;
+	MclSize seed;
+	MclAtomic state;
+	MclWorkerLevel *levels;
+} MclThreadWorker;
 
 MCL_TYPE(MclThreadPool) {
 	const char *name;
 	MclTaskQueue *taskQueue;
+	MclThreadWorker *workers;
+	MclSize levelCount;
+	bool isOrdered;
+	MclEventCount workReady;
+	MclThreadPoolConfig config;
+	MclMutex scaleLock;
+	MclAtomic runningCount;
+	MclAtomic idleCount;
+	MclAtomic busyCount;
+	MclEventCount allIdle;
 	MclSize threadCount;
 	MclThreadInfo threads[];
 };
 
-MCL_PRIVATE void MclThreadPool_ExecuteTask(MclTaskQueue *taskQueue) {
-    MCL_LOG_DBG("Task thread try to pop task...");
-    MclTask *task = MclTaskQueue_PopTask(taskQueue);
-    if (task) {
-        MCL_LOG_DBG("Task thread popped task (%u).", task->key);
-        MCL_ASSERT_SUCC_CALL_VOID(MclTask_Execute(task));
-        MclTask_Destroy(task);
-    } else {
-        MclThread_Yield();
-    }
+MCL_PRIVATE _Thread_local MclThreadWorker *currentWorker = NULL;
+
+///////////////////////////////////////////////////////////
+MCL_PRIVATE MclStatus MclThreadWorker_Init(MclThreadWorker *self, MclThreadPool *pool, MclSize index) {
+	self->pool = pool;
+	self->index = index;
+	self->seed = index * 2654435761u + 1;
+	MclAtomic_Clear(&self->state);
+	self->levels = MCL_MALLOC(sizeof(MclWorkerLevel) * pool->levelCount);
+	MCL_ASSERT_VALID_PTR(self->levels);
+
+	MCL_LOOP_FOREACH_INDEX(i, pool->levelCount) {
+		MclTask **buff = MCL_MALLOC(sizeof(MclTask*) * MCL_THREAD_POOL_DEQUE_CAPACITY);
+		MCL_ASSERT_VALID_PTR(buff);
+		MCL_ASSERT_SUCC_CALL(MclTaskDeque_Init(&self->levels[i].deque, MCL_THREAD_POOL_DEQUE_CAPACITY, buff));
+		self->levels[i].threshold = MclTaskQueue_GetThreshold(pool->taskQueue, i);
+		self->levels[i].poppedCount = 0;
+	}
+	return MCL_SUCCESS;
 }
 
-MCL_PRIVATE void MclThreadPool_RunThread(void *ctxt) {
-	MclTaskQueue *taskQueue = (MclTaskQueue*)ctxt;
-	MCL_ASSERT_VALID_PTR_VOID(taskQueue);
+MCL_PRIVATE void MclThreadWorker_Destroy(MclThreadWorker *self) {
+	if (!self->levels) return;
 
-    while (MclTaskQueue_IsRunning(taskQueue)) {
-        MclThreadPool_ExecuteTask(taskQueue);
-    }
+	MCL_LOOP_FOREACH_INDEX(i, self->pool->levelCount) {
+		MclTaskDeque *deque = &self->levels[i].deque;
+		MclTask **buff = MclTaskDeque_GetBuff(deque);
+		if (!buff) continue;
+
+		MclTask *task = NULL;
+		while ((task = MclTaskDeque_Steal(deque))) {
+			MclTask_Destroy(task);
+		}
+		MCL_FREE(buff);
+	}
+	MCL_FREE(self->levels);
+	self->levels = NULL;
+}
+
+MCL_PRIVATE bool MclThreadWorker_IsEmpty(const MclThreadWorker *self) {
+	MCL_LOOP_FOREACH_INDEX(i, self->pool->levelCount) {
+		if (!MclTaskDeque_IsEmpty(&self->levels[i].deque)) return false;
+	}
+	return true;
+}
+
+MCL_PRIVATE bool MclWorkerLevel_IsReachThreshold(const MclWorkerLevel *level) {
+	if (level->threshold == 0 || level->poppedCount == 0) return false;
+	return level->poppedCount % level->threshold == 0;
+}
+
+/* Only pops levels of priority no lower than topPriority */
+MCL_PRIVATE MclTask* MclThreadWorker_PopLocal(MclThreadWorker *self, MclTaskPriority topPriority) {
+	MclSize levelCount = (topPriority < self->pool->levelCount) ? topPriority + 1 : self->pool->levelCount;
+	MCL_LOOP_FOREACH_INDEX(i, levelCount) {
+		MclWorkerLevel *level = &self->levels[i];
+		if (MclTaskDeque_IsEmpty(&level->deque)) continue;
+		if (MclWorkerLevel_IsReachThreshold(level)) {
+			level->poppedCount = 0;
+			MCL_TASK_STATS_ON_THRESHOLD_SKIP(MclTaskQueue_GetStats(self->pool->taskQueue), i);
+			continue;
+		}
+		MclTask *task = MclTaskDeque_Pop(&level->deque);
+		if (task) {
+			level->poppedCount++;
+			return task;
+		}
+	}
+	return NULL;
+}
+
+MCL_PRIVATE MclSize MclThreadWorker_GetRandom(MclThreadWorker *self) {
+	/* xorshift, good enough to spread victims */
+	MclSize x = self->seed;
+	x ^= x << 13;
+	x ^= x >> 17;
+	x ^= x << 5;
+	self->seed = x;
+	return x;
+}
+
+MCL_PRIVATE MclTask* MclThreadWorker_StealFrom(MclThreadWorker *victim) {
+	MCL_LOOP_FOREACH_INDEX(i, victim->pool->levelCount) {
+		MclTask *task = MclTaskDeque_Steal(&victim->levels[i].deque);
+		if (task) return task;
+	}
+	return NULL;
+}
+
+MCL_PRIVATE MclTask* MclThreadPool_Steal(MclThreadPool *self, MclThreadWorker *thief) {
+	MclSize start = thief ? MclThreadWorker_GetRandom(thief) % self->threadCount : 0;
+
+	MCL_LOOP_FOREACH_INDEX(i, self->threadCount) {
+		MclThreadWorker *victim = &self->workers[(start + i) % self->threadCount];
+		if (victim == thief) continue;
+
+		MclTask *task = MclThreadWorker_StealFrom(victim);
+		if (task) return task;
+	}
+	return NULL;
+}
+
+/* Takes fair share of queued tasks for each running worker, no more than the batch,
+ * one by one if any worker is parked, which would find nothing to steal before woken */
+MCL_PRIVATE MclSize MclThreadPool_GetPopBatch(MclThreadPool *self) {
+	if (self->isOrdered || MclAtomic_LoadAcquire(&self->idleCount) > 0) return 1;
+
+	MclSize runningCount = MclAtomic_LoadAcquire(&self->runningCount);
+	MclSize share = MclTaskQueue_GetCount(self->taskQueue) / (runningCount ? runningCount : 1);
+	if (share == 0) return 1;
+	return (share < MCL_THREAD_POOL_POP_BATCH) ? share : MCL_THREAD_POOL_POP_BATCH;
+}
+
+/* Rest of batch is pushed in reverse, so the owner pops it in order, a full deque sends it back to the queue */
+MCL_PRIVATE MclTask* MclThreadWorker_PopBatch(MclThreadWorker *self) {
+	MclSize batch = MclThreadPool_GetPopBatch(self->pool);
+	if (batch == 1) return MclTaskQueue_TryPopTask(self->pool->taskQueue);
+
+	MclTask *tasks[MCL_THREAD_POOL_POP_BATCH];
+	MclTaskPriority priorities[MCL_THREAD_POOL_POP_BATCH];
+	MclSize count = MclTaskQueue_TryPopBatch(self->pool->taskQueue, tasks, priorities, batch);
+	if (count == 0) return NULL;
+
+	for (MclSize i = count - 1; i > 0; i--) {
+		if (MCL_SUCCESS == MclTaskDeque_Push(&self->levels[priorities[i]].deque, tasks[i])) continue;
+		if (MCL_FAILED(MclTaskQueue_AddTask(self->pool->taskQueue, tasks[i], priorities[i]))) {
+			MCL_LOG_ERR("%s give back task (%u) failed!", self->pool->name, tasks[i]->key);
+			MclTask_Destroy(tasks[i]);
+		}
+	}
+	return tasks[0];
+}
+
+MCL_PRIVATE MclTask* MclThreadPool_FindTask(MclThreadPool *self, MclThreadWorker *worker) {
+	MclTask *task = worker ? MclThreadWorker_PopLocal(worker, MclTaskQueue_GetTopPriority(self->taskQueue)) : NULL;
+	if (task) return task;
+
+	task = worker ? MclThreadWorker_PopBatch(worker) : MclTaskQueue_TryPopTask(self->taskQueue);
+	if (task) return task;
+
+	return MclThreadPool_Steal(self, worker);
+}
+
+/* Keyed task stays in the shared queue, where it can be removed or replaced by key */
+MCL_PRIVATE MclThreadWorker* MclThreadPool_GetLocalWorker(MclThreadPool *self, const MclTask *task) {
+	if (self->isOrdered || MclTaskKey_IsValid(task->key)) return NULL;
+	return (currentWorker && (currentWorker->pool == self)) ? currentWorker : NULL;
+}
+
+MCL_PRIVATE bool MclThreadPool_IsEmpty(const MclThreadPool *self) {
+	if (!MclTaskQueue_IsEmpty(self->taskQueue)) return false;
+
+	MCL_LOOP_FOREACH_INDEX(i, self->threadCount) {
+		if (!MclThreadWorker_IsEmpty(&self->workers[i])) return false;
+	}
+	return true;
+}
+
+///////////////////////////////////////////////////////////
+MCL_PRIVATE void MclThreadPool_ExecuteTask(MclThreadPool *self, MclTask *task) {
+	MCL_LOG_DBG("Task thread popped task (%u).", task->key);
+	MCL_TASK_STATS_ON_START(task);
+	MCL_ASSERT_SUCC_CALL_VOID(MclTask_Execute(task));
+	MCL_TASK_STATS_ON_FINISH(MclTaskQueue_GetStats(self->taskQueue), task);
+	MclTask_Destroy(task);
+}
+
+MCL_PRIVATE bool MclThreadPool_IsElastic(const MclThreadPool *self) {
+	return self->config.minThreads < self->config.maxThreads;
+}
+
+MCL_PRIVATE bool MclThreadPool_IsOverloaded(MclThreadPool *self) {
+	if (!MclThreadPool_IsElastic(self)) return false;
+
+	MclSize runningCount = MclAtomic_LoadAcquire(&self->runningCount);
+	if (runningCount >= self->config.maxThreads) return false;
+	if (runningCount == 0) return !MclThreadPool_IsEmpty(self);
+	if (MclAtomic_LoadAcquire(&self->idleCount) > 0) return false;
+
+	return MclTaskQueue_GetCount(self->taskQueue) > self->config.queueDepthTarget * runningCount;
+}
+
+MCL_PRIVATE void MclThreadPool_JoinWorker(MclThreadPool *self, MclSize index) {
+	if (MclAtomic_LoadAcquire(&self->workers[index].state) == MCL_THREAD_WORKER_FREE) return;
+
+	MCL_PEEK_SUCC_CALL(MclThread_Join(self->threads[index].thread, NULL));
+	MclAtomic_StoreRelease(&self->workers[index].state, MCL_THREAD_WORKER_FREE);
+}
+
+/* IMPORTANT: SHOULD INVOKE WITH scaleLock LOCKED!!! */
+MCL_PRIVATE MclStatus MclThreadPool_LaunchWorker(MclThreadPool *self, MclSize index) {
+	MclThreadWorker *worker = &self->workers[index];
+	if (MclAtomic_LoadAcquire(&worker->state) == MCL_THREAD_WORKER_RUNNING) return MCL_FAILURE;
+
+	MclThreadPool_JoinWorker(self, index);
+
+	MclAtomic_StoreRelease(&worker->state, MCL_THREAD_WORKER_RUNNING);
+	MclAtomic_AddFetch(&self->runningCount, 1);
+	if (MCL_FAILED(MclThreadLauncher_Launch(&self->threads[index], 1))) {
+		MCL_LOG_ERR("%s launch worker %u failed!", self->name, index);
+		MclAtomic_SubFetch(&self->runningCount, 1);
+		MclAtomic_StoreRelease(&worker->state, MCL_THREAD_WORKER_FREE);
+		return MCL_FAILURE;
+	}
+	return MCL_SUCCESS;
 }
 
-MCL_PRIVATE void MclThreadPool_StopThread(void *ctxt) {
-	MclTaskQueue *taskQueue = (MclTaskQueue*)ctxt;
-	MCL_ASSERT_VALID_PTR_VOID(taskQueue);
+/* Only try lock, another one scaling or quitting means no need to grow */
+MCL_PRIVATE void MclThreadPool_TryGrow(MclThreadPool *self) {
+	if (!MclThreadPool_IsOverloaded(self)) return;
+	if (MCL_FAILED(MclMutex_TryLock(&self->scaleLock))) return;
+
+	if (MclTaskQueue_IsRunning(self->taskQueue) && MclThreadPool_IsOverloaded(self)) {
+		MCL_LOOP_FOREACH_INDEX(i, self->threadCount) {
+			if (MCL_SUCCESS == MclThreadPool_LaunchWorker(self, i)) {
+				MCL_LOG_DBG("%s grow worker %u.", self->name, i);
+				break;
+			}
+		}
+	}
+	(void)MclMutex_UnLock(&self->scaleLock);
+}
+
+MCL_PRIVATE bool MclThreadPool_TryRetire(MclThreadPool *self) {
+	MclSize runningCount = MclAtomic_LoadAcquire(&self->runningCount);
+	while (runningCount > self->config.minThreads) {
+		if (MclAtomic_CompareExchange(&self->runningCount, &runningCount, runningCount - 1)) {
+			return true;
+		}
+	}
+	return false;
+}
+
+/* Worker is busy unless parked, a popped task always belongs to a busy worker */
+MCL_PRIVATE void MclThreadPool_EnterBusy(MclThreadPool *self) {
+	MclAtomic_AddFetch(&self->busyCount, 1);
+}
+
+MCL_PRIVATE void MclThreadPool_LeaveBusy(MclThreadPool *self) {
+	if (MclAtomic_SubFetch(&self->busyCount, 1) == 0) {
+		MclEventCount_NotifyAll(&self->allIdle);
+	}
+}
 
-	MclTaskQueue_Stop(taskQueue);
+MCL_PRIVATE bool MclThreadPool_IsDone(const MclThreadPool *self) {
+	return (MclAtomic_LoadAcquire(&self->busyCount) == 0) && MclThreadPool_IsEmpty(self);
+}
+
+MCL_PRIVATE MclStatus MclThreadPool_WaitTask(MclThreadPool *self, MclThreadWorker *worker) {
+	MclSize key = MclEventCount_PrepareWait(&self->workReady);
+
+	MclTask *task = MclThreadPool_FindTask(self, worker);
+	if (task || !MclTaskQueue_IsRunning(self->taskQueue)) {
+		MclEventCount_CancelWait(&self->workReady);
+		if (task) MclThreadPool_ExecuteTask(self, task);
+		return MCL_SUCCESS;
+	}
+
+	MclAtomic_AddFetch(&self->idleCount, 1);
+	MclThreadPool_LeaveBusy(self);
+	MclStatus ret = MclEventCount_WaitUntil(&self->workReady, key, MclEventCount_GetDeadline(self->config.idleTimeoutUs));
+	MclThreadPool_EnterBusy(self);
+	MclAtomic_SubFetch(&self->idleCount, 1);
+	return ret;
+}
+
+MCL_PRIVATE void MclThreadPool_RunThread(void *ctxt) {
+	MclThreadWorker *worker = (MclThreadWorker*)ctxt;
+	MCL_ASSERT_VALID_PTR_VOID(worker);
+
+	MclThreadPool *self = worker->pool;
+	currentWorker = worker;
+	MclThreadPool_EnterBusy(self);
+
+	while (MclTaskQueue_IsRunning(self->taskQueue)) {
+		MclTask *task = MclThreadPool_FindTask(self, worker);
+		if (task) {
+			MclThreadPool_TryGrow(self);
+			MclThreadPool_ExecuteTask(self, task);
+		} else if (MclThreadPool_WaitTask(self, worker) == MCL_TIMEDOUT) {
+			if (MclThreadWorker_IsEmpty(worker) && MclThreadPool_TryRetire(self)) {
+				MCL_LOG_DBG("%s retire worker %u.", self->name, worker->index);
+				break;
+			}
+		}
+	}
+	MclThreadPool_LeaveBusy(self);
+	currentWorker = NULL;
+	MclAtomic_StoreRelease(&worker->state, MCL_THREAD_WORKER_EXITED);
 }
 
 MCL_PRIVATE MclStatus MclThreadPool_Launch(MclThreadPool *self) {
@@ -47,10 +368,18 @@ MCL_PRIVATE MclStatus MclThreadPool_Launch(MclThreadPool *self) {
 
     MclTaskQueue_Start(self->taskQueue);
 
-    if (MCL_FAILED(MclThreadLauncher_Launch(self->threads, self->threadCount))) {
-        MCL_LOG_ERR("%s launch threads failed!", self->name);
-        MclTaskQueue_Stop(self->taskQueue);
-        return MCL_FAILURE;
+    MCL_LOCK_AUTO(self->scaleLock);
+    MCL_LOOP_FOREACH_INDEX(i, self->config.minThreads) {
+        if (MCL_FAILED(MclThreadPool_LaunchWorker(self, i))) {
+            MCL_LOG_ERR("%s launch threads failed!", self->name);
+            MclTaskQueue_Stop(self->taskQueue);
+            MclEventCount_NotifyAll(&self->workReady);
+            MCL_LOOP_FOREACH_INDEX(j, self->threadCount) {
+                MclThreadPool_JoinWorker(self, j);
+            }
+            MclAtomic_Clear(&self->runningCount);
+            return MCL_FAILURE;
+        }
     }
     MCL_LOG_DBG("%s launch OK!", self->name);
     return MCL_SUCCESS;
@@ -58,42 +387,142 @@ MCL_PRIVATE MclStatus MclThreadPool_Launch(MclThreadPool *self) {
 
 MCL_PRIVATE MclStatus MclThreadPool_Quit(MclThreadPool *self) {
     MCL_LOG_DBG("%s quit begin...", self->name);
-    MclThreadLauncher_WaitDone(self->threads, self->threadCount);
+
+    MclTaskQueue_Stop(self->taskQueue);
+    MclEventCount_NotifyAll(&self->workReady);
+
+    MCL_LOCK_AUTO(self->scaleLock);
+    MCL_LOOP_FOREACH_INDEX(i, self->threadCount) {
+        MclThreadPool_JoinWorker(self, i);
+    }
+    MclAtomic_Clear(&self->runningCount);
+
     MCL_LOG_DBG("%s quit OK!", self->name);
     return MCL_SUCCESS;
 }
 
-MCL_PRIVATE void MclThreadPool_InitThread(MclThreadPool *self, MclSize index)
+/* Candidates are the cpus list if given, else the cpus allowed to the creating thread */
+MCL_PRIVATE void MclThreadPool_PinThread(MclThreadPool *self, MclSize index, const MclSize *cpus, MclSize cpuCount,
+		MclCpuSet *affinity) {
+	if (cpuCount == 0) return;
+
+	switch (self->config.pinning) {
+	case MCL_THREAD_PIN_COMPACT:
+		MclCpuSet_Add(affinity, cpus[index % cpuCount]);
+		break;
+	case MCL_THREAD_PIN_SCATTER: {
+		MclSize stride = (cpuCount > self->config.maxThreads) ? cpuCount / self->config.maxThreads : 1;
+		MclCpuSet_Add(affinity, cpus[(index * stride + index / cpuCount) % cpuCount]);
+		break;
+	}
+	case MCL_THREAD_PIN_EXPLICIT:
+		MCL_LOOP_FOREACH_INDEX(i, cpuCount) {
+			MclCpuSet_Add(affinity, cpus[i]);
+		}
+		break;
+	default:
+		break;
+	}
+}
+
+MCL_PRIVATE void MclThreadPool_InitThread(MclThreadPool *self, MclSize index, const MclSize *cpus, MclSize cpuCount)
 {
 	self->threads[index].name = self->name;
 	self->threads[index].run = MclThreadPool_RunThread;
-	self->threads[index].stop = (index == 0) ? MclThreadPool_StopThread : NULL;
-	self->threads[index].ctxt = self->taskQueue;
+	self->threads[index].stop = NULL;
+	self->threads[index].ctxt = NULL;
+	self->threads[index].options = self->config.options;
+	MclCpuSet_Clear(&self->threads[index].options.affinity);
+	MclThreadPool_PinThread(self, index, cpus, cpuCount, &self->threads[index].options.affinity);
 }
 
 MCL_PRIVATE MclStatus MclThreadPool_InitThreads(MclThreadPool *self, MclSize threadCount)
 {
+	MclSize allowedCpus[MCL_CPU_SET_MAX];
+	const MclSize *cpus = self->config.cpus;
+	MclSize cpuCount = self->config.cpuCount;
+	if (!cpus && (self->config.pinning != MCL_THREAD_PIN_NONE)) {
+		cpuCount = MclThread_GetAllowedCpus(allowedCpus, MCL_CPU_SET_MAX);
+		cpus = allowedCpus;
+	}
+
 	MCL_LOOP_FOREACH_INDEX(i, threadCount) {
-		MclThreadPool_InitThread(self, i);
+		MclThreadPool_InitThread(self, i, cpus, cpuCount);
 	}
     self->threadCount = threadCount;
     return MCL_SUCCESS;
 }
 
-MCL_PRIVATE MclStatus MclThreadPool_Init(MclThreadPool *self, const char *name, MclSize threadCount) {
+MCL_PRIVATE void MclThreadPool_DestroyWorkers(MclThreadPool *self) {
+	if (!self->workers) return;
+
+	MCL_LOOP_FOREACH_INDEX(i, self->threadCount) {
+		MclThreadWorker_Destroy(&self->workers[i]);
+		self->threads[i].ctxt = NULL;
+	}
+	MCL_FREE(self->workers);
+	self->workers = NULL;
+	self->levelCount = 0;
+}
+
+MCL_PRIVATE MclStatus MclThreadPool_InitWorkers(MclThreadPool *self) {
+	self->levelCount = MclTaskQueue_GetPriorities(self->taskQueue);
+	self->isOrdered = MclTaskQueue_GetPolicy(self->taskQueue) != MCL_TASK_POLICY_PRIORITY;
+	self->workers = MCL_MALLOC(sizeof(MclThreadWorker) * self->threadCount);
+	MCL_ASSERT_VALID_PTR(self->workers);
+	MCL_MEM_CLEAR(self->workers, sizeof(MclThreadWorker) * self->threadCount);
+
+	MCL_LOOP_FOREACH_INDEX(i, self->threadCount) {
+		if (MCL_FAILED(MclThreadWorker_Init(&self->workers[i], self, i))) {
+			MCL_LOG_ERR("%s init worker %u failed!", self->name, i);
+			MclThreadPool_DestroyWorkers(self);
+			return MCL_FAILURE;
+		}
+		self->threads[i].ctxt = &self->workers[i];
+	}
+	return MCL_SUCCESS;
+}
+
+MCL_PRIVATE MclStatus MclThreadPool_Init(MclThreadPool *self, const char *name, const MclThreadPoolConfig *config) {
 	self->name = name ? name : "MclThreadPool";
     self->taskQueue = NULL;
-    MCL_ASSERT_SUCC_CALL(MclThreadPool_InitThreads(self, threadCount));
+    self->workers = NULL;
+    self->levelCount = 0;
+    self->isOrdered = false;
+    self->config = *config;
+    MclAtomic_Clear(&self->runningCount);
+    MclAtomic_Clear(&self->idleCount);
+    MclAtomic_Clear(&self->busyCount);
+    MCL_ASSERT_SUCC_CALL(MclMutex_Init(&self->scaleLock, NULL));
+    if (MCL_FAILED(MclEventCount_Init(&self->workReady))) {
+        (void)MclMutex_Destroy(&self->scaleLock);
+        return MCL_FAILURE;
+    }
+    if (MCL_FAILED(MclEventCount_Init(&self->allIdle))) {
+        MclEventCount_Destroy(&self->workReady);
+        (void)MclMutex_Destroy(&self->scaleLock);
+        return MCL_FAILURE;
+    }
+    MCL_ASSERT_SUCC_CALL(MclThreadPool_InitThreads(self, config->maxThreads));
     return MCL_SUCCESS;
 }
 
 MclThreadPool* MclThreadPool_Create(const char *name, MclSize threadCount) {
-	MCL_ASSERT_TRUE_NIL(threadCount > 0);
+	MclThreadPoolConfig config = MCL_THREAD_POOL_CONFIG_FIXED(threadCount);
+	return MclThreadPool_CreateElastic(name, &config);
+}
+
+MclThreadPool* MclThreadPool_CreateElastic(const char *name, const MclThreadPoolConfig *config) {
+	MCL_ASSERT_VALID_PTR_NIL(config);
+	MCL_ASSERT_TRUE_NIL(config->maxThreads > 0);
+	MCL_ASSERT_TRUE_NIL(config->minThreads <= config->maxThreads);
+	MCL_ASSERT_TRUE_NIL(!config->cpus || config->cpuCount > 0);
+	MCL_ASSERT_TRUE_NIL(config->pinning != MCL_THREAD_PIN_EXPLICIT || config->cpus);
 
-	MclThreadPool *self = MCL_MALLOC(sizeof(MclThreadPool) + sizeof(MclThreadInfo) * threadCount);
+	MclThreadPool *self = MCL_MALLOC(sizeof(MclThreadPool) + sizeof(MclThreadInfo) * config->maxThreads);
 	MCL_ASSERT_VALID_PTR_NIL(self);
 
-	if (MCL_FAILED(MclThreadPool_Init(self, name, threadCount))) {
+	if (MCL_FAILED(MclThreadPool_Init(self, name, config))) {
 		MCL_LOG_ERR("%s init failed!", self->name);
 		MCL_FREE(self);
 		return NULL;
@@ -112,6 +541,10 @@ void MclThreadPool_Delete(MclThreadPool *self) {
 		}
 	//	MclTaskQueue_Delete(self->taskQueue); // TODO : should delete out or by args?
 	}
+	MclThreadPool_DestroyWorkers(self);
+	MclEventCount_Destroy(&self->workReady);
+	MclEventCount_Destroy(&self->allIdle);
+	MCL_PEEK_SUCC_CALL(MclMutex_Destroy(&self->scaleLock));
     MCL_LOG_DBG("%s delete OK!", self->name);
 	MCL_FREE(self);
 }
@@ -123,6 +556,7 @@ MclStatus MclThreadPool_Start(MclThreadPool *self) {
 	if (MclTaskQueue_IsRunning(self->taskQueue)) return MCL_SUCCESS;
 
     MCL_ASSERT_SUCC_CALL(MclThreadPool_Launch(self));
+    MclThreadPool_TryGrow(self);
     MCL_LOG_DBG("%s start OK!", self->name);
 	return MCL_SUCCESS;
 }
@@ -152,8 +586,9 @@ MclStatus MclThreadPool_SubmitTaskQueue(MclThreadPool *self, MclTaskQueue *queue
 	MCL_ASSERT_TRUE(self->taskQueue == NULL);
 
 	self->taskQueue = queue;
-	MCL_LOOP_FOREACH_INDEX(i, self->threadCount) {
-		self->threads[i].ctxt = self->taskQueue;
+	if (MCL_FAILED(MclThreadPool_InitWorkers(self))) {
+		self->taskQueue = NULL;
+		return MCL_FAILURE;
 	}
 
 	MCL_LOG_DBG("%s submit task queue OK!", self->name);
@@ -164,6 +599,7 @@ MclTaskQueue* MclThreadPool_RemoveTaskQueue(MclThreadPool *self)
 {
 	MCL_ASSERT_VALID_PTR_NIL(self);
 
+	MclThreadPool_DestroyWorkers(self);
 	MclTaskQueue *queue = self->taskQueue;
 	self->taskQueue = NULL;
 
@@ -171,18 +607,105 @@ MclTaskQueue* MclThreadPool_RemoveTaskQueue(MclThreadPool *self)
 	return queue;
 }
 
+MclStatus MclThreadPool_SubmitTask(MclThreadPool *self, MclTask *task, MclTaskPriority priority) {
+	MCL_ASSERT_VALID_PTR(self);
+	MCL_ASSERT_VALID_PTR(self->taskQueue);
+	MCL_ASSERT_VALID_PTR(task);
+	MCL_ASSERT_TRUE(priority < self->levelCount);
+
+	MCL_TASK_STATS_ON_SUBMIT(MclTaskQueue_GetStats(self->taskQueue), task, priority);
+
+	MclThreadWorker *worker = MclThreadPool_GetLocalWorker(self, task);
+	if (!worker || MCL_FAILED(MclTaskDeque_Push(&worker->levels[priority].deque, task))) {
+		MCL_ASSERT_SUCC_CALL(MclTaskQueue_AddTask(self->taskQueue, task, priority));
+	}
+	MclEventCount_Notify(&self->workReady);
+	MclThreadPool_TryGrow(self);
+	return MCL_SUCCESS;
+}
+
+MclStatus MclThreadPool_SubmitTaskWithDeadline(MclThreadPool *self, MclTask *task, MclTaskPriority priority, MclTimeUs deadlineUs) {
+	MCL_ASSERT_VALID_PTR(self);
+	MCL_ASSERT_VALID_PTR(self->taskQueue);
+	MCL_ASSERT_VALID_PTR(task);
+	MCL_ASSERT_TRUE(priority < self->levelCount);
+
+	MCL_TASK_STATS_ON_SUBMIT(MclTaskQueue_GetStats(self->taskQueue), task, priority);
+	MCL_ASSERT_SUCC_CALL(MclTaskQueue_AddTaskWithDeadline(self->taskQueue, task, priority, deadlineUs));
+	MclEventCount_Notify(&self->workReady);
+	MclThreadPool_TryGrow(self);
+	return MCL_SUCCESS;
+}
+
+MclStatus MclThreadPool_ReplaceTask(MclThreadPool *self, MclTask *task, MclTaskPriority priority) {
+	MCL_ASSERT_VALID_PTR(self);
+	MCL_ASSERT_VALID_PTR(self->taskQueue);
+	MCL_ASSERT_VALID_PTR(task);
+	MCL_ASSERT_TRUE(priority < self->levelCount);
+
+	MCL_TASK_STATS_ON_SUBMIT(MclTaskQueue_GetStats(self->taskQueue), task, priority);
+	MCL_ASSERT_SUCC_CALL(MclTaskQueue_ReplaceTask(self->taskQueue, task, priority));
+	MclEventCount_Notify(&self->workReady);
+	MclThreadPool_TryGrow(self);
+	return MCL_SUCCESS;
+}
+
+MclSize MclThreadPool_SubmitTasks(MclThreadPool *self, MclTask **tasks, MclSize count, MclTaskPriority priority) {
+	MCL_ASSERT_VALID_PTR_R(self, 0);
+	MCL_ASSERT_VALID_PTR_R(self->taskQueue, 0);
+	MCL_ASSERT_TRUE_R(count == 0 || tasks != NULL, 0);
+	MCL_ASSERT_TRUE_R(priority < self->levelCount, 0);
+	MCL_LOOP_FOREACH_INDEX(i, count) {
+		MCL_ASSERT_VALID_PTR_R(tasks[i], 0);
+		MCL_TASK_STATS_ON_STAMP(tasks[i], priority);
+	}
+
+	MclSize submitted = 0;
+	while (submitted < count) {
+		MclThreadWorker *worker = MclThreadPool_GetLocalWorker(self, tasks[submitted]);
+		if (!worker || MCL_FAILED(MclTaskDeque_Push(&worker->levels[priority].deque, tasks[submitted]))) break;
+		submitted++;
+	}
+	submitted += MclTaskQueue_AddTasks(self->taskQueue, tasks + submitted, count - submitted, priority);
+	MCL_TASK_STATS_ON_SUBMITTED(MclTaskQueue_GetStats(self->taskQueue), priority, submitted);
+
+	/* at least one wakeup bumps the epoch, so a worker going to park never misses the batch */
+	MclSize idleCount = MclAtomic_LoadAcquire(&self->idleCount);
+	MclEventCount_NotifyN(&self->workReady, (submitted < idleCount) ? submitted : (idleCount ? idleCount : 1));
+	MclThreadPool_TryGrow(self);
+	return submitted;
+}
+
+MclSize MclThreadPool_GetThreadCount(const MclThreadPool *self) {
+	MCL_ASSERT_VALID_PTR_R(self, 0);
+	return MclAtomic_LoadAcquire(&self->runningCount);
+}
+
 void MclThreadPool_LocalExecute(MclThreadPool *self) {
 	MCL_ASSERT_VALID_PTR_VOID(self);
 	MCL_ASSERT_VALID_PTR_VOID(self->taskQueue);
 
     MCL_LOG_DBG("%s execute in local begin!", self->name);
 
-	while (!MclTaskQueue_IsEmpty(self->taskQueue)) {
-        MclThreadPool_ExecuteTask(self->taskQueue);
+	MclTask *task = NULL;
+	while ((task = MclThreadPool_FindTask(self, NULL))) {
+		MclThreadPool_ExecuteTask(self, task);
 	}
 	MCL_LOG_DBG("%s executed in local done!", self->name);
 }
 
+bool MclThreadPool_TryLocalExecute(MclThreadPool *self) {
+	MCL_ASSERT_VALID_PTR_BOOL(self);
+	MCL_ASSERT_VALID_PTR_BOOL(self->taskQueue);
+
+	MclThreadWorker *worker = (currentWorker && (currentWorker->pool == self)) ? currentWorker : NULL;
+	MclTask *task = MclThreadPool_FindTask(self, worker);
+	if (!task) return false;
+
+	MclThreadPool_ExecuteTask(self, task);
+	return true;
+}
+
 void MclThreadPool_WaitDone(MclThreadPool *self) {
     MCL_ASSERT_VALID_PTR_VOID(self);
     MCL_ASSERT_VALID_PTR_VOID(self->taskQueue);
@@ -190,12 +713,13 @@ void MclThreadPool_WaitDone(MclThreadPool *self) {
 
     MCL_LOG_DBG("%s wait begin.", self->name);
 
-    while (!MclTaskQueue_IsEmpty(self->taskQueue)) {
-        if (self->threadCount == 0) {
-            MclThreadPool_ExecuteTask(self->taskQueue);
-        } else {
-            MclThread_Yield();
+    while (true) {
+        MclSize key = MclEventCount_PrepareWait(&self->allIdle);
+        if (MclThreadPool_IsDone(self) || !MclTaskQueue_IsRunning(self->taskQueue)) {
+            MclEventCount_CancelWait(&self->allIdle);
+            break;
         }
+        (void)MclEventCount_WaitUntil(&self->allIdle, key, MCL_TIME_US_INVALID);
     }
     MCL_LOG_DBG("%s wait done!", self->name);
 }
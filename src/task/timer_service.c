@@ -0,0 +1,182 @@
+#include "mcl/task/timer_service.h"
+#include "mcl/thread/thread_launcher.h"
+#include "mcl/lock/event_count.h"
+#include "mcl/lock/atomic.h"
+#include "mcl/lock/mutex.h"
+#include "mcl/mem/memory.h"
+#include "mcl/assert.h"
+
+MCL_TYPE(MclTimerService) {
+	const char *name;
+	MclTimeUs tickUs;
+	MclAtomic isRunning;
+	MclMutex mutex;
+	MclEventCount changed;
+	MclThreadInfo thread;
+	MclTimerWheel wheel;
+};
+
+/* Deadline of 0 timeout is just the monotonic now */
+MCL_PRIVATE MclTimeUs MclTimerService_GetNowUs() {
+	return MclEventCount_GetDeadline(0);
+}
+
+MCL_PRIVATE MclTimerTick MclTimerService_GetNowTick(const MclTimerService *self) {
+	return MclTimerService_GetNowUs() / self->tickUs;
+}
+
+MCL_PRIVATE MclTimerTick MclTimerService_ToTicks(const MclTimerService *self, MclTimeUs us) {
+	return (us + self->tickUs - 1) / self->tickUs;
+}
+
+/* Returns the deadline to sleep until, which is the next tick anything fires or cascades */
+MCL_PRIVATE MclTimeUs MclTimerService_Advance(MclTimerService *self) {
+	MCL_LOCK_AUTO(self->mutex);
+
+	(void)MclTimerWheel_Advance(&self->wheel, MclTimerService_GetNowTick(self));
+	if (MclTimerWheel_GetCount(&self->wheel) == 0) return MCL_TIME_US_INVALID;
+
+	return MclTimerWheel_GetNextTick(&self->wheel) * self->tickUs;
+}
+
+MCL_PRIVATE void MclTimerService_RunThread(void *ctxt) {
+	MclTimerService *self = (MclTimerService*)ctxt;
+	MCL_ASSERT_VALID_PTR_VOID(self);
+
+	while (MclAtomic_IsTrue(&self->isRunning)) {
+		MclSize key = MclEventCount_PrepareWait(&self->changed);
+
+		MclTimeUs deadline = MclTimerService_Advance(self);
+		if (!MclAtomic_IsTrue(&self->isRunning)) {
+			MclEventCount_CancelWait(&self->changed);
+			break;
+		}
+		(void)MclEventCount_WaitUntil(&self->changed, key, deadline);
+	}
+}
+
+MCL_PRIVATE void MclTimerService_StopThread(void *ctxt) {
+	MclTimerService *self = (MclTimerService*)ctxt;
+	MCL_ASSERT_VALID_PTR_VOID(self);
+
+	MclAtomic_Clear(&self->isRunning);
+	MclEventCount_NotifyAll(&self->changed);
+}
+
+MCL_PRIVATE MclStatus MclTimerService_Init(MclTimerService *self, const char *name, MclTimeUs tickUs) {
+	self->name = name ? name : "MclTimerService";
+	self->tickUs = tickUs;
+	MclAtomic_Clear(&self->isRunning);
+	MclTimerWheel_Init(&self->wheel, MclTimerService_GetNowTick(self));
+
+	MclThreadInfo thread = MCL_THREAD_INFO(self->name, MclTimerService_RunThread, MclTimerService_StopThread, self);
+	self->thread = thread;
+
+	MCL_ASSERT_SUCC_CALL(MclMutex_InitRecursive(&self->mutex));
+	if (MCL_FAILED(MclEventCount_Init(&self->changed))) {
+		(void)MclMutex_Destroy(&self->mutex);
+		return MCL_FAILURE;
+	}
+	return MCL_SUCCESS;
+}
+
+MclTimerService* MclTimerService_Create(const char *name, MclTimeUs tickUs) {
+	MCL_ASSERT_TRUE_NIL(tickUs > 0);
+
+	MclTimerService *self = MCL_MALLOC(sizeof(MclTimerService));
+	MCL_ASSERT_VALID_PTR_NIL(self);
+
+	if (MCL_FAILED(MclTimerService_Init(self, name, tickUs))) {
+		MCL_LOG_ERR("%s init failed!", self->name);
+		MCL_FREE(self);
+		return NULL;
+	}
+	return self;
+}
+
+void MclTimerService_Delete(MclTimerService *self) {
+	MCL_ASSERT_VALID_PTR_VOID(self);
+
+	(void)MclTimerService_Stop(self);
+	{
+		MCL_LOCK_AUTO(self->mutex);
+		MclTimerWheel_Clear(&self->wheel);
+	}
+	MclEventCount_Destroy(&self->changed);
+	MCL_PEEK_SUCC_CALL(MclMutex_Destroy(&self->mutex));
+	MCL_FREE(self);
+}
+
+MclStatus MclTimerService_Start(MclTimerService *self) {
+	MCL_ASSERT_VALID_PTR(self);
+
+	if (MclAtomic_IsTrue(&self->isRunning)) return MCL_SUCCESS;
+
+	MclAtomic_Set(&self->isRunning, 1);
+	if (MCL_FAILED(MclThreadLauncher_Launch(&self->thread, 1))) {
+		MCL_LOG_ERR("%s launch thread failed!", self->name);
+		MclAtomic_Clear(&self->isRunning);
+		return MCL_FAILURE;
+	}
+	MCL_LOG_DBG("%s start OK!", self->name);
+	return MCL_SUCCESS;
+}
+
+MclStatus MclTimerService_Stop(MclTimerService *self) {
+	MCL_ASSERT_VALID_PTR(self);
+
+	if (!MclAtomic_IsTrue(&self->isRunning)) return MCL_SUCCESS;
+
+	MclThreadLauncher_WaitDone(&self->thread, 1);
+	MCL_LOG_DBG("%s stop OK!", self->name);
+	return MCL_SUCCESS;
+}
+
+bool MclTimerService_IsRunning(const MclTimerService *self) {
+	MCL_ASSERT_VALID_PTR_BOOL(self);
+	return MclAtomic_IsTrue((MclAtomic*)&self->isRunning);
+}
+
+MclStatus MclTimerService_Add(MclTimerService *self, MclTimer *timer, MclTimeUs delayUs, MclTimeUs periodUs) {
+	MCL_ASSERT_VALID_PTR(self);
+	MCL_ASSERT_VALID_PTR(timer);
+
+	MclTimeUs nowUs = MclTimerService_GetNowUs();
+	MclTimerTick periodTicks = periodUs ? MCL_MAX(MclTimerService_ToTicks(self, periodUs), 1) : 0;
+	{
+		MCL_LOCK_AUTO(self->mutex);
+
+		if (MclTimerWheel_GetCount(&self->wheel) == 0) {
+			MclTimerWheel_Init(&self->wheel, nowUs / self->tickUs);
+		}
+		MclTimerTick expireTick = MclTimerService_ToTicks(self, nowUs + delayUs);
+		MclTimerTick currentTick = MclTimerWheel_GetCurrentTick(&self->wheel);
+		MclTimerTick delayTicks = (expireTick > currentTick) ? (expireTick - currentTick) : 0;
+
+		MCL_ASSERT_SUCC_CALL(MclTimerWheel_Add(&self->wheel, timer, delayTicks, periodTicks));
+	}
+	MclEventCount_Notify(&self->changed);
+	return MCL_SUCCESS;
+}
+
+MclStatus MclTimerService_Cancel(MclTimerService *self, MclTimer *timer) {
+	MCL_ASSERT_VALID_PTR(self);
+	MCL_ASSERT_VALID_PTR(timer);
+
+	MCL_LOCK_AUTO(self->mutex);
+	return MclTimerWheel_Cancel(&self->wheel, timer);
+}
+
+MclSize MclTimerService_RemoveAllByPred(MclTimerService *self, MclTimerPred pred, void *arg) {
+	MCL_ASSERT_VALID_PTR_R(self, 0);
+
+	MCL_LOCK_AUTO(self->mutex);
+	return MclTimerWheel_RemoveAllByPred(&self->wheel, pred, arg);
+}
+
+MclSize MclTimerService_GetCount(MclTimerService *self) {
+	MCL_ASSERT_VALID_PTR_R(self, 0);
+
+	MCL_LOCK_AUTO(self->mutex);
+	return MclTimerWheel_GetCount(&self->wheel);
+}
@@ -0,0 +1,257 @@
+#include "mcl/task/timer_wheel.h"
+#include "mcl/algo/loop.h"
+#include "mcl/assert.h"
+
+#define MCL_TIMER_WHEEL_LEVEL0_MASK  ((MclTimerTick)MCL_TIMER_WHEEL_LEVEL0_SIZE - 1)
+#define MCL_TIMER_WHEEL_LEVEL_MASK   ((MclTimerTick)MCL_TIMER_WHEEL_LEVEL_SIZE - 1)
+
+MCL_PRIVATE MclSize MclTimerWheel_GetLevelShift(MclSize level) {
+	return MCL_TIMER_WHEEL_LEVEL0_BITS + MCL_TIMER_WHEEL_LEVEL_BITS * level;
+}
+
+MCL_PRIVATE MclSize MclTimerWheel_GetLevelIndex(MclTimerTick tick, MclSize level) {
+	return (tick >> MclTimerWheel_GetLevelShift(level)) & MCL_TIMER_WHEEL_LEVEL_MASK;
+}
+
+/* Timer beyond the range waits in the top level slot of its expire tick,
+ * and is linked again by each cascade of the slot until it comes in range */
+MCL_PRIVATE MclTimerLink* MclTimerWheel_GetSlot(MclTimerWheel *self, MclTimerTick expireTick) {
+	MclTimerTick delta = expireTick - self->currentTick;
+	if (delta < MCL_TIMER_WHEEL_LEVEL0_SIZE) {
+		return &self->level0[expireTick & MCL_TIMER_WHEEL_LEVEL0_MASK];
+	}
+	MCL_LOOP_FOREACH_INDEX(level, MCL_TIMER_WHEEL_LEVEL_NUM - 1) {
+		if (delta < ((MclTimerTick)1 << MclTimerWheel_GetLevelShift(level + 1))) {
+			return &self->levels[level][MclTimerWheel_GetLevelIndex(expireTick, level)];
+		}
+	}
+	return &self->levels[MCL_TIMER_WHEEL_LEVEL_NUM - 2][MclTimerWheel_GetLevelIndex(expireTick, MCL_TIMER_WHEEL_LEVEL_NUM - 2)];
+}
+
+MCL_PRIVATE void MclTimerWheel_Link(MclTimerWheel *self, MclTimer *timer) {
+	if (timer->expireTick < self->currentTick) {
+		timer->expireTick = self->currentTick;
+	}
+	MclTimerLink *slot = MclTimerWheel_GetSlot(self, timer->expireTick);
+	MCL_LINK_INSERT_TAIL(slot, timer, MclTimer, link);
+}
+
+MCL_PRIVATE void MclTimerWheel_Unlink(MclTimer *timer) {
+	MCL_LINK_REMOVE(timer, link);
+	timer->link.next = NULL;
+	timer->link.prev = NULL;
+}
+
+/* Slot is moved out before relinked, as a timer still beyond the range goes back to the same slot */
+MCL_PRIVATE void MclTimerWheel_Cascade(MclTimerWheel *self, MclSize level) {
+	MclTimerLink *cascadeSlot = &self->levels[level][MclTimerWheel_GetLevelIndex(self->currentTick, level)];
+	if (MCL_LINK_EMPTY(cascadeSlot, MclTimer, link)) return;
+
+	MclTimerLink slot;
+	MCL_LINK_INIT(&slot, MclTimer, link);
+	MclTimer *first = MCL_LINK_FIRST(cascadeSlot);
+	MclTimer *last = MCL_LINK_LAST(cascadeSlot);
+	MCL_LINK_UNSPLICE(first, last, link);
+	MCL_LINK_SPLICE_TAIL(&slot, first, last, MclTimer, link);
+
+	while (!MCL_LINK_EMPTY(&slot, MclTimer, link)) {
+		MclTimer *timer = MCL_LINK_FIRST(&slot);
+		MCL_LINK_REMOVE(timer, link);
+		MclTimerWheel_Link(self, timer);
+	}
+}
+
+/* Cascades lower level first, upper level only when the lower one turns round */
+MCL_PRIVATE void MclTimerWheel_CascadeLevels(MclTimerWheel *self) {
+	MCL_LOOP_FOREACH_INDEX(level, MCL_TIMER_WHEEL_LEVEL_NUM - 1) {
+		MclTimerTick lowerMask = ((MclTimerTick)1 << MclTimerWheel_GetLevelShift(level)) - 1;
+		if ((self->currentTick & lowerMask) != 0) break;
+		MclTimerWheel_Cascade(self, level);
+	}
+}
+
+MCL_PRIVATE MclSize MclTimerWheel_FireSlot(MclTimerWheel *self, MclTimerLink *slot) {
+	MclSize firedCount = 0;
+	while (!MCL_LINK_EMPTY(slot, MclTimer, link)) {
+		MclTimer *timer = MCL_LINK_FIRST(slot);
+		MclTimerWheel_Unlink(timer);
+
+		if (timer->periodTicks) {
+			timer->expireTick += timer->periodTicks;
+			MclTimerWheel_Link(self, timer);
+		} else {
+			self->timerCount--;
+		}
+		firedCount++;
+		if (timer->expire) timer->expire(timer);
+	}
+	return firedCount;
+}
+
+MCL_PRIVATE MclSize MclTimerWheel_Step(MclTimerWheel *self) {
+	MclTimerTick tick = self->currentTick;
+	MclTimerWheel_CascadeLevels(self);
+
+	/* due timers are moved out before fired, so expire may add timers to the same slot */
+	MclTimerLink *slot = &self->dueTimers;
+	MCL_LINK_INIT(slot, MclTimer, link);
+
+	MclTimerLink *dueSlot = &self->level0[tick & MCL_TIMER_WHEEL_LEVEL0_MASK];
+	if (!MCL_LINK_EMPTY(dueSlot, MclTimer, link)) {
+		MclTimer *first = MCL_LINK_FIRST(dueSlot);
+		MclTimer *last = MCL_LINK_LAST(dueSlot);
+		MCL_LINK_UNSPLICE(first, last, link);
+		MCL_LINK_SPLICE_TAIL(slot, first, last, MclTimer, link);
+	}
+
+	self->currentTick = tick + 1;
+	return MclTimerWheel_FireSlot(self, slot);
+}
+
+///////////////////////////////////////////////////////////
+void MclTimer_Init(MclTimer *self, MclTimerExpire expire, MclTimerDestroy destroy) {
+	MCL_ASSERT_VALID_PTR_VOID(self);
+
+	self->link.next = NULL;
+	self->link.prev = NULL;
+	self->expireTick = 0;
+	self->periodTicks = 0;
+	self->expire = expire;
+	self->destroy = destroy;
+}
+
+bool MclTimer_IsPending(const MclTimer *self) {
+	return MCL_LINK_NODE_IS_IN_LINK(self, link);
+}
+
+void MclTimerWheel_Init(MclTimerWheel *self, MclTimerTick currentTick) {
+	MCL_ASSERT_VALID_PTR_VOID(self);
+
+	self->currentTick = currentTick;
+	self->timerCount = 0;
+	MCL_LOOP_FOREACH_INDEX(i, MCL_TIMER_WHEEL_LEVEL0_SIZE) {
+		MCL_LINK_INIT(&self->level0[i], MclTimer, link);
+	}
+	MCL_LOOP_FOREACH_INDEX(level, MCL_TIMER_WHEEL_LEVEL_NUM - 1) {
+		MCL_LOOP_FOREACH_INDEX(i, MCL_TIMER_WHEEL_LEVEL_SIZE) {
+			MCL_LINK_INIT(&self->levels[level][i], MclTimer, link);
+		}
+	}
+	MCL_LINK_INIT(&self->dueTimers, MclTimer, link);
+}
+
+MCL_PRIVATE bool MclTimerPred_All(MclTimer *timer, void *arg) {
+	(void)timer;
+	(void)arg;
+	return true;
+}
+
+void MclTimerWheel_Clear(MclTimerWheel *self) {
+	MCL_ASSERT_VALID_PTR_VOID(self);
+	(void)MclTimerWheel_RemoveAllByPred(self, MclTimerPred_All, NULL);
+}
+
+MclStatus MclTimerWheel_Add(MclTimerWheel *self, MclTimer *timer, MclTimerTick delayTicks, MclTimerTick periodTicks) {
+	MCL_ASSERT_VALID_PTR(self);
+	MCL_ASSERT_VALID_PTR(timer);
+	MCL_ASSERT_TRUE(!MclTimer_IsPending(timer));
+
+	timer->expireTick = self->currentTick + delayTicks;
+	timer->periodTicks = periodTicks;
+	MclTimerWheel_Link(self, timer);
+	self->timerCount++;
+	return MCL_SUCCESS;
+}
+
+MclStatus MclTimerWheel_Cancel(MclTimerWheel *self, MclTimer *timer) {
+	MCL_ASSERT_VALID_PTR(self);
+	MCL_ASSERT_VALID_PTR(timer);
+
+	if (!MclTimer_IsPending(timer)) return MCL_FAILURE;
+
+	MclTimerWheel_Unlink(timer);
+	self->timerCount--;
+	return MCL_SUCCESS;
+}
+
+MCL_PRIVATE MclSize MclTimerWheel_RemoveFromSlot(MclTimerWheel *self, MclTimerLink *slot, MclTimerPred pred, void *arg) {
+	MclSize removedCount = 0;
+	MclTimer *timer = NULL;
+	MclTimer *nextTimer = NULL;
+	MCL_LINK_FOREACH_SAFE(slot, MclTimer, link, timer, nextTimer) {
+		if (!pred(timer, arg)) continue;
+
+		MclTimerWheel_Unlink(timer);
+		self->timerCount--;
+		removedCount++;
+		if (timer->destroy) timer->destroy(timer);
+	}
+	return removedCount;
+}
+
+MclSize MclTimerWheel_RemoveAllByPred(MclTimerWheel *self, MclTimerPred pred, void *arg) {
+	MCL_ASSERT_VALID_PTR_R(self, 0);
+	MCL_ASSERT_VALID_PTR_R(pred, 0);
+
+	MclSize removedCount = 0;
+	MCL_LOOP_FOREACH_INDEX(i, MCL_TIMER_WHEEL_LEVEL0_SIZE) {
+		removedCount += MclTimerWheel_RemoveFromSlot(self, &self->level0[i], pred, arg);
+	}
+	MCL_LOOP_FOREACH_INDEX(level, MCL_TIMER_WHEEL_LEVEL_NUM - 1) {
+		MCL_LOOP_FOREACH_INDEX(i, MCL_TIMER_WHEEL_LEVEL_SIZE) {
+			removedCount += MclTimerWheel_RemoveFromSlot(self, &self->levels[level][i], pred, arg);
+		}
+	}
+	return removedCount;
+}
+
+MCL_PRIVATE bool MclTimerWheel_IsSlotEmpty(const MclTimerLink *slot) {
+	return MCL_LINK_EMPTY((MclTimerLink*)slot, MclTimer, link);
+}
+
+/* Cascade of level happens on ticks multiple of its slot span, first one no earlier than current */
+MCL_PRIVATE MclTimerTick MclTimerWheel_GetNextCascadeTick(const MclTimerWheel *self, MclSize level, MclTimerTick limitTick) {
+	MclTimerTick span = (MclTimerTick)1 << MclTimerWheel_GetLevelShift(level);
+	MclTimerTick tick = (self->currentTick + span - 1) & ~(span - 1);
+
+	MCL_LOOP_FOREACH_INDEX(i, MCL_TIMER_WHEEL_LEVEL_SIZE) {
+		if (tick >= limitTick) break;
+		if (!MclTimerWheel_IsSlotEmpty(&self->levels[level][MclTimerWheel_GetLevelIndex(tick, level)])) return tick;
+		tick += span;
+	}
+	return limitTick;
+}
+
+MclTimerTick MclTimerWheel_GetNextTick(const MclTimerWheel *self) {
+	MCL_ASSERT_VALID_PTR_R(self, 0);
+
+	MclTimerTick nextTick = self->currentTick + MCL_TIMER_WHEEL_TICKS_MAX;
+	MCL_LOOP_FOREACH_INDEX(i, MCL_TIMER_WHEEL_LEVEL0_SIZE) {
+		MclTimerTick tick = self->currentTick + i;
+		if (!MclTimerWheel_IsSlotEmpty(&self->level0[tick & MCL_TIMER_WHEEL_LEVEL0_MASK])) {
+			nextTick = tick;
+			break;
+		}
+	}
+	MCL_LOOP_FOREACH_INDEX(level, MCL_TIMER_WHEEL_LEVEL_NUM - 1) {
+		nextTick = MclTimerWheel_GetNextCascadeTick(self, level, nextTick);
+	}
+	return nextTick;
+}
+
+/* Jumps over the ticks of nothing due and nothing to cascade, so a long idle gap costs no steps */
+MclSize MclTimerWheel_Advance(MclTimerWheel *self, MclTimerTick tick) {
+	MCL_ASSERT_VALID_PTR_R(self, 0);
+
+	MclSize firedCount = 0;
+	while (self->currentTick <= tick) {
+		MclTimerTick nextTick = (self->timerCount == 0) ? tick + 1 : MclTimerWheel_GetNextTick(self);
+		if (nextTick > tick) {
+			self->currentTick = tick + 1;
+			break;
+		}
+		self->currentTick = nextTick;
+		firedCount += MclTimerWheel_Step(self);
+	}
+	return firedCount;
+}
@@ -23,8 +23,16 @@ MCL_PRIVATE void* MclThreadLauncher_RunThread(void *data) {
 }
 
 MCL_PRIVATE MclStatus MclThreadLauncher_LaunchThread(MclThreadInfo *thread) {
-	MCL_ASSERT_SUCC_CALL(MclThread_Create(&thread->thread, NULL, MclThreadLauncher_RunThread, thread));
-	return MCL_SUCCESS;
+	if (MclThreadOptions_IsDefault(&thread->options)) {
+		MCL_ASSERT_SUCC_CALL(MclThread_Create(&thread->thread, NULL, MclThreadLauncher_RunThread, thread));
+		return MCL_SUCCESS;
+	}
+
+	MclThreadAttr attr;
+	MCL_ASSERT_SUCC_CALL(MclThreadOptions_InitAttr(&thread->options, &attr));
+	MclStatus ret = MclThread_Create(&thread->thread, &attr, MclThreadLauncher_RunThread, thread);
+	MclThreadOptions_DestroyAttr(&attr);
+	return ret;
 }
 
 MclStatus MclThreadLauncher_Launch(MclThreadInfo *threads, MclSize threadNum) {
@@ -0,0 +1,113 @@
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+#include "mcl/thread/thread_options.h"
+#include "mcl/assert.h"
+#include <sched.h>
+#include <unistd.h>
+
+MCL_PRIVATE MclStatus MclThreadOptions_SetStackSize(const MclThreadOptions *self, MclThreadAttr *attr) {
+	if (self->stackSize == 0) return MCL_SUCCESS;
+
+	int ret = pthread_attr_setstacksize(attr, self->stackSize);
+	if (ret) {
+		MCL_LOG_ERR("Set thread stack size %u failed %d!", self->stackSize, ret);
+	}
+	return ret ? MCL_FAILURE : MCL_SUCCESS;
+}
+
+MCL_PRIVATE int MclThreadPolicy_ToSched(MclThreadPolicy policy) {
+	switch (policy) {
+	case MCL_THREAD_POLICY_FIFO : return SCHED_FIFO;
+	case MCL_THREAD_POLICY_RR   : return SCHED_RR;
+	default : return SCHED_OTHER;
+	}
+}
+
+/* Real time policy usually needs privilege, thread creation fails without it */
+MCL_PRIVATE MclStatus MclThreadOptions_SetPolicy(const MclThreadOptions *self, MclThreadAttr *attr) {
+	if (self->policy == MCL_THREAD_POLICY_DEFAULT) return MCL_SUCCESS;
+
+	struct sched_param param = {.sched_priority = self->priority};
+	int ret = pthread_attr_setinheritsched(attr, PTHREAD_EXPLICIT_SCHED);
+	if (!ret) ret = pthread_attr_setschedpolicy(attr, MclThreadPolicy_ToSched(self->policy));
+	if (!ret) ret = pthread_attr_setschedparam(attr, &param);
+	if (ret) {
+		MCL_LOG_ERR("Set thread policy %d priority %d failed %d!", self->policy, self->priority, ret);
+	}
+	return ret ? MCL_FAILURE : MCL_SUCCESS;
+}
+
+MCL_PRIVATE MclStatus MclThreadOptions_SetAffinity(const MclThreadOptions *self, MclThreadAttr *attr) {
+	if (MclCpuSet_IsEmpty(&self->affinity)) return MCL_SUCCESS;
+
+#if defined(MCL_OS_LINUX) && defined(__GLIBC__)
+	cpu_set_t cpus;
+	CPU_ZERO(&cpus);
+	for (MclSize cpu = 0; (cpu < MCL_CPU_SET_MAX) && (cpu < CPU_SETSIZE); cpu++) {
+		if (MclCpuSet_Has(&self->affinity, cpu)) CPU_SET(cpu, &cpus);
+	}
+	int ret = pthread_attr_setaffinity_np(attr, sizeof(cpus), &cpus);
+	if (ret) {
+		MCL_LOG_ERR("Set thread affinity failed %d!", ret);
+	}
+	return ret ? MCL_FAILURE : MCL_SUCCESS;
+#else
+	MCL_LOG_WARN("Thread affinity is not supported, ignored!");
+	return MCL_SUCCESS;
+#endif
+}
+
+bool MclThreadOptions_IsDefault(const MclThreadOptions *self) {
+	if (!self) return true;
+	return (self->stackSize == 0) && (self->policy == MCL_THREAD_POLICY_DEFAULT) && MclCpuSet_IsEmpty(&self->affinity);
+}
+
+MclStatus MclThreadOptions_InitAttr(const MclThreadOptions *self, MclThreadAttr *attr) {
+	MCL_ASSERT_VALID_PTR(self);
+	MCL_ASSERT_VALID_PTR(attr);
+
+	if (pthread_attr_init(attr)) {
+		MCL_LOG_ERR("Init thread attr failed!");
+		return MCL_FAILURE;
+	}
+	if (MCL_FAILED(MclThreadOptions_SetStackSize(self, attr)) ||
+		MCL_FAILED(MclThreadOptions_SetPolicy(self, attr)) ||
+		MCL_FAILED(MclThreadOptions_SetAffinity(self, attr))) {
+		(void)pthread_attr_destroy(attr);
+		return MCL_FAILURE;
+	}
+	return MCL_SUCCESS;
+}
+
+void MclThreadOptions_DestroyAttr(MclThreadAttr *attr) {
+	MCL_ASSERT_VALID_PTR_VOID(attr);
+	(void)pthread_attr_destroy(attr);
+}
+
+MclSize MclThread_GetCpuCount() {
+	long count = sysconf(_SC_NPROCESSORS_ONLN);
+	return (count > 0) ? (MclSize)count : 1;
+}
+
+MclSize MclThread_GetAllowedCpus(MclSize *cpus, MclSize capacity) {
+	MCL_ASSERT_VALID_PTR_R(cpus, 0);
+
+	MclSize count = 0;
+#if defined(MCL_OS_LINUX) && defined(__GLIBC__)
+	cpu_set_t allowed;
+	CPU_ZERO(&allowed);
+	if (sched_getaffinity(0, sizeof(allowed), &allowed) == 0) {
+		for (MclSize cpu = 0; (cpu < CPU_SETSIZE) && (count < capacity); cpu++) {
+			if (CPU_ISSET(cpu, &allowed)) cpus[count++] = cpu;
+		}
+		if (count > 0) return count;
+	}
+	MCL_LOG_WARN("Get allowed cpus failed, take online cpus!");
+#endif
+	MclSize cpuCount = MclThread_GetCpuCount();
+	for (; (count < cpuCount) && (count < capacity); count++) {
+		cpus[count] = count;
+	}
+	return count;
+}
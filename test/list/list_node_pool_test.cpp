@@ -0,0 +1,49 @@
+#include <cctest/cctest.h>
+#include "mcl/list/list.h"
+#include "mcl/list/list_node_pool.h"
+
+FIXTURE(ListNodePoolTest)
+{
+	constexpr static MclSize PREALLOC_COUNT = 4;
+
+	MclListNodePool pool;
+	MclList list;
+
+	BEFORE {
+		ASSERT_EQ(MCL_SUCCESS, MclListNodePool_Init(&pool, PREALLOC_COUNT));
+		MclList_Init(&list, MclListNodePool_GetAllocator(&pool));
+	}
+
+	AFTER {
+		MclList_Clear(&list, NULL);
+		MclListNodePool_Destroy(&pool);
+	}
+
+	TEST("should prealloc nodes") {
+		ASSERT_EQ(PREALLOC_COUNT, MclListNodePool_GetFreeCount(&pool));
+	}
+
+	TEST("should take nodes from pool and recycle them") {
+		for (long i = 1; i <= (long)PREALLOC_COUNT; i++) {
+			ASSERT_TRUE(MclList_PushBack(&list, (MclListData)i) != NULL);
+		}
+		ASSERT_EQ(0, MclListNodePool_GetFreeCount(&pool));
+
+		ASSERT_EQ(1, (long)MclList_RemoveFirst(&list));
+		ASSERT_EQ(1, MclListNodePool_GetFreeCount(&pool));
+
+		MclList_Clear(&list, NULL);
+		ASSERT_EQ(PREALLOC_COUNT, MclListNodePool_GetFreeCount(&pool));
+	}
+
+	TEST("should alloc from heap when pool exhausted and keep nodes after free") {
+		for (long i = 1; i <= (long)PREALLOC_COUNT * 2; i++) {
+			ASSERT_TRUE(MclList_PushBack(&list, (MclListData)i) != NULL);
+		}
+		ASSERT_EQ(0, MclListNodePool_GetFreeCount(&pool));
+		ASSERT_EQ(PREALLOC_COUNT * 2, MclList_GetSize(&list));
+
+		MclList_Clear(&list, NULL);
+		ASSERT_EQ(PREALLOC_COUNT * 2, MclListNodePool_GetFreeCount(&pool));
+	}
+};
@@ -20,6 +20,10 @@ namespace {
 
         return NULL;
     }
+
+    void addValue(MclStatus status, void *value, void *ctxt) {
+        if (MclStatus_IsSucc(status)) *(int*)ctxt += *(int*)value;
+    }
 }
 
 FIXTURE(FutureTest) {
@@ -42,4 +46,109 @@ FIXTURE(FutureTest) {
 
         MclThread_Join(th, NULL);
     }
+
+    TEST("should run callback when future set or right now if ready") {
+        MclFuture *future = MclFuture_Create();
+        int value = 3;
+        int sum = 0;
+
+        ASSERT_EQ(MCL_SUCCESS, MclFuture_OnReady(future, addValue, &sum));
+        ASSERT_EQ(MCL_SUCCESS, MclFuture_OnReady(future, addValue, &sum));
+        ASSERT_EQ(0, sum);
+
+        MclFuture_Set(future, MCL_SUCCESS, &value);
+        ASSERT_EQ(6, sum);
+
+        ASSERT_EQ(MCL_SUCCESS, MclFuture_OnReady(future, addValue, &sum));
+        ASSERT_EQ(9, sum);
+
+        MclFuture_Delete(future);
+    }
+
+    TEST("should cancel callback not yet run") {
+        MclFuture *future = MclFuture_Create();
+        int value = 3;
+        int sums[4] = {0, 0, 0, 0};
+
+        for (int &sum : sums) {
+            ASSERT_EQ(MCL_SUCCESS, MclFuture_OnReady(future, addValue, &sum));
+        }
+        ASSERT_EQ(MCL_SUCCESS, MclFuture_CancelOnReady(future, addValue, &sums[1]));
+        ASSERT_EQ(MCL_SUCCESS, MclFuture_CancelOnReady(future, addValue, &sums[3]));
+        ASSERT_EQ(MCL_FAILURE, MclFuture_CancelOnReady(future, addValue, &sums[3]));
+        ASSERT_EQ(MCL_SUCCESS, MclFuture_OnReady(future, addValue, &sums[3]));
+
+        MclFuture_Set(future, MCL_SUCCESS, &value);
+        ASSERT_EQ(3, sums[0]);
+        ASSERT_EQ(0, sums[1]);
+        ASSERT_EQ(3, sums[2]);
+        ASSERT_EQ(3, sums[3]);
+        ASSERT_EQ(MCL_FAILURE, MclFuture_CancelOnReady(future, addValue, &sums[0]));
+
+        MclFuture_Delete(future);
+    }
+
+    TEST("should be ready when all futures ready") {
+        MclFuture *futures[3] = {MclFuture_Create(), MclFuture_Create(), MclFuture_Create()};
+        MclFuture *all = MclFuture_WhenAll(futures, 3);
+
+        MclFuture_Set(futures[1], MCL_SUCCESS, NULL);
+        MclFuture_Set(futures[0], MCL_SUCCESS, NULL);
+        ASSERT_FALSE(MclFuture_IsReady(all));
+
+        MclFuture_Set(futures[2], MCL_TIMEDOUT, NULL);
+        ASSERT_TRUE(MclFuture_IsReady(all));
+
+        MclStatus status {MCL_SUCCESS};
+        void *value {nullptr};
+        MclFuture_Get(all, &status, &value);
+        ASSERT_EQ(MCL_TIMEDOUT, status);
+
+        MclFuture_Delete(all);
+        for (auto future : futures) MclFuture_Delete(future);
+    }
+
+    TEST("should be ready with first ready future") {
+        MclFuture *futures[2] = {MclFuture_Create(), MclFuture_Create()};
+        MclFuture *any = MclFuture_WhenAny(futures, 2);
+        ASSERT_FALSE(MclFuture_IsReady(any));
+
+        int first = 1;
+        int second = 2;
+        MclFuture_Set(futures[1], MCL_SUCCESS, &second);
+        MclFuture_Set(futures[0], MCL_SUCCESS, &first);
+
+        MclStatus status {MCL_FAILURE};
+        void *value {nullptr};
+        MclFuture_Get(any, &status, &value);
+        ASSERT_EQ(MCL_SUCCESS, status);
+        ASSERT_EQ(2, *(int*)value);
+
+        MclFuture_Delete(any);
+        for (auto future : futures) MclFuture_Delete(future);
+    }
+
+    TEST("should fail to set future already stopped or set") {
+        MclFuture *future = MclFuture_Create();
+        int value = 3;
+
+        MclFuture_Stop(future);
+        ASSERT_EQ(MCL_FAILURE, MclFuture_Set(future, MCL_SUCCESS, &value));
+
+        MclStatus status {MCL_SUCCESS};
+        void *result {&value};
+        MclFuture_Get(future, &status, &result);
+        ASSERT_EQ(MCL_STATUS_DONE, status);
+        ASSERT_TRUE(result == nullptr);
+        MclFuture_Delete(future);
+
+        future = MclFuture_Create();
+        ASSERT_EQ(MCL_SUCCESS, MclFuture_Set(future, MCL_SUCCESS, &value));
+        ASSERT_EQ(MCL_FAILURE, MclFuture_Set(future, MCL_TIMEDOUT, nullptr));
+
+        MclFuture_Get(future, &status, &result);
+        ASSERT_EQ(MCL_SUCCESS, status);
+        ASSERT_EQ(3, *(int*)result);
+        MclFuture_Delete(future);
+    }
 };
@@ -0,0 +1,69 @@
+#include <cctest/cctest.h>
+#include "mcl/lock/grace_period.h"
+
+namespace {
+	struct Foo {
+		MclGraceNode grace;
+		bool isFreed;
+	};
+
+	void Foo_Free(MclGraceNode *grace) {
+		((Foo*)grace)->isFreed = true;
+	}
+}
+
+FIXTURE(GracePeriodTest) {
+	Foo foo {{}, false};
+
+	TEST("should nest read sections")
+	{
+		ASSERT_FALSE(MclGracePeriod_IsReading());
+
+		MclGracePeriod_ReadLock();
+		MclGracePeriod_ReadLock();
+		MclGracePeriod_ReadUnlock();
+		ASSERT_TRUE(MclGracePeriod_IsReading());
+
+		MclGracePeriod_ReadUnlock();
+		ASSERT_FALSE(MclGracePeriod_IsReading());
+	}
+
+	TEST("should leave read section when auto read lock out of scope")
+	{
+		{
+			MCL_GRACE_READ_AUTO;
+			ASSERT_TRUE(MclGracePeriod_IsReading());
+		}
+		ASSERT_FALSE(MclGracePeriod_IsReading());
+	}
+
+	TEST("should not free node retired in read section before leaving")
+	{
+		MclGracePeriod_ReadLock();
+		MclGracePeriod_Retire(&foo.grace, Foo_Free);
+
+		(void)MclGracePeriod_Reclaim();
+		ASSERT_FALSE(foo.isFreed);
+
+		MclGracePeriod_ReadUnlock();
+		(void)MclGracePeriod_Reclaim();
+		ASSERT_TRUE(foo.isFreed);
+	}
+
+	TEST("should free node retired before entering read section")
+	{
+		MclGracePeriod_Retire(&foo.grace, Foo_Free);
+
+		MCL_GRACE_READ_AUTO;
+		(void)MclGracePeriod_Reclaim();
+		ASSERT_TRUE(foo.isFreed);
+	}
+
+	TEST("should free retired node when synchronize")
+	{
+		MclGracePeriod_Retire(&foo.grace, Foo_Free);
+
+		MclGracePeriod_Synchronize();
+		ASSERT_TRUE(foo.isFreed);
+	}
+};
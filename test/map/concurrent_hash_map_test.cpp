@@ -0,0 +1,217 @@
+#include <cctest/cctest.h>
+#include "mcl/map/concurrent_hash_map.h"
+#include "mcl/lock/grace_period.h"
+#include "mcl/lock/atomic.h"
+#include "mcl/thread/thread.h"
+
+namespace {
+	using FooId = uint32_t;
+
+	struct Foo {
+		static MclSize FOO_COUNT;
+
+		Foo (FooId id) : id {id} {
+		}
+
+		FooId getId() const {
+			return id;
+		}
+	private:
+		FooId id;
+	};
+
+	MclSize Foo::FOO_COUNT {0};
+
+	Foo* Foo_Create(FooId id) {
+		Foo::FOO_COUNT++;
+		return new Foo {id};
+	}
+
+	void Foo_Delete(Foo *f) {
+		Foo::FOO_COUNT--;
+		if (f) delete f;
+	}
+
+	MclStatus ConcurrentHashVisit_Sum(MclHashKey key, MclHashValue value, void *arg) {
+		auto foo = (Foo*)value;
+		if (foo->getId() != key) return MCL_FAILURE;
+		auto sum = (uint64_t*)arg;
+		(*sum) += foo->getId();
+		return MCL_SUCCESS;
+	}
+
+	MclStatus ConcurrentHashVisit_Count(MclHashKey key, MclHashValue value, void *arg) {
+		auto count = (MclSize*)arg;
+		return (++(*count) == 3) ? MCL_STATUS_DONE : MCL_SUCCESS;
+	}
+
+	constexpr FooId KEY_COUNT = 2000;
+	constexpr MclSize READER_COUNT = 4;
+	constexpr MclSize ROUND_COUNT = 20;
+
+	struct SharedMap {
+		MclConcurrentHashMap *map;
+		Foo *foos[KEY_COUNT];
+		MclAtomic isStopped;
+		MclAtomic errorCount;
+		MclAtomic hitCount;
+	};
+
+	void* readFoos(void *arg) {
+		auto shared = (SharedMap*)arg;
+		while (!MclAtomic_LoadAcquire(&shared->isStopped)) {
+			for (FooId id = 0; id < KEY_COUNT; id++) {
+				auto f = (Foo*)MclConcurrentHashMap_Get(shared->map, id);
+				if (!f) continue;
+				if (f->getId() != id) MclAtomic_AddFetch(&shared->errorCount, 1);
+				MclAtomic_AddFetch(&shared->hitCount, 1);
+			}
+			MclThread_Yield();
+		}
+		return NULL;
+	}
+
+	/* Foos outlive the map, so readers may use a value removed meanwhile */
+	void* writeFoos(void *arg) {
+		auto shared = (SharedMap*)arg;
+		for (MclSize round = 0; round < ROUND_COUNT; round++) {
+			for (FooId id = 0; id < KEY_COUNT; id++) {
+				MclConcurrentHashMap_Set(shared->map, id, shared->foos[id]);
+			}
+			for (FooId id = round % 2; id < KEY_COUNT; id += 2) {
+				MclConcurrentHashMap_Remove(shared->map, id);
+			}
+			MclThread_Yield();
+		}
+		MclAtomic_StoreRelease(&shared->isStopped, 1);
+		return NULL;
+	}
+}
+
+FIXTURE(ConcurrentHashMapTest) {
+	MclConcurrentHashMap *foos {nullptr};
+
+	BEFORE {
+		foos = MclConcurrentHashMap_CreateDefault();
+	}
+
+	AFTER {
+		MclConcurrentHashMap_Delete(foos, (MclHashValueDestroy)Foo_Delete);
+		ASSERT_EQ(0, Foo::FOO_COUNT);
+	}
+
+	TEST("should be empty when initialized")
+	{
+		ASSERT_TRUE(MclConcurrentHashMap_IsEmpty(foos));
+		ASSERT_EQ(MCL_CONCURRENT_HASHMAP_BUCKET_COUNT_DEFAULT, MclConcurrentHashMap_GetBucketCount(foos));
+		ASSERT_TRUE(MclConcurrentHashMap_Get(foos, 1) == nullptr);
+	}
+
+	TEST("should add and replace elements")
+	{
+		auto foo1 = Foo_Create(1);
+		auto foo2 = Foo_Create(1);
+
+		ASSERT_EQ(foo1, (Foo*)MclConcurrentHashMap_Set(foos, 1, foo1));
+		ASSERT_EQ(foo1, (Foo*)MclConcurrentHashMap_Set(foos, 1, foo2));
+		ASSERT_EQ(1, MclConcurrentHashMap_GetSize(foos));
+		ASSERT_EQ(foo2, (Foo*)MclConcurrentHashMap_Get(foos, 1));
+
+		Foo_Delete(foo1);
+	}
+
+	TEST("should refuse invalid key and value")
+	{
+		auto foo = Foo_Create(1);
+
+		ASSERT_TRUE(MclConcurrentHashMap_Set(foos, MCL_HASH_KEY_INVALID, foo) == nullptr);
+		ASSERT_TRUE(MclConcurrentHashMap_Set(foos, 1, nullptr) == nullptr);
+		ASSERT_TRUE(MclConcurrentHashMap_IsEmpty(foos));
+
+		Foo_Delete(foo);
+	}
+
+	TEST("should remove element from map")
+	{
+		MclConcurrentHashMap_Set(foos, 1, Foo_Create(1));
+		MclConcurrentHashMap_Set(foos, 2, Foo_Create(2));
+
+		auto result = (Foo*)MclConcurrentHashMap_Remove(foos, 1);
+		ASSERT_TRUE(result != nullptr);
+		ASSERT_EQ(1, result->getId());
+		Foo_Delete(result);
+
+		ASSERT_EQ(1, MclConcurrentHashMap_GetSize(foos));
+		ASSERT_TRUE(MclConcurrentHashMap_Get(foos, 1) == nullptr);
+		ASSERT_TRUE(MclConcurrentHashMap_Remove(foos, 1) == nullptr);
+	}
+
+	TEST("should grow and find all elements")
+	{
+		constexpr FooId COUNT = 10000;
+
+		for (FooId id = 0; id < COUNT; id++) {
+			MclConcurrentHashMap_Set(foos, id, Foo_Create(id));
+		}
+		ASSERT_EQ(COUNT, MclConcurrentHashMap_GetSize(foos));
+		ASSERT_TRUE(MclConcurrentHashMap_GetBucketCount(foos) > MCL_CONCURRENT_HASHMAP_BUCKET_COUNT_DEFAULT);
+
+		for (FooId id = 0; id < COUNT; id++) {
+			auto f = (Foo*)MclConcurrentHashMap_Get(foos, id);
+			ASSERT_TRUE(f != nullptr);
+			ASSERT_EQ(id, f->getId());
+		}
+		MclGracePeriod_Synchronize();
+	}
+
+	TEST("should visit all elements")
+	{
+		for (FooId id = 1; id <= 100; id++) {
+			MclConcurrentHashMap_Set(foos, id, Foo_Create(id));
+		}
+		uint64_t sum = 0;
+		ASSERT_EQ(MCL_SUCCESS, MclConcurrentHashMap_Accept(foos, ConcurrentHashVisit_Sum, &sum));
+		ASSERT_EQ(5050, sum);
+	}
+
+	TEST("should stop visiting when done")
+	{
+		for (FooId id = 1; id <= 10; id++) {
+			MclConcurrentHashMap_Set(foos, id, Foo_Create(id));
+		}
+		MclSize count = 0;
+		ASSERT_EQ(MCL_SUCCESS, MclConcurrentHashMap_Accept(foos, ConcurrentHashVisit_Count, &count));
+		ASSERT_EQ(3, count);
+	}
+
+	TEST("should read consistently while writer sets removes and grows")
+	{
+		SharedMap shared {};
+		shared.map = MclConcurrentHashMap_Create(0);
+		for (FooId id = 0; id < KEY_COUNT; id++) {
+			shared.foos[id] = Foo_Create(id);
+		}
+
+		MclThread readers[READER_COUNT];
+		for (auto &reader : readers) {
+			MclThread_Create(&reader, NULL, readFoos, &shared);
+		}
+		MclThread writer;
+		MclThread_Create(&writer, NULL, writeFoos, &shared);
+
+		MclThread_Join(writer, NULL);
+		for (auto &reader : readers) {
+			MclThread_Join(reader, NULL);
+		}
+
+		ASSERT_EQ(0, shared.errorCount);
+		ASSERT_TRUE(shared.hitCount > 0);
+		ASSERT_EQ(KEY_COUNT / 2, MclConcurrentHashMap_GetSize(shared.map));
+
+		MclConcurrentHashMap_Delete(shared.map, NULL);
+		MclGracePeriod_Synchronize();
+		for (auto foo : shared.foos) {
+			Foo_Delete(foo);
+		}
+	}
+};
@@ -0,0 +1,223 @@
+#include <cctest/cctest.h>
+#include "mcl/map/flat_hash_map.h"
+
+namespace {
+	using FooId = uint32_t;
+
+	struct Foo {
+		static MclSize FOO_COUNT;
+
+		Foo (FooId id) : id {id} {
+		}
+
+		FooId getId() const {
+			return id;
+		}
+	private:
+		FooId id;
+	};
+
+	MclSize Foo::FOO_COUNT {0};
+
+	Foo* Foo_Create(FooId id) {
+		Foo::FOO_COUNT++;
+		return new Foo {id};
+	}
+
+	void Foo_Delete(Foo *f) {
+		Foo::FOO_COUNT--;
+		if (f) delete f;
+	}
+
+	MclStatus FlatHashVisit_Sum(MclHashKey key, MclHashValue value, void *arg) {
+		auto foo = (Foo*)value;
+		if (foo->getId() != key) return MCL_FAILURE;
+		auto sum = (uint64_t*)arg;
+		(*sum) += foo->getId();
+		return MCL_SUCCESS;
+	}
+
+	MclStatus FlatHashVisit_Count(MclHashKey key, MclHashValue value, void *arg) {
+		auto count = (MclSize*)arg;
+		return (++(*count) == 3) ? MCL_STATUS_DONE : MCL_SUCCESS;
+	}
+}
+
+FIXTURE(FlatHashMapTest) {
+	MclFlatHashMap *foos {nullptr};
+
+	BEFORE {
+		foos = MclFlatHashMap_CreateDefault();
+	}
+
+	AFTER {
+		MclFlatHashMap_Delete(foos, (MclHashValueDestroy)Foo_Delete);
+		ASSERT_EQ(0, Foo::FOO_COUNT);
+	}
+
+	TEST("should be empty when initialized")
+	{
+		ASSERT_TRUE(MclFlatHashMap_IsEmpty(foos));
+		ASSERT_EQ(0, MclFlatHashMap_GetSize(foos));
+		ASSERT_FALSE(MclHashValue_IsValid(MclFlatHashMap_Get(foos, 0)));
+	}
+
+	TEST("should add elements to map")
+	{
+		MclFlatHashMap_Set(foos, 1, Foo_Create(1));
+		MclFlatHashMap_Set(foos, 2, Foo_Create(2));
+		MclFlatHashMap_Set(foos, 3, Foo_Create(3));
+
+		ASSERT_EQ(3, MclFlatHashMap_GetSize(foos));
+		for (FooId id = 1; id <= 3; id++) {
+			auto f = (Foo*)MclFlatHashMap_Get(foos, id);
+			ASSERT_TRUE(f != nullptr);
+			ASSERT_EQ(id, f->getId());
+		}
+		ASSERT_TRUE(MclFlatHashMap_Get(foos, 4) == nullptr);
+	}
+
+	TEST("should replace element in map")
+	{
+		auto foo1 = Foo_Create(1);
+		auto foo2 = Foo_Create(2);
+
+		ASSERT_EQ(foo1, (Foo*)MclFlatHashMap_Set(foos, 1, foo1));
+		ASSERT_EQ(foo1, (Foo*)MclFlatHashMap_Set(foos, 1, foo2));
+		ASSERT_EQ(1, MclFlatHashMap_GetSize(foos));
+		ASSERT_EQ(foo2, (Foo*)MclFlatHashMap_Get(foos, 1));
+
+		Foo_Delete(foo1);
+	}
+
+	TEST("should refuse invalid key and value")
+	{
+		auto foo = Foo_Create(1);
+
+		ASSERT_TRUE(MclFlatHashMap_Set(foos, MCL_HASH_KEY_INVALID, foo) == nullptr);
+		ASSERT_TRUE(MclFlatHashMap_Set(foos, 1, nullptr) == nullptr);
+		ASSERT_TRUE(MclFlatHashMap_IsEmpty(foos));
+
+		Foo_Delete(foo);
+	}
+
+	TEST("should remove element from map")
+	{
+		MclFlatHashMap_Set(foos, 1, Foo_Create(1));
+		MclFlatHashMap_Set(foos, 2, Foo_Create(2));
+
+		auto result = (Foo*)MclFlatHashMap_Remove(foos, 1);
+		ASSERT_TRUE(result != nullptr);
+		ASSERT_EQ(1, result->getId());
+		Foo_Delete(result);
+
+		ASSERT_EQ(1, MclFlatHashMap_GetSize(foos));
+		ASSERT_TRUE(MclFlatHashMap_Get(foos, 1) == nullptr);
+		ASSERT_TRUE(MclFlatHashMap_Remove(foos, 1) == nullptr);
+		ASSERT_EQ(2, ((Foo*)MclFlatHashMap_Get(foos, 2))->getId());
+	}
+
+	TEST("should grow and find all elements")
+	{
+		constexpr FooId COUNT = 10000;
+
+		for (FooId id = 0; id < COUNT; id++) {
+			MclFlatHashMap_Set(foos, id, Foo_Create(id));
+		}
+		ASSERT_EQ(COUNT, MclFlatHashMap_GetSize(foos));
+		ASSERT_TRUE(MclFlatHashMap_GetCapacity(foos) > COUNT);
+
+		for (FooId id = 0; id < COUNT; id++) {
+			auto f = (Foo*)MclFlatHashMap_Get(foos, id);
+			ASSERT_TRUE(f != nullptr);
+			ASSERT_EQ(id, f->getId());
+		}
+	}
+
+	TEST("should keep other elements reachable after removing")
+	{
+		constexpr FooId COUNT = 5000;
+
+		for (FooId id = 0; id < COUNT; id++) {
+			MclFlatHashMap_Set(foos, id, Foo_Create(id));
+		}
+		for (FooId id = 0; id < COUNT; id += 2) {
+			Foo_Delete((Foo*)MclFlatHashMap_Remove(foos, id));
+		}
+		ASSERT_EQ(COUNT / 2, MclFlatHashMap_GetSize(foos));
+
+		for (FooId id = 0; id < COUNT; id++) {
+			auto f = (Foo*)MclFlatHashMap_Get(foos, id);
+			if (id % 2) {
+				ASSERT_TRUE(f != nullptr);
+				ASSERT_EQ(id, f->getId());
+			} else {
+				ASSERT_TRUE(f == nullptr);
+			}
+		}
+	}
+
+	TEST("should reuse capacity after removing all")
+	{
+		for (FooId id = 0; id < 40; id++) {
+			MclFlatHashMap_Set(foos, id, Foo_Create(id));
+		}
+		MclSize capacity = MclFlatHashMap_GetCapacity(foos);
+
+		for (FooId round = 0; round < 100; round++) {
+			for (FooId id = 0; id < 40; id++) {
+				Foo_Delete((Foo*)MclFlatHashMap_Remove(foos, id));
+			}
+			ASSERT_TRUE(MclFlatHashMap_IsEmpty(foos));
+			for (FooId id = 0; id < 40; id++) {
+				MclFlatHashMap_Set(foos, id, Foo_Create(id));
+			}
+		}
+		ASSERT_EQ(capacity, MclFlatHashMap_GetCapacity(foos));
+		ASSERT_EQ(40, MclFlatHashMap_GetSize(foos));
+	}
+
+	TEST("should not grow when created for count")
+	{
+		auto map = MclFlatHashMap_Create(1000);
+		MclSize capacity = MclFlatHashMap_GetCapacity(map);
+
+		for (FooId id = 0; id < 1000; id++) {
+			MclFlatHashMap_Set(map, id, Foo_Create(id));
+		}
+		ASSERT_EQ(capacity, MclFlatHashMap_GetCapacity(map));
+
+		MclFlatHashMap_Delete(map, (MclHashValueDestroy)Foo_Delete);
+	}
+
+	TEST("should visit all elements")
+	{
+		for (FooId id = 1; id <= 100; id++) {
+			MclFlatHashMap_Set(foos, id, Foo_Create(id));
+		}
+		uint64_t sum = 0;
+		ASSERT_EQ(MCL_SUCCESS, MclFlatHashMap_Accept(foos, FlatHashVisit_Sum, &sum));
+		ASSERT_EQ(5050, sum);
+	}
+
+	TEST("should stop visiting when done")
+	{
+		for (FooId id = 1; id <= 10; id++) {
+			MclFlatHashMap_Set(foos, id, Foo_Create(id));
+		}
+		MclSize count = 0;
+		ASSERT_EQ(MCL_SUCCESS, MclFlatHashMap_Accept(foos, FlatHashVisit_Count, &count));
+		ASSERT_EQ(3, count);
+	}
+
+	TEST("should destroy all elements when clear")
+	{
+		for (FooId id = 1; id <= 100; id++) {
+			MclFlatHashMap_Set(foos, id, Foo_Create(id));
+		}
+		MclFlatHashMap_Clear(foos, (MclHashValueDestroy)Foo_Delete);
+		ASSERT_EQ(0, Foo::FOO_COUNT);
+		ASSERT_TRUE(MclFlatHashMap_IsEmpty(foos));
+		ASSERT_TRUE(MclFlatHashMap_Get(foos, 1) == nullptr);
+	}
+};
@@ -1,5 +1,6 @@
 #include <cctest/cctest.h>
 #include "mcl/map/hash_map.h"
+#include "mcl/mem/slab.h"
 
 namespace {
 	using FooId = uint32_t;
@@ -41,6 +42,11 @@ namespace {
     	return foo->getId() > (long)arg;
     }
 
+    MclStatus HashNodeVisit_CountToTwo(MclHashNode *node, void *arg) {
+    	auto count = (uint32_t*)arg;
+    	return (++(*count) == 2) ? MCL_STATUS_DONE : MCL_SUCCESS;
+    }
+
     MclStatus HashNodeVisit_Sum(MclHashNode *node, void *arg) {
     	auto foo = (Foo*)MclHashNode_GetValue(node);
     	if (FOO_ID_INVALID == foo->getId()) return MCL_STATUS_DONE;
@@ -288,12 +294,24 @@ FIXTURE(HashMapTest) {
 		MclHashMap_Set(foos, 12, Foo_Create(12));
 		MclHashMap_Set(foos, 13, Foo_Create(13));
 		MclHashMap_Set(foos, 14, Foo_Create(14));
-		MclHashMap_Set(foos, FOO_ID_INVALID, Foo_Create(FOO_ID_INVALID));
 		MclHashMap_Set(foos, 15, Foo_Create(15));
 
 		uint32_t sum = 0;
 		MclHashMap_Accept(foos, HashNodeVisit_Sum, &sum);
-		ASSERT_EQ(39, sum);
+		ASSERT_EQ(54, sum);
+
+		MclHashMap_Clear(foos, (MclHashValueDestroy)Foo_Delete);
+	}
+
+	TEST("should stop visiting nodes in map when done")
+	{
+		for (uint32_t i = 0; i < 5; i++) {
+			MclHashMap_Set(foos, i * MCL_HASHMAP_BUCKET_COUNT_DEFAULT, Foo_Create(i));
+		}
+
+		uint32_t count = 0;
+		ASSERT_EQ(MCL_SUCCESS, MclHashMap_Accept(foos, HashNodeVisit_CountToTwo, &count));
+		ASSERT_EQ(2, count);
 
 		MclHashMap_Clear(foos, (MclHashValueDestroy)Foo_Delete);
 	}
@@ -327,4 +345,253 @@ FIXTURE(HashMapTest) {
 
 		MclHashMap_Clear(foos, (MclHashValueDestroy)Foo_Delete);
 	}
+
+	TEST("should grow buckets incrementally when size passes bucket count")
+	{
+		constexpr uint32_t BUCKETS = MCL_HASHMAP_BUCKET_COUNT_DEFAULT;
+
+		for (uint32_t i = 0; i <= BUCKETS; i++) {
+			MclHashMap_Set(foos, i, Foo_Create(i));
+		}
+		ASSERT_TRUE(MclHashMap_IsResizing(foos));
+		ASSERT_EQ(BUCKETS * 2, MclHashMap_GetBucketCount(foos));
+
+		for (uint32_t i = 0; i <= BUCKETS; i++) {
+			auto f = (Foo*)MclHashMap_Get(foos, i);
+			ASSERT_TRUE(f != NULL);
+			ASSERT_EQ(i, f->getId());
+		}
+
+		Foo_Delete((Foo*)MclHashMap_Remove(foos, 0));
+		for (uint32_t i = BUCKETS + 1; MclHashMap_IsResizing(foos); i++) {
+			MclHashMap_Set(foos, i, Foo_Create(i));
+		}
+		ASSERT_TRUE(MclHashMap_GetSize(foos) < BUCKETS * 2);
+
+		uint32_t count = MclHashMap_GetSize(foos);
+		for (uint32_t i = 1; i <= count; i++) {
+			auto f = (Foo*)MclHashMap_Get(foos, i);
+			ASSERT_TRUE(f != NULL);
+			ASSERT_EQ(i, f->getId());
+		}
+		ASSERT_TRUE(MclHashMap_Get(foos, 0) == NULL);
+
+		MclHashMap_Clear(foos, (MclHashValueDestroy)Foo_Delete);
+	}
+
+	TEST("should reserve buckets for bulk load")
+	{
+		constexpr uint32_t MAX_ELEMS = 10000;
+
+		ASSERT_EQ(MCL_SUCCESS, MclHashMap_Reserve(foos, MAX_ELEMS));
+		ASSERT_FALSE(MclHashMap_IsResizing(foos));
+
+		MclSize bucketCount = MclHashMap_GetBucketCount(foos);
+		ASSERT_TRUE(bucketCount >= MAX_ELEMS);
+
+		for (uint32_t i = 0; i < MAX_ELEMS; i++) {
+			MclHashMap_Set(foos, i, Foo_Create(i));
+		}
+		ASSERT_EQ(bucketCount, MclHashMap_GetBucketCount(foos));
+		ASSERT_FALSE(MclHashMap_IsResizing(foos));
+
+		MclHashMap_Clear(foos, (MclHashValueDestroy)Foo_Delete);
+	}
+
+	TEST("should not grow buckets given by init unless growable")
+	{
+		constexpr uint32_t BUCKETS = 8;
+		MclHashBucket buckets[BUCKETS];
+		MclHashMap map;
+		MclHashMap_Init(&map, buckets, BUCKETS, &MclHashNodeAllocator_Default);
+
+		for (uint32_t i = 0; i < 32; i++) {
+			MclHashMap_Set(&map, i, Foo_Create(i));
+		}
+		ASSERT_EQ(BUCKETS, MclHashMap_GetBucketCount(&map));
+		ASSERT_FALSE(MclHashMap_IsResizing(&map));
+		ASSERT_EQ(31, ((Foo*)MclHashMap_Get(&map, 31))->getId());
+
+		MclHashMap_Clear(&map, (MclHashValueDestroy)Foo_Delete);
+		ASSERT_TRUE(map.buckets == buckets);
+	}
+
+	TEST("should keep buckets given by init when growing")
+	{
+		constexpr uint32_t BUCKETS = 7;
+		MclHashBucket buckets[BUCKETS];
+		MclHashMap map;
+		MclHashMap_InitGrowable(&map, buckets, BUCKETS, &MclHashNodeAllocator_Default);
+
+		for (uint32_t i = 0; i < 100; i++) {
+			MclHashMap_Set(&map, i, Foo_Create(i));
+		}
+		ASSERT_TRUE(MclHashMap_GetBucketCount(&map) > BUCKETS);
+		for (uint32_t i = 0; i < 100; i++) {
+			auto f = (Foo*)MclHashMap_Get(&map, i);
+			ASSERT_TRUE(f != NULL);
+			ASSERT_EQ(i, f->getId());
+		}
+
+		MclHashMap_Destroy(&map, (MclHashValueDestroy)Foo_Delete);
+	}
+
+	TEST("should get batch of keys as getting one by one")
+	{
+		constexpr uint32_t COUNT = 100;
+
+		for (uint32_t i = 0; i < COUNT; i += 2) {
+			MclHashMap_Set(foos, i, Foo_Create(i));
+		}
+		MclHashKey keys[COUNT + 1];
+		MclHashValue values[COUNT + 1];
+		for (uint32_t i = 0; i < COUNT; i++) {
+			keys[i] = COUNT - 1 - i;
+		}
+		keys[COUNT] = MCL_HASH_KEY_INVALID;
+
+		MclHashMap_GetBatch(foos, keys, COUNT + 1, values);
+		for (uint32_t i = 0; i <= COUNT; i++) {
+			ASSERT_EQ(MclHashMap_Get(foos, keys[i]), values[i]);
+		}
+		ASSERT_EQ(COUNT - 2, ((Foo*)values[1])->getId());
+		ASSERT_TRUE(values[0] == NULL);
+
+		MclHashMap_Clear(foos, (MclHashValueDestroy)Foo_Delete);
+	}
+
+	TEST("should get batch of keys while resizing")
+	{
+		constexpr uint32_t COUNT = MCL_HASHMAP_BUCKET_COUNT_DEFAULT + 1;
+
+		for (uint32_t i = 0; i < COUNT; i++) {
+			MclHashMap_Set(foos, i, Foo_Create(i));
+		}
+		ASSERT_TRUE(MclHashMap_IsResizing(foos));
+
+		MclHashKey keys[COUNT];
+		MclHashValue values[COUNT];
+		for (uint32_t i = 0; i < COUNT; i++) {
+			keys[i] = i;
+		}
+		MclHashMap_GetBatch(foos, keys, COUNT, values);
+		for (uint32_t i = 0; i < COUNT; i++) {
+			ASSERT_TRUE(values[i] != NULL);
+			ASSERT_EQ(i, ((Foo*)values[i])->getId());
+		}
+
+		MclHashMap_Clear(foos, (MclHashValueDestroy)Foo_Delete);
+	}
+
+	TEST("should set and remove batch of keys in order")
+	{
+		auto foo1 = Foo_Create(1);
+		auto foo2 = Foo_Create(1);
+		auto foo3 = Foo_Create(3);
+
+		MclHashKey keys[] = {1, 3, 1};
+		MclHashValue values[] = {foo1, foo3, foo2};
+		MclHashValue results[3];
+
+		ASSERT_EQ(3, MclHashMap_SetBatch(foos, keys, values, 3, results));
+		ASSERT_EQ(foo1, (Foo*)results[0]);
+		ASSERT_EQ(foo3, (Foo*)results[1]);
+		ASSERT_EQ(foo1, (Foo*)results[2]);
+		ASSERT_EQ(2, MclHashMap_GetSize(foos));
+		ASSERT_EQ(foo2, (Foo*)MclHashMap_Get(foos, 1));
+		Foo_Delete(foo1);
+
+		MclHashKey removedKeys[] = {3, 2, 1, 3};
+		MclHashValue removed[4];
+		ASSERT_EQ(2, MclHashMap_RemoveBatch(foos, removedKeys, 4, removed));
+		ASSERT_EQ(foo3, (Foo*)removed[0]);
+		ASSERT_TRUE(removed[1] == NULL);
+		ASSERT_EQ(foo2, (Foo*)removed[2]);
+		ASSERT_TRUE(removed[3] == NULL);
+		ASSERT_TRUE(MclHashMap_IsEmpty(foos));
+
+		Foo_Delete(foo2);
+		Foo_Delete(foo3);
+	}
+
+	TEST("should alloc nodes from slab allocator")
+	{
+		auto map = MclHashMap_Create(MCL_HASHMAP_BUCKET_COUNT_DEFAULT, &MclHashNodeAllocator_Slab);
+
+		for (uint32_t i = 0; i < 1000; i++) {
+			MclHashMap_Set(map, i, Foo_Create(i));
+		}
+		ASSERT_TRUE(MclSlabCache_GetSlabCount(MclHashNodeAllocator_GetSlabCache()) > 0);
+		for (uint32_t i = 0; i < 1000; i++) {
+			auto f = (Foo*)MclHashMap_Get(map, i);
+			ASSERT_TRUE(f != NULL);
+			ASSERT_EQ(i, f->getId());
+		}
+
+		MclHashMap_Delete(map, (MclHashValueDestroy)Foo_Delete);
+		MclSlabCache_FlushLocal(MclHashNodeAllocator_GetSlabCache());
+		MclSlabCache_Reclaim(MclHashNodeAllocator_GetSlabCache());
+		ASSERT_EQ(0, MclSlabCache_GetSlabCount(MclHashNodeAllocator_GetSlabCache()));
+	}
+
+	TEST("should not grow without allocator")
+	{
+		constexpr uint32_t BUCKETS = 8;
+		MclHashBucket buckets[BUCKETS];
+		MclHashNode nodes[32];
+		MclHashMap map;
+		MclHashMap_Init(&map, buckets, BUCKETS, NULL);
+
+		for (uint32_t i = 0; i < 32; i++) {
+			MclHashNode_Init(&nodes[i], i, &nodes[i]);
+			ASSERT_EQ(MCL_SUCCESS, MclHashMap_InsertNode(&map, &nodes[i]));
+		}
+		ASSERT_EQ(BUCKETS, MclHashMap_GetBucketCount(&map));
+		ASSERT_FALSE(MclHashMap_IsResizing(&map));
+		ASSERT_EQ(&nodes[31], MclHashMap_FindNode(&map, 31));
+	}
+
+	TEST("should not reserve without allocator unless growable")
+	{
+		constexpr uint32_t BUCKETS = 8;
+		MclHashBucket buckets[BUCKETS];
+		MclHashMap map;
+		MclHashMap_Init(&map, buckets, BUCKETS, NULL);
+
+		ASSERT_EQ(MCL_SUCCESS, MclHashMap_Reserve(&map, BUCKETS));
+		ASSERT_EQ(MCL_FAILURE, MclHashMap_Reserve(&map, 100));
+		ASSERT_EQ(BUCKETS, MclHashMap_GetBucketCount(&map));
+		ASSERT_TRUE(map.buckets == buckets);
+
+		MclHashMap_InitGrowable(&map, buckets, BUCKETS, NULL);
+		ASSERT_EQ(MCL_SUCCESS, MclHashMap_Reserve(&map, 100));
+		ASSERT_TRUE(MclHashMap_GetBucketCount(&map) >= 100);
+		MclHashMap_Destroy(&map, NULL);
+	}
+
+	TEST("should grow node map without allocator when growable")
+	{
+		constexpr uint32_t BUCKETS = 8;
+		MclHashBucket buckets[BUCKETS];
+		MclHashNode nodes[100];
+		MclHashMap map;
+		MclHashMap_InitGrowable(&map, buckets, BUCKETS, NULL);
+
+		for (uint32_t i = 0; i < 100; i++) {
+			MclHashNode_Init(&nodes[i], i, &nodes[i]);
+			ASSERT_EQ(MCL_SUCCESS, MclHashMap_InsertNode(&map, &nodes[i]));
+		}
+		ASSERT_TRUE(MclHashMap_GetBucketCount(&map) > BUCKETS);
+		for (uint32_t i = 0; i < 100; i++) {
+			ASSERT_EQ(&nodes[i], MclHashMap_FindNode(&map, i));
+		}
+		for (uint32_t i = 0; i < 100; i += 2) {
+			ASSERT_EQ(MCL_SUCCESS, MclHashMap_RemoveNode(&map, &nodes[i], NULL));
+		}
+		ASSERT_EQ(50, MclHashMap_GetSize(&map));
+		ASSERT_TRUE(MclHashMap_FindNode(&map, 2) == NULL);
+		ASSERT_EQ(&nodes[99], MclHashMap_FindNode(&map, 99));
+
+		MclHashMap_Destroy(&map, NULL);
+	}
 };
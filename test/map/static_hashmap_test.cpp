@@ -9,6 +9,13 @@ namespace {
     		MCL_MACRO_REPEAT_SIMPLE(MCL_HASHMAP_BUCKET_COUNT_DEFAULT, __MCL_HASH_BUCKETS_ITEM_INIT)
     };
     MclHashMap foomap = MCL_HASHMAP(foomap, buckets, MCL_HASHMAP_BUCKET_COUNT_DEFAULT, NULL);
+
+	#define __MCL_HASH_VALUE_BUCKETS_ITEM_INIT(n)  [n]=MCL_HASH_BUCKET(valueBuckets[n]),
+
+    MclHashBucket valueBuckets[MCL_HASHMAP_BUCKET_COUNT_DEFAULT] = {
+    		MCL_MACRO_REPEAT_SIMPLE(MCL_HASHMAP_BUCKET_COUNT_DEFAULT, __MCL_HASH_VALUE_BUCKETS_ITEM_INIT)
+    };
+    MclHashMap valuemap = MCL_HASHMAP_DEFAULT(valuemap, valueBuckets, MCL_HASHMAP_BUCKET_COUNT_DEFAULT);
 }
 
 FIXTURE(HashMapStaticTest) {
@@ -26,6 +33,7 @@ FIXTURE(HashMapStaticTest) {
 
     AFTER {
 		MclHashMap_Clear(foos, NULL);
+		MclHashMap_Clear(&valuemap, NULL);
     }
 
 	TEST("find all valid data")
@@ -65,4 +73,20 @@ FIXTURE(HashMapStaticTest) {
 
         ASSERT_EQ(3, MclHashMap_GetSize(foos));
 	}
+
+	TEST("should keep static buckets when set more values than buckets")
+	{
+		constexpr long VALUE_NUM = MCL_HASHMAP_BUCKET_COUNT_DEFAULT * 4;
+
+		for (long i = 0; i < VALUE_NUM; i++) {
+			ASSERT_TRUE(MclHashMap_Set(&valuemap, (MclHashKey)i, (MclHashValue)(i + 1)) != NULL);
+		}
+		ASSERT_EQ(VALUE_NUM, MclHashMap_GetSize(&valuemap));
+		ASSERT_EQ(MCL_HASHMAP_BUCKET_COUNT_DEFAULT, MclHashMap_GetBucketCount(&valuemap));
+		ASSERT_FALSE(MclHashMap_IsResizing(&valuemap));
+		ASSERT_EQ(VALUE_NUM, (long)MclHashMap_Get(&valuemap, VALUE_NUM - 1));
+
+		MclHashMap_Clear(&valuemap, NULL);
+		ASSERT_TRUE(valuemap.buckets == valueBuckets);
+	}
 };
@@ -0,0 +1,89 @@
+#include <cctest/cctest.h>
+#include "mcl/mem/slab.h"
+#include <set>
+#include <vector>
+
+namespace {
+	struct Foo {
+		uint64_t id;
+		Foo *next;
+		void *data;
+	};
+
+	MclSlabCache fooCache = MCL_SLAB_CACHE(sizeof(Foo));
+	MclSlabCache hugeCache = MCL_SLAB_CACHE(MCL_SLAB_SIZE);
+}
+
+FIXTURE(SlabTest) {
+	AFTER {
+		MclSlabCache_FlushLocal(&fooCache);
+		MclSlabCache_Reclaim(&fooCache);
+		ASSERT_EQ(0, MclSlabCache_GetSlabCount(&fooCache));
+	}
+
+	TEST("should alloc distinct objects")
+	{
+		std::set<Foo*> foos;
+		for (uint64_t i = 0; i < 1000; i++) {
+			auto foo = (Foo*)MclSlabCache_Alloc(&fooCache);
+			ASSERT_TRUE(foo != nullptr);
+			foo->id = i;
+			foos.insert(foo);
+		}
+		ASSERT_EQ(1000, foos.size());
+		ASSERT_TRUE(MclSlabCache_GetSlabCount(&fooCache) > 1);
+
+		for (auto foo : foos) {
+			MclSlabCache_Free(&fooCache, foo);
+		}
+	}
+
+	TEST("should reuse object freed by the same thread")
+	{
+		auto foo = MclSlabCache_Alloc(&fooCache);
+		MclSlabCache_Free(&fooCache, foo);
+		ASSERT_EQ(foo, MclSlabCache_Alloc(&fooCache));
+		MclSlabCache_Free(&fooCache, foo);
+	}
+
+	TEST("should keep objects intact while others are freed")
+	{
+		std::vector<Foo*> foos;
+		for (uint64_t i = 0; i < 5000; i++) {
+			auto foo = (Foo*)MclSlabCache_Alloc(&fooCache);
+			foo->id = i;
+			foos.push_back(foo);
+		}
+		for (uint64_t i = 0; i < foos.size(); i += 2) {
+			MclSlabCache_Free(&fooCache, foos[i]);
+		}
+		for (uint64_t i = 1; i < foos.size(); i += 2) {
+			ASSERT_EQ(i, foos[i]->id);
+			MclSlabCache_Free(&fooCache, foos[i]);
+		}
+	}
+
+	TEST("should unmap slabs after all objects freed")
+	{
+		std::vector<void*> foos;
+		for (int i = 0; i < 10000; i++) {
+			foos.push_back(MclSlabCache_Alloc(&fooCache));
+		}
+		MclSize slabCount = MclSlabCache_GetSlabCount(&fooCache);
+		ASSERT_TRUE(slabCount > MCL_SLAB_EMPTY_SLAB_MAX);
+
+		for (auto foo : foos) {
+			MclSlabCache_Free(&fooCache, foo);
+		}
+		MclSlabCache_FlushLocal(&fooCache);
+		ASSERT_TRUE(MclSlabCache_GetSlabCount(&fooCache) < slabCount);
+
+		MclSlabCache_Reclaim(&fooCache);
+		ASSERT_EQ(0, MclSlabCache_GetSlabCount(&fooCache));
+	}
+
+	TEST("should refuse object too large for slab")
+	{
+		ASSERT_TRUE(MclSlabCache_Alloc(&hugeCache) == nullptr);
+	}
+};
@@ -0,0 +1,94 @@
+#include <cctest/cctest.h>
+#include "mcl/mem/slab.h"
+#include "mcl/ringbuff/mpmc_queue.h"
+#include "mcl/thread/thread.h"
+
+namespace {
+	struct Foo {
+		uint64_t id;
+		uint64_t check;
+	};
+
+	MclSlabCache fooCache = MCL_SLAB_CACHE(sizeof(Foo));
+
+	constexpr uint64_t FOO_COUNT = 100000;
+	constexpr uint64_t FOO_CHECK = 0x5a5a5a5a5a5a5a5aULL;
+
+	struct Channel {
+		MclMpmcQueue *queue;
+		uint64_t badCount;
+	};
+
+	/* Objects are freed by another thread than the one which allocated them */
+	void* produceFoos(void *arg) {
+		auto channel = (Channel*)arg;
+		for (uint64_t i = 0; i < FOO_COUNT; i++) {
+			auto foo = (Foo*)MclSlabCache_Alloc(&fooCache);
+			foo->id = i;
+			foo->check = i ^ FOO_CHECK;
+			while (MCL_FAILED(MclMpmcQueue_Put(channel->queue, &foo))) {
+				MclThread_Yield();
+			}
+		}
+		return NULL;
+	}
+
+	void* consumeFoos(void *arg) {
+		auto channel = (Channel*)arg;
+		for (uint64_t i = 0; i < FOO_COUNT; i++) {
+			Foo *foo = nullptr;
+			while (MCL_FAILED(MclMpmcQueue_Pop(channel->queue, &foo))) {
+				MclThread_Yield();
+			}
+			if ((foo->id != i) || (foo->check != (i ^ FOO_CHECK))) channel->badCount++;
+			MclSlabCache_Free(&fooCache, foo);
+		}
+		return NULL;
+	}
+
+	void* churnFoos(void *arg) {
+		Foo *foos[64];
+		for (int round = 0; round < 2000; round++) {
+			for (auto &foo : foos) {
+				foo = (Foo*)MclSlabCache_Alloc(&fooCache);
+			}
+			for (auto foo : foos) {
+				MclSlabCache_Free(&fooCache, foo);
+			}
+		}
+		return NULL;
+	}
+}
+
+FIXTURE(SlabThreadTest) {
+	TEST("should free objects allocated by other thread")
+	{
+		Channel channel {MclMpmcQueue_Create(1024, sizeof(Foo*)), 0};
+
+		MclThread producer, consumer;
+		MclThread_Create(&producer, NULL, produceFoos, &channel);
+		MclThread_Create(&consumer, NULL, consumeFoos, &channel);
+		MclThread_Join(producer, NULL);
+		MclThread_Join(consumer, NULL);
+
+		ASSERT_EQ(0, channel.badCount);
+		MclMpmcQueue_Delete(channel.queue);
+
+		MclSlabCache_Reclaim(&fooCache);
+		ASSERT_EQ(0, MclSlabCache_GetSlabCount(&fooCache));
+	}
+
+	TEST("should give back objects cached by threads when they exit")
+	{
+		MclThread threads[4];
+		for (auto &thread : threads) {
+			MclThread_Create(&thread, NULL, churnFoos, NULL);
+		}
+		for (auto &thread : threads) {
+			MclThread_Join(thread, NULL);
+		}
+
+		MclSlabCache_Reclaim(&fooCache);
+		ASSERT_EQ(0, MclSlabCache_GetSlabCount(&fooCache));
+	}
+};
@@ -0,0 +1,84 @@
+#include <cctest/cctest.h>
+#include "mcl/msg/msg_pool.h"
+#include "mcl/msg/msg_queue.h"
+
+FIXTURE(MsgPoolTest) {
+    constexpr static MclSize BODY_COUNT = 4;
+
+    MclMsgPool *pool {nullptr};
+
+    BEFORE {
+        pool = MclMsgPool_Create(BODY_COUNT);
+    };
+
+    AFTER {
+        MclMsgPool_Delete(pool);
+    };
+
+    TEST("should create pool with all bodies free") {
+        ASSERT_TRUE(pool != NULL);
+        ASSERT_EQ(BODY_COUNT, MclMsgPool_GetFreeCount(pool, 64));
+        ASSERT_EQ(BODY_COUNT, MclMsgPool_GetFreeCount(pool, MCL_MSG_POOL_BODY_SIZE_MAX));
+    }
+
+    TEST("should alloc body from fit size class and free it back") {
+        MclMsg msg;
+        ASSERT_EQ(MCL_SUCCESS, MclMsgPool_Alloc(pool, &msg, 1, 2, 100));
+        ASSERT_TRUE(msg.body != NULL);
+        ASSERT_EQ(100, msg.bodyBytes);
+        ASSERT_EQ(BODY_COUNT, MclMsgPool_GetFreeCount(pool, 64));
+        ASSERT_EQ(BODY_COUNT - 1, MclMsgPool_GetFreeCount(pool, 256));
+
+        ASSERT_EQ(MCL_SUCCESS, MclMsgPool_Free(pool, &msg));
+        ASSERT_TRUE(msg.body == NULL);
+        ASSERT_EQ(BODY_COUNT, MclMsgPool_GetFreeCount(pool, 256));
+    }
+
+    TEST("should alloc from larger class when fit class runs out") {
+        MclMsg msgs[BODY_COUNT * 2];
+        for (auto &msg : msgs) {
+            ASSERT_EQ(MCL_SUCCESS, MclMsgPool_Alloc(pool, &msg, 1, 2, 1024));
+        }
+        MclMsg msg;
+        ASSERT_TRUE(MCL_FAILED(MclMsgPool_Alloc(pool, &msg, 1, 2, 1024)));
+        ASSERT_TRUE(MCL_FAILED(MclMsgPool_Alloc(pool, &msg, 1, 2, MCL_MSG_POOL_BODY_SIZE_MAX + 1)));
+
+        for (auto &msg : msgs) {
+            ASSERT_EQ(MCL_SUCCESS, MclMsgPool_Free(pool, &msg));
+        }
+        ASSERT_EQ(BODY_COUNT, MclMsgPool_GetFreeCount(pool, 1024));
+        ASSERT_EQ(BODY_COUNT, MclMsgPool_GetFreeCount(pool, MCL_MSG_POOL_BODY_SIZE_MAX));
+    }
+
+    TEST("should not free body not owned by pool") {
+        uint64_t value = 0;
+        MclMsg msg = MCL_MSG(1, 2, sizeof(value), &value);
+        ASSERT_TRUE(MCL_FAILED(MclMsgPool_Free(pool, &msg)));
+    }
+
+    TEST("should pass body ownership through msg queue without copy") {
+        MclMsgQueue *mq = MclMsgQueue_Create(4);
+
+        MclMsg msg;
+        ASSERT_EQ(MCL_SUCCESS, MclMsgPool_Alloc(pool, &msg, 3, 4, MCL_MSG_POOL_BODY_SIZE_MAX));
+        uint64_t value = 0xdeadc0de;
+        ASSERT_EQ(MCL_SUCCESS, MclMsg_Fill(&msg, 0, sizeof(value), &value));
+        ASSERT_EQ(MCL_SUCCESS, MclMsgQueue_Send(mq, &msg));
+
+        MclMsg result;
+        ASSERT_EQ(MCL_SUCCESS, MclMsgQueue_RecvOwned(mq, &result));
+        ASSERT_TRUE(result.body == msg.body);
+        ASSERT_EQ(3, result.type);
+        ASSERT_EQ(4, result.id);
+
+        uint64_t outValue = 0;
+        ASSERT_EQ(MCL_SUCCESS, MclMsg_Fetch(&result, 0, sizeof(outValue), &outValue));
+        ASSERT_EQ(value, outValue);
+
+        ASSERT_EQ(MCL_SUCCESS, MclMsgPool_Free(pool, &result));
+        ASSERT_EQ(BODY_COUNT, MclMsgPool_GetFreeCount(pool, MCL_MSG_POOL_BODY_SIZE_MAX));
+        ASSERT_TRUE(MCL_FAILED(MclMsgQueue_RecvOwned(mq, &result)));
+
+        MclMsgQueue_Delete(mq);
+    }
+};
@@ -104,4 +104,120 @@ FIXTURE(MsgQueueTest) {
         ASSERT_TRUE(MCL_FAILED(MclMsgQueue_Recv(mq, &result)));
         ASSERT_EQ(0, MclMsgQueue_GetCount(mq));
     }
+
+    static void onReady(void *ctxt) {
+        (*(int*)ctxt)++;
+    }
+
+    TEST("should run ready callbacks once on send") {
+        int readyCount = 0;
+        int cancelledCount = 0;
+        ASSERT_EQ(MCL_SUCCESS, MclMsgQueue_OnReady(mq, onReady, &readyCount));
+        ASSERT_EQ(MCL_SUCCESS, MclMsgQueue_OnReady(mq, onReady, &cancelledCount));
+        ASSERT_EQ(MCL_SUCCESS, MclMsgQueue_CancelOnReady(mq, onReady, &cancelledCount));
+        ASSERT_EQ(0, readyCount);
+
+        MCL_AUTO_MSG MclMsg *msg = MclMsg_Create(defaultType, defaultId, sizeof(uint64_t));
+        ASSERT_EQ(MCL_SUCCESS, MclMsgQueue_Send(mq, msg));
+        ASSERT_EQ(MCL_SUCCESS, MclMsgQueue_Send(mq, msg));
+        ASSERT_EQ(1, readyCount);
+        ASSERT_EQ(0, cancelledCount);
+        ASSERT_EQ(MCL_FAILURE, MclMsgQueue_CancelOnReady(mq, onReady, &readyCount));
+
+        ASSERT_EQ(MCL_SUCCESS, MclMsgQueue_OnReady(mq, onReady, &readyCount));
+        ASSERT_EQ(2, readyCount);
+    }
+};
+
+FIXTURE(MsgQueueLockFreeTest) {
+    constexpr static MclSize MSG_QUEUE_CAPACITY = 8;
+
+    MclMsgQueue *mq {nullptr};
+
+    BEFORE {
+        mq = MclMsgQueue_CreateLockFree(MSG_QUEUE_CAPACITY);
+    };
+
+    AFTER {
+        MclMsgQueue_Delete(mq);
+    };
+
+    TEST("should not create lock free mq with capacity not power of 2") {
+        ASSERT_TRUE(MclMsgQueue_CreateLockFree(10) == NULL);
+    }
+
+    TEST("should send to full and recv to empty in order") {
+        uint16_t value = 0xabcd;
+        MclMsg msg = MCL_MSG(3, 0, sizeof(value), &value);
+        for (MclSize i = 0; i < MSG_QUEUE_CAPACITY; i++) {
+            msg.id = i;
+            ASSERT_EQ(MCL_SUCCESS, MclMsgQueue_Send(mq, &msg));
+        }
+        ASSERT_TRUE(MclMsgQueue_IsFull(mq));
+        ASSERT_TRUE(MCL_FAILED(MclMsgQueue_Send(mq, &msg)));
+
+        uint16_t outValue = 0;
+        MclMsg result = MCL_MSG(0, 0, sizeof(outValue), &outValue);
+        for (MclSize i = 0; i < MSG_QUEUE_CAPACITY; i++) {
+            ASSERT_EQ(MSG_QUEUE_CAPACITY - i, MclMsgQueue_GetCount(mq));
+            ASSERT_EQ(MCL_SUCCESS, MclMsgQueue_Recv(mq, &result));
+            ASSERT_EQ(i, result.id);
+            ASSERT_EQ(0xabcd, outValue);
+        }
+        ASSERT_TRUE(MclMsgQueue_IsEmpty(mq));
+        ASSERT_TRUE(MCL_FAILED(MclMsgQueue_Recv(mq, &result)));
+    }
+
+    TEST("should be empty after clear") {
+        uint16_t value = 0xabcd;
+        MclMsg msg = MCL_MSG(3, 0, sizeof(value), &value);
+        ASSERT_EQ(MCL_SUCCESS, MclMsgQueue_Send(mq, &msg));
+        ASSERT_EQ(MCL_SUCCESS, MclMsgQueue_Send(mq, &msg));
+
+        MclMsgQueue_Clear(mq);
+        ASSERT_TRUE(MclMsgQueue_IsEmpty(mq));
+    }
+};
+
+FIXTURE(MsgQueueBatchTest) {
+    constexpr static MclSize BATCH_SIZE = 6;
+
+    void sendAndRecvBatch(MclMsgQueue *mq, MclSize capacity) {
+        uint32_t values[BATCH_SIZE] = {0};
+        MclMsg msgs[BATCH_SIZE];
+        for (MclSize i = 0; i < BATCH_SIZE; i++) {
+            values[i] = i * 10;
+            msgs[i] = MCL_MSG(3, (MclMsgId)i, sizeof(uint32_t), &values[i]);
+        }
+
+        MclSize sentCount = MCL_MIN(BATCH_SIZE, capacity);
+        ASSERT_EQ(sentCount, MclMsgQueue_SendBatch(mq, msgs, BATCH_SIZE));
+        ASSERT_EQ(sentCount, MclMsgQueue_GetCount(mq));
+
+        uint32_t outValues[BATCH_SIZE] = {0};
+        MclMsg results[BATCH_SIZE];
+        for (MclSize i = 0; i < BATCH_SIZE; i++) {
+            results[i] = MCL_MSG(0, 0, sizeof(uint32_t), &outValues[i]);
+        }
+        ASSERT_EQ(sentCount, MclMsgQueue_RecvBatch(mq, results, BATCH_SIZE));
+        for (MclSize i = 0; i < sentCount; i++) {
+            ASSERT_EQ(i, results[i].id);
+            ASSERT_EQ(i * 10, outValues[i]);
+        }
+        ASSERT_TRUE(MclMsgQueue_IsEmpty(mq));
+        ASSERT_EQ(0, MclMsgQueue_RecvBatch(mq, results, BATCH_SIZE));
+    }
+
+    TEST("should send and recv batch of msgs") {
+        MclMsgQueue *mq = MclMsgQueue_Create(4);
+        sendAndRecvBatch(mq, 4);
+        sendAndRecvBatch(mq, 4);
+        MclMsgQueue_Delete(mq);
+    }
+
+    TEST("should send and recv batch of msgs in lock free mq") {
+        MclMsgQueue *mq = MclMsgQueue_CreateLockFree(8);
+        sendAndRecvBatch(mq, 8);
+        MclMsgQueue_Delete(mq);
+    }
 };
@@ -9,6 +9,11 @@ namespace {
     MclMsg msgBuff[MSG_QUEUE_CAPACITY];
     MclMsgQueue mq = MCL_MSG_QUEUE(msgBuff, MSG_QUEUE_CAPACITY);
 
+    constexpr MclSize LOCK_FREE_CAPACITY = 16;
+
+    uint8_t cellBuff[MCL_MSG_QUEUE_LOCK_FREE_BUFF_SIZE(LOCK_FREE_CAPACITY)];
+    MclMsgQueue lockFreeMq = MCL_MSG_QUEUE_LOCK_FREE(cellBuff, LOCK_FREE_CAPACITY);
+
     constexpr uint16_t TRY_COUNT = 10000;
     MclAtomic SENT_COUNT = 0;
     MclAtomic RECV_COUNT = 0;
@@ -16,10 +21,11 @@ namespace {
     uint16_t value = 0xcd;
     uint16_t outValue = 0;
 
-    void* sendMsg(void *) {
+    void* sendMsg(void *arg) {
+        MclMsgQueue *queue = arg ? (MclMsgQueue*)arg : &mq;
         for (uint16_t i = 0; i < TRY_COUNT; i++) {
             MclMsg msg = MCL_MSG(0, i, sizeof(value), &value);
-            if (!MCL_FAILED(MclMsgQueue_Send(&mq, &msg))) {
+            if (!MCL_FAILED(MclMsgQueue_Send(queue, &msg))) {
                 MclAtomic_AddFetch(&SENT_COUNT, 1);
             }
             MclThread_Yield();
@@ -27,10 +33,11 @@ namespace {
         return NULL;
     }
 
-    void* recvMsg(void *) {
+    void* recvMsg(void *arg) {
+        MclMsgQueue *queue = arg ? (MclMsgQueue*)arg : &mq;
         for (uint16_t i = 0; i < TRY_COUNT; i++) {
             MclMsg msg = MCL_MSG(0, 0, sizeof(outValue), &outValue);
-            if (!MCL_FAILED(MclMsgQueue_Recv(&mq, &msg))) {
+            if (!MCL_FAILED(MclMsgQueue_Recv(queue, &msg))) {
                 MclAtomic_AddFetch(&RECV_COUNT, 1);
             }
             MclThread_Yield();
@@ -60,4 +67,122 @@ FIXTURE(MsgQueueThreadTest) {
 
         ASSERT_EQ(SENT_COUNT, RECV_COUNT + MclMsgQueue_GetCount(&mq));
     }
+
+    TEST("should execute correct in multi threads with lock free mq") {
+        MclThread s1, s2, r1, r2;
+
+        MclThread_Create(&s1, NULL, sendMsg, &lockFreeMq);
+        MclThread_Create(&s2, NULL, sendMsg, &lockFreeMq);
+        MclThread_Create(&r1, NULL, recvMsg, &lockFreeMq);
+        MclThread_Create(&r2, NULL, recvMsg, &lockFreeMq);
+
+        MclThread_Join(s1, NULL);
+        MclThread_Join(s2, NULL);
+        MclThread_Join(r1, NULL);
+        MclThread_Join(r2, NULL);
+
+        ASSERT_EQ(SENT_COUNT, RECV_COUNT + MclMsgQueue_GetCount(&lockFreeMq));
+    }
+};
+
+namespace {
+    constexpr MclTimeUs WAIT_TIMEOUT_US = 20 * 1000;
+    constexpr uint32_t WAIT_MSG_COUNT = 20000;
+
+    void* sendAllByWait(void *arg) {
+        MclMsgQueue *queue = (MclMsgQueue*)arg;
+        for (uint32_t i = 0; i < WAIT_MSG_COUNT; i++) {
+            MclMsg msg = MCL_MSG(0, (MclMsgId)i, sizeof(value), &value);
+            if (!MCL_FAILED(MclMsgQueue_SendWait(queue, &msg, MCL_TIME_US_INVALID))) {
+                MclAtomic_AddFetch(&SENT_COUNT, 1);
+            }
+        }
+        return NULL;
+    }
+
+    void* recvAllByWait(void *arg) {
+        MclMsgQueue *queue = (MclMsgQueue*)arg;
+        uint16_t body = 0;
+        MclMsg msg = MCL_MSG(0, 0, sizeof(body), &body);
+        while (!MCL_FAILED(MclMsgQueue_RecvWait(queue, &msg, WAIT_TIMEOUT_US * 10))) {
+            MclAtomic_AddFetch(&RECV_COUNT, 1);
+        }
+        return NULL;
+    }
+
+    void* sendOneLater(void *arg) {
+        MclThread_Yield();
+        MclMsg msg = MCL_MSG(0, 7, sizeof(value), &value);
+        MclMsgQueue_Send((MclMsgQueue*)arg, &msg);
+        return NULL;
+    }
+}
+
+FIXTURE(MsgQueueWaitTest) {
+    BEFORE {
+        MclAtomic_Clear(&SENT_COUNT);
+        MclAtomic_Clear(&RECV_COUNT);
+    }
+
+    void sendAndRecvByWait(MclMsgQueue *queue) {
+        MclThread s1, s2, r1, r2;
+
+        MclThread_Create(&r1, NULL, recvAllByWait, queue);
+        MclThread_Create(&r2, NULL, recvAllByWait, queue);
+        MclThread_Create(&s1, NULL, sendAllByWait, queue);
+        MclThread_Create(&s2, NULL, sendAllByWait, queue);
+
+        MclThread_Join(s1, NULL);
+        MclThread_Join(s2, NULL);
+        MclThread_Join(r1, NULL);
+        MclThread_Join(r2, NULL);
+
+        ASSERT_EQ(2 * WAIT_MSG_COUNT, MclAtomic_Get(&SENT_COUNT));
+        ASSERT_EQ(2 * WAIT_MSG_COUNT, MclAtomic_Get(&RECV_COUNT));
+        ASSERT_TRUE(MclMsgQueue_IsEmpty(queue));
+    }
+
+    TEST("should time out when recv wait on empty mq") {
+        MclMsgQueue *queue = MclMsgQueue_Create(4);
+        uint16_t body = 0;
+        MclMsg msg = MCL_MSG(0, 0, sizeof(body), &body);
+        ASSERT_EQ(MCL_TIMEDOUT, MclMsgQueue_RecvWait(queue, &msg, WAIT_TIMEOUT_US));
+        MclMsgQueue_Delete(queue);
+    }
+
+    TEST("should time out when send wait on full mq") {
+        MclMsgQueue *queue = MclMsgQueue_CreateLockFree(2);
+        MclMsg msg = MCL_MSG(0, 0, sizeof(value), &value);
+        ASSERT_EQ(MCL_SUCCESS, MclMsgQueue_SendWait(queue, &msg, WAIT_TIMEOUT_US));
+        ASSERT_EQ(MCL_SUCCESS, MclMsgQueue_SendWait(queue, &msg, WAIT_TIMEOUT_US));
+        ASSERT_EQ(MCL_TIMEDOUT, MclMsgQueue_SendWait(queue, &msg, WAIT_TIMEOUT_US));
+        MclMsgQueue_Delete(queue);
+    }
+
+    TEST("should be woken up when msg arrives") {
+        MclMsgQueue *queue = MclMsgQueue_Create(4);
+        MclThread sender;
+        MclThread_Create(&sender, NULL, sendOneLater, queue);
+
+        uint16_t body = 0;
+        MclMsg msg = MCL_MSG(0, 0, sizeof(body), &body);
+        ASSERT_EQ(MCL_SUCCESS, MclMsgQueue_RecvWait(queue, &msg, MCL_TIME_US_INVALID));
+        ASSERT_EQ(7, msg.id);
+        ASSERT_EQ(0xcd, body);
+
+        MclThread_Join(sender, NULL);
+        MclMsgQueue_Delete(queue);
+    }
+
+    TEST("should send and recv all msgs by wait") {
+        MclMsgQueue *queue = MclMsgQueue_Create(8);
+        sendAndRecvByWait(queue);
+        MclMsgQueue_Delete(queue);
+    }
+
+    TEST("should send and recv all msgs by wait in lock free mq") {
+        MclMsgQueue *queue = MclMsgQueue_CreateLockFree(8);
+        sendAndRecvByWait(queue);
+        MclMsgQueue_Delete(queue);
+    }
 };
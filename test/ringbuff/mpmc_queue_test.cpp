@@ -0,0 +1,94 @@
+#include <cctest/cctest.h>
+#include "mcl/ringbuff/mpmc_queue.h"
+
+FIXTURE(MpmcQueueTest) {
+    constexpr static MclSize QUEUE_CAPACITY = 4;
+
+    MclMpmcQueue *queue {nullptr};
+
+    BEFORE {
+        queue = MclMpmcQueue_Create(QUEUE_CAPACITY, sizeof(uint32_t));
+    };
+
+    AFTER {
+        MclMpmcQueue_Delete(queue);
+    };
+
+    TEST("should create an empty queue") {
+        ASSERT_TRUE(queue != NULL);
+        ASSERT_TRUE(MclMpmcQueue_IsEmpty(queue));
+        ASSERT_FALSE(MclMpmcQueue_IsFull(queue));
+        ASSERT_EQ(0, MclMpmcQueue_GetCount(queue));
+        ASSERT_EQ(QUEUE_CAPACITY, MclMpmcQueue_GetCapacity(queue));
+    }
+
+    TEST("should not create queue with capacity not power of 2") {
+        ASSERT_TRUE(MclMpmcQueue_Create(3, sizeof(uint32_t)) == NULL);
+    }
+
+    TEST("should not pop from empty queue") {
+        uint32_t result = 0;
+        ASSERT_TRUE(MCL_FAILED(MclMpmcQueue_Pop(queue, &result)));
+    }
+
+    TEST("should put and pop element") {
+        uint32_t value = 3;
+        ASSERT_EQ(MCL_SUCCESS, MclMpmcQueue_Put(queue, &value));
+        ASSERT_EQ(1, MclMpmcQueue_GetCount(queue));
+
+        uint32_t result = 0;
+        ASSERT_EQ(MCL_SUCCESS, MclMpmcQueue_Pop(queue, &result));
+        ASSERT_EQ(3, result);
+        ASSERT_TRUE(MclMpmcQueue_IsEmpty(queue));
+    }
+
+    TEST("should use all capacity and not put to full queue") {
+        for (uint32_t i = 0; i < QUEUE_CAPACITY; i++) {
+            ASSERT_EQ(MCL_SUCCESS, MclMpmcQueue_Put(queue, &i));
+        }
+        ASSERT_TRUE(MclMpmcQueue_IsFull(queue));
+
+        uint32_t value = 100;
+        ASSERT_TRUE(MCL_FAILED(MclMpmcQueue_Put(queue, &value)));
+    }
+
+    TEST("should keep fifo order when wrap around") {
+        for (uint32_t round = 0; round < 3; round++) {
+            for (uint32_t i = 0; i < QUEUE_CAPACITY; i++) {
+                uint32_t value = round * QUEUE_CAPACITY + i;
+                ASSERT_EQ(MCL_SUCCESS, MclMpmcQueue_Put(queue, &value));
+            }
+            for (uint32_t i = 0; i < QUEUE_CAPACITY; i++) {
+                uint32_t result = 0;
+                ASSERT_EQ(MCL_SUCCESS, MclMpmcQueue_Pop(queue, &result));
+                ASSERT_EQ(round * QUEUE_CAPACITY + i, result);
+            }
+            ASSERT_TRUE(MclMpmcQueue_IsEmpty(queue));
+        }
+    }
+
+    TEST("should be empty after reset") {
+        uint32_t value = 1;
+        ASSERT_EQ(MCL_SUCCESS, MclMpmcQueue_Put(queue, &value));
+        MclMpmcQueue_Reset(queue);
+        ASSERT_TRUE(MclMpmcQueue_IsEmpty(queue));
+        ASSERT_EQ(MCL_SUCCESS, MclMpmcQueue_Put(queue, &value));
+        ASSERT_EQ(1, MclMpmcQueue_GetCount(queue));
+    }
+};
+
+FIXTURE(MpmcQueueStaticTest) {
+    TEST("should work with static buffer") {
+        static uint8_t buff[2 * MCL_MPMC_QUEUE_CELL_SIZE(sizeof(uint64_t))];
+        static MclMpmcQueue queue = MCL_MPMC_QUEUE(2, sizeof(uint64_t), buff);
+
+        uint64_t value = 0x1234;
+        ASSERT_EQ(MCL_SUCCESS, MclMpmcQueue_Put(&queue, &value));
+        ASSERT_EQ(MCL_SUCCESS, MclMpmcQueue_Put(&queue, &value));
+        ASSERT_TRUE(MCL_FAILED(MclMpmcQueue_Put(&queue, &value)));
+
+        uint64_t result = 0;
+        ASSERT_EQ(MCL_SUCCESS, MclMpmcQueue_Pop(&queue, &result));
+        ASSERT_EQ(0x1234, result);
+    }
+};
@@ -0,0 +1,72 @@
+#include <cctest/cctest.h>
+#include "mcl/ringbuff/mpmc_queue.h"
+#include "mcl/lock/atomic.h"
+#include "mcl/thread/thread.h"
+
+namespace {
+    constexpr MclSize QUEUE_CAPACITY = 64;
+    constexpr uint32_t PRODUCER_COUNT = 2;
+    constexpr uint32_t CONSUMER_COUNT = 2;
+    constexpr uint32_t MSG_PER_PRODUCER = 50000;
+
+    MclMpmcQueue *queue = nullptr;
+    MclAtomic RECV_COUNT = 0;
+    MclAtomic RECV_FLAGS[PRODUCER_COUNT * MSG_PER_PRODUCER];
+
+    void* produce(void *arg) {
+        uint32_t base = (uint32_t)(uintptr_t)arg * MSG_PER_PRODUCER;
+        for (uint32_t i = 0; i < MSG_PER_PRODUCER; i++) {
+            uint32_t value = base + i;
+            while (MCL_FAILED(MclMpmcQueue_Put(queue, &value))) {
+                MclThread_Yield();
+            }
+        }
+        return NULL;
+    }
+
+    void* consume(void *) {
+        while (MclAtomic_Get(&RECV_COUNT) < PRODUCER_COUNT * MSG_PER_PRODUCER) {
+            uint32_t value = 0;
+            if (MCL_FAILED(MclMpmcQueue_Pop(queue, &value))) {
+                MclThread_Yield();
+                continue;
+            }
+            MclAtomic_AddFetch(&RECV_FLAGS[value], 1);
+            MclAtomic_AddFetch(&RECV_COUNT, 1);
+        }
+        return NULL;
+    }
+}
+
+FIXTURE(MpmcQueueThreadTest) {
+    BEFORE {
+        queue = MclMpmcQueue_Create(QUEUE_CAPACITY, sizeof(uint32_t));
+        MclAtomic_Clear(&RECV_COUNT);
+        for (auto &flag : RECV_FLAGS) MclAtomic_Clear(&flag);
+    }
+
+    AFTER {
+        MclMpmcQueue_Delete(queue);
+    }
+
+    TEST("should receive every value exactly once in multi threads") {
+        MclThread producers[PRODUCER_COUNT];
+        MclThread consumers[CONSUMER_COUNT];
+
+        for (uint32_t i = 0; i < CONSUMER_COUNT; i++) {
+            MclThread_Create(&consumers[i], NULL, consume, NULL);
+        }
+        for (uint32_t i = 0; i < PRODUCER_COUNT; i++) {
+            MclThread_Create(&producers[i], NULL, produce, (void*)(uintptr_t)i);
+        }
+
+        for (auto &p : producers) MclThread_Join(p, NULL);
+        for (auto &c : consumers) MclThread_Join(c, NULL);
+
+        ASSERT_EQ(PRODUCER_COUNT * MSG_PER_PRODUCER, MclAtomic_Get(&RECV_COUNT));
+        ASSERT_TRUE(MclMpmcQueue_IsEmpty(queue));
+        for (auto &flag : RECV_FLAGS) {
+            ASSERT_EQ(1, MclAtomic_Get(&flag));
+        }
+    }
+};
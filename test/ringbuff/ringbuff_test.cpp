@@ -83,3 +83,154 @@ FIXTURE(RingbuffTest) {
         ASSERT_EQ(0, MclRingBuff_GetCount(rb));
     }
 };
+
+FIXTURE(RingbuffSpscTest) {
+    constexpr static MclSize RING_BUFF_SIZE = 4;
+
+    MclRingBuff *rb {nullptr};
+
+    BEFORE {
+        rb = MclRingBuff_CreateSpsc(RING_BUFF_SIZE, sizeof(Msg));
+    };
+
+    AFTER {
+        MclRingBuff_Delete(rb);
+    };
+
+    TEST("should not create spsc ringbuff with capacity not power of 2") {
+        ASSERT_TRUE(MclRingBuff_CreateSpsc(3, sizeof(Msg)) == NULL);
+    }
+
+    TEST("should create an empty spsc ringbuff") {
+        ASSERT_TRUE(rb != NULL);
+        ASSERT_TRUE(MclRingBuff_IsEmpty(rb));
+        ASSERT_FALSE(MclRingBuff_IsFull(rb));
+        ASSERT_EQ(0, MclRingBuff_GetCount(rb));
+    }
+
+    TEST("should use all slots of spsc ringbuff") {
+        Msg msg{3, true};
+        for (MclSize i = 0; i < RING_BUFF_SIZE; i++) {
+            ASSERT_EQ(MCL_SUCCESS, MclRingBuff_Put(rb, &msg));
+            ASSERT_EQ(i + 1, MclRingBuff_GetCount(rb));
+        }
+        ASSERT_TRUE(MclRingBuff_IsFull(rb));
+        ASSERT_TRUE(MCL_FAILED(MclRingBuff_Put(rb, &msg)));
+        ASSERT_EQ(RING_BUFF_SIZE, MclRingBuff_GetCount(rb));
+    }
+
+    TEST("should keep fifo order when wrap around") {
+        Msg result;
+        for (MclSize i = 0; i < RING_BUFF_SIZE * 3; i++) {
+            Msg msg{i, true};
+            ASSERT_EQ(MCL_SUCCESS, MclRingBuff_Put(rb, &msg));
+            ASSERT_EQ(MCL_SUCCESS, MclRingBuff_Pop(rb, &result));
+            ASSERT_EQ(i, result.value);
+            ASSERT_TRUE(MclRingBuff_IsEmpty(rb));
+        }
+        ASSERT_TRUE(MCL_FAILED(MclRingBuff_Pop(rb, &result)));
+    }
+};
+
+FIXTURE(RingbuffBatchTest) {
+    constexpr static MclSize RING_BUFF_SIZE = 8;
+
+    void putAndPopAcrossWrap(MclRingBuff *rb, MclSize usableCount) {
+        Msg msgs[RING_BUFF_SIZE];
+        Msg results[RING_BUFF_SIZE];
+
+        for (MclSize round = 0; round < 3; round++) {
+            for (MclSize i = 0; i < RING_BUFF_SIZE; i++) {
+                msgs[i] = Msg{round * RING_BUFF_SIZE + i, true};
+            }
+            ASSERT_EQ(usableCount, MclRingBuff_PutN(rb, msgs, RING_BUFF_SIZE));
+            ASSERT_TRUE(MclRingBuff_IsFull(rb));
+            ASSERT_EQ(0, MclRingBuff_PutN(rb, msgs, 1));
+
+            ASSERT_EQ(3, MclRingBuff_PopN(rb, results, 3));
+            ASSERT_EQ(usableCount - 3, MclRingBuff_PopN(rb, results + 3, RING_BUFF_SIZE));
+            for (MclSize i = 0; i < usableCount; i++) {
+                ASSERT_EQ(round * RING_BUFF_SIZE + i, results[i].value);
+            }
+            ASSERT_TRUE(MclRingBuff_IsEmpty(rb));
+            ASSERT_EQ(0, MclRingBuff_PopN(rb, results, 1));
+
+            ASSERT_EQ(round + 1, MclRingBuff_PutN(rb, msgs, round + 1));
+            ASSERT_EQ(round + 1, MclRingBuff_PopN(rb, results, RING_BUFF_SIZE));
+        }
+    }
+
+    TEST("should put and pop batch across wrap point") {
+        MclRingBuff *rb = MclRingBuff_Create(RING_BUFF_SIZE, sizeof(Msg));
+        putAndPopAcrossWrap(rb, RING_BUFF_SIZE - 1);
+        MclRingBuff_Delete(rb);
+    }
+
+    TEST("should put and pop batch across wrap point in spsc mode") {
+        MclRingBuff *rb = MclRingBuff_CreateSpsc(RING_BUFF_SIZE, sizeof(Msg));
+        putAndPopAcrossWrap(rb, RING_BUFF_SIZE);
+        MclRingBuff_Delete(rb);
+    }
+};
+
+FIXTURE(RingbuffZeroCopyTest) {
+    constexpr static MclSize RING_BUFF_SIZE = 4;
+
+    void reserveAndPeekInPlace(MclRingBuff *rb, MclSize usableCount) {
+        MclSize count = 0;
+        Msg *slots = (Msg*)MclRingBuff_Reserve(rb, RING_BUFF_SIZE, &count);
+        ASSERT_TRUE(slots != NULL);
+        ASSERT_EQ(usableCount, count);
+        for (MclSize i = 0; i < count; i++) {
+            slots[i] = Msg{i, true};
+        }
+        ASSERT_TRUE(MclRingBuff_IsEmpty(rb));
+        ASSERT_EQ(MCL_SUCCESS, MclRingBuff_Commit(rb, count));
+        ASSERT_EQ(usableCount, MclRingBuff_GetCount(rb));
+        ASSERT_TRUE(MclRingBuff_Reserve(rb, 1, &count) == NULL);
+        ASSERT_TRUE(MCL_FAILED(MclRingBuff_Commit(rb, 1)));
+
+        Msg *items = (Msg*)MclRingBuff_Peek(rb, 2, &count);
+        ASSERT_TRUE(items != NULL);
+        ASSERT_EQ(2, count);
+        ASSERT_EQ(0, items[0].value);
+        ASSERT_EQ(1, items[1].value);
+        ASSERT_EQ(MCL_SUCCESS, MclRingBuff_Release(rb, count));
+        ASSERT_EQ(usableCount - 2, MclRingBuff_GetCount(rb));
+
+        slots = (Msg*)MclRingBuff_Reserve(rb, RING_BUFF_SIZE, &count);
+        ASSERT_TRUE(slots != NULL);
+        ASSERT_TRUE(count >= 1);
+        slots[0] = Msg{100, true};
+        ASSERT_EQ(MCL_SUCCESS, MclRingBuff_Commit(rb, 1));
+
+        MclSize readValues[RING_BUFF_SIZE];
+        MclSize readCount = 0;
+        while ((items = (Msg*)MclRingBuff_Peek(rb, RING_BUFF_SIZE, &count)) != NULL) {
+            for (MclSize i = 0; i < count; i++) {
+                readValues[readCount++] = items[i].value;
+            }
+            ASSERT_EQ(MCL_SUCCESS, MclRingBuff_Release(rb, count));
+        }
+        ASSERT_EQ(usableCount - 1, readCount);
+        for (MclSize i = 0; i < readCount - 1; i++) {
+            ASSERT_EQ(i + 2, readValues[i]);
+        }
+        ASSERT_EQ(100, readValues[readCount - 1]);
+        ASSERT_TRUE(MclRingBuff_IsEmpty(rb));
+        ASSERT_TRUE(MclRingBuff_Peek(rb, 1, &count) == NULL);
+        ASSERT_TRUE(MCL_FAILED(MclRingBuff_Release(rb, 1)));
+    }
+
+    TEST("should write and read in place") {
+        MclRingBuff *rb = MclRingBuff_Create(RING_BUFF_SIZE, sizeof(Msg));
+        reserveAndPeekInPlace(rb, RING_BUFF_SIZE - 1);
+        MclRingBuff_Delete(rb);
+    }
+
+    TEST("should write and read in place in spsc mode") {
+        MclRingBuff *rb = MclRingBuff_CreateSpsc(RING_BUFF_SIZE, sizeof(Msg));
+        reserveAndPeekInPlace(rb, RING_BUFF_SIZE);
+        MclRingBuff_Delete(rb);
+    }
+};
@@ -51,6 +51,53 @@ namespace {
         MCL_LOG_SUCC("Msg queue recv thread quit OK!");
         return NULL;
     }
+
+    ///////////////////////////////////////////////////////////
+    constexpr MclSize STREAM_COUNT = 1000000;
+    constexpr MclSize STREAM_RING_SIZE = 1024;
+
+    struct Stream {
+        MclRingBuff *ringbuff;
+        MclSize received;
+        bool inOrder;
+    };
+
+    void* sendStream(void *arg) {
+        Stream *stream = (Stream*)arg;
+        for (MclSize i = 0; i < STREAM_COUNT;) {
+            Msg msg {i, true};
+            if (MCL_FAILED(MclRingBuff_Put(stream->ringbuff, &msg))) {
+                MclThread_Yield();
+                continue;
+            }
+            i++;
+        }
+        return NULL;
+    }
+
+    void* recvStream(void *arg) {
+        Stream *stream = (Stream*)arg;
+        while (stream->received < STREAM_COUNT) {
+            Msg msg{0, false};
+            if (MCL_FAILED(MclRingBuff_Pop(stream->ringbuff, &msg))) {
+                MclThread_Yield();
+                continue;
+            }
+            if (msg.value != stream->received) stream->inOrder = false;
+            stream->received++;
+        }
+        return NULL;
+    }
+
+    void runStream(Stream &stream) {
+        MclThread producer, consumer;
+
+        MclThread_Create(&producer, NULL, sendStream, &stream);
+        MclThread_Create(&consumer, NULL, recvStream, &stream);
+
+        MclThread_Join(producer, NULL);
+        MclThread_Join(consumer, NULL);
+    }
 }
 
 FIXTURE(RingbuffAdvanceTest) {
@@ -65,4 +112,20 @@ FIXTURE(RingbuffAdvanceTest) {
 
         ASSERT_EQ(MAX_SEND_VALUE, LAST_RECEIVED_VALUD);
     }
+
+    TEST("should spsc ringbuff transfer in order as default") {
+        Stream defaultStream {MclRingBuff_Create(STREAM_RING_SIZE, sizeof(Msg)), 0, true};
+        Stream spscStream {MclRingBuff_CreateSpsc(STREAM_RING_SIZE, sizeof(Msg)), 0, true};
+
+        runStream(defaultStream);
+        runStream(spscStream);
+
+        ASSERT_EQ(STREAM_COUNT, defaultStream.received);
+        ASSERT_EQ(STREAM_COUNT, spscStream.received);
+        ASSERT_TRUE(defaultStream.inOrder);
+        ASSERT_TRUE(spscStream.inOrder);
+
+        MclRingBuff_Delete(defaultStream.ringbuff);
+        MclRingBuff_Delete(spscStream.ringbuff);
+    }
 };
@@ -0,0 +1,193 @@
+#include <cctest/cctest.h>
+#include "mcl/task/fiber.h"
+#include "mcl/task/task_scheduler.h"
+#include "mcl/task/task.h"
+#include "mcl/lock/future.h"
+#include "mcl/lock/atomic.h"
+#include "mcl/msg/msg_queue.h"
+#include <unistd.h>
+
+namespace {
+	enum {
+		URGENT, NORMAL, SLOW, MAX_PRIORITY
+	};
+
+	constexpr MclSize FIBER_COUNT = 1000;
+
+	MclFuture *gate = nullptr;
+	MclFuture *allDone = nullptr;
+	MclAtomic awaitedCount = 0;
+	MclAtomic seq = 0;
+	MclAtomic sleeperSeq = 0;
+	MclAtomic plainSeq = 0;
+
+	void AwaitGate_Run(void *arg) {
+		MclStatus status = MCL_FAILURE;
+		void *value = nullptr;
+		MclFiber_AwaitFuture(gate, &status, &value);
+		if ((status == MCL_SUCCESS) && ((long)value == 42) && MclFiber_IsInFiber()) {
+			if (MclAtomic_AddFetch(&awaitedCount, 1) == FIBER_COUNT) {
+				MclFuture_Set(allDone, MCL_SUCCESS, nullptr);
+			}
+		}
+	}
+
+	MclTaskScheduler *sleeperScheduler = nullptr;
+	MclTask plainTask;
+
+	MclStatus PlainTask_Execute(MclTask*) {
+		MclAtomic_Set(&plainSeq, MclAtomic_AddFetch(&seq, 1));
+		return MCL_SUCCESS;
+	}
+
+	/* Plain task queued by the sleeper itself can only run on the one worker after the sleeper suspended */
+	void Sleeper_Run(void*) {
+		plainTask = MCL_TASK(2, PlainTask_Execute, NULL);
+		MclTaskScheduler_SubmitTask(sleeperScheduler, &plainTask, NORMAL);
+		MclFiber_Sleep(20000);
+		MclAtomic_Set(&sleeperSeq, MclAtomic_AddFetch(&seq, 1));
+		MclFuture_Set(allDone, MCL_SUCCESS, nullptr);
+	}
+
+	struct RecvContext {
+		MclMsgQueue *queue;
+		MclTimeUs timeoutUs;
+		MclStatus status;
+		uint32_t body;
+	};
+
+	void Receiver_Run(void *arg) {
+		RecvContext *ctxt = (RecvContext*)arg;
+		MclMsg msg = MCL_MSG(0, 0, sizeof(ctxt->body), &ctxt->body);
+		ctxt->status = MclFiber_AwaitRecv(ctxt->queue, &msg, ctxt->timeoutUs);
+		MclFuture_Set(allDone, MCL_SUCCESS, nullptr);
+	}
+}
+
+FIXTURE(FiberTest)
+{
+	MclTaskScheduler *scheduler {nullptr};
+
+	BEFORE {
+		gate = MclFuture_Create();
+		allDone = MclFuture_Create();
+		MclAtomic_Clear(&awaitedCount);
+		MclAtomic_Clear(&seq);
+		scheduler = MclTaskScheduler_Create(1, MAX_PRIORITY, NULL);
+		MclTaskScheduler_Start(scheduler);
+	}
+
+	AFTER {
+		MclTaskScheduler_Delete(scheduler);
+		MclFuture_Delete(allDone);
+		MclFuture_Delete(gate);
+	}
+
+	void waitAllDone() {
+		MclStatus status = MCL_FAILURE;
+		void *value = nullptr;
+		MclFuture_Get(allDone, &status, &value);
+	}
+
+	TEST("should await future in thousands of fibers on one worker") {
+		for (MclSize i = 0; i < FIBER_COUNT; i++) {
+			ASSERT_EQ(MCL_SUCCESS, MclFiber_Spawn(scheduler, i, NORMAL, AwaitGate_Run, nullptr));
+		}
+		MclTaskScheduler_WaitDone(scheduler);
+		ASSERT_EQ(0, MclAtomic_Get(&awaitedCount));
+
+		MclFuture_Set(gate, MCL_SUCCESS, (void*)42);
+		waitAllDone();
+		ASSERT_EQ(FIBER_COUNT, MclAtomic_Get(&awaitedCount));
+	}
+
+	TEST("should destroy fiber awaiting future when removed") {
+		ASSERT_EQ(MCL_SUCCESS, MclFiber_Spawn(scheduler, 1, NORMAL, AwaitGate_Run, nullptr));
+		MclTaskScheduler_WaitDone(scheduler);
+
+		ASSERT_EQ(MCL_SUCCESS, MclTaskScheduler_RemoveTask(scheduler, 1, NORMAL));
+		ASSERT_EQ(MCL_SUCCESS, MclFuture_Set(gate, MCL_SUCCESS, (void*)42));
+		MclTaskScheduler_WaitDone(scheduler);
+		ASSERT_EQ(0, MclAtomic_Get(&awaitedCount));
+	}
+
+	TEST("should destroy fiber awaiting future never set when scheduler deleted") {
+		ASSERT_EQ(MCL_SUCCESS, MclFiber_Spawn(scheduler, 1, NORMAL, AwaitGate_Run, nullptr));
+		MclTaskScheduler_WaitDone(scheduler);
+
+		MclTaskScheduler_Delete(scheduler);
+		ASSERT_EQ(MCL_SUCCESS, MclFuture_Set(gate, MCL_SUCCESS, (void*)42));
+		ASSERT_EQ(0, MclAtomic_Get(&awaitedCount));
+
+		scheduler = MclTaskScheduler_Create(1, MAX_PRIORITY, NULL);
+	}
+
+	TEST("should run other tasks while fiber sleeping") {
+		sleeperScheduler = scheduler;
+		ASSERT_EQ(MCL_SUCCESS, MclFiber_Spawn(scheduler, 1, NORMAL, Sleeper_Run, nullptr));
+
+		waitAllDone();
+		MclTaskScheduler_WaitDone(scheduler);
+		ASSERT_EQ(1, MclAtomic_Get(&plainSeq));
+		ASSERT_EQ(2, MclAtomic_Get(&sleeperSeq));
+	}
+
+	TEST("should await msg from queue") {
+		MclMsgQueue *queue = MclMsgQueue_Create(4);
+		RecvContext ctxt = {.queue = queue, .timeoutUs = MCL_TIME_US_INVALID, .status = MCL_FAILURE, .body = 0};
+
+		ASSERT_EQ(MCL_SUCCESS, MclFiber_Spawn(scheduler, 1, NORMAL, Receiver_Run, &ctxt));
+		usleep(5000);
+
+		uint32_t body = 7;
+		MclMsg msg = MCL_MSG(0, 0, sizeof(body), &body);
+		ASSERT_EQ(MCL_SUCCESS, MclMsgQueue_Send(queue, &msg));
+
+		waitAllDone();
+		ASSERT_EQ(MCL_SUCCESS, ctxt.status);
+		ASSERT_EQ(7, ctxt.body);
+		MclTaskScheduler_WaitDone(scheduler);
+		MclMsgQueue_Delete(queue);
+	}
+
+	TEST("should time out awaiting msg") {
+		MclMsgQueue *queue = MclMsgQueue_Create(4);
+		RecvContext ctxt = {.queue = queue, .timeoutUs = 5000, .status = MCL_FAILURE, .body = 0};
+
+		ASSERT_EQ(MCL_SUCCESS, MclFiber_Spawn(scheduler, 1, NORMAL, Receiver_Run, &ctxt));
+
+		waitAllDone();
+		ASSERT_EQ(MCL_TIMEDOUT, ctxt.status);
+		MclTaskScheduler_WaitDone(scheduler);
+		MclMsgQueue_Delete(queue);
+	}
+
+	TEST("should destroy fiber awaiting msg when scheduler deleted") {
+		MclMsgQueue *queue = MclMsgQueue_Create(4);
+		RecvContext ctxt = {.queue = queue, .timeoutUs = 1000000, .status = MCL_FAILURE, .body = 0};
+
+		ASSERT_EQ(MCL_SUCCESS, MclFiber_Spawn(scheduler, 1, NORMAL, Receiver_Run, &ctxt));
+		MclTaskScheduler_WaitDone(scheduler);
+
+		MclTaskScheduler_Delete(scheduler);
+		uint32_t body = 7;
+		MclMsg msg = MCL_MSG(0, 0, sizeof(body), &body);
+		ASSERT_EQ(MCL_SUCCESS, MclMsgQueue_Send(queue, &msg));
+		ASSERT_FALSE(MclFuture_IsReady(allDone));
+		ASSERT_EQ(MCL_FAILURE, ctxt.status);
+		MclMsgQueue_Delete(queue);
+
+		scheduler = MclTaskScheduler_Create(1, MAX_PRIORITY, NULL);
+	}
+
+	TEST("should block as usual out of fiber") {
+		ASSERT_FALSE(MclFiber_IsInFiber());
+
+		MclFuture_Set(gate, MCL_SUCCESS, (void*)42);
+		MclStatus status = MCL_FAILURE;
+		void *value = nullptr;
+		MclFiber_AwaitFuture(gate, &status, &value);
+		ASSERT_EQ(MCL_SUCCESS, status);
+		ASSERT_EQ(42, (long)value);
+	}
+};
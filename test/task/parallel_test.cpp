@@ -0,0 +1,103 @@
+#include <cctest/cctest.h>
+#include "mcl/task/parallel.h"
+#include "mcl/task/task_scheduler.h"
+#include "mcl/lock/atomic.h"
+
+namespace {
+	enum {
+		URGENT, NORMAL, SLOW, MAX_PRIORITY
+	};
+
+	constexpr MclSize ITEM_COUNT = 10000;
+
+	struct ForCtxt {
+		MclAtomic visited[ITEM_COUNT];
+		MclAtomic chunkCount;
+	};
+
+	void visit(MclSize begin, MclSize end, void *ctxt) {
+		ForCtxt *forCtxt = (ForCtxt*)ctxt;
+		for (MclSize i = begin; i < end; i++) {
+			MclAtomic_AddFetch(&forCtxt->visited[i], 1);
+		}
+		MclAtomic_AddFetch(&forCtxt->chunkCount, 1);
+	}
+
+	void sum(MclSize begin, MclSize end, void*, void *partial) {
+		uint64_t *value = (uint64_t*)partial;
+		for (MclSize i = begin; i < end; i++) {
+			*value += i;
+		}
+	}
+
+	void add(void *result, const void *partial, void*) {
+		*(uint64_t*)result += *(const uint64_t*)partial;
+	}
+}
+
+FIXTURE(ParallelTest)
+{
+	MclTaskScheduler *scheduler {nullptr};
+	ForCtxt ctxt;
+
+	BEFORE {
+		for (MclSize i = 0; i < ITEM_COUNT; i++) {
+			MclAtomic_Clear(&ctxt.visited[i]);
+		}
+		MclAtomic_Clear(&ctxt.chunkCount);
+		scheduler = MclTaskScheduler_Create(2, MAX_PRIORITY, NULL);
+		MclTaskScheduler_Start(scheduler);
+	}
+
+	AFTER {
+		MclTaskScheduler_Delete(scheduler);
+	}
+
+	bool isAllVisitedOnce() {
+		for (MclSize i = 0; i < ITEM_COUNT; i++) {
+			if (MclAtomic_Get(&ctxt.visited[i]) != 1) return false;
+		}
+		return true;
+	}
+
+	TEST("should visit every index once in parallel for") {
+		MclThreadPool *pool = MclTaskScheduler_GetThreadPool(scheduler);
+
+		ASSERT_EQ(MCL_SUCCESS, MclParallel_For(pool, 0, ITEM_COUNT, 64, visit, &ctxt));
+		ASSERT_TRUE(isAllVisitedOnce());
+		ASSERT_TRUE(MclAtomic_Get(&ctxt.chunkCount) > 1);
+	}
+
+	TEST("should execute small range inline as one chunk") {
+		MclThreadPool *pool = MclTaskScheduler_GetThreadPool(scheduler);
+
+		ASSERT_EQ(MCL_SUCCESS, MclParallel_For(pool, 10, 20, 64, visit, &ctxt));
+		ASSERT_EQ(1, MclAtomic_Get(&ctxt.chunkCount));
+		ASSERT_EQ(1, MclAtomic_Get(&ctxt.visited[10]));
+		ASSERT_EQ(0, MclAtomic_Get(&ctxt.visited[20]));
+	}
+
+	TEST("should pick grain automatically") {
+		MclThreadPool *pool = MclTaskScheduler_GetThreadPool(scheduler);
+
+		ASSERT_EQ(MCL_SUCCESS, MclParallel_For(pool, 0, ITEM_COUNT, 0, visit, &ctxt));
+		ASSERT_TRUE(isAllVisitedOnce());
+	}
+
+	TEST("should reduce range by parallel reduce") {
+		MclThreadPool *pool = MclTaskScheduler_GetThreadPool(scheduler);
+
+		uint64_t identity = 0;
+		uint64_t result = identity;
+		ASSERT_EQ(MCL_SUCCESS, MclParallel_Reduce(pool, 0, ITEM_COUNT, 100, sizeof(uint64_t), &identity, sum, add, NULL, &result));
+		ASSERT_EQ((uint64_t)ITEM_COUNT * (ITEM_COUNT - 1) / 2, result);
+	}
+
+	TEST("should execute all chunks by caller when pool stopped") {
+		MclTaskScheduler_Stop(scheduler);
+		MclThreadPool *pool = MclTaskScheduler_GetThreadPool(scheduler);
+
+		ASSERT_EQ(MCL_SUCCESS, MclParallel_For(pool, 0, ITEM_COUNT, 256, visit, &ctxt));
+		ASSERT_TRUE(isAllVisitedOnce());
+	}
+};
@@ -0,0 +1,139 @@
+#include <cctest/cctest.h>
+#include "mcl/task/strand.h"
+#include "mcl/task/task_scheduler.h"
+#include "mcl/task/task.h"
+#include "mcl/lock/atomic.h"
+#include <unistd.h>
+
+namespace {
+	enum {
+		URGENT, NORMAL, SLOW, MAX_PRIORITY
+	};
+
+	constexpr MclSize KEY_COUNT = 4;
+	constexpr MclSize TASK_COUNT = 64;
+
+	MclAtomic runningCount[KEY_COUNT];
+	MclAtomic overlapCount = 0;
+	MclAtomic maxKeysRunning = 0;
+	MclAtomic keysRunning = 0;
+
+	struct OrderedTask {
+		MclTask task;
+		MclSize index;
+		MclSize *lastIndex;
+		bool *isInOrder;
+	};
+
+	MclStatus OrderedTask_Execute(MclTask *task) {
+		OrderedTask *self = (OrderedTask*)task;
+
+		if (MclAtomic_AddFetch(&runningCount[task->key], 1) != 1) {
+			MclAtomic_AddFetch(&overlapCount, 1);
+		}
+		MclSize running = MclAtomic_AddFetch(&keysRunning, 1);
+		MclSize maxRunning = MclAtomic_Get(&maxKeysRunning);
+		while ((running > maxRunning) && !MclAtomic_CompareExchange(&maxKeysRunning, &maxRunning, running));
+
+		if (*self->lastIndex + 1 != self->index) *self->isInOrder = false;
+		*self->lastIndex = self->index;
+		usleep(100);
+
+		MclAtomic_SubFetch(&keysRunning, 1);
+		MclAtomic_SubFetch(&runningCount[task->key], 1);
+		return MCL_SUCCESS;
+	}
+}
+
+FIXTURE(StrandTest)
+{
+	MclTaskScheduler *scheduler {nullptr};
+	MclStrand *strand {nullptr};
+	OrderedTask tasks[KEY_COUNT][TASK_COUNT];
+	MclSize lastIndex[KEY_COUNT];
+	bool isInOrder[KEY_COUNT];
+
+	BEFORE {
+		MclAtomic_Clear(&overlapCount);
+		MclAtomic_Clear(&maxKeysRunning);
+		MclAtomic_Clear(&keysRunning);
+		for (MclSize key = 0; key < KEY_COUNT; key++) {
+			MclAtomic_Clear(&runningCount[key]);
+			lastIndex[key] = 0;
+			isInOrder[key] = true;
+			for (MclSize i = 0; i < TASK_COUNT; i++) {
+				tasks[key][i].task = MCL_TASK(key, OrderedTask_Execute, NULL);
+				tasks[key][i].index = i + 1;
+				tasks[key][i].lastIndex = &lastIndex[key];
+				tasks[key][i].isInOrder = &isInOrder[key];
+			}
+		}
+		scheduler = MclTaskScheduler_Create(4, MAX_PRIORITY, NULL);
+		strand = MclStrand_Create(scheduler, NORMAL);
+	}
+
+	AFTER {
+		MclTaskScheduler_Delete(scheduler);
+		MclStrand_Delete(strand);
+	}
+
+	TEST("should run tasks of same key one by one in order") {
+		MclTaskScheduler_Start(scheduler);
+
+		for (MclSize i = 0; i < TASK_COUNT; i++) {
+			for (MclSize key = 0; key < KEY_COUNT; key++) {
+				ASSERT_EQ(MCL_SUCCESS, MclStrand_SubmitTask(strand, &tasks[key][i].task));
+			}
+		}
+		MclTaskScheduler_WaitDone(scheduler);
+
+		ASSERT_EQ(0, MclAtomic_Get(&overlapCount));
+		ASSERT_EQ(0, MclStrand_GetBusyKeyCount(strand));
+		for (MclSize key = 0; key < KEY_COUNT; key++) {
+			ASSERT_TRUE(isInOrder[key]);
+			ASSERT_EQ(TASK_COUNT, lastIndex[key]);
+		}
+	}
+
+	TEST("should run tasks of different keys in parallel") {
+		for (MclSize i = 0; i < TASK_COUNT; i++) {
+			for (MclSize key = 0; key < KEY_COUNT; key++) {
+				MclStrand_SubmitTask(strand, &tasks[key][i].task);
+			}
+		}
+		ASSERT_EQ(KEY_COUNT, MclStrand_GetBusyKeyCount(strand));
+		ASSERT_EQ(TASK_COUNT, MclStrand_GetPendingCount(strand, 0));
+
+		MclTaskScheduler_Start(scheduler);
+		MclTaskScheduler_WaitDone(scheduler);
+
+		ASSERT_EQ(0, MclAtomic_Get(&overlapCount));
+		ASSERT_TRUE(MclAtomic_Get(&maxKeysRunning) > 1);
+	}
+
+	TEST("should drop queued tasks of key removed from scheduler") {
+		for (MclSize i = 0; i < TASK_COUNT; i++) {
+			MclStrand_SubmitTask(strand, &tasks[0][i].task);
+			MclStrand_SubmitTask(strand, &tasks[1][i].task);
+		}
+		MclTaskScheduler_RemoveTask(scheduler, 0, NORMAL);
+		ASSERT_EQ(1, MclStrand_GetBusyKeyCount(strand));
+		ASSERT_EQ(0, MclStrand_GetPendingCount(strand, 0));
+
+		MclTaskScheduler_Start(scheduler);
+		MclTaskScheduler_WaitDone(scheduler);
+
+		ASSERT_EQ(0, lastIndex[0]);
+		ASSERT_EQ(TASK_COUNT, lastIndex[1]);
+	}
+
+	TEST("should keep task with caller when lane submit failed") {
+		MclStrand *badStrand = MclStrand_Create(scheduler, MAX_PRIORITY);
+
+		ASSERT_EQ(MCL_FAILURE, MclStrand_SubmitTask(badStrand, &tasks[0][0].task));
+		ASSERT_EQ(0, MclStrand_GetBusyKeyCount(badStrand));
+		ASSERT_EQ(0, MclStrand_GetPendingCount(badStrand, 0));
+
+		MclStrand_Delete(badStrand);
+	}
+};
@@ -0,0 +1,56 @@
+#include <cctest/cctest.h>
+#include "mcl/task/task_deque.h"
+#include "mcl/task/task.h"
+
+FIXTURE(TaskDequeTest) {
+    constexpr static MclSize DEQUE_CAPACITY = 4;
+
+    MclTaskDeque *deque {nullptr};
+    MclTask tasks[DEQUE_CAPACITY + 1];
+
+    BEFORE {
+        deque = MclTaskDeque_Create(DEQUE_CAPACITY);
+        for (MclSize i = 0; i <= DEQUE_CAPACITY; i++) {
+            tasks[i] = MCL_TASK(i, NULL, NULL);
+        }
+    };
+
+    AFTER {
+        MclTaskDeque_Delete(deque);
+    };
+
+    TEST("should create an empty deque") {
+        ASSERT_TRUE(deque != NULL);
+        ASSERT_TRUE(MclTaskDeque_IsEmpty(deque));
+        ASSERT_TRUE(MclTaskDeque_Pop(deque) == NULL);
+        ASSERT_TRUE(MclTaskDeque_Steal(deque) == NULL);
+    }
+
+    TEST("should not create deque with capacity not power of 2") {
+        ASSERT_TRUE(MclTaskDeque_Create(3) == NULL);
+    }
+
+    TEST("should pop in lifo and steal in fifo") {
+        for (MclSize i = 0; i < 3; i++) {
+            ASSERT_EQ(MCL_SUCCESS, MclTaskDeque_Push(deque, &tasks[i]));
+        }
+        ASSERT_EQ(3, MclTaskDeque_GetCount(deque));
+
+        ASSERT_TRUE(MclTaskDeque_Pop(deque) == &tasks[2]);
+        ASSERT_TRUE(MclTaskDeque_Steal(deque) == &tasks[0]);
+        ASSERT_TRUE(MclTaskDeque_Pop(deque) == &tasks[1]);
+        ASSERT_TRUE(MclTaskDeque_IsEmpty(deque));
+        ASSERT_TRUE(MclTaskDeque_Pop(deque) == NULL);
+    }
+
+    TEST("should not push to full deque") {
+        for (MclSize i = 0; i < DEQUE_CAPACITY; i++) {
+            ASSERT_EQ(MCL_SUCCESS, MclTaskDeque_Push(deque, &tasks[i]));
+        }
+        ASSERT_TRUE(MCL_FAILED(MclTaskDeque_Push(deque, &tasks[DEQUE_CAPACITY])));
+
+        ASSERT_TRUE(MclTaskDeque_Steal(deque) == &tasks[0]);
+        ASSERT_EQ(MCL_SUCCESS, MclTaskDeque_Push(deque, &tasks[DEQUE_CAPACITY]));
+        ASSERT_TRUE(MclTaskDeque_Pop(deque) == &tasks[DEQUE_CAPACITY]);
+    }
+};
@@ -0,0 +1,78 @@
+#include <cctest/cctest.h>
+#include "mcl/task/task_deque.h"
+#include "mcl/task/task.h"
+#include "mcl/lock/atomic.h"
+#include "mcl/thread/thread.h"
+
+namespace {
+    constexpr MclSize TASK_COUNT = 100000;
+    constexpr MclSize THIEF_COUNT = 2;
+
+    MclTaskDeque *deque = nullptr;
+    MclTask tasks[TASK_COUNT];
+    MclAtomic TAKEN_FLAGS[TASK_COUNT];
+    MclAtomic TAKEN_COUNT = 0;
+
+    void take(MclTask *task) {
+        MclAtomic_AddFetch(&TAKEN_FLAGS[task->key], 1);
+        MclAtomic_AddFetch(&TAKEN_COUNT, 1);
+    }
+
+    void* steal(void *) {
+        while (MclAtomic_Get(&TAKEN_COUNT) < TASK_COUNT) {
+            MclTask *task = MclTaskDeque_Steal(deque);
+            if (task) {
+                take(task);
+            } else {
+                MclThread_Yield();
+            }
+        }
+        return NULL;
+    }
+}
+
+FIXTURE(TaskDequeThreadTest) {
+    BEFORE {
+        deque = MclTaskDeque_Create(64);
+        MclAtomic_Clear(&TAKEN_COUNT);
+        for (MclSize i = 0; i < TASK_COUNT; i++) {
+            tasks[i] = MCL_TASK(i, NULL, NULL);
+            MclAtomic_Clear(&TAKEN_FLAGS[i]);
+        }
+    }
+
+    AFTER {
+        MclTaskDeque_Delete(deque);
+    }
+
+    TEST("should take every task exactly once when owner pops and thieves steal") {
+        MclThread thieves[THIEF_COUNT];
+        for (auto &thief : thieves) {
+            MclThread_Create(&thief, NULL, steal, NULL);
+        }
+
+        for (MclSize i = 0; i < TASK_COUNT; i++) {
+            while (MCL_FAILED(MclTaskDeque_Push(deque, &tasks[i]))) {
+                MclTask *task = MclTaskDeque_Pop(deque);
+                if (task) take(task);
+            }
+            if (i % 3 == 0) {
+                MclTask *task = MclTaskDeque_Pop(deque);
+                if (task) take(task);
+            }
+        }
+        MclTask *task = NULL;
+        while ((task = MclTaskDeque_Pop(deque))) {
+            take(task);
+        }
+
+        for (auto &thief : thieves) {
+            MclThread_Join(thief, NULL);
+        }
+
+        ASSERT_EQ(TASK_COUNT, MclAtomic_Get(&TAKEN_COUNT));
+        for (MclSize i = 0; i < TASK_COUNT; i++) {
+            ASSERT_EQ(1, MclAtomic_Get(&TAKEN_FLAGS[i]));
+        }
+    }
+};
@@ -0,0 +1,139 @@
+#include <cctest/cctest.h>
+#include "mcl/task/task_future.h"
+#include "mcl/task/task_scheduler.h"
+
+namespace {
+	enum {
+		URGENT, NORMAL, SLOW, MAX_PRIORITY
+	};
+
+	MclStatus square(void *arg, void **value) {
+		long v = (long)arg;
+		*value = (void*)(v * v);
+		return MCL_SUCCESS;
+	}
+
+	MclStatus fail(void*, void**) {
+		return MCL_TIMEDOUT;
+	}
+
+	MclStatus addOne(MclStatus prevStatus, void *prevValue, void*, void **value) {
+		if (MCL_FAILED(prevStatus)) return prevStatus;
+		*value = (void*)((long)prevValue + 1);
+		return MCL_SUCCESS;
+	}
+}
+
+FIXTURE(TaskFutureTest)
+{
+	MclTaskScheduler *scheduler {nullptr};
+
+	BEFORE {
+		scheduler = MclTaskScheduler_Create(2, MAX_PRIORITY, NULL);
+		MclTaskScheduler_Start(scheduler);
+	}
+
+	AFTER {
+		MclTaskScheduler_Delete(scheduler);
+	}
+
+	TEST("should complete future with result of async task") {
+		MclFuture *future = MclTaskScheduler_SubmitAsync(scheduler, 1, NORMAL, square, (void*)7);
+
+		MclStatus status {MCL_FAILURE};
+		void *value {nullptr};
+		MclFuture_Get(future, &status, &value);
+
+		ASSERT_EQ(MCL_SUCCESS, status);
+		ASSERT_EQ(49, (long)value);
+		MclFuture_Delete(future);
+	}
+
+	TEST("should run continuation in scheduler after prev ready") {
+		MclFuture *first = MclTaskScheduler_SubmitAsync(scheduler, 1, NORMAL, square, (void*)3);
+		MclFuture *second = MclTaskScheduler_Then(scheduler, first, 2, URGENT, addOne, NULL);
+		MclFuture *third = MclTaskScheduler_Then(scheduler, second, 3, SLOW, addOne, NULL);
+
+		MclStatus status {MCL_FAILURE};
+		void *value {nullptr};
+		MclFuture_Get(third, &status, &value);
+
+		ASSERT_EQ(MCL_SUCCESS, status);
+		ASSERT_EQ(11, (long)value);
+
+		MclFuture_Delete(third);
+		MclFuture_Delete(second);
+		MclFuture_Delete(first);
+	}
+
+	TEST("should fan in futures by when all") {
+		constexpr MclSize COUNT = 8;
+		MclFuture *futures[COUNT];
+		for (MclSize i = 0; i < COUNT; i++) {
+			futures[i] = MclTaskScheduler_SubmitAsync(scheduler, i, NORMAL, square, (void*)(long)i);
+		}
+		MclFuture *all = MclFuture_WhenAll(futures, COUNT);
+
+		MclStatus status {MCL_FAILURE};
+		void *value {nullptr};
+		MclFuture_Get(all, &status, &value);
+		ASSERT_EQ(MCL_SUCCESS, status);
+
+		for (MclSize i = 0; i < COUNT; i++) {
+			ASSERT_TRUE(MclFuture_IsReady(futures[i]));
+			MclFuture_Get(futures[i], &status, &value);
+			ASSERT_EQ(i * i, (long)value);
+			MclFuture_Delete(futures[i]);
+		}
+		MclFuture_Delete(all);
+	}
+
+	TEST("should pass failure to continuation") {
+		MclFuture *first = MclTaskScheduler_SubmitAsync(scheduler, 1, NORMAL, fail, NULL);
+		MclFuture *second = MclTaskScheduler_Then(scheduler, first, 2, NORMAL, addOne, NULL);
+
+		MclStatus status {MCL_SUCCESS};
+		void *value {nullptr};
+		MclFuture_Get(second, &status, &value);
+		ASSERT_EQ(MCL_TIMEDOUT, status);
+
+		MclFuture_Delete(second);
+		MclFuture_Delete(first);
+	}
+
+	TEST("should stop continuation when removed before prev ready") {
+		MclFuture *prev = MclFuture_Create();
+		MclFuture *next = MclTaskScheduler_Then(scheduler, prev, 2, NORMAL, addOne, NULL);
+
+		ASSERT_EQ(MCL_SUCCESS, MclTaskScheduler_RemoveTask(scheduler, 2, NORMAL));
+		ASSERT_TRUE(MclFuture_IsReady(next));
+
+		MclStatus status {MCL_SUCCESS};
+		void *value {nullptr};
+		MclFuture_Get(next, &status, &value);
+		ASSERT_EQ(MCL_STATUS_DONE, status);
+
+		(void)MclFuture_Set(prev, MCL_SUCCESS, (void*)1);
+		MclFuture_Delete(next);
+		MclFuture_Delete(prev);
+	}
+
+	TEST("should stop continuation when scheduler deleted before prev ready") {
+		MclTaskScheduler *other = MclTaskScheduler_Create(1, MAX_PRIORITY, NULL);
+		MclTaskScheduler_Start(other);
+
+		MclFuture *prev = MclFuture_Create();
+		MclFuture *next = MclTaskScheduler_Then(other, prev, 2, NORMAL, addOne, NULL);
+		MclTaskScheduler_Delete(other);
+		ASSERT_TRUE(MclFuture_IsReady(next));
+
+		MclStatus status {MCL_SUCCESS};
+		void *value {nullptr};
+		MclFuture_Get(next, &status, &value);
+		ASSERT_EQ(MCL_STATUS_DONE, status);
+
+		(void)MclFuture_Set(prev, MCL_SUCCESS, (void*)1);
+		MclFuture_Delete(next);
+		MclFuture_Delete(prev);
+	}
+};
@@ -0,0 +1,121 @@
+#include <cctest/cctest.h>
+#include "mcl/task/task_group.h"
+#include "mcl/task/task_scheduler.h"
+#include "mcl/task/task.h"
+#include "mcl/lock/atomic.h"
+#include "mcl/thread/thread.h"
+#include <unistd.h>
+
+namespace {
+	enum {
+		URGENT, NORMAL, SLOW, MAX_PRIORITY
+	};
+
+	MclAtomic finishedSleepCount = 0;
+	MclAtomic gateOpened = 0;
+	MclAtomic gateEnteredCount = 0;
+
+	MclStatus SleepTask_Execute(MclTask*) {
+		usleep(10000);
+		MclAtomic_AddFetch(&finishedSleepCount, 1);
+		return MCL_SUCCESS;
+	}
+
+	MclStatus GateTask_Execute(MclTask*) {
+		MclAtomic_AddFetch(&gateEnteredCount, 1);
+		while (!MclAtomic_IsTrue(&gateOpened)) {
+			usleep(1000);
+		}
+		return MCL_SUCCESS;
+	}
+}
+
+FIXTURE(TaskGroupTest)
+{
+	static constexpr MclSize TASK_COUNT{8};
+
+	MclTaskScheduler *scheduler {nullptr};
+	MclTask tasks[TASK_COUNT];
+
+	BEFORE {
+		MclAtomic_Clear(&finishedSleepCount);
+		MclAtomic_Clear(&gateOpened);
+		MclAtomic_Clear(&gateEnteredCount);
+		scheduler = MclTaskScheduler_Create(2, MAX_PRIORITY, NULL);
+		MclTaskScheduler_Start(scheduler);
+	}
+
+	AFTER {
+		MclTaskScheduler_Delete(scheduler);
+	}
+
+	TEST("should wait until all tasks in group finished") {
+		MclTaskGroup *group = MclTaskGroup_Create(scheduler);
+
+		for (MclSize i = 0; i < TASK_COUNT; i++) {
+			tasks[i] = MCL_TASK(i + 1, SleepTask_Execute, NULL);
+			ASSERT_EQ(MCL_SUCCESS, MclTaskGroup_SubmitTask(group, &tasks[i], NORMAL));
+		}
+
+		ASSERT_EQ(MCL_SUCCESS, MclTaskGroup_Wait(group, MCL_TIME_US_INVALID));
+		ASSERT_EQ(TASK_COUNT, MclAtomic_Get(&finishedSleepCount));
+		ASSERT_EQ(TASK_COUNT, MclTaskGroup_GetSubmittedCount(group));
+		ASSERT_EQ(TASK_COUNT, MclTaskGroup_GetFinishedCount(group));
+		ASSERT_EQ(0, MclTaskGroup_GetRunningCount(group));
+
+		MclTaskGroup_Delete(group);
+	}
+
+	TEST("should timeout when task in group still running") {
+		MclTaskGroup *group = MclTaskGroup_Create(scheduler);
+
+		tasks[0] = MCL_TASK(1, GateTask_Execute, NULL);
+		ASSERT_EQ(MCL_SUCCESS, MclTaskGroup_SubmitTask(group, &tasks[0], URGENT));
+
+		ASSERT_EQ(MCL_TIMEDOUT, MclTaskGroup_Wait(group, 20000));
+		ASSERT_EQ(0, MclTaskGroup_GetFinishedCount(group));
+
+		MclAtomic_Set(&gateOpened, 1);
+		ASSERT_EQ(MCL_SUCCESS, MclTaskGroup_Wait(group, MCL_TIME_US_INVALID));
+		ASSERT_EQ(1, MclTaskGroup_GetFinishedCount(group));
+
+		MclTaskGroup_Delete(group);
+	}
+
+	TEST("should finish task removed before executed") {
+		MclTaskGroup *group = MclTaskGroup_Create(scheduler);
+
+		tasks[0] = MCL_TASK(1, GateTask_Execute, NULL);
+		tasks[1] = MCL_TASK(2, GateTask_Execute, NULL);
+		tasks[2] = MCL_TASK(3, SleepTask_Execute, NULL);
+		ASSERT_EQ(MCL_SUCCESS, MclTaskGroup_SubmitTask(group, &tasks[0], URGENT));
+		ASSERT_EQ(MCL_SUCCESS, MclTaskGroup_SubmitTask(group, &tasks[1], URGENT));
+
+		// both workers are held by gates, so task 3 stays queued until removed
+		while (MclAtomic_Get(&gateEnteredCount) < 2) {
+			MclThread_Yield();
+		}
+		ASSERT_EQ(MCL_SUCCESS, MclTaskGroup_SubmitTask(group, &tasks[2], SLOW));
+		ASSERT_TRUE(MclTaskScheduler_IsPending(scheduler, 3, SLOW));
+
+		ASSERT_EQ(MCL_SUCCESS, MclTaskScheduler_RemoveTask(scheduler, 3, SLOW));
+		ASSERT_FALSE(MclTaskScheduler_IsPending(scheduler, 3, SLOW));
+		MclAtomic_Set(&gateOpened, 1);
+
+		ASSERT_EQ(MCL_SUCCESS, MclTaskGroup_Wait(group, MCL_TIME_US_INVALID));
+		ASSERT_EQ(3, MclTaskGroup_GetFinishedCount(group));
+		ASSERT_EQ(0, MclAtomic_Get(&finishedSleepCount));
+
+		MclTaskGroup_Delete(group);
+	}
+
+	TEST("should wait done until running tasks finished") {
+		for (MclSize i = 0; i < TASK_COUNT; i++) {
+			tasks[i] = MCL_TASK(i + 1, SleepTask_Execute, NULL);
+			MclTaskScheduler_SubmitTask(scheduler, &tasks[i], NORMAL);
+		}
+
+		MclTaskScheduler_WaitDone(scheduler);
+		ASSERT_EQ(TASK_COUNT, MclAtomic_Get(&finishedSleepCount));
+	}
+};
@@ -0,0 +1,213 @@
+#include <cctest/cctest.h>
+#include "mcl/task/task_queue.h"
+#include "mcl/task/task.h"
+
+namespace {
+	enum {
+		URGENT, NORMAL, SLOW, MAX_PRIORITY
+	};
+
+	constexpr MclSize TASK_COUNT = 8;
+
+	MclStatus NoopTask_Execute(MclTask*) {
+		return MCL_SUCCESS;
+	}
+}
+
+FIXTURE(TaskPolicyTest)
+{
+	MclTask tasks[MAX_PRIORITY][TASK_COUNT];
+	MclTaskQueue *queue {nullptr};
+
+	TaskPolicyTest() {
+		for (MclSize priority = 0; priority < MAX_PRIORITY; priority++) {
+			for (MclSize key = 0; key < TASK_COUNT; key++) {
+				tasks[priority][key] = MCL_TASK(key, NoopTask_Execute, NULL);
+			}
+		}
+	}
+
+	AFTER {
+		MclTaskQueue_Delete(queue);
+	}
+
+	MclTask* taskOf(MclTaskPriority priority, MclTaskKey key) {
+		return &tasks[priority][key];
+	}
+
+	TEST("should pop by earliest deadline over priorities") {
+		MclTaskPolicy policy = MCL_TASK_POLICY_EDF(NULL);
+		queue = MclTaskQueue_CreateWithPolicy(MAX_PRIORITY, &policy);
+		ASSERT_EQ(MCL_TASK_POLICY_EDF, MclTaskQueue_GetPolicy(queue));
+
+		MclTaskQueue_AddTaskWithDeadline(queue, taskOf(NORMAL, 1), NORMAL, 3000000);
+		MclTaskQueue_AddTaskWithDeadline(queue, taskOf(URGENT, 2), URGENT, 5000000);
+		MclTaskQueue_AddTaskWithDeadline(queue, taskOf(SLOW, 3), SLOW, 1000000);
+		MclTaskQueue_AddTask(queue, taskOf(URGENT, 4), URGENT);
+
+		ASSERT_EQ(taskOf(SLOW, 3), MclTaskQueue_TryPopTask(queue));
+		ASSERT_EQ(taskOf(NORMAL, 1), MclTaskQueue_TryPopTask(queue));
+		ASSERT_EQ(taskOf(URGENT, 2), MclTaskQueue_TryPopTask(queue));
+		ASSERT_EQ(taskOf(URGENT, 4), MclTaskQueue_TryPopTask(queue));
+		ASSERT_TRUE(MclTaskQueue_TryPopTask(queue) == NULL);
+	}
+
+	TEST("should give deadline of priority budget to task without deadline") {
+		MclTimeUs budgetsUs[MAX_PRIORITY] = {1000, 1000000, MCL_TIME_US_INVALID};
+		MclTaskPolicy policy = MCL_TASK_POLICY_EDF(budgetsUs);
+		queue = MclTaskQueue_CreateWithPolicy(MAX_PRIORITY, &policy);
+
+		MclTaskQueue_AddTask(queue, taskOf(SLOW, 1), SLOW);
+		MclTaskQueue_AddTask(queue, taskOf(NORMAL, 1), NORMAL);
+		MclTaskQueue_AddTask(queue, taskOf(URGENT, 1), URGENT);
+		MclTaskQueue_AddTaskWithDeadline(queue, taskOf(SLOW, 2), SLOW, 0);
+
+		ASSERT_EQ(taskOf(SLOW, 2), MclTaskQueue_TryPopTask(queue));
+		ASSERT_EQ(taskOf(URGENT, 1), MclTaskQueue_TryPopTask(queue));
+		ASSERT_EQ(taskOf(NORMAL, 1), MclTaskQueue_TryPopTask(queue));
+		ASSERT_EQ(taskOf(SLOW, 1), MclTaskQueue_TryPopTask(queue));
+	}
+
+	TEST("should keep key index when deadline reorders tasks of the key") {
+		MclTaskPolicy policy = MCL_TASK_POLICY_EDF(NULL);
+		queue = MclTaskQueue_CreateWithPolicy(MAX_PRIORITY, &policy);
+
+		tasks[NORMAL][2].key = 1;
+		MclTaskQueue_AddTaskWithDeadline(queue, taskOf(NORMAL, 1), NORMAL, 9000000);
+		MclTaskQueue_AddTaskWithDeadline(queue, taskOf(NORMAL, 2), NORMAL, 1000000);
+		MclTaskQueue_AddTaskWithDeadline(queue, taskOf(NORMAL, 3), NORMAL, 5000000);
+
+		ASSERT_EQ(taskOf(NORMAL, 2), MclTaskQueue_TryPopTask(queue));
+		ASSERT_TRUE(MclTaskQueue_HasTask(queue, 1, NORMAL));
+
+		MclTaskQueue_DelTask(queue, 1, NORMAL);
+		ASSERT_FALSE(MclTaskQueue_HasTask(queue, 1, NORMAL));
+		ASSERT_EQ(1, MclTaskQueue_GetCount(queue));
+		ASSERT_EQ(taskOf(NORMAL, 3), MclTaskQueue_TryPopTask(queue));
+	}
+
+	TEST("should remove and pop by key among many keys and unkeyed tasks") {
+		constexpr MclSize KEY_COUNT = 1000;
+		MclTaskPolicy policy = MCL_TASK_POLICY_EDF(NULL);
+		queue = MclTaskQueue_CreateWithPolicy(MAX_PRIORITY, &policy);
+
+		static MclTask keyed[KEY_COUNT];
+		static MclTask unkeyed[KEY_COUNT];
+		for (MclSize i = 0; i < KEY_COUNT; i++) {
+			keyed[i] = MCL_TASK(i, NoopTask_Execute, NULL);
+			unkeyed[i] = MCL_TASK(MCL_TASK_KEY_INVALID, NoopTask_Execute, NULL);
+			MclTaskQueue_AddTaskWithDeadline(queue, &keyed[i], NORMAL, (KEY_COUNT - i) * 1000000);
+			MclTaskQueue_AddTaskWithDeadline(queue, &unkeyed[i], NORMAL, (KEY_COUNT + i) * 1000000);
+		}
+		ASSERT_FALSE(MclTaskQueue_HasTask(queue, MCL_TASK_KEY_INVALID, NORMAL));
+
+		for (MclSize i = 0; i < KEY_COUNT; i += 2) {
+			ASSERT_EQ(MCL_SUCCESS, MclTaskQueue_DelTask(queue, i, NORMAL));
+		}
+		ASSERT_EQ(KEY_COUNT * 3 / 2, MclTaskQueue_GetCount(queue));
+
+		for (MclSize i = KEY_COUNT - 1; i < KEY_COUNT; i -= 2) {
+			ASSERT_TRUE(MclTaskQueue_HasTask(queue, i, NORMAL));
+			ASSERT_EQ(&keyed[i], MclTaskQueue_TryPopTask(queue));
+			ASSERT_FALSE(MclTaskQueue_HasTask(queue, i, NORMAL));
+		}
+		for (MclSize i = 0; i < KEY_COUNT; i++) {
+			ASSERT_EQ(&unkeyed[i], MclTaskQueue_TryPopTask(queue));
+		}
+		ASSERT_TRUE(MclTaskQueue_IsEmpty(queue));
+	}
+
+	TEST("should pop by deadline after removing keys from middle of queue") {
+		constexpr MclSize KEY_COUNT = 1000;
+		MclTaskPolicy policy = MCL_TASK_POLICY_EDF(NULL);
+		queue = MclTaskQueue_CreateWithPolicy(MAX_PRIORITY, &policy);
+
+		static MclTask keyed[KEY_COUNT];
+		for (MclSize i = 0; i < KEY_COUNT; i++) {
+			keyed[i] = MCL_TASK(i, NoopTask_Execute, NULL);
+			MclTimeUs deadlineUs = ((i * 7919) % KEY_COUNT + 1) * 1000000;
+			MclTaskQueue_AddTaskWithDeadline(queue, &keyed[i], SLOW, deadlineUs);
+		}
+		for (MclSize i = 0; i < KEY_COUNT; i += 3) {
+			ASSERT_EQ(MCL_SUCCESS, MclTaskQueue_DelTask(queue, i, SLOW));
+		}
+
+		MclTimeUs lastUs = 0;
+		MclSize poppedCount = 0;
+		MclTask *task = NULL;
+		while ((task = MclTaskQueue_TryPopTask(queue))) {
+			ASSERT_TRUE(task->key % 3 != 0);
+			ASSERT_TRUE(task->deadlineUs >= lastUs);
+			lastUs = task->deadlineUs;
+			poppedCount++;
+		}
+		ASSERT_EQ(KEY_COUNT - (KEY_COUNT + 2) / 3, poppedCount);
+	}
+
+	TEST("should share pops by weights of priorities") {
+		MclSize weights[MAX_PRIORITY] = {3, 1, 1};
+		MclTaskPolicy policy = MCL_TASK_POLICY_WFQ(weights, NULL);
+		queue = MclTaskQueue_CreateWithPolicy(MAX_PRIORITY, &policy);
+
+		for (MclSize key = 0; key < TASK_COUNT; key++) {
+			MclTaskQueue_AddTask(queue, taskOf(URGENT, key), URGENT);
+			MclTaskQueue_AddTask(queue, taskOf(NORMAL, key), NORMAL);
+		}
+
+		MclSize popped[MAX_PRIORITY] = {0};
+		MclTaskPriority priorities[TASK_COUNT];
+		MclTask *popTasks[TASK_COUNT];
+		ASSERT_EQ(TASK_COUNT, MclTaskQueue_TryPopTasks(queue, popTasks, priorities, TASK_COUNT));
+		for (MclSize i = 0; i < TASK_COUNT; i++) {
+			popped[priorities[i]]++;
+		}
+		ASSERT_EQ(6, popped[URGENT]);
+		ASSERT_EQ(2, popped[NORMAL]);
+	}
+
+	TEST("should pop batch of one priority until keyed task") {
+		queue = MclTaskQueue_Create(MAX_PRIORITY, NULL);
+
+		MclTask unkeyed[4];
+		for (auto &task : unkeyed) {
+			task = MCL_TASK(MCL_TASK_KEY_INVALID, NoopTask_Execute, NULL);
+		}
+		MclTaskQueue_AddTask(queue, &unkeyed[0], NORMAL);
+		MclTaskQueue_AddTask(queue, &unkeyed[1], NORMAL);
+		MclTaskQueue_AddTask(queue, taskOf(NORMAL, 1), NORMAL);
+		MclTaskQueue_AddTask(queue, &unkeyed[2], NORMAL);
+		MclTaskQueue_AddTask(queue, &unkeyed[3], SLOW);
+
+		MclTaskPriority priorities[TASK_COUNT];
+		MclTask *popTasks[TASK_COUNT];
+		ASSERT_EQ(2, MclTaskQueue_TryPopBatch(queue, popTasks, priorities, TASK_COUNT));
+		ASSERT_EQ(&unkeyed[0], popTasks[0]);
+		ASSERT_EQ(&unkeyed[1], popTasks[1]);
+		ASSERT_EQ(NORMAL, priorities[1]);
+		ASSERT_TRUE(MclTaskQueue_HasTask(queue, 1, NORMAL));
+
+		ASSERT_EQ(2, MclTaskQueue_TryPopBatch(queue, popTasks, priorities, TASK_COUNT));
+		ASSERT_EQ(taskOf(NORMAL, 1), popTasks[0]);
+		ASSERT_EQ(&unkeyed[2], popTasks[1]);
+
+		ASSERT_EQ(1, MclTaskQueue_TryPopBatch(queue, popTasks, priorities, TASK_COUNT));
+		ASSERT_EQ(&unkeyed[3], popTasks[0]);
+		ASSERT_EQ(SLOW, priorities[0]);
+	}
+
+	TEST("should serve aged task before weights") {
+		MclSize weights[MAX_PRIORITY] = {100, 1, 1};
+		MclTimeUs budgetsUs[MAX_PRIORITY] = {MCL_TIME_US_INVALID, 0, MCL_TIME_US_INVALID};
+		MclTaskPolicy policy = MCL_TASK_POLICY_WFQ(weights, budgetsUs);
+		queue = MclTaskQueue_CreateWithPolicy(MAX_PRIORITY, &policy);
+
+		for (MclSize key = 0; key < TASK_COUNT; key++) {
+			MclTaskQueue_AddTask(queue, taskOf(URGENT, key), URGENT);
+		}
+		MclTaskQueue_AddTask(queue, taskOf(NORMAL, 1), NORMAL);
+		MclTaskQueue_AddTask(queue, taskOf(SLOW, 1), SLOW);
+
+		ASSERT_EQ(taskOf(NORMAL, 1), MclTaskQueue_TryPopTask(queue));
+		ASSERT_EQ(taskOf(URGENT, 0), MclTaskQueue_TryPopTask(queue));
+	}
+};
@@ -1,6 +1,108 @@
 #include <cctest/cctest.h>
 #include "mcl/task/task_scheduler.h"
+#include "mcl/task/thread_pool.h"
+#include "mcl/task/task_stats.h"
 #include "task/task_utils/demo_task.h"
+#include "mcl/lock/atomic.h"
+#include "mcl/lock/future.h"
+#include "mcl/thread/thread.h"
+#include <sched.h>
+
+namespace {
+	constexpr MclSize CHILD_TASK_COUNT = 64;
+
+	MclTaskScheduler *spawnScheduler = nullptr;
+	MclTask childTasks[CHILD_TASK_COUNT];
+	MclAtomic executedChildCount = 0;
+
+	MclStatus ChildTask_Execute(MclTask*) {
+		MclAtomic_AddFetch(&executedChildCount, 1);
+		return MCL_SUCCESS;
+	}
+
+	MclAtomic destroyedWaiterCount = 0;
+
+	void WaiterTask_Destroy(MclTask*) {
+		MclAtomic_AddFetch(&destroyedWaiterCount, 1);
+	}
+
+	MclStatus SleepTask_Execute(MclTask*) {
+		usleep(5000);
+		return MCL_SUCCESS;
+	}
+
+	MclAtomic executedTimerCount = 0;
+	MclAtomic pinnedTaskCount = 0;
+
+	MclSize pinnedCpu = 0;
+
+	MclStatus PinnedTask_Execute(MclTask*) {
+		cpu_set_t cpus;
+		CPU_ZERO(&cpus);
+		pthread_getaffinity_np(pthread_self(), sizeof(cpus), &cpus);
+		if ((CPU_COUNT(&cpus) == 1) && CPU_ISSET(pinnedCpu, &cpus)) {
+			MclAtomic_AddFetch(&pinnedTaskCount, 1);
+		}
+		return MCL_SUCCESS;
+	}
+
+	MclStatus TimerTask_Execute(MclTask*) {
+		MclAtomic_AddFetch(&executedTimerCount, 1);
+		return MCL_SUCCESS;
+	}
+
+	MclStatus ParentTask_Execute(MclTask*) {
+		for (MclSize i = 0; i < CHILD_TASK_COUNT; i++) {
+			childTasks[i] = MCL_TASK(MCL_TASK_KEY_INVALID, ChildTask_Execute, NULL);
+			MclTaskScheduler_SubmitTask(spawnScheduler, &childTasks[i], NORMAL);
+		}
+		return MCL_SUCCESS;
+	}
+
+	MclStatus BatchParentTask_Execute(MclTask*) {
+		MclTask *tasks[CHILD_TASK_COUNT];
+		for (MclSize i = 0; i < CHILD_TASK_COUNT; i++) {
+			childTasks[i] = MCL_TASK(MCL_TASK_KEY_INVALID, ChildTask_Execute, NULL);
+			tasks[i] = &childTasks[i];
+		}
+		MclSize submitted = MclTaskScheduler_SubmitTasks(spawnScheduler, tasks, CHILD_TASK_COUNT, NORMAL);
+		return (submitted == CHILD_TASK_COUNT) ? MCL_SUCCESS : MCL_FAILURE;
+	}
+
+	constexpr MclTaskKey KEYED_CHILD_KEY = 7;
+	MclTask keyedChildTask;
+	bool isKeyedChildPending = false;
+	bool isKeyedChildRemoved = false;
+
+	MclStatus KeyedParentTask_Execute(MclTask*) {
+		keyedChildTask = MCL_TASK(KEYED_CHILD_KEY, ChildTask_Execute, NULL);
+		MclTaskScheduler_SubmitTask(spawnScheduler, &keyedChildTask, NORMAL);
+		isKeyedChildPending = MclTaskScheduler_IsPending(spawnScheduler, KEYED_CHILD_KEY, NORMAL);
+		MclTaskScheduler_RemoveTask(spawnScheduler, KEYED_CHILD_KEY, NORMAL);
+		isKeyedChildRemoved = !MclTaskScheduler_IsPending(spawnScheduler, KEYED_CHILD_KEY, NORMAL);
+		return MCL_SUCCESS;
+	}
+
+	MclTask localSlowTask;
+	MclTask queuedUrgentTask;
+	MclAtomic executedOrder = 0;
+	MclAtomic localSlowOrder = 0;
+	MclAtomic queuedUrgentOrder = 0;
+
+	MclStatus OrderedTask_Execute(MclTask *task) {
+		MclAtomic order = MclAtomic_AddFetch(&executedOrder, 1);
+		MclAtomic_Set((task == &localSlowTask) ? &localSlowOrder : &queuedUrgentOrder, order);
+		return MCL_SUCCESS;
+	}
+
+	MclStatus MixedParentTask_Execute(MclTask*) {
+		localSlowTask = MCL_TASK(MCL_TASK_KEY_INVALID, OrderedTask_Execute, NULL);
+		queuedUrgentTask = MCL_TASK(1, OrderedTask_Execute, NULL);
+		MclTaskScheduler_SubmitTask(spawnScheduler, &localSlowTask, SLOW);
+		MclTaskScheduler_SubmitTask(spawnScheduler, &queuedUrgentTask, URGENT);
+		return MCL_SUCCESS;
+	}
+}
 
 FIXTURE(TaskSchedulerTest)
 {
@@ -90,6 +192,26 @@ FIXTURE(TaskSchedulerTest)
 		MclTaskScheduler_Delete(scheduler);
 	}
 
+	TEST("should execute tasks by earliest deadline under EDF policy")
+	{
+		MclThreadPoolConfig config = MCL_THREAD_POOL_CONFIG_FIXED(1);
+		MclTaskPolicy policy = MCL_TASK_POLICY_EDF(NULL);
+		MclTaskScheduler *scheduler = MclTaskScheduler_CreateWithPolicy(&config, MAX_PRIORITY, &policy);
+
+		MclTaskScheduler_SubmitWithDeadline(scheduler, &demoTasks[URGENT][1].task, URGENT, 3000000);
+		MclTaskScheduler_SubmitWithDeadline(scheduler, &demoTasks[NORMAL][2].task, NORMAL, 1000000);
+		MclTaskScheduler_SubmitWithDeadline(scheduler, &demoTasks[URGENT][3].task, URGENT, 2000000);
+
+		MclTaskScheduler_Start(scheduler);
+		MclTaskScheduler_WaitDone(scheduler);
+		MclTaskScheduler_Stop(scheduler);
+
+		ASSERT_EQ(3, history.getSize());
+		ASSERT_TRUE(history.isInOrderOf({__ET(NORMAL, 2), __ET(URGENT, 3), __ET(URGENT, 1)}));
+
+		MclTaskScheduler_Delete(scheduler);
+	}
+
 	TEST("should execute tasks by multiple threads")
 	{
 		MclTaskScheduler *scheduler = MclTaskScheduler_Create(2, MAX_PRIORITY, NULL);
@@ -175,4 +297,327 @@ FIXTURE(TaskSchedulerTest)
 
 		ASSERT_TRUE(history.isInOrderOf({__ET(URGENT), __ET(NORMAL), __ET(SLOW)}));
 	}
+
+	TEST("should execute tasks submitted from worker threads") {
+		spawnScheduler = MclTaskScheduler_Create(2, MAX_PRIORITY, NULL);
+		MclAtomic_Clear(&executedChildCount);
+
+		MclTask parentTask = MCL_TASK(0, ParentTask_Execute, NULL);
+
+		MclTaskScheduler_Start(spawnScheduler);
+		MclTaskScheduler_SubmitTask(spawnScheduler, &parentTask, URGENT);
+
+		while (MclAtomic_Get(&executedChildCount) < CHILD_TASK_COUNT) {
+			MclThread_Yield();
+		}
+		MclTaskScheduler_WaitDone(spawnScheduler);
+		MclTaskScheduler_Delete(spawnScheduler);
+
+		ASSERT_EQ(CHILD_TASK_COUNT, MclAtomic_Get(&executedChildCount));
+	}
+
+	TEST("should execute batch submitted tasks in order") {
+		MclTaskScheduler *scheduler = MclTaskScheduler_Create(1, MAX_PRIORITY, NULL);
+
+		MclTask *tasks[TASK_COUNT];
+		for (MclSize i = 0; i < TASK_COUNT; i++) {
+			tasks[i] = &demoTasks[NORMAL][i].task;
+		}
+		ASSERT_EQ(TASK_COUNT, MclTaskScheduler_SubmitTasks(scheduler, tasks, TASK_COUNT, NORMAL));
+
+		MclTaskScheduler_Start(scheduler);
+		MclTaskScheduler_WaitDone(scheduler);
+		MclTaskScheduler_Delete(scheduler);
+
+		ASSERT_TRUE(history.isInOrderOf({__ET(NORMAL, 0), __ET(NORMAL, 1), __ET(NORMAL, 2), __ET(NORMAL, 3), __ET(NORMAL, 4),
+		                                 __ET(NORMAL, 5), __ET(NORMAL, 6), __ET(NORMAL, 7), __ET(NORMAL, 8), __ET(NORMAL, 9)}));
+	}
+
+	TEST("should execute batch submitted tasks from worker threads") {
+		spawnScheduler = MclTaskScheduler_Create(2, MAX_PRIORITY, NULL);
+		MclAtomic_Clear(&executedChildCount);
+
+		MclTask parentTask = MCL_TASK(0, BatchParentTask_Execute, NULL);
+
+		MclTaskScheduler_Start(spawnScheduler);
+		MclTaskScheduler_SubmitTask(spawnScheduler, &parentTask, URGENT);
+
+		while (MclAtomic_Get(&executedChildCount) < CHILD_TASK_COUNT) {
+			MclThread_Yield();
+		}
+		MclTaskScheduler_WaitDone(spawnScheduler);
+		MclTaskScheduler_Delete(spawnScheduler);
+
+		ASSERT_EQ(CHILD_TASK_COUNT, MclAtomic_Get(&executedChildCount));
+	}
+
+	TEST("should remove keyed task submitted from worker thread") {
+		spawnScheduler = MclTaskScheduler_Create(1, MAX_PRIORITY, NULL);
+		MclAtomic_Clear(&executedChildCount);
+
+		MclTask parentTask = MCL_TASK(0, KeyedParentTask_Execute, NULL);
+
+		MclTaskScheduler_Start(spawnScheduler);
+		MclTaskScheduler_SubmitTask(spawnScheduler, &parentTask, URGENT);
+		MclTaskScheduler_WaitDone(spawnScheduler);
+		MclTaskScheduler_Delete(spawnScheduler);
+
+		ASSERT_TRUE(isKeyedChildPending);
+		ASSERT_TRUE(isKeyedChildRemoved);
+		ASSERT_EQ(0, MclAtomic_Get(&executedChildCount));
+	}
+
+	TEST("should execute queued task of higher priority before local task") {
+		spawnScheduler = MclTaskScheduler_Create(1, MAX_PRIORITY, NULL);
+		MclAtomic_Clear(&executedOrder);
+
+		MclTask parentTask = MCL_TASK(0, MixedParentTask_Execute, NULL);
+
+		MclTaskScheduler_Start(spawnScheduler);
+		MclTaskScheduler_SubmitTask(spawnScheduler, &parentTask, URGENT);
+		MclTaskScheduler_WaitDone(spawnScheduler);
+		MclTaskScheduler_Delete(spawnScheduler);
+
+		ASSERT_EQ(1, MclAtomic_Get(&queuedUrgentOrder));
+		ASSERT_EQ(2, MclAtomic_Get(&localSlowOrder));
+	}
+
+	TEST("should replace pending task of same key") {
+		MclTaskScheduler *scheduler = MclTaskScheduler_Create(1, MAX_PRIORITY, NULL);
+
+		submitTask(scheduler, NORMAL, 0);
+		submitTask(scheduler, NORMAL, 1);
+		submitTask(scheduler, NORMAL, 2);
+
+		ASSERT_TRUE(MclTaskScheduler_IsPending(scheduler, 1, NORMAL));
+		ASSERT_FALSE(MclTaskScheduler_IsPending(scheduler, 1, URGENT));
+		ASSERT_FALSE(MclTaskScheduler_IsPending(scheduler, 3, NORMAL));
+
+		DemoTask replacement;
+		DemoTask_Init(&replacement, 1, NORMAL, slowTaskPauseTime, &history);
+		ASSERT_EQ(MCL_SUCCESS, MclTaskScheduler_ReplaceTask(scheduler, &replacement.task, NORMAL));
+		ASSERT_TRUE(MclTaskScheduler_IsPending(scheduler, 1, NORMAL));
+
+		MclTaskScheduler_Start(scheduler);
+		MclTaskScheduler_WaitDone(scheduler);
+		MclTaskScheduler_Delete(scheduler);
+
+		ASSERT_TRUE(history.isInOrderOf({__ET(NORMAL, 0), __ET(NORMAL, 2), __ET(NORMAL, 1)}));
+	}
+
+	TEST("should remove all pending tasks of key by index") {
+		MclTaskScheduler *scheduler = MclTaskScheduler_Create(1, MAX_PRIORITY, NULL);
+
+		DemoTask duplicate;
+		DemoTask_Init(&duplicate, 1, URGENT, slowTaskPauseTime, &history);
+
+		submitTask(scheduler, URGENT, 0);
+		submitTask(scheduler, URGENT, 1);
+		MclTaskScheduler_SubmitTask(scheduler, &duplicate.task, URGENT);
+		submitTask(scheduler, URGENT, 2);
+
+		ASSERT_EQ(MCL_SUCCESS, MclTaskScheduler_RemoveTask(scheduler, 1, URGENT));
+		ASSERT_FALSE(MclTaskScheduler_IsPending(scheduler, 1, URGENT));
+		ASSERT_TRUE(MclTaskScheduler_IsPending(scheduler, 2, URGENT));
+
+		MclTaskScheduler_Start(scheduler);
+		MclTaskScheduler_WaitDone(scheduler);
+		MclTaskScheduler_Delete(scheduler);
+
+		ASSERT_TRUE(history.isInOrderOf({__ET(URGENT, 0), __ET(URGENT, 2)}));
+	}
+
+	TEST("should pin workers to explicit cpus") {
+		const MclSize cpus[] = {0};
+		MclThreadPoolConfig config = MCL_THREAD_POOL_CONFIG_FIXED(2);
+		config.pinning = MCL_THREAD_PIN_EXPLICIT;
+		config.cpus = cpus;
+		config.cpuCount = 1;
+		MclTaskScheduler *scheduler = MclTaskScheduler_CreateElastic(&config, MAX_PRIORITY, NULL);
+		MclAtomic_Clear(&pinnedTaskCount);
+		pinnedCpu = 0;
+
+		MclTask pinnedTasks[8];
+		for (MclSize i = 0; i < 8; i++) {
+			pinnedTasks[i] = MCL_TASK(i, PinnedTask_Execute, NULL);
+			MclTaskScheduler_SubmitTask(scheduler, &pinnedTasks[i], NORMAL);
+		}
+		MclTaskScheduler_Start(scheduler);
+		MclTaskScheduler_WaitDone(scheduler);
+		MclTaskScheduler_Delete(scheduler);
+
+		ASSERT_EQ(8, MclAtomic_Get(&pinnedTaskCount));
+	}
+
+	TEST("should pin workers only to cpus allowed to creator") {
+		cpu_set_t origin;
+		CPU_ZERO(&origin);
+		ASSERT_EQ(0, pthread_getaffinity_np(pthread_self(), sizeof(origin), &origin));
+
+		// like a cpuset without cpu 0, when more than one cpu is online
+		pinnedCpu = 0;
+		for (MclSize cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+			if (CPU_ISSET(cpu, &origin)) pinnedCpu = cpu;
+		}
+		cpu_set_t restricted;
+		CPU_ZERO(&restricted);
+		CPU_SET(pinnedCpu, &restricted);
+		ASSERT_EQ(0, pthread_setaffinity_np(pthread_self(), sizeof(restricted), &restricted));
+
+		MclThreadPoolConfig config = MCL_THREAD_POOL_CONFIG_FIXED(2);
+		config.pinning = MCL_THREAD_PIN_COMPACT;
+		MclTaskScheduler *scheduler = MclTaskScheduler_CreateElastic(&config, MAX_PRIORITY, NULL);
+		ASSERT_EQ(0, pthread_setaffinity_np(pthread_self(), sizeof(origin), &origin));
+		MclAtomic_Clear(&pinnedTaskCount);
+
+		MclTask pinnedTasks[8];
+		for (MclSize i = 0; i < 8; i++) {
+			pinnedTasks[i] = MCL_TASK(i, PinnedTask_Execute, NULL);
+			MclTaskScheduler_SubmitTask(scheduler, &pinnedTasks[i], NORMAL);
+		}
+		ASSERT_EQ(MCL_SUCCESS, MclTaskScheduler_Start(scheduler));
+		MclTaskScheduler_WaitDone(scheduler);
+		MclTaskScheduler_Delete(scheduler);
+
+		ASSERT_EQ(8, MclAtomic_Get(&pinnedTaskCount));
+	}
+
+#ifdef MCL_TASK_STATS_ENABLED
+	TEST("should collect task stats by priority") {
+		MclTaskScheduler *scheduler = MclTaskScheduler_Create(1, MAX_PRIORITY, NULL);
+
+		submitTask(scheduler, URGENT, 0);
+		submitTask(scheduler, URGENT, 1);
+		submitTask(scheduler, NORMAL, 0);
+		MclTaskScheduler_RemoveTask(scheduler, 0, NORMAL);
+
+		MclTaskScheduler_Start(scheduler);
+		MclTaskScheduler_WaitDone(scheduler);
+
+		MclTaskPriorityStats stats;
+		ASSERT_EQ(MCL_SUCCESS, MclTaskScheduler_GetStats(scheduler, URGENT, &stats));
+		ASSERT_EQ(2, stats.submittedCount);
+		ASSERT_EQ(2, stats.executedCount);
+		ASSERT_EQ(2, stats.latency.count);
+
+		ASSERT_EQ(MCL_SUCCESS, MclTaskScheduler_GetStats(scheduler, NORMAL, &stats));
+		ASSERT_EQ(1, stats.submittedCount);
+		ASSERT_EQ(0, stats.executedCount);
+		ASSERT_EQ(1, stats.cancelledCount);
+
+		MclTaskScheduler_Delete(scheduler);
+	}
+#else
+	TEST("should fail to get task stats when compiled out") {
+		MclTaskScheduler *scheduler = MclTaskScheduler_Create(1, MAX_PRIORITY, NULL);
+
+		MclTaskPriorityStats stats;
+		ASSERT_EQ(MCL_FAILURE, MclTaskScheduler_GetStats(scheduler, URGENT, &stats));
+
+		MclTaskScheduler_Delete(scheduler);
+	}
+#endif
+
+	TEST("should grow workers when overloaded and retire them when idle") {
+		MclThreadPoolConfig config = MCL_THREAD_POOL_CONFIG_ELASTIC(1, 4, 1, 50 * 1000);
+		MclTaskScheduler *scheduler = MclTaskScheduler_CreateElastic(&config, MAX_PRIORITY, NULL);
+
+		MclTaskScheduler_Start(scheduler);
+		ASSERT_EQ(1, MclTaskScheduler_GetThreadCount(scheduler));
+
+		MclTask sleepTasks[32];
+		MclSize maxThreadCount = 0;
+		for (MclSize i = 0; i < 32; i++) {
+			sleepTasks[i] = MCL_TASK(i, SleepTask_Execute, NULL);
+			MclTaskScheduler_SubmitTask(scheduler, &sleepTasks[i], NORMAL);
+		}
+		for (int i = 0; i < 100 && MclTaskScheduler_GetThreadCount(scheduler) < 4; i++) {
+			usleep(1000);
+		}
+		maxThreadCount = MclTaskScheduler_GetThreadCount(scheduler);
+
+		MclTaskScheduler_WaitDone(scheduler);
+		ASSERT_TRUE(maxThreadCount > 1);
+		ASSERT_TRUE(maxThreadCount <= 4);
+
+		for (int i = 0; i < 100 && MclTaskScheduler_GetThreadCount(scheduler) > 1; i++) {
+			usleep(20 * 1000);
+		}
+		ASSERT_EQ(1, MclTaskScheduler_GetThreadCount(scheduler));
+
+		MclTaskScheduler_Delete(scheduler);
+	}
+
+	TEST("should execute delayed task after delay") {
+		MclTaskScheduler *scheduler = MclTaskScheduler_Create(1, MAX_PRIORITY, NULL);
+		MclAtomic_Clear(&executedTimerCount);
+
+		MclTask task = MCL_TASK(1, TimerTask_Execute, NULL);
+		MclTaskScheduler_Start(scheduler);
+		ASSERT_EQ(MCL_SUCCESS, MclTaskScheduler_SubmitDelayed(scheduler, &task, NORMAL, 50 * 1000));
+
+		usleep(10 * 1000);
+		ASSERT_EQ(0, MclAtomic_Get(&executedTimerCount));
+
+		for (int i = 0; i < 100 && MclAtomic_Get(&executedTimerCount) == 0; i++) {
+			usleep(10 * 1000);
+		}
+		ASSERT_EQ(1, MclAtomic_Get(&executedTimerCount));
+
+		MclTaskScheduler_Delete(scheduler);
+	}
+
+	TEST("should execute periodic task until removed") {
+		MclTaskScheduler *scheduler = MclTaskScheduler_Create(1, MAX_PRIORITY, NULL);
+		MclAtomic_Clear(&executedTimerCount);
+
+		MclTask task = MCL_TASK(2, TimerTask_Execute, NULL);
+		MclTaskScheduler_Start(scheduler);
+		ASSERT_EQ(MCL_SUCCESS, MclTaskScheduler_SubmitPeriodic(scheduler, &task, URGENT, 10 * 1000));
+
+		for (int i = 0; i < 200 && MclAtomic_Get(&executedTimerCount) < 3; i++) {
+			usleep(10 * 1000);
+		}
+		ASSERT_TRUE(MclAtomic_Get(&executedTimerCount) >= 3);
+
+		ASSERT_EQ(MCL_SUCCESS, MclTaskScheduler_RemoveTask(scheduler, 2, URGENT));
+		MclTaskScheduler_WaitDone(scheduler);
+		MclAtomic count = MclAtomic_Get(&executedTimerCount);
+		usleep(50 * 1000);
+		ASSERT_EQ(count, MclAtomic_Get(&executedTimerCount));
+
+		MclTaskScheduler_Delete(scheduler);
+	}
+
+	TEST("should submit task on ready and destroy it if removed or deleted before") {
+		MclTaskScheduler *scheduler = MclTaskScheduler_Create(1, MAX_PRIORITY, NULL);
+		MclFuture *ready = MclFuture_Create();
+		MclFuture *never = MclFuture_Create();
+		MclAtomic_Clear(&executedChildCount);
+		MclAtomic_Clear(&destroyedWaiterCount);
+
+		MclTask readyTask = MCL_TASK(1, ChildTask_Execute, WaiterTask_Destroy);
+		MclTask removedTask = MCL_TASK(2, ChildTask_Execute, WaiterTask_Destroy);
+		MclTask droppedTask = MCL_TASK(3, ChildTask_Execute, WaiterTask_Destroy);
+		MclTaskScheduler_Start(scheduler);
+		ASSERT_EQ(MCL_SUCCESS, MclTaskScheduler_SubmitOnReady(scheduler, &readyTask, NORMAL, ready));
+		ASSERT_EQ(MCL_SUCCESS, MclTaskScheduler_SubmitOnReady(scheduler, &removedTask, NORMAL, never));
+		ASSERT_EQ(MCL_SUCCESS, MclTaskScheduler_SubmitOnReady(scheduler, &droppedTask, NORMAL, never));
+
+		ASSERT_EQ(MCL_SUCCESS, MclTaskScheduler_RemoveTask(scheduler, 2, NORMAL));
+		ASSERT_EQ(1, MclAtomic_Get(&destroyedWaiterCount));
+
+		ASSERT_EQ(MCL_SUCCESS, MclFuture_Set(ready, MCL_SUCCESS, nullptr));
+		MclTaskScheduler_WaitDone(scheduler);
+		ASSERT_EQ(1, MclAtomic_Get(&executedChildCount));
+		ASSERT_EQ(2, MclAtomic_Get(&destroyedWaiterCount));
+
+		MclTaskScheduler_Delete(scheduler);
+		ASSERT_EQ(3, MclAtomic_Get(&destroyedWaiterCount));
+		ASSERT_EQ(MCL_SUCCESS, MclFuture_Set(never, MCL_SUCCESS, nullptr));
+		ASSERT_EQ(1, MclAtomic_Get(&executedChildCount));
+
+		MclFuture_Delete(never);
+		MclFuture_Delete(ready);
+	}
 };
@@ -0,0 +1,73 @@
+#include <cctest/cctest.h>
+#include "mcl/task/task_stats.h"
+
+FIXTURE(TaskStatsTest)
+{
+	MclTaskStats *stats {nullptr};
+	MclTaskPriorityStats snapshot;
+
+	BEFORE {
+		stats = MclTaskStats_Create(2);
+	}
+
+	AFTER {
+		MclTaskStats_Delete(stats);
+	}
+
+	TEST("should count events by priority") {
+		MclTaskStats_AddSubmitted(stats, 0, 3);
+		MclTaskStats_AddSubmitted(stats, 1, 1);
+		MclTaskStats_AddCancelled(stats, 0, 1);
+		MclTaskStats_AddThresholdSkip(stats, 1);
+		MclTaskStats_AddExecuted(stats, 0, 10, 20);
+
+		ASSERT_EQ(MCL_SUCCESS, MclTaskStats_GetSnapshot(stats, 0, &snapshot));
+		ASSERT_EQ(3, snapshot.submittedCount);
+		ASSERT_EQ(1, snapshot.executedCount);
+		ASSERT_EQ(1, snapshot.cancelledCount);
+		ASSERT_EQ(0, snapshot.thresholdSkipCount);
+
+		ASSERT_EQ(MCL_SUCCESS, MclTaskStats_GetSnapshot(stats, 1, &snapshot));
+		ASSERT_EQ(1, snapshot.submittedCount);
+		ASSERT_EQ(0, snapshot.executedCount);
+		ASSERT_EQ(1, snapshot.thresholdSkipCount);
+
+		ASSERT_EQ(MCL_FAILURE, MclTaskStats_GetSnapshot(stats, 2, &snapshot));
+	}
+
+	TEST("should record queue wait run time and latency histograms") {
+		MclTaskStats_AddExecuted(stats, 0, 0, 5);
+		MclTaskStats_AddExecuted(stats, 0, 100, 1000);
+
+		MclTaskStats_GetSnapshot(stats, 0, &snapshot);
+		ASSERT_EQ(2, snapshot.queueWait.count);
+		ASSERT_EQ(1, snapshot.queueWait.buckets[0]);
+		ASSERT_EQ(1, snapshot.queueWait.buckets[7]);
+		ASSERT_EQ(100, snapshot.queueWait.maxUs);
+		ASSERT_EQ(1005, snapshot.runTime.sumUs);
+		ASSERT_EQ(1100, snapshot.latency.maxUs);
+		ASSERT_EQ(1105, snapshot.latency.sumUs);
+	}
+
+	TEST("should get percentile by bucket upper bound") {
+		for (MclTimeUs i = 0; i < 99; i++) {
+			MclTaskStats_AddExecuted(stats, 0, 3, 0);
+		}
+		MclTaskStats_AddExecuted(stats, 0, 5000, 0);
+
+		MclTaskStats_GetSnapshot(stats, 0, &snapshot);
+		ASSERT_EQ(3, MclTaskHistogram_GetPercentileUs(&snapshot.queueWait, 500));
+		ASSERT_EQ(3, MclTaskHistogram_GetPercentileUs(&snapshot.queueWait, 990));
+		ASSERT_EQ(5000, MclTaskHistogram_GetPercentileUs(&snapshot.queueWait, 1000));
+	}
+
+	TEST("should clear all by reset") {
+		MclTaskStats_AddSubmitted(stats, 0, 3);
+		MclTaskStats_AddExecuted(stats, 0, 1, 1);
+		MclTaskStats_Reset(stats);
+
+		MclTaskStats_GetSnapshot(stats, 0, &snapshot);
+		ASSERT_EQ(0, snapshot.submittedCount);
+		ASSERT_EQ(0, snapshot.latency.count);
+	}
+};
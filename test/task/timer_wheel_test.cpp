@@ -0,0 +1,156 @@
+#include <cctest/cctest.h>
+#include "mcl/task/timer_wheel.h"
+#include <vector>
+
+namespace {
+	struct DemoTimer {
+		MclTimer timer;
+		int id;
+		std::vector<MclTimerTick> *firedTicks;
+		MclTimerWheel *wheel;
+		bool isDestroyed;
+	};
+
+	void DemoTimer_Expire(MclTimer *timer) {
+		DemoTimer *self = (DemoTimer*)timer;
+		self->firedTicks->push_back(MclTimerWheel_GetCurrentTick(self->wheel) - 1);
+	}
+
+	void DemoTimer_Destroy(MclTimer *timer) {
+		((DemoTimer*)timer)->isDestroyed = true;
+	}
+
+	bool DemoTimerPred_IsOdd(MclTimer *timer, void*) {
+		return ((DemoTimer*)timer)->id % 2;
+	}
+}
+
+FIXTURE(TimerWheelTest)
+{
+	MclTimerWheel wheel;
+	std::vector<MclTimerTick> firedTicks;
+
+	BEFORE {
+		MclTimerWheel_Init(&wheel, 0);
+	}
+
+	void initTimer(DemoTimer &timer, int id) {
+		MclTimer_Init(&timer.timer, DemoTimer_Expire, DemoTimer_Destroy);
+		timer.id = id;
+		timer.firedTicks = &firedTicks;
+		timer.wheel = &wheel;
+		timer.isDestroyed = false;
+	}
+
+	TEST("should fire timer when due") {
+		DemoTimer timer;
+		initTimer(timer, 0);
+
+		ASSERT_EQ(MCL_SUCCESS, MclTimerWheel_Add(&wheel, &timer.timer, 10, 0));
+		ASSERT_TRUE(MclTimer_IsPending(&timer.timer));
+		ASSERT_EQ(1, MclTimerWheel_GetCount(&wheel));
+
+		ASSERT_EQ(0, MclTimerWheel_Advance(&wheel, 9));
+		ASSERT_EQ(1, MclTimerWheel_Advance(&wheel, 10));
+		ASSERT_FALSE(MclTimer_IsPending(&timer.timer));
+		ASSERT_EQ(0, MclTimerWheel_GetCount(&wheel));
+		ASSERT_EQ(10, firedTicks[0]);
+	}
+
+	TEST("should fire timers cascaded from upper levels at exact tick") {
+		MclTimerTick delays[] = {255, 256, 300, 16383, 16384, 70000, 2000000};
+		DemoTimer timers[7];
+		for (int i = 0; i < 7; i++) {
+			initTimer(timers[i], i);
+			ASSERT_EQ(MCL_SUCCESS, MclTimerWheel_Add(&wheel, &timers[i].timer, delays[i], 0));
+		}
+
+		ASSERT_EQ(7, MclTimerWheel_Advance(&wheel, 2000000));
+		for (int i = 0; i < 7; i++) {
+			ASSERT_EQ(delays[i], firedTicks[i]);
+		}
+	}
+
+	TEST("should fire timers beyond range at exact tick") {
+		MclTimerTick delays[] = {MCL_TIMER_WHEEL_TICKS_MAX, MCL_TIMER_WHEEL_TICKS_MAX * 2 + 300, MCL_TIMER_WHEEL_TICKS_MAX * 3 + 70000};
+		DemoTimer timers[3];
+		for (int i = 0; i < 3; i++) {
+			initTimer(timers[i], i);
+			ASSERT_EQ(MCL_SUCCESS, MclTimerWheel_Add(&wheel, &timers[i].timer, delays[i], 0));
+		}
+
+		ASSERT_EQ(0, MclTimerWheel_Advance(&wheel, delays[0] - 1));
+		ASSERT_EQ(1, MclTimerWheel_Advance(&wheel, delays[0]));
+		ASSERT_EQ(0, MclTimerWheel_Advance(&wheel, delays[1] - 1));
+		ASSERT_EQ(1, MclTimerWheel_Advance(&wheel, delays[1]));
+		ASSERT_EQ(0, MclTimerWheel_Advance(&wheel, delays[2] - 1));
+		ASSERT_EQ(1, MclTimerWheel_Advance(&wheel, delays[2]));
+		for (int i = 0; i < 3; i++) {
+			ASSERT_EQ(delays[i], firedTicks[i]);
+		}
+	}
+
+	TEST("should tell next tick of due slot or cascade") {
+		ASSERT_EQ(MCL_TIMER_WHEEL_TICKS_MAX, MclTimerWheel_GetNextTick(&wheel));
+
+		DemoTimer timers[2];
+		initTimer(timers[0], 0);
+		initTimer(timers[1], 1);
+		MclTimerWheel_Add(&wheel, &timers[0].timer, 10, 0);
+		MclTimerWheel_Add(&wheel, &timers[1].timer, 1000, 0);
+		ASSERT_EQ(10, MclTimerWheel_GetNextTick(&wheel));
+
+		ASSERT_EQ(1, MclTimerWheel_Advance(&wheel, 10));
+		ASSERT_EQ(768, MclTimerWheel_GetNextTick(&wheel));
+
+		ASSERT_EQ(0, MclTimerWheel_Advance(&wheel, 768));
+		ASSERT_EQ(1000, MclTimerWheel_GetNextTick(&wheel));
+
+		ASSERT_EQ(1, MclTimerWheel_Advance(&wheel, 1000));
+		ASSERT_EQ(1000, firedTicks[1]);
+	}
+
+	TEST("should not fire cancelled timer") {
+		DemoTimer timer;
+		initTimer(timer, 0);
+
+		MclTimerWheel_Add(&wheel, &timer.timer, 1000, 0);
+		ASSERT_EQ(MCL_SUCCESS, MclTimerWheel_Cancel(&wheel, &timer.timer));
+		ASSERT_TRUE(MCL_FAILED(MclTimerWheel_Cancel(&wheel, &timer.timer)));
+
+		ASSERT_EQ(0, MclTimerWheel_Advance(&wheel, 2000));
+		ASSERT_TRUE(firedTicks.empty());
+		ASSERT_FALSE(timer.isDestroyed);
+	}
+
+	TEST("should fire periodic timer every period") {
+		DemoTimer timer;
+		initTimer(timer, 0);
+
+		MclTimerWheel_Add(&wheel, &timer.timer, 100, 100);
+		ASSERT_EQ(5, MclTimerWheel_Advance(&wheel, 500));
+		ASSERT_TRUE(MclTimer_IsPending(&timer.timer));
+		for (int i = 0; i < 5; i++) {
+			ASSERT_EQ((MclTimerTick)(i + 1) * 100, firedTicks[i]);
+		}
+		MclTimerWheel_Cancel(&wheel, &timer.timer);
+	}
+
+	TEST("should remove and destroy timers by pred") {
+		DemoTimer timers[4];
+		for (int i = 0; i < 4; i++) {
+			initTimer(timers[i], i);
+			MclTimerWheel_Add(&wheel, &timers[i].timer, 100 * (i + 1) * (i + 1), 0);
+		}
+
+		ASSERT_EQ(2, MclTimerWheel_RemoveAllByPred(&wheel, DemoTimerPred_IsOdd, NULL));
+		ASSERT_TRUE(timers[1].isDestroyed);
+		ASSERT_TRUE(timers[3].isDestroyed);
+		ASSERT_EQ(2, MclTimerWheel_GetCount(&wheel));
+
+		MclTimerWheel_Clear(&wheel);
+		ASSERT_TRUE(timers[0].isDestroyed);
+		ASSERT_TRUE(timers[2].isDestroyed);
+		ASSERT_EQ(0, MclTimerWheel_GetCount(&wheel));
+	}
+};
@@ -2,6 +2,7 @@
 #include "mcl/thread/thread_launcher.h"
 #include "mcl/array/array_size.h"
 #include "mcl/lock/atomic.h"
+#include <sched.h>
 
 namespace {
 	struct ThreadCtxt {
@@ -33,6 +34,25 @@ namespace {
 		}
 	}
 
+	struct OptionsCtxt {
+		bool isPinned;
+		size_t stackSize;
+	};
+
+	void checkOptions(void *ctxt) {
+		OptionsCtxt *optionsCtxt = (OptionsCtxt*)ctxt;
+
+		cpu_set_t cpus;
+		CPU_ZERO(&cpus);
+		pthread_getaffinity_np(pthread_self(), sizeof(cpus), &cpus);
+		optionsCtxt->isPinned = (CPU_COUNT(&cpus) == 1) && CPU_ISSET(0, &cpus);
+
+		pthread_attr_t attr;
+		pthread_getattr_np(pthread_self(), &attr);
+		pthread_attr_getstacksize(&attr, &optionsCtxt->stackSize);
+		pthread_attr_destroy(&attr);
+	}
+
 	void stop(void *ctxt) {
 		ThreadCtxt *threadCtxt = (ThreadCtxt*)ctxt;
 		MclAtomic_Set(&threadCtxt->stop, 1);
@@ -71,4 +91,32 @@ FIXTURE(ThreadLauncherTest) {
 		ASSERT_TRUE(ctxt.increaseCount < MAX_COUNT);
 		ASSERT_TRUE(ctxt.decreaseCount < MAX_COUNT);
 	}
+
+	TEST("should launch thread with affinity and stack size") {
+		constexpr MclSize STACK_SIZE = 512 * 1024;
+		OptionsCtxt ctxt = {.isPinned = false, .stackSize = 0};
+
+		MclThreadInfo thread = MCL_THREAD_INFO("Options", checkOptions, NULL, &ctxt);
+		MclCpuSet_Add(&thread.options.affinity, 0);
+		thread.options.stackSize = STACK_SIZE;
+
+		ASSERT_EQ(MCL_SUCCESS, MclThreadLauncher_Launch(&thread, 1));
+		MclThreadLauncher_WaitDone(&thread, 1);
+
+		ASSERT_TRUE(ctxt.isPinned);
+		ASSERT_EQ(STACK_SIZE, ctxt.stackSize);
+	}
+
+	TEST("should get cpus allowed to calling thread") {
+		cpu_set_t allowed;
+		CPU_ZERO(&allowed);
+		ASSERT_EQ(0, sched_getaffinity(0, sizeof(allowed), &allowed));
+
+		MclSize cpus[MCL_CPU_SET_MAX];
+		MclSize count = MclThread_GetAllowedCpus(cpus, MCL_CPU_SET_MAX);
+		ASSERT_EQ((MclSize)CPU_COUNT(&allowed), count);
+		for (MclSize i = 0; i < count; i++) {
+			ASSERT_TRUE(CPU_ISSET(cpus[i], &allowed));
+		}
+	}
 };